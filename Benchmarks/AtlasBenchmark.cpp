@@ -0,0 +1,97 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryAtlas.h"
+
+/**
+ *  Builds the vertex buffer of 100K sprites drawn from a 2048x2048 texture atlas. Computing
+ *  the vertices of each sprite from its CGRects is compared with
+ *  JSGRectArrayWriteSpriteVertices.
+ */
+
+int main()
+{
+    const size_t spriteCount = 100000;
+    const CGSize textureSize = CGSizeMake(2048, 2048);
+    std::vector<CGRect> frames(spriteCount);
+    std::vector<CGRect> atlasRects(spriteCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Sprites are packed in a grid of 64x64 cells in the atlas
+    for (size_t i = 0; i < spriteCount; i++) {
+        size_t cell = (size_t)(next() * 1024);
+
+        frames[i] = CGRectMake(next() * 1920, next() * 1080, 16 + next() * 48, 16 + next() * 48);
+        atlasRects[i] = CGRectMake(cell % 32 * 64, cell / 32 * 64, 16 + (int)(next() * 48), 16 + (int)(next() * 48));
+    }
+
+    std::vector<JSGSpriteVertex> expected(spriteCount * JSG_SPRITE_VERTEX_COUNT);
+
+    JSGBenchmarkRun("vertices from each sprite's CGRects (100K sprites)", 10, spriteCount, [&] {
+        for (size_t i = 0; i < spriteCount; i++) {
+            CGRect frame = frames[i];
+            CGRect atlasRect = CGRectInset(atlasRects[i], 0.5, 0.5);
+            JSGSpriteVertex *vertices = &expected[i * JSG_SPRITE_VERTEX_COUNT];
+
+            for (size_t corner = 0; corner < JSG_SPRITE_VERTEX_COUNT; corner++) {
+                bool right = corner & 1;
+                bool bottom = corner & 2;
+
+                vertices[corner].x = (float)(right ? CGRectGetMaxX(frame) : CGRectGetMinX(frame));
+                vertices[corner].y = (float)(bottom ? CGRectGetMaxY(frame) : CGRectGetMinY(frame));
+                vertices[corner].u = (float)((right ? CGRectGetMaxX(atlasRect) : CGRectGetMinX(atlasRect)) / textureSize.width);
+                vertices[corner].v = (float)((bottom ? CGRectGetMaxY(atlasRect) : CGRectGetMinY(atlasRect)) / textureSize.height);
+            }
+        }
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGRectArray frameArray;
+    JSGRectArray atlasArray;
+    JSGRectArrayInit(&frameArray);
+    JSGRectArrayInit(&atlasArray);
+    JSGRectArraySetRects(&frameArray, frames.data(), spriteCount);
+    JSGRectArraySetRects(&atlasArray, atlasRects.data(), spriteCount);
+
+    std::vector<JSGSpriteVertex> vertices(spriteCount * JSG_SPRITE_VERTEX_COUNT);
+
+    JSGBenchmarkRun("JSGRectArrayWriteSpriteVertices (100K sprites)", 10, spriteCount, [&] {
+        JSGRectArrayWriteSpriteVertices(&frameArray, &atlasArray, textureSize, 0.5, false, vertices.data(), sizeof(JSGSpriteVertex), offsetof(JSGSpriteVertex, x), offsetof(JSGSpriteVertex, u));
+        JSGBenchmarkKeep(vertices);
+    });
+
+    // Multiplying by the inverse of a power of two texture size is exact
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (vertices[i].x != expected[i].x || vertices[i].y != expected[i].y || vertices[i].u != expected[i].u || vertices[i].v != expected[i].v) {
+            std::printf("Vertex %zu of sprite %zu differs\n", i % JSG_SPRITE_VERTEX_COUNT, i / JSG_SPRITE_VERTEX_COUNT);
+            return 1;
+        }
+    }
+
+    std::vector<uint32_t> indices(spriteCount * JSG_SPRITE_INDEX_COUNT);
+
+    JSGBenchmarkRun("JSGSpriteIndicesFill (100K sprites)", 10, spriteCount, [&] {
+        JSGSpriteIndicesFill(indices.data(), 0, spriteCount);
+        JSGBenchmarkKeep(indices);
+    });
+
+    if (indices.back() != spriteCount * JSG_SPRITE_VERTEX_COUNT - 1) {
+        std::printf("The last index is %u instead of %zu\n", indices.back(), spriteCount * JSG_SPRITE_VERTEX_COUNT - 1);
+        return 1;
+    }
+
+    JSGRectArrayDestroy(&frameArray);
+    JSGRectArrayDestroy(&atlasArray);
+
+    return 0;
+}
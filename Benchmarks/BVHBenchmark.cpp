@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryBVH.h"
+
+/**
+ *  Indexes the 200K layers of a large design document, then measures viewport culling &
+ *  hit testing. The BVH is compared with an R-tree bulk loaded using sort-tile-recursive
+ *  packing, the usual choice for static data, & with a linear scan.
+ */
+
+static const size_t JSGPackedRTreeNodeSize = 16;
+
+struct JSGPackedRTree {
+    struct Node {
+        CGFloat minX, minY, maxX, maxY;
+        size_t first;
+        size_t count;
+        bool leaf;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<size_t> items;
+    std::vector<CGRect> rects;
+    size_t root = 0;
+
+    void build(const std::vector<CGRect> &input)
+    {
+        rects = input;
+        items.resize(rects.size());
+        nodes.clear();
+
+        for (size_t i = 0; i < items.size(); i++) {
+            items[i] = i;
+        }
+
+        std::vector<Node> level = pack(items, true);
+
+        while (level.size() > 1) {
+            size_t first = nodes.size();
+            nodes.insert(nodes.end(), level.begin(), level.end());
+
+            std::vector<size_t> children(level.size());
+
+            for (size_t i = 0; i < children.size(); i++) {
+                children[i] = first + i;
+            }
+
+            level = pack(children, false);
+        }
+
+        root = nodes.size();
+        nodes.insert(nodes.end(), level.begin(), level.end());
+    }
+
+    CGRect bounds(size_t entry, bool leaf) const
+    {
+        return leaf ? rects[entry] : CGRectMake(nodes[entry].minX, nodes[entry].minY, nodes[entry].maxX - nodes[entry].minX, nodes[entry].maxY - nodes[entry].minY);
+    }
+
+    // Sort by x into vertical slices, then each slice by y into nodes
+    std::vector<Node> pack(std::vector<size_t> &entries, bool leaf)
+    {
+        size_t nodeCount = (entries.size() + JSGPackedRTreeNodeSize - 1) / JSGPackedRTreeNodeSize;
+        size_t sliceSize = (size_t)ceil(sqrt((double)nodeCount)) * JSGPackedRTreeNodeSize;
+        std::vector<Node> level;
+
+        std::sort(entries.begin(), entries.end(), [&](size_t a, size_t b) {
+            return CGRectGetMidX(bounds(a, leaf)) < CGRectGetMidX(bounds(b, leaf));
+        });
+
+        for (size_t slice = 0; slice < entries.size(); slice += sliceSize) {
+            size_t sliceEnd = std::min(slice + sliceSize, entries.size());
+
+            std::sort(entries.begin() + slice, entries.begin() + sliceEnd, [&](size_t a, size_t b) {
+                return CGRectGetMidY(bounds(a, leaf)) < CGRectGetMidY(bounds(b, leaf));
+            });
+
+            for (size_t start = slice; start < sliceEnd; start += JSGPackedRTreeNodeSize) {
+                Node node = {CGFLOAT_MAX, CGFLOAT_MAX, -CGFLOAT_MAX, -CGFLOAT_MAX, start, std::min(JSGPackedRTreeNodeSize, sliceEnd - start), leaf};
+
+                for (size_t i = start; i < start + node.count; i++) {
+                    CGRect rect = bounds(entries[i], leaf);
+                    node.minX = std::min(node.minX, CGRectGetMinX(rect));
+                    node.minY = std::min(node.minY, CGRectGetMinY(rect));
+                    node.maxX = std::max(node.maxX, CGRectGetMaxX(rect));
+                    node.maxY = std::max(node.maxY, CGRectGetMaxY(rect));
+                }
+
+                level.push_back(node);
+            }
+        }
+
+        if (leaf) {
+            items = entries;
+        } else {
+            // Inner nodes point at their children, which are stored contiguously
+            std::vector<Node> children(entries.size());
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                children[i] = nodes[entries[i]];
+            }
+
+            size_t first = nodes.size() - entries.size();
+            std::copy(children.begin(), children.end(), nodes.begin() + first);
+
+            for (Node &node : level) {
+                node.first += first;
+            }
+        }
+
+        return level;
+    }
+
+    size_t query(CGRect rect) const
+    {
+        size_t stack[256];
+        size_t stackCount = 0;
+        size_t found = 0;
+
+        stack[stackCount++] = root;
+
+        while (stackCount) {
+            const Node &node = nodes[stack[--stackCount]];
+
+            if (node.minX >= CGRectGetMaxX(rect) || node.minY >= CGRectGetMaxY(rect) || node.maxX <= CGRectGetMinX(rect) || node.maxY <= CGRectGetMinY(rect)) {
+                continue;
+            }
+
+            for (size_t i = node.first; i < node.first + node.count; i++) {
+                if (node.leaf) {
+                    found += !CGRectIsEmpty(CGRectIntersection(rects[items[i]], rect));
+                } else {
+                    stack[stackCount++] = i;
+                }
+            }
+        }
+
+        return found;
+    }
+};
+
+int main()
+{
+    const size_t layerCount = 200000;
+    const size_t queryCount = 10000;
+    std::vector<CGRect> layers(layerCount);
+    std::vector<CGRect> viewports(queryCount);
+    std::vector<CGPoint> points(queryCount);
+    std::vector<size_t> found(layerCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Artboards full of small layers, with a few large backgrounds & groups
+    for (size_t i = 0; i < layerCount; i++) {
+        CGFloat artboardX = (int)(next() * 20) * 1000;
+        CGFloat artboardY = (int)(next() * 20) * 1000;
+        CGFloat size = i % 1000 == 0 ? 400 + next() * 600 : 4 + next() * 60;
+
+        layers[i] = CGRectMake(artboardX + next() * (1000 - size), artboardY + next() * (1000 - size), size * (0.5 + next()), size * (0.5 + next()));
+    }
+
+    for (size_t i = 0; i < queryCount; i++) {
+        viewports[i] = CGRectMake(next() * 19000, next() * 19000, 1280, 800);
+        points[i] = CGPointMake(next() * 20000, next() * 20000);
+    }
+
+    JSGRectArray rects;
+    JSGRectArrayInit(&rects);
+    JSGRectArraySetRects(&rects, layers.data(), layerCount);
+
+    JSGPackedRTree rtree;
+    JSGBVH bvh;
+    JSGBVHInit(&bvh, &rects, 1);
+
+    JSGBenchmarkRun("R-tree STR bulk load (200K rects)", 1, layerCount, [&] {
+        rtree.build(layers);
+        JSGBenchmarkKeep(rtree.root);
+    });
+
+    JSGBenchmarkRun("JSGBVHInit, 1 thread (200K rects)", 3, layerCount, [&] {
+        JSGBVHDestroy(&bvh);
+        JSGBVHInit(&bvh, &rects, 1);
+        JSGBenchmarkKeep(bvh.nodeCount);
+    });
+
+    JSGBenchmarkRun("JSGBVHInit, default threads (200K rects)", 3, layerCount, [&] {
+        JSGBVHDestroy(&bvh);
+        JSGBVHInit(&bvh, &rects, 0);
+        JSGBenchmarkKeep(bvh.nodeCount);
+    });
+
+    std::vector<size_t> expected(queryCount);
+    std::vector<size_t> counts(queryCount);
+
+    JSGBenchmarkRun("viewport culling, linear scan", 1, 100, [&] {
+        for (size_t i = 0; i < 100; i++) {
+            size_t count = 0;
+
+            for (const CGRect &layer : layers) {
+                count += !CGRectIsEmpty(CGRectIntersection(layer, viewports[i]));
+            }
+
+            expected[i] = count;
+        }
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGBenchmarkRun("viewport culling, R-tree", 1, queryCount, [&] {
+        for (size_t i = 0; i < queryCount; i++) {
+            counts[i] = rtree.query(viewports[i]);
+        }
+        JSGBenchmarkKeep(counts);
+    });
+
+    for (size_t i = 0; i < 100; i++) {
+        if (counts[i] != expected[i]) {
+            std::printf("R-tree found %zu layers instead of %zu\n", counts[i], expected[i]);
+            return 1;
+        }
+    }
+
+    JSGBenchmarkRun("viewport culling, JSGBVHQuery", 1, queryCount, [&] {
+        for (size_t i = 0; i < queryCount; i++) {
+            counts[i] = JSGBVHQuery(&bvh, viewports[i], found.data(), found.size());
+        }
+        JSGBenchmarkKeep(counts);
+    });
+
+    for (size_t i = 0; i < 100; i++) {
+        if (counts[i] != expected[i]) {
+            std::printf("BVH found %zu layers instead of %zu\n", counts[i], expected[i]);
+            return 1;
+        }
+    }
+
+    std::vector<size_t> hits(queryCount);
+
+    JSGBenchmarkRun("hit testing, JSGBVHHitTest", 1, queryCount, [&] {
+        for (size_t i = 0; i < queryCount; i++) {
+            hits[i] = JSGBVHHitTest(&bvh, points[i]);
+        }
+        JSGBenchmarkKeep(hits);
+    });
+
+    for (size_t i = 0; i < 100; i++) {
+        size_t hit = JSG_BVH_NONE;
+
+        for (size_t j = 0; j < layerCount; j++) {
+            hit = CGRectContainsPoint(layers[j], points[i]) ? j : hit;
+        }
+
+        if (hits[i] != hit) {
+            std::printf("BVH hit layer %zu instead of %zu\n", hits[i], hit);
+            return 1;
+        }
+    }
+
+    // The hierarchy must not depend on the number of threads it's built with
+    JSGBVH serial;
+    JSGBVHInit(&serial, &rects, 1);
+
+    if (serial.nodeCount != bvh.nodeCount || memcmp(serial.nodes, bvh.nodes, bvh.nodeCount * sizeof(JSGBVHNode)) != 0) {
+        std::printf("Building with threads gave a different hierarchy\n");
+        return 1;
+    }
+
+    std::printf("%zu nodes\n", bvh.nodeCount);
+
+    JSGBVHDestroy(&serial);
+    JSGBVHDestroy(&bvh);
+    JSGRectArrayDestroy(&rects);
+
+    return 0;
+}
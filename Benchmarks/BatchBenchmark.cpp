@@ -0,0 +1,70 @@
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryBatch.h"
+#include "../JSGeometryCommandBuffer.h"
+
+/**
+ *  Compares applying scattered rect changes directly, one call site at a time,
+ *  with recording them in a command buffer and flushing it
+ */
+
+int main()
+{
+    const size_t count = 4096;
+    const size_t changes = 16384;
+    std::vector<CGRect> rects(count);
+    std::vector<size_t> targets(changes);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(i % 97, i % 89, 20 + i % 61, 10 + i % 53);
+    }
+
+    for (size_t i = 0; i < changes; i++) {
+        targets[i] = (i * 2654435761u) % count;
+    }
+
+    JSGBenchmarkRun("direct JSGRectChange*", 1000, changes, [&] {
+        for (size_t i = 0; i < changes; i++) {
+            CGRect &rect = rects[targets[i]];
+
+            switch (i % 3) {
+                case 0:
+                    rect = JSGRectChangeOriginX(rect, i);
+                    break;
+                case 1:
+                    rect = JSGRectChangeWidth(rect, i);
+                    break;
+                case 2:
+                    rect = JSGRectChangeHeight(rect, i);
+                    break;
+            }
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+
+    JSGBenchmarkRun("JSGCommandBuffer enqueue + flush", 1000, changes, [&] {
+        for (size_t i = 0; i < changes; i++) {
+            switch (i % 3) {
+                case 0:
+                    JSGCommandBufferEnqueueChangeOriginX(&buffer, targets[i], i);
+                    break;
+                case 1:
+                    JSGCommandBufferEnqueueChangeWidth(&buffer, targets[i], i);
+                    break;
+                case 2:
+                    JSGCommandBufferEnqueueChangeHeight(&buffer, targets[i], i);
+                    break;
+            }
+        }
+        JSGCommandBufferFlush(&buffer, rects.data(), count);
+        JSGBenchmarkKeep(rects);
+    });
+
+    JSGCommandBufferDestroy(&buffer);
+
+    return 0;
+}
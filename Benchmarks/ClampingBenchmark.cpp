@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryClamping.h"
+
+/**
+ *  Keeps 1M dragged & popped up frames on a 1920x1080 screen, with a margin of 8 points.
+ *  Clamping each CGRect with JSGRectChangeOriginX & JSGRectChangeOriginY is compared with
+ *  clamping a rect array.
+ */
+
+int main()
+{
+    const size_t frameCount = 1000000;
+    const CGRect screen = CGRectMake(0, 0, 1920, 1080);
+    const JSGEdgeInsets margins = JSGEdgeInsetsMake(8, 8, 8, 8);
+    std::vector<CGRect> frames(frameCount);
+    std::vector<CGRect> results(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Mostly frames partially off screen, with a few larger than the screen
+    for (size_t i = 0; i < frameCount; i++) {
+        CGFloat width = i % 100 == 0 ? 2000 : 100 + next() * 600;
+        CGFloat height = i % 100 == 0 ? 1200 : 50 + next() * 400;
+
+        frames[i] = CGRectMake(next() * 2400 - 400, next() * 1600 - 300, width, height);
+    }
+
+    JSGBenchmarkRun("JSGRectChangeOriginX/Y with min & max (1M rects)", 10, frameCount, [&] {
+        for (size_t i = 0; i < frameCount; i++) {
+            CGRect frame = frames[i];
+            frame = JSGRectChangeOriginX(frame, std::max(8.0, std::min(frame.origin.x, 1912 - frame.size.width)));
+            frame = JSGRectChangeOriginY(frame, std::max(8.0, std::min(frame.origin.y, 1072 - frame.size.height)));
+            results[i] = frame;
+        }
+        JSGBenchmarkKeep(results);
+    });
+
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+
+    // Frames that were clamped once stay where they are, so every iteration does the same work
+    JSGBenchmarkRun("JSGRectArrayClampToRect, shift (1M rects)", 10, frameCount, [&] {
+        JSGRectArrayClampToRect(&array, screen, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShift);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    for (size_t i = 0; i < frameCount; i++) {
+        if (!CGRectEqualToRect(JSGRectArrayGetRect(&array, i), results[i])) {
+            std::printf("Shifting rect %zu gave a different rect\n", i);
+            return 1;
+        }
+    }
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+
+    JSGBenchmarkRun("JSGRectArrayClampToRect, shrink (1M rects)", 10, frameCount, [&] {
+        JSGRectArrayClampToRect(&array, screen, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShrink);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    CGRect inside = CGRectMake(8, 8, 1904, 1064);
+
+    for (size_t i = 0; i < frameCount; i++) {
+        CGRect rect = JSGRectArrayGetRect(&array, i);
+
+        if (!CGRectEqualToRect(rect, JSGRectClampToRect(frames[i], screen, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShrink)) || !CGRectContainsRect(inside, rect)) {
+            std::printf("Shrinking rect %zu left it outside of the screen\n", i);
+            return 1;
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+
+    return 0;
+}
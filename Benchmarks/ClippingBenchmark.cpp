@@ -0,0 +1,47 @@
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryClipping.h"
+
+/**
+ *  Compares clipping rects one by one using CGRectIntersection with
+ *  JSGRectsClipToRect, with roughly half of the rects being visible
+ */
+
+int main()
+{
+    const size_t count = 1 << 16;
+    std::vector<CGRect> rects(count);
+    std::vector<CGRect> clipped(count);
+    std::vector<size_t> indices(count);
+    CGRect clipRect = CGRectMake(0, 0, 1024, 768);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake((CGFloat)((i * 7919) % 2048) - 256, (CGFloat)((i * 104729) % 1536) - 192, 20 + i % 300, 10 + i % 200);
+    }
+
+    JSGBenchmarkRun("CGRectIntersection loop", 200, count, [&] {
+        size_t clippedCount = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            CGRect rect = CGRectIntersection(rects[i], clipRect);
+
+            if (!CGRectIsEmpty(rect)) {
+                clipped[clippedCount] = rect;
+                indices[clippedCount] = i;
+                clippedCount++;
+            }
+        }
+
+        JSGBenchmarkKeep(clippedCount);
+        JSGBenchmarkKeep(clipped);
+    });
+
+    JSGBenchmarkRun("JSGRectsClipToRect", 200, count, [&] {
+        size_t clippedCount = JSGRectsClipToRect(rects.data(), count, clipRect, clipped.data(), indices.data());
+        JSGBenchmarkKeep(clippedCount);
+        JSGBenchmarkKeep(clipped);
+    });
+
+    return 0;
+}
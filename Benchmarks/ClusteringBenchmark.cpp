@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryClustering.h"
+
+/**
+ *  Clusters 100K map annotations for zoom levels 0 to 16, then measures the queries made
+ *  when panning & zooming a map, which re-query the precomputed clusters
+ */
+
+int main()
+{
+    const size_t pointCount = 100000;
+    const CGFloat worldSize = 256;
+    std::vector<CGPoint> points(pointCount);
+    std::vector<JSGCluster> clusters(pointCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Annotations gathered around cities, like most map data
+    for (size_t i = 0; i < pointCount; i++) {
+        if (i % 100 == 0) {
+            points[i] = CGPointMake(next() * worldSize, next() * worldSize);
+        } else {
+            CGPoint city = points[i - i % 100];
+            points[i] = CGPointMake(city.x + (next() - 0.5) * 2, city.y + (next() - 0.5) * 2);
+        }
+    }
+
+    JSGClusterIndex index;
+    JSGClusterIndexInit(&index, points.data(), pointCount, 40, 0, 16);
+
+    JSGBenchmarkRun("JSGClusterIndexInit (100K points, zoom 0-16)", 1, pointCount, [&] {
+        JSGClusterIndexDestroy(&index);
+        JSGClusterIndexInit(&index, points.data(), pointCount, 40, 0, 16);
+        JSGBenchmarkKeep(index.levels);
+    });
+
+    size_t query = 0;
+
+    JSGBenchmarkRun("JSGClusterIndexGetClusters (1024x768 viewport, zoom 0-17)", 1000, 1, [&] {
+        size_t zoom = query % 18;
+        CGFloat scale = (CGFloat)(1 << zoom);
+        CGRect viewport = CGRectMake(points[(query * 7919) % pointCount].x - 512 / scale, points[(query * 7919) % pointCount].y - 384 / scale, 1024 / scale, 768 / scale);
+        size_t count = JSGClusterIndexGetClusters(&index, viewport, zoom, clusters.data(), clusters.size());
+        JSGBenchmarkKeep(count);
+        query++;
+    });
+
+    // Every level must account for every point, & children must add up to their cluster
+    CGRect world = CGRectMake(-10, -10, worldSize + 20, worldSize + 20);
+
+    for (size_t zoom = 0; zoom <= 17; zoom++) {
+        size_t count = JSGClusterIndexGetClusters(&index, world, zoom, clusters.data(), clusters.size());
+        size_t total = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            total += clusters[i].count;
+        }
+
+        if (total != pointCount) {
+            std::printf("Zoom level %zu has %zu points instead of %zu\n", zoom, total, pointCount);
+            return 1;
+        }
+
+        if (zoom % 4 == 0) {
+            std::printf("Zoom level %zu: %zu clusters\n", zoom, count);
+        }
+
+        if (zoom <= 16) {
+            JSGCluster children[256];
+
+            for (size_t i = 0; i < count; i += 97) {
+                size_t childCount = JSGClusterIndexGetChildren(&index, zoom, clusters[i].identifier, children, 256);
+                size_t childTotal = 0;
+
+                for (size_t j = 0; j < childCount && j < 256; j++) {
+                    childTotal += children[j].count;
+                }
+
+                if (childCount <= 256 && childTotal != clusters[i].count) {
+                    std::printf("Cluster %zu at zoom level %zu has children with %zu points instead of %zu\n", clusters[i].identifier, zoom, childTotal, clusters[i].count);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // Queries must find the same clusters as a linear scan
+    CGRect viewport = CGRectMake(100, 100, 40, 30);
+    const JSGClusterLevel *level = &index.levels[8];
+    size_t expected = 0;
+
+    for (size_t i = 0; i < level->count; i++) {
+        expected += level->x[i] >= CGRectGetMinX(viewport) && level->x[i] <= CGRectGetMaxX(viewport) && level->y[i] >= CGRectGetMinY(viewport) && level->y[i] <= CGRectGetMaxY(viewport);
+    }
+
+    if (JSGClusterIndexGetClusters(&index, viewport, 8, NULL, 0) != expected) {
+        std::printf("Query found %zu clusters instead of %zu\n", JSGClusterIndexGetClusters(&index, viewport, 8, NULL, 0), expected);
+        return 1;
+    }
+
+    JSGClusterIndexDestroy(&index);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+
+"""
+Measures how long it takes to build a synthetic project of many translation
+units that all use JSGeometry, once including the headers and once importing
+the jsgeometry C++20 module.
+
+Usage: CompileTimeBenchmark.py [--units 500] [--modes header,module] [--jobs N] [--work-dir DIR]
+                               [--driver cmake|compiler] [--compiler CXX]
+
+With the cmake driver, the project is built with CMake, whose module support requires
+CMake 3.28. The compiler driver invokes GCC (with -fmodules-ts) or Clang directly instead,
+for when CMake is older, building the module interface first in module mode.
+"""
+
+import argparse
+import concurrent.futures
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+REPOSITORY = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def module_headers():
+    """Return the headers exported by the module, so that both modes see the same API."""
+    with open(os.path.join(REPOSITORY, "JSGeometry.cppm")) as module:
+        return re.findall(r'^#include "(JSGeometry\w*\.h)"', module.read(), re.MULTILINE)
+
+
+def write_unit(path, index, headers):
+    includes = "\n".join('#include "%s"' % header for header in headers)
+
+    with open(path, "w") as unit:
+        unit.write("""#ifdef JSG_USE_MODULE
+import jsgeometry;
+#else
+%(includes)s
+#endif
+
+CGRect JSGSyntheticLayout%(index)d(CGRect frame, CGRect container)
+{
+    frame = JSGRectChangeWidth(frame, %(index)d);
+    frame = JSGRectScale(frame, 2, 2);
+    frame = JSGRectGetCenterInRect(frame, container);
+
+    return JSGRectAlignInRect(frame, container, JSGRectAlignmentBottom);
+}
+""" % {"includes": includes, "index": index})
+
+
+def generate(directory, units, mode):
+    if os.path.exists(directory):
+        shutil.rmtree(directory)
+
+    os.makedirs(directory)
+    headers = module_headers()
+    sources = []
+
+    for index in range(units):
+        name = "Unit%d.cpp" % index
+        write_unit(os.path.join(directory, name), index, headers)
+        sources.append(name)
+
+    target = "JSGeometry::Module" if mode == "module" else "JSGeometry::JSGeometry"
+
+    with open(os.path.join(directory, "CMakeLists.txt"), "w") as project:
+        project.write("""cmake_minimum_required(VERSION 3.16...3.28)
+project(JSGeometryCompileTime LANGUAGES CXX)
+set(CMAKE_CXX_STANDARD 20)
+set(JSG_BUILD_MODULE %(module)s CACHE BOOL "" FORCE)
+add_subdirectory("%(repository)s" JSGeometry)
+add_library(Synthetic STATIC
+    %(sources)s
+)
+target_link_libraries(Synthetic PRIVATE %(target)s)
+%(definitions)s
+""" % {
+            "module": "ON" if mode == "module" else "OFF",
+            "repository": REPOSITORY.replace("\\", "/"),
+            "sources": "\n    ".join(sources),
+            "target": target,
+            "definitions": "target_compile_definitions(Synthetic PRIVATE JSG_USE_MODULE)" if mode == "module" else "",
+        })
+
+
+def measure(directory, jobs):
+    build = os.path.join(directory, "build")
+    subprocess.check_call(["cmake", "-S", directory, "-B", build, "-DCMAKE_BUILD_TYPE=Release"], stdout=subprocess.DEVNULL)
+    subprocess.check_call(["cmake", "--build", build, "--target", "clean"], stdout=subprocess.DEVNULL)
+
+    start = time.perf_counter()
+    subprocess.check_call(["cmake", "--build", build, "-j", str(jobs)], stdout=subprocess.DEVNULL)
+
+    return time.perf_counter() - start
+
+
+def measure_compiler(directory, jobs, units, mode, compiler):
+    flags = [compiler, "-std=c++20", "-O2", "-Wno-unknown-pragmas", "-I", REPOSITORY]
+    version = subprocess.check_output([compiler, "--version"], universal_newlines=True)
+    clang = "clang" in version
+    interface = os.path.join(REPOSITORY, "JSGeometry.cppm")
+    commands = []
+
+    if mode == "module":
+        if clang:
+            flags.append("-fmodule-file=jsgeometry=jsgeometry.pcm")
+            commands.append([compiler, "-std=c++20", "-O2", "-Wno-unknown-pragmas", "-I", REPOSITORY, "--precompile", "-x", "c++-module", interface, "-o", "jsgeometry.pcm"])
+            commands.append(flags + ["-c", "jsgeometry.pcm", "-o", "jsgeometry.o"])
+        else:
+            flags.append("-fmodules-ts")
+            commands.append(flags + ["-x", "c++", "-c", interface, "-o", "jsgeometry.o"])
+
+        flags.append("-DJSG_USE_MODULE")
+
+    def compile_unit(index):
+        subprocess.check_call(flags + ["-c", "Unit%d.cpp" % index, "-o", "Unit%d.o" % index], cwd=directory)
+
+    start = time.perf_counter()
+
+    # The module interface must be built before the units that import it
+    for command in commands:
+        subprocess.check_call(command, cwd=directory)
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as executor:
+        list(executor.map(compile_unit, range(units)))
+
+    return time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--units", type=int, default=500)
+    parser.add_argument("--modes", default="header,module")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--work-dir", default=os.path.join(REPOSITORY, "_compile_time_benchmark"))
+    parser.add_argument("--driver", choices=["cmake", "compiler"], default="cmake")
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    arguments = parser.parse_args()
+
+    results = []
+
+    for mode in arguments.modes.split(","):
+        directory = os.path.join(arguments.work_dir, mode)
+        generate(directory, arguments.units, mode)
+
+        try:
+            if arguments.driver == "compiler":
+                seconds = measure_compiler(directory, arguments.jobs, arguments.units, mode, arguments.compiler)
+            else:
+                seconds = measure(directory, arguments.jobs)
+        except subprocess.CalledProcessError:
+            print("%s mode failed to build, see %s" % (mode, directory), file=sys.stderr)
+            continue
+
+        results.append((mode, seconds))
+
+    print("| Mode | Units | Jobs | Build time (s) | Per unit (ms) |")
+    print("|------|-------|------|----------------|---------------|")
+
+    for mode, seconds in results:
+        print("| %s | %d | %d | %.2f | %.1f |" % (mode, arguments.units, arguments.jobs, seconds, seconds * 1000 / arguments.units))
+
+    return 0 if results else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryComponents.h"
+
+/**
+ *  Groups overlapping frames scattered over a large canvas. Testing every pair of frames is
+ *  compared with JSGRectArrayGetOverlapGroups, which only tests frames that overlap
+ *  horizontally.
+ */
+
+static size_t JSGPairwiseOverlapGroups(const std::vector<CGRect> &rects, std::vector<size_t> &groups)
+{
+    std::vector<size_t> parents(rects.size());
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        parents[i] = i;
+    }
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        for (size_t j = i + 1; j < rects.size(); j++) {
+            if (!CGRectIsEmpty(CGRectIntersection(rects[i], rects[j]))) {
+                JSGComponentUnion(parents.data(), i, j);
+            }
+        }
+    }
+
+    std::vector<size_t> ids(rects.size(), JSG_COMPONENT_NONE);
+    size_t groupCount = 0;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        size_t root = JSGComponentFind(parents.data(), i);
+
+        if (ids[root] == JSG_COMPONENT_NONE) {
+            ids[root] = groupCount++;
+        }
+
+        groups[i] = ids[root];
+    }
+
+    return groupCount;
+}
+
+int main()
+{
+    const size_t count = 10000;
+    std::vector<CGRect> rects(count);
+    std::vector<size_t> expected(count);
+    std::vector<size_t> groups(count);
+    JSGRectArray array;
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Integer frames, so that many of them touch without overlapping
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake((int)(next() * 2800), (int)(next() * 2800), (int)(next() * 40), (int)(5 + next() * 40));
+    }
+
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), count);
+
+    size_t expectedCount = 0;
+    size_t groupCount = 0;
+
+    JSGBenchmarkRun("pairwise overlap tests (10K rects)", 1, count, [&] {
+        expectedCount = JSGPairwiseOverlapGroups(rects, expected);
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGBenchmarkRun("JSGRectArrayGetOverlapGroups (10K rects)", 20, count, [&] {
+        JSGRectArrayGetOverlapGroups(&array, groups.data(), &groupCount);
+        JSGBenchmarkKeep(groups);
+    });
+
+    std::printf("%zu groups\n", groupCount);
+
+    if (groupCount != expectedCount || groups != expected) {
+        std::printf("Sweep & prune gave %zu groups instead of %zu\n", groupCount, expectedCount);
+        return 1;
+    }
+
+    JSGRectArrayDestroy(&array);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryCoverage.h"
+
+/**
+ *  Measures the overdraw of the 5K frames of a scrolling screen, with 3x screen pixels. Filling the
+ *  pixels of each frame is compared with a coverage raster.
+ */
+
+int main()
+{
+    const size_t frameCount = 5000;
+    const CGRect screen = CGRectMake(0, 0, 390, 844);
+    const CGFloat pixelSize = 1.0 / 3;
+    std::vector<CGRect> frames(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Full screen backgrounds, then the table cells of a long scrolling list & the labels
+    // & icons within them, most of them off screen
+    for (size_t i = 0; i < frameCount; i++) {
+        if (i % 1000 == 0) {
+            frames[i] = screen;
+        } else if (i % 10 == 0) {
+            frames[i] = CGRectMake(0, next() * 8440 - 40, 390, 44 + next() * 40);
+        } else {
+            frames[i] = CGRectMake(next() * 360 - 10, next() * 8440 - 10, 8 + next() * 200, 8 + next() * 30);
+        }
+    }
+
+    JSGRectArray rects;
+    JSGRectArrayInit(&rects);
+    JSGRectArraySetRects(&rects, frames.data(), frameCount);
+
+    JSGCoverageRaster raster;
+    JSGCoverageRasterInit(&raster, screen, pixelSize);
+
+    std::vector<uint32_t> expected(raster.width * raster.height);
+
+    JSGBenchmarkRun("filling the pixels of each frame (5K frames, 1170x2532)", 1, frameCount, [&] {
+        std::fill(expected.begin(), expected.end(), 0);
+
+        for (const CGRect &frame : frames) {
+            long firstColumn = std::max(0L, (long)std::ceil(CGRectGetMinX(frame) / pixelSize - 0.5));
+            long endColumn = std::min((long)raster.width, (long)std::ceil(CGRectGetMaxX(frame) / pixelSize - 0.5));
+            long firstRow = std::max(0L, (long)std::ceil(CGRectGetMinY(frame) / pixelSize - 0.5));
+            long endRow = std::min((long)raster.height, (long)std::ceil(CGRectGetMaxY(frame) / pixelSize - 0.5));
+
+            for (long row = firstRow; row < endRow; row++) {
+                for (long column = firstColumn; column < endColumn; column++) {
+                    expected[row * raster.width + column]++;
+                }
+            }
+        }
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGBenchmarkRun("JSGCoverageRasterAddRects (5K frames, 1170x2532)", 10, frameCount, [&] {
+        JSGCoverageRasterClear(&raster);
+        JSGCoverageRasterAddRects(&raster, &rects);
+        JSGBenchmarkKeep(raster.counts);
+    });
+
+    if (memcmp(raster.counts, expected.data(), expected.size() * sizeof(uint32_t)) != 0) {
+        std::printf("Coverage raster counts differ from filled pixels\n");
+        return 1;
+    }
+
+    JSGCoverageStatistics statistics;
+    size_t histogram[8];
+
+    JSGBenchmarkRun("JSGCoverageRasterGetStatistics (1170x2532)", 10, expected.size(), [&] {
+        JSGCoverageRasterGetStatistics(&raster, &statistics, histogram, 8);
+        JSGBenchmarkKeep(statistics);
+    });
+
+    size_t overdrawn = 0;
+
+    for (uint32_t count : expected) {
+        overdrawn += count > 1;
+    }
+
+    if (statistics.overdrawnPixelCount != overdrawn || histogram[0] != statistics.pixelCount - statistics.coveredPixelCount) {
+        std::printf("Coverage statistics found %zu overdrawn pixels instead of %zu\n", statistics.overdrawnPixelCount, overdrawn);
+        return 1;
+    }
+
+    std::printf("%.2f average coverage, %u maximum coverage, %.1f%% of pixels overdrawn\n", (double)statistics.totalCount / statistics.coveredPixelCount, statistics.maximumCount, 100.0 * overdrawn / statistics.pixelCount);
+
+    JSGCoverageRasterDestroy(&raster);
+    JSGRectArrayDestroy(&rects);
+
+    return 0;
+}
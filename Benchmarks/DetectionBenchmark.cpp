@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryDetection.h"
+
+/**
+ *  Measures intersection over union & non-maximum suppression over simulated detector
+ *  output, where boxes are clustered around a number of objects. Greedy suppression is
+ *  compared with a straightforward implementation based on JSGRectIntersectionOverUnion.
+ */
+
+static std::vector<CGRect> JSGDetectionBoxes(size_t count, std::vector<CGFloat> &scores)
+{
+    std::vector<CGRect> boxes(count);
+    scores.resize(count);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    size_t objects = count / 20 + 1;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t object = i % objects;
+        CGFloat centerX = (object * 7919 % 1000) * 4 + next() * 12;
+        CGFloat centerY = (object * 104729 % 1000) * 3 + next() * 12;
+        CGFloat width = 40 + (object % 7) * 10 + next() * 8;
+        CGFloat height = 30 + (object % 5) * 12 + next() * 8;
+        boxes[i] = CGRectMake(centerX - width / 2, centerY - height / 2, width, height);
+        scores[i] = next();
+    }
+
+    return boxes;
+}
+
+static size_t JSGNaiveNonMaximumSuppression(const std::vector<CGRect> &boxes, const std::vector<CGFloat> &scores, CGFloat threshold, std::vector<size_t> &kept)
+{
+    std::vector<size_t> order(boxes.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+    });
+
+    std::vector<bool> suppressed(boxes.size());
+    size_t keptCount = 0;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if (suppressed[i]) {
+            continue;
+        }
+
+        kept[keptCount++] = order[i];
+
+        for (size_t j = i + 1; j < order.size(); j++) {
+            if (!suppressed[j] && JSGRectIntersectionOverUnion(boxes[order[i]], boxes[order[j]]) > threshold) {
+                suppressed[j] = true;
+            }
+        }
+    }
+
+    return keptCount;
+}
+
+int main()
+{
+    const size_t counts[] = {1000, 5000, 20000, 50000};
+
+    for (size_t count : counts) {
+        std::vector<CGFloat> scores;
+        std::vector<CGRect> boxes = JSGDetectionBoxes(count, scores);
+        std::vector<size_t> naiveKept(count), kept(count);
+        std::vector<CGFloat> ious(count), keptScores(count);
+        JSGRectArray array;
+        JSGRectArrayInit(&array);
+        JSGRectArraySetRects(&array, boxes.data(), count);
+
+        size_t iterations = std::max<size_t>(1, 20000000 / (count * count / 10 + count));
+        char name[96];
+
+        std::snprintf(name, sizeof(name), "IoU one-vs-many scalar (%zu boxes)", count);
+        JSGBenchmarkRun(name, 1000, count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                ious[i] = JSGRectIntersectionOverUnion(boxes[0], boxes[i]);
+            }
+            JSGBenchmarkKeep(ious);
+        });
+
+        std::snprintf(name, sizeof(name), "IoU one-vs-many JSGRectArray (%zu boxes)", count);
+        JSGBenchmarkRun(name, 1000, count, [&] {
+            JSGRectArrayGetIntersectionOverUnion(&array, boxes[0], ious.data());
+            JSGBenchmarkKeep(ious);
+        });
+
+        size_t naiveCount = 0, keptCount = 0;
+
+        std::snprintf(name, sizeof(name), "greedy NMS naive (%zu boxes)", count);
+        JSGBenchmarkRun(name, iterations, count, [&] {
+            naiveCount = JSGNaiveNonMaximumSuppression(boxes, scores, 0.5, naiveKept);
+        });
+
+        std::snprintf(name, sizeof(name), "greedy NMS JSGRectArray (%zu boxes)", count);
+        JSGBenchmarkRun(name, iterations, count, [&] {
+            JSGRectArrayNonMaximumSuppression(&array, scores.data(), 0.5, kept.data(), &keptCount);
+        });
+
+        if (naiveCount != keptCount || !std::equal(kept.begin(), kept.begin() + keptCount, naiveKept.begin())) {
+            std::printf("Greedy suppression results differ\n");
+            return 1;
+        }
+
+        if (count <= 5000) {
+            std::snprintf(name, sizeof(name), "soft NMS gaussian (%zu boxes)", count);
+            JSGBenchmarkRun(name, 1, count, [&] {
+                JSGRectArraySoftNonMaximumSuppression(&array, scores.data(), JSGSoftSuppressionGaussian, 0.5, 0.001, kept.data(), keptScores.data(), &keptCount);
+            });
+        }
+
+        JSGRectArrayDestroy(&array);
+    }
+
+    return 0;
+}
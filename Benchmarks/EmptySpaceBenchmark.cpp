@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryEmptySpace.h"
+
+/**
+ *  Maintains the maximal empty rects around 10K obstacles scattered over a large canvas,
+ *  measuring the initial build, obstacle moves & top-k queries
+ */
+
+int main()
+{
+    const size_t obstacleCount = 10000;
+    const CGRect container = CGRectMake(0, 0, 8000, 8000);
+    std::vector<CGRect> obstacles(obstacleCount);
+    std::vector<CGRect> moves(1024);
+    CGRect largest[16];
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    auto randomRect = [&]() {
+        return CGRectMake((int)(next() * 8000) - 20, (int)(next() * 8000) - 20, (int)(5 + next() * 60), (int)(5 + next() * 60));
+    };
+
+    for (size_t i = 0; i < obstacleCount; i++) {
+        obstacles[i] = randomRect();
+    }
+
+    for (size_t i = 0; i < moves.size(); i++) {
+        moves[i] = randomRect();
+    }
+
+    JSGEmptySpace space;
+    JSGEmptySpaceInit(&space, container);
+
+    JSGBenchmarkRun("JSGEmptySpaceAddObstacles (10K obstacles)", 1, obstacleCount, [&] {
+        JSGEmptySpaceDestroy(&space);
+        JSGEmptySpaceInit(&space, container);
+        JSGEmptySpaceAddObstacles(&space, obstacles.data(), obstacleCount);
+        JSGBenchmarkKeep(space.emptyRects.count);
+    });
+
+    std::printf("%zu maximal empty rects\n", space.emptyRects.count);
+
+    size_t move = 0;
+
+    JSGBenchmarkRun("JSGEmptySpaceMoveObstacle", 100, 1, [&] {
+        JSGEmptySpaceMoveObstacle(&space, (move * 7919) % obstacleCount, moves[move % moves.size()]);
+        move++;
+    });
+
+    JSGBenchmarkRun("JSGEmptySpaceGetLargestRects (top 16)", 100, 1, [&] {
+        size_t count;
+        JSGEmptySpaceGetLargestRects(&space, CGSizeMake(200, 150), 16, largest, &count);
+        JSGBenchmarkKeep(count);
+    });
+
+    // Moves must give the same empty rects as building from scratch
+    JSGEmptySpace rebuilt;
+    JSGEmptySpaceInit(&rebuilt, container);
+    std::vector<CGRect> current(obstacleCount);
+    JSGRectArrayGetRects(&space.obstacles, current.data());
+    JSGEmptySpaceAddObstacles(&rebuilt, current.data(), obstacleCount);
+
+    if (rebuilt.emptyRects.count != space.emptyRects.count) {
+        std::printf("Moving obstacles gave %zu empty rects instead of %zu\n", space.emptyRects.count, rebuilt.emptyRects.count);
+        return 1;
+    }
+
+    JSGEmptySpaceDestroy(&rebuilt);
+    JSGEmptySpaceDestroy(&space);
+
+    return 0;
+}
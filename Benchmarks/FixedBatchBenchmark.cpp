@@ -0,0 +1,54 @@
+#include "JSGBenchmark.h"
+#include "../JSGeometryBatch.h"
+#include "../JSGeometryFixedBatch.h"
+
+/**
+ *  Compares the fixed width batch functions against the generic batch
+ *  loops, for the batch widths that the fixed width functions exist for
+ */
+
+#define JSG_BENCHMARK_WIDTH(N) \
+    do { \
+        CGRect rects[N]; \
+        CGFloat widths[N]; \
+        CGRect container = CGRectMake(0, 0, 1024, 768); \
+        JSGRectAlignment alignment = (JSGRectAlignment)(JSGRectAlignmentBottom | JSGRectAlignmentRight); \
+        volatile size_t opaqueCount = N; \
+        for (size_t i = 0; i < N; i++) { \
+            rects[i] = CGRectMake(i * 10, i * 3, 40 + i, 30 + i); \
+            widths[i] = 44 + i; \
+        } \
+        JSGBenchmarkRun("generic ChangeWidth x" #N, 10000000, N, [&] { \
+            JSGRectsChangeWidth(rects, widths, opaqueCount); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+        JSGBenchmarkRun("fixed ChangeWidth x" #N, 10000000, N, [&] { \
+            JSGRectsFixed(N, ChangeWidth)(rects, widths); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+        JSGBenchmarkRun("generic Scale x" #N, 2000000, N, [&] { \
+            JSGRectsScale(rects, opaqueCount, 1, 1); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+        JSGBenchmarkRun("fixed Scale x" #N, 2000000, N, [&] { \
+            JSGRectsFixed(N, Scale)(rects, 1, 1); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+        JSGBenchmarkRun("generic AlignInRect x" #N, 10000000, N, [&] { \
+            JSGRectsAlignInRectForCoordinateSystemOrigin(rects, opaqueCount, container, alignment, JSGCoordinateSystemOriginTopLeft); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+        JSGBenchmarkRun("fixed AlignInRect x" #N, 10000000, N, [&] { \
+            JSGRectsFixed(N, AlignInRectForCoordinateSystemOrigin)(rects, container, alignment, JSGCoordinateSystemOriginTopLeft); \
+            JSGBenchmarkKeep(rects); \
+        }); \
+    } while (0)
+
+int main()
+{
+    JSG_BENCHMARK_WIDTH(4);
+    JSG_BENCHMARK_WIDTH(8);
+    JSG_BENCHMARK_WIDTH(16);
+
+    return 0;
+}
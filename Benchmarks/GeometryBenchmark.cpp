@@ -0,0 +1,65 @@
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometry.h"
+
+/**
+ *  Measures the single value functions in JSGeometry.h, applied to an array of rects
+ */
+
+int main()
+{
+    const size_t count = 4096;
+    std::vector<CGRect> rects(count);
+    CGRect container = CGRectMake(0, 0, 1024, 768);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(i % 97, i % 89, 20 + i % 61, 10 + i % 53);
+    }
+
+    JSGBenchmarkRun("JSGRectChangeWidth", 20000, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            rects[i] = JSGRectChangeWidth(rects[i], 44);
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    JSGBenchmarkRun("JSGRectChangeOrigin", 20000, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            rects[i] = JSGRectChangeOrigin(rects[i], CGPointMake(i, i));
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    JSGBenchmarkRun("JSGRectScale", 500, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            rects[i] = JSGRectScale(rects[i], 1, 1);
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    JSGBenchmarkRun("JSGRectGetCenterInRect", 2000, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            rects[i] = JSGRectGetCenterInRect(rects[i], container);
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    const JSGRectAlignment alignments[] = {
+        JSGRectAlignmentTop,
+        JSGRectAlignmentRight,
+        JSGRectAlignmentBottom,
+        JSGRectAlignmentLeft,
+        (JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentLeft),
+        (JSGRectAlignment)(JSGRectAlignmentBottom | JSGRectAlignmentRight),
+    };
+
+    JSGBenchmarkRun("JSGRectAlignInRect (mixed alignments)", 10000, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            rects[i] = JSGRectAlignInRect(rects[i], container, alignments[i % 6]);
+        }
+        JSGBenchmarkKeep(rects);
+    });
+
+    return 0;
+}
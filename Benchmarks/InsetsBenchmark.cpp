@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryInsets.h"
+
+/**
+ *  Insets 1M cell frames for their content & slices a header off the top of each one.
+ *  CGRectInset & CGRectDivide on each CGRect are compared with the rect array functions.
+ */
+
+int main()
+{
+    const size_t frameCount = 1000000;
+    std::vector<CGRect> frames(frameCount);
+    std::vector<CGRect> results(frameCount);
+    std::vector<CGRect> headers(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    for (size_t i = 0; i < frameCount; i++) {
+        frames[i] = CGRectMake(next() * 1000, next() * 100000, 40 + next() * 300, 40 + next() * 200);
+    }
+
+    JSGRectArray array;
+    JSGRectArray sliced;
+    JSGRectArray checked;
+    JSGRectArrayInit(&array);
+    JSGRectArrayInit(&sliced);
+    JSGRectArrayInit(&checked);
+
+    JSGBenchmarkRun("CGRectInset (1M rects)", 10, frameCount, [&] {
+        for (size_t i = 0; i < frameCount; i++) {
+            results[i] = CGRectInset(frames[i], 8, 4);
+        }
+        JSGBenchmarkKeep(results);
+    });
+
+    // Insetting in place, then outsetting back, so that each iteration starts from the same rects
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+
+    JSGBenchmarkRun("JSGRectArrayInset (1M rects, inset & outset)", 10, frameCount * 2, [&] {
+        JSGRectArrayInset(&array, 8, 4);
+        JSGRectArrayInset(&array, -8, -4);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+    JSGRectArrayInset(&array, 8, 4);
+
+    JSGRectArraySetRects(&checked, results.data(), frameCount);
+
+    if (memcmp(array.x, checked.x, frameCount * sizeof(CGFloat)) != 0 || memcmp(array.width, checked.width, frameCount * sizeof(CGFloat)) != 0 || memcmp(array.height, checked.height, frameCount * sizeof(CGFloat)) != 0) {
+        std::printf("JSGRectArrayInset differs from CGRectInset\n");
+        return 1;
+    }
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+
+    JSGBenchmarkRun("JSGRectArrayInsetByEdgeInsets (1M rects, inset & outset)", 10, frameCount * 2, [&] {
+        JSGRectArrayInsetByEdgeInsets(&array, JSGEdgeInsetsMake(12, 16, 4, 8), JSGCoordinateSystemOriginBottomLeft);
+        JSGRectArrayInsetByEdgeInsets(&array, JSGEdgeInsetsMake(-12, -16, -4, -8), JSGCoordinateSystemOriginBottomLeft);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+    JSGRectArrayInsetByEdgeInsets(&array, JSGEdgeInsetsMake(12, 16, 4, 8), JSGCoordinateSystemOriginBottomLeft);
+
+    for (size_t i = 0; i < frameCount; i++) {
+        CGRect frame = frames[i];
+        CGRect expected = CGRectMake(frame.origin.x + 16, frame.origin.y + 4, frame.size.width - 24, frame.size.height - 16);
+
+        if (!CGRectEqualToRect(JSGRectArrayGetRect(&array, i), expected)) {
+            std::printf("Rect %zu was inset incorrectly for a bottom left origin\n", i);
+            return 1;
+        }
+    }
+
+    // Slicing a 44 point header off the top of each frame, with a top left origin
+    JSGBenchmarkRun("CGRectDivide (1M rects)", 10, frameCount, [&] {
+        for (size_t i = 0; i < frameCount; i++) {
+            CGRectDivide(frames[i], &headers[i], &results[i], 44, CGRectMinYEdge);
+        }
+        JSGBenchmarkKeep(results);
+    });
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+
+    JSGBenchmarkRun("JSGRectArrayDivide (1M rects)", 10, frameCount, [&] {
+        JSGRectArrayDivide(&array, 44, JSGRectAlignmentTop, JSGCoordinateSystemOriginTopLeft, &sliced, &checked);
+        JSGBenchmarkKeep(checked.y);
+    });
+
+    // Removing the headers in place must give the same remainders
+    JSGRectArrayDivide(&array, 44, JSGRectAlignmentTop, JSGCoordinateSystemOriginTopLeft, NULL, &array);
+
+    for (size_t i = 0; i < frameCount; i++) {
+        if (!CGRectEqualToRect(JSGRectArrayGetRect(&sliced, i), headers[i]) || !CGRectEqualToRect(JSGRectArrayGetRect(&checked, i), results[i]) || !CGRectEqualToRect(JSGRectArrayGetRect(&array, i), results[i])) {
+            std::printf("JSGRectArrayDivide differs from CGRectDivide for rect %zu\n", i);
+            return 1;
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+    JSGRectArrayDestroy(&sliced);
+    JSGRectArrayDestroy(&checked);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#ifndef JSGBenchmark
+#define JSGBenchmark
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ *  Prevent the compiler from optimizing away the computation of a value
+ */
+template <typename T>
+inline void JSGBenchmarkKeep(T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    volatile T sink = value;
+    (void)sink;
+#endif
+}
+
+/**
+ *  Return a multiplier for benchmark iteration counts, read from the
+ *  JSG_BENCHMARK_SCALE environment variable (defaults to 1)
+ */
+inline double JSGBenchmarkScale()
+{
+    const char *scale = std::getenv("JSG_BENCHMARK_SCALE");
+
+    return scale ? std::atof(scale) : 1;
+}
+
+/**
+ *  Measure a benchmark body, and print the best time per iteration & per item
+ *
+ *  @param name The name to print for the benchmark
+ *  @param iterations The number of times to run the body per repetition
+ *  @param itemsPerIteration The number of items (rects, boxes...) processed per iteration
+ *  @param body The code to measure
+ *
+ *  @return The best measured time per iteration, in nanoseconds
+ *
+ *  @discussion The body is run once as a warmup, then the iterations are repeated five
+ *  times, and the fastest repetition is reported.
+ */
+template <typename Body>
+inline double JSGBenchmarkRun(const char *name, size_t iterations, size_t itemsPerIteration, Body body)
+{
+    iterations = (size_t)(iterations * JSGBenchmarkScale());
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    body();
+
+    double best = 0;
+
+    for (int repetition = 0; repetition < 5; repetition++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < iterations; i++) {
+            body();
+        }
+
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        double perIteration = elapsed.count() / iterations;
+
+        if (repetition == 0 || perIteration < best) {
+            best = perIteration;
+        }
+    }
+
+    std::printf("%-56s %14.1f ns/iter %10.3f ns/item\n", name, best, best / (itemsPerIteration ? itemsPerIteration : 1));
+
+    return best;
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryJoin.h"
+#include "../JSGeometrySpatialGrid.h"
+
+/**
+ *  Joins the 1M text runs of a long document with 100K highlight regions. Querying a
+ *  spatial grid of highlights for each run is compared with JSGRectArrayJoin.
+ */
+
+int main()
+{
+    const size_t runCount = 1000000;
+    const size_t highlightCount = 100000;
+    const CGRect document = CGRectMake(0, 0, 2000, 500000);
+    std::vector<CGRect> runs(runCount);
+    std::vector<CGRect> highlights(highlightCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Runs are laid out in lines, highlights cover a few words or lines each
+    for (size_t i = 0; i < runCount; i++) {
+        size_t line = i / 10;
+        runs[i] = CGRectMake((i % 10) * 200 + next() * 20, line * 5, 100 + next() * 80, 4);
+    }
+
+    for (size_t i = 0; i < highlightCount; i++) {
+        highlights[i] = CGRectMake(next() * 1900, next() * 499990, 20 + next() * 400, 4 + (int)(next() * 3) * 5);
+    }
+
+    JSGRectArray runArray;
+    JSGRectArray highlightArray;
+    JSGRectArrayInit(&runArray);
+    JSGRectArrayInit(&highlightArray);
+    JSGRectArraySetRects(&runArray, runs.data(), runCount);
+    JSGRectArraySetRects(&highlightArray, highlights.data(), highlightCount);
+
+    std::vector<JSGRectPair> expected;
+    JSGSpatialGrid grid;
+    JSGSpatialGridInit(&grid, document, 200);
+
+    for (const CGRect &highlight : highlights) {
+        JSGSpatialGridInsert(&grid, highlight);
+    }
+
+    JSGBenchmarkRun("spatial grid query per run (1M x 100K)", 1, runCount, [&] {
+        std::vector<size_t> found(highlightCount);
+        expected.clear();
+
+        for (size_t i = 0; i < runCount; i++) {
+            size_t count = JSGSpatialGridQuery(&grid, runs[i], found.data(), found.size());
+
+            for (size_t j = 0; j < count; j++) {
+                JSGRectPair pair = {i, found[j]};
+                expected.push_back(pair);
+            }
+        }
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGRectPairArray pairs;
+    JSGRectPairArrayInit(&pairs);
+
+    JSGBenchmarkRun("JSGRectArrayJoin, 1 thread (1M x 100K)", 3, runCount, [&] {
+        pairs.count = 0;
+        JSGRectArrayJoin(&runArray, &highlightArray, 1, &pairs);
+        JSGBenchmarkKeep(pairs.count);
+    });
+
+    JSGRectPairArray parallelPairs;
+    JSGRectPairArrayInit(&parallelPairs);
+
+    JSGBenchmarkRun("JSGRectArrayJoin, default threads (1M x 100K)", 3, runCount, [&] {
+        parallelPairs.count = 0;
+        JSGRectArrayJoin(&runArray, &highlightArray, 0, &parallelPairs);
+        JSGBenchmarkKeep(parallelPairs.count);
+    });
+
+    std::printf("%zu overlapping pairs\n", pairs.count);
+
+    // The join must find every pair exactly once, in the same order for any thread count
+    auto less = [](const JSGRectPair &a, const JSGRectPair &b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    };
+    auto equal = [](const JSGRectPair &a, const JSGRectPair &b) {
+        return a.first == b.first && a.second == b.second;
+    };
+
+    if (!std::equal(pairs.pairs, pairs.pairs + pairs.count, parallelPairs.pairs, parallelPairs.pairs + parallelPairs.count, equal)) {
+        std::printf("Joining with threads gave different pairs\n");
+        return 1;
+    }
+
+    std::vector<JSGRectPair> sorted(pairs.pairs, pairs.pairs + pairs.count);
+    std::sort(sorted.begin(), sorted.end(), less);
+    std::sort(expected.begin(), expected.end(), less);
+
+    if (!std::equal(sorted.begin(), sorted.end(), expected.begin(), expected.end(), equal)) {
+        std::printf("Join found %zu pairs instead of %zu\n", sorted.size(), expected.size());
+        return 1;
+    }
+
+    JSGRectPairArrayDestroy(&pairs);
+    JSGRectPairArrayDestroy(&parallelPairs);
+    JSGSpatialGridDestroy(&grid);
+    JSGRectArrayDestroy(&runArray);
+    JSGRectArrayDestroy(&highlightArray);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryLabels.h"
+
+/**
+ *  Places chart labels next to scattered data points. Testing each candidate against all
+ *  placed labels is compared with JSGLabelsPlace for 10K labels, and JSGLabelsPlace is
+ *  then measured with 100K labels.
+ */
+
+static size_t JSGNaiveLabelsPlace(const std::vector<CGPoint> &anchors, const std::vector<CGSize> &sizes, CGRect bounds, CGFloat offset, std::vector<CGRect> &frames)
+{
+    const JSGRectAlignment *positions = JSGLabelPositionsDefault();
+    std::vector<CGRect> placed;
+
+    for (size_t i = 0; i < anchors.size(); i++) {
+        frames[i] = CGRectNull;
+
+        for (size_t j = 0; j < JSG_LABEL_POSITION_COUNT; j++) {
+            CGRect frame = JSGLabelGetFrame(anchors[i], sizes[i], offset, positions[j], JSGCoordinateSystemOriginTopLeft);
+            bool fits = CGRectContainsRect(bounds, frame);
+
+            for (size_t k = 0; fits && k < placed.size(); k++) {
+                fits = !CGRectIntersectsRect(frame, placed[k]);
+            }
+
+            if (fits) {
+                frames[i] = frame;
+                placed.push_back(frame);
+                break;
+            }
+        }
+    }
+
+    return placed.size();
+}
+
+int main()
+{
+    const CGRect bounds = CGRectMake(0, 0, 3840, 2160);
+    const size_t counts[] = {10000, 100000};
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    for (size_t count : counts) {
+        std::vector<CGPoint> anchors(count);
+        std::vector<CGSize> sizes(count);
+        std::vector<CGFloat> priorities(count);
+        std::vector<CGRect> frames(count), naiveFrames(count);
+        char name[96];
+
+        for (size_t i = 0; i < count; i++) {
+            anchors[i] = CGPointMake(next() * 3840, next() * 2160);
+            sizes[i] = CGSizeMake(24 + next() * 40, 12);
+            priorities[i] = next();
+        }
+
+        size_t placedCount = 0;
+
+        std::snprintf(name, sizeof(name), "JSGLabelsPlace (%zu labels)", count);
+        JSGBenchmarkRun(name, 5, count, [&] {
+            JSGLabelsPlace(anchors.data(), sizes.data(), NULL, count, bounds, 2, NULL, 0, JSGCoordinateSystemOriginTopLeft, NULL, frames.data(), NULL, &placedCount);
+        });
+
+        std::printf("%zu of %zu labels placed\n", placedCount, count);
+
+        if (count <= 10000) {
+            size_t naiveCount = 0;
+
+            std::snprintf(name, sizeof(name), "naive quadratic placement (%zu labels)", count);
+            JSGBenchmarkRun(name, 1, count, [&] {
+                naiveCount = JSGNaiveLabelsPlace(anchors, sizes, bounds, 2, naiveFrames);
+            });
+
+            for (size_t i = 0; i < count; i++) {
+                if (!CGRectEqualToRect(frames[i], naiveFrames[i])) {
+                    std::printf("Label %zu was placed differently\n", i);
+                    return 1;
+                }
+            }
+        }
+
+        std::snprintf(name, sizeof(name), "JSGLabelsPlace with priorities (%zu labels)", count);
+        JSGBenchmarkRun(name, 5, count, [&] {
+            JSGLabelsPlace(anchors.data(), sizes.data(), priorities.data(), count, bounds, 2, NULL, 0, JSGCoordinateSystemOriginTopLeft, NULL, frames.data(), NULL, &placedCount);
+        });
+    }
+
+    return 0;
+}
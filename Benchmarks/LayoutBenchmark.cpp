@@ -0,0 +1,48 @@
+#include <cstring>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "LayoutWorkload.h"
+
+/**
+ *  Runs the synthetic layout workload from LayoutWorkload.h
+ *
+ *  @discussion Pass --train to run the workload using the training seed instead of
+ *  measuring it, which is what the profile guided optimization workflow does.
+ */
+
+int main(int argc, char **argv)
+{
+    const size_t count = 8192;
+    bool train = argc > 1 && std::strcmp(argv[1], "--train") == 0;
+    JSGLayoutWorkloadData data = JSGLayoutWorkloadMake(train ? 1 : 2, count);
+    std::vector<CGRect> frames(count * 3);
+
+    if (train) {
+        for (int pass = 0; pass < 200; pass++) {
+            JSGLayoutWorkloadRunList(data, frames);
+            JSGLayoutWorkloadRunGrid(data, frames);
+            JSGLayoutWorkloadRunAlignment(data, frames);
+            JSGBenchmarkKeep(frames);
+        }
+
+        return 0;
+    }
+
+    JSGBenchmarkRun("layout list pass", 200, count, [&] {
+        JSGLayoutWorkloadRunList(data, frames);
+        JSGBenchmarkKeep(frames);
+    });
+
+    JSGBenchmarkRun("layout grid pass", 200, count, [&] {
+        JSGLayoutWorkloadRunGrid(data, frames);
+        JSGBenchmarkKeep(frames);
+    });
+
+    JSGBenchmarkRun("layout alignment pass", 1000, count, [&] {
+        JSGLayoutWorkloadRunAlignment(data, frames);
+        JSGBenchmarkKeep(frames);
+    });
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+#ifndef JSGLayoutWorkload
+#define JSGLayoutWorkload
+
+#include <cstdint>
+#include <vector>
+
+#include "../JSGeometry.h"
+
+/**
+ *  A synthetic layout workload, modelled after typical UI layout code
+ *
+ *  @discussion The workload consists of three kinds of passes, mixed in proportions
+ *  similar to what a list & grid heavy app performs:
+ *
+ *  - List passes, that stretch rows to the width of their container, center a title
+ *    within each row, and pin an accessory to the row's right edge.
+ *  - Grid passes, that size cells to a fraction of the container, position them in
+ *    columns, and center an icon within each cell.
+ *  - Alignment passes, that align rects within containers using a distribution of
+ *    alignments & coordinate system origins (top/left dominates, like in most UIs).
+ *
+ *  It's used both as the training workload for profile guided optimization, and to
+ *  measure its effect. Use different seeds for training & measuring, so that the
+ *  measurement doesn't just replay the training run.
+ */
+struct JSGLayoutWorkloadGenerator {
+    uint64_t state;
+
+    explicit JSGLayoutWorkloadGenerator(uint64_t seed) : state(seed * 2685821657736338717ull + 1) {}
+
+    uint32_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+
+        return (uint32_t)((state * 2685821657736338717ull) >> 32);
+    }
+
+    CGFloat uniform(CGFloat minimum, CGFloat maximum)
+    {
+        return minimum + (maximum - minimum) * (next() / 4294967296.0);
+    }
+};
+
+struct JSGLayoutWorkloadItem {
+    CGRect frame;
+    CGRect container;
+    JSGRectAlignment alignment;
+    JSGCoordinateSystemOrigin origin;
+};
+
+struct JSGLayoutWorkloadData {
+    std::vector<JSGLayoutWorkloadItem> rows;
+    std::vector<JSGLayoutWorkloadItem> cells;
+    std::vector<JSGLayoutWorkloadItem> alignments;
+    size_t columns;
+};
+
+inline JSGRectAlignment JSGLayoutWorkloadAlignment(JSGLayoutWorkloadGenerator &generator)
+{
+    uint32_t roll = generator.next() % 100;
+
+    if (roll < 35) {
+        return (JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentLeft);
+    } else if (roll < 55) {
+        return JSGRectAlignmentRight;
+    } else if (roll < 70) {
+        return JSGRectAlignmentBottom;
+    } else if (roll < 80) {
+        return (JSGRectAlignment)(JSGRectAlignmentBottom | JSGRectAlignmentRight);
+    } else if (roll < 90) {
+        return JSGRectAlignmentLeft;
+    } else if (roll < 97) {
+        return JSGRectAlignmentTop;
+    }
+
+    return (JSGRectAlignment)0;
+}
+
+/**
+ *  Generate the data for a workload
+ *
+ *  @param seed The seed to generate the data from
+ *  @param count The number of items to generate for each kind of pass
+ */
+inline JSGLayoutWorkloadData JSGLayoutWorkloadMake(uint64_t seed, size_t count)
+{
+    JSGLayoutWorkloadGenerator generator(seed);
+    JSGLayoutWorkloadData data;
+    data.columns = 2 + generator.next() % 5;
+
+    CGRect screen = CGRectMake(0, 0, generator.uniform(320, 1440), generator.uniform(480, 900));
+
+    for (size_t i = 0; i < count; i++) {
+        JSGLayoutWorkloadItem row;
+        row.container = screen;
+        row.frame = CGRectMake(0, 0, generator.uniform(40, 300), generator.next() % 4 ? 44 : generator.uniform(60, 120));
+        row.alignment = JSGRectAlignmentRight;
+        row.origin = JSGCoordinateSystemOriginTopLeft;
+        data.rows.push_back(row);
+
+        JSGLayoutWorkloadItem cell;
+        cell.container = screen;
+        cell.frame = CGRectMake(0, 0, generator.uniform(16, 64), generator.uniform(16, 64));
+        cell.alignment = (JSGRectAlignment)0;
+        cell.origin = JSGCoordinateSystemOriginTopLeft;
+        data.cells.push_back(cell);
+
+        JSGLayoutWorkloadItem alignment;
+        alignment.container = CGRectMake(0, 0, generator.uniform(100, 1000), generator.uniform(100, 1000));
+        alignment.frame = CGRectMake(generator.uniform(0, 50), generator.uniform(0, 50), generator.uniform(10, 100), generator.uniform(10, 100));
+        alignment.alignment = JSGLayoutWorkloadAlignment(generator);
+        alignment.origin = generator.next() % 4 ? JSGCoordinateSystemOriginTopLeft : JSGCoordinateSystemOriginBottomLeft;
+        data.alignments.push_back(alignment);
+    }
+
+    return data;
+}
+
+/**
+ *  Run a list pass over a workload, writing the resulting frames
+ */
+inline void JSGLayoutWorkloadRunList(const JSGLayoutWorkloadData &data, std::vector<CGRect> &frames)
+{
+    CGFloat y = 0;
+
+    for (size_t i = 0; i < data.rows.size(); i++) {
+        const JSGLayoutWorkloadItem &item = data.rows[i];
+        CGRect row = JSGRectChangeWidth(item.container, CGRectGetWidth(item.container));
+        row = JSGRectChangeHeight(row, item.frame.size.height);
+        row = JSGRectChangeOriginY(row, y);
+
+        CGRect title = JSGRectGetCenterInRect(item.frame, row);
+        CGRect accessory = JSGRectAlignInRectForCoordinateSystemOrigin(JSGRectChangeSize(item.frame, CGSizeMake(24, 24)), row, item.alignment, item.origin);
+
+        frames[i * 3] = row;
+        frames[i * 3 + 1] = title;
+        frames[i * 3 + 2] = accessory;
+        y += row.size.height;
+    }
+}
+
+/**
+ *  Run a grid pass over a workload, writing the resulting frames
+ */
+inline void JSGLayoutWorkloadRunGrid(const JSGLayoutWorkloadData &data, std::vector<CGRect> &frames)
+{
+    for (size_t i = 0; i < data.cells.size(); i++) {
+        const JSGLayoutWorkloadItem &item = data.cells[i];
+        CGSize cellSize = JSGSizeScale(item.container.size, 1.0 / data.columns, 1.0 / data.columns);
+        size_t column = i % data.columns;
+        size_t row = i / data.columns;
+
+        CGRect cell = JSGRectChangeSize(item.container, cellSize);
+        cell = JSGRectChangeOrigin(cell, CGPointMake(column * cellSize.width, row * cellSize.height));
+
+        CGRect icon = JSGRectGetCenterInRect(item.frame, cell);
+        icon = JSGRectChangeOrigin(icon, CGPointMake(icon.origin.x + cell.origin.x, icon.origin.y + cell.origin.y));
+
+        frames[i * 2] = cell;
+        frames[i * 2 + 1] = JSGRectScale(icon, 2, 2);
+    }
+}
+
+/**
+ *  Run an alignment pass over a workload, writing the resulting frames
+ */
+inline void JSGLayoutWorkloadRunAlignment(const JSGLayoutWorkloadData &data, std::vector<CGRect> &frames)
+{
+    for (size_t i = 0; i < data.alignments.size(); i++) {
+        const JSGLayoutWorkloadItem &item = data.alignments[i];
+        frames[i] = JSGRectAlignInRectForCoordinateSystemOrigin(item.frame, item.container, item.alignment, item.origin);
+    }
+}
+
+#endif
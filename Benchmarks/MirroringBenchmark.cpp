@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryMirroring.h"
+
+/**
+ *  Turns 1M frames laid out from left to right into right to left frames, both within a
+ *  single 1280 point wide window & within each frame's own parent. Moving each CGRect with
+ *  JSGRectChangeOriginX is compared with mirroring a rect array.
+ */
+
+int main()
+{
+    const size_t frameCount = 1000000;
+    const CGRect window = CGRectMake(0, 0, 1280, 800);
+    std::vector<CGRect> frames(frameCount);
+    std::vector<CGRect> parents(frameCount);
+    std::vector<CGRect> results(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    for (size_t i = 0; i < frameCount; i++) {
+        CGFloat width = 20 + next() * 400;
+
+        frames[i] = CGRectMake(next() * (1280 - width), next() * 100000, width, 20 + next() * 60);
+        parents[i] = CGRectMake(0, 0, width + next() * 800, 100);
+    }
+
+    JSGBenchmarkRun("JSGRectChangeOriginX (1M rects)", 10, frameCount, [&] {
+        for (size_t i = 0; i < frameCount; i++) {
+            CGRect frame = frames[i];
+            results[i] = JSGRectChangeOriginX(frame, window.size.width - frame.origin.x - frame.size.width);
+        }
+        JSGBenchmarkKeep(results);
+    });
+
+    JSGRectArray array;
+    JSGRectArray containers;
+    JSGRectArrayInit(&array);
+    JSGRectArrayInit(&containers);
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+    JSGRectArraySetRects(&containers, parents.data(), frameCount);
+
+    // Mirroring twice per iteration, so that each iteration starts from the same rects
+    JSGBenchmarkRun("JSGRectArrayMirrorInRect (1M rects, mirrored & back)", 10, frameCount * 2, [&] {
+        JSGRectArrayMirrorInRect(&array, window);
+        JSGRectArrayMirrorInRect(&array, window);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    JSGBenchmarkRun("JSGRectArrayMirrorInRects (1M rects, mirrored & back)", 10, frameCount * 2, [&] {
+        JSGRectArrayMirrorInRects(&array, &containers);
+        JSGRectArrayMirrorInRects(&array, &containers);
+        JSGBenchmarkKeep(array.x);
+    });
+
+    JSGRectArraySetRects(&array, frames.data(), frameCount);
+    JSGRectArrayMirrorInRect(&array, window);
+
+    for (size_t i = 0; i < frameCount; i++) {
+        if (!CGRectEqualToRect(JSGRectArrayGetRect(&array, i), JSGRectMirrorInRect(frames[i], window))) {
+            std::printf("Mirroring rect %zu gave a different rect\n", i);
+            return 1;
+        }
+    }
+
+    // Aligning to the leading edge from right to left matches mirroring the left to right result
+    JSGRectAlignment alignment = (JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentLeading);
+
+    for (size_t i = 0; i < 1000; i++) {
+        CGRect leftToRight = JSGRectAlignInRectForCoordinateSystemOrigin(frames[i], parents[i], JSGRectAlignmentForLayoutDirection(alignment, JSGLayoutDirectionLeftToRight), JSGCoordinateSystemOriginTopLeft);
+        CGRect rightToLeft = JSGRectAlignInRectForCoordinateSystemOrigin(frames[i], parents[i], JSGRectAlignmentForLayoutDirection(alignment, JSGLayoutDirectionRightToLeft), JSGCoordinateSystemOriginTopLeft);
+
+        if (!CGRectEqualToRect(JSGRectMirrorInRect(leftToRight, parents[i]), rightToLeft)) {
+            std::printf("Aligning rect %zu to the leading edge didn't mirror it\n", i);
+            return 1;
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+    JSGRectArrayDestroy(&containers);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryNineSlice.h"
+
+/**
+ *  Slices the stretchable backgrounds of 100K buttons & chat bubbles, drawn from 16 atlas
+ *  regions. Slicing each frame by hand with CGRectDivide is compared with
+ *  JSGRectArrayGetNineSlices.
+ */
+
+int main()
+{
+    const size_t frameCount = 100000;
+    std::vector<CGRect> frames(frameCount);
+    std::vector<CGRect> regions(frameCount);
+    std::vector<JSGEdgeInsets> capInsets(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    for (size_t i = 0; i < frameCount; i++) {
+        size_t region = (size_t)(next() * 16);
+        CGFloat cap = 4 + region % 4 * 4;
+
+        frames[i] = CGRectMake(next() * 1000, next() * 100000, 40 + next() * 300, 40 + next() * 120);
+        regions[i] = CGRectMake(region % 4 * 64, region / 4 * 64, 64, 64);
+        capInsets[i] = JSGEdgeInsetsMake(cap, cap, cap + 4, cap);
+    }
+
+    std::vector<CGRect> sourceSlices(frameCount * JSG_NINE_SLICE_COUNT);
+    std::vector<CGRect> destinationSlices(frameCount * JSG_NINE_SLICE_COUNT);
+
+    // Slicing columns off the left & right, then rows off the top & bottom of each column
+    auto slice = [](CGRect rect, JSGEdgeInsets insets, CGRect *slices) {
+        CGRect columns[3];
+        CGRect rest;
+
+        CGRectDivide(rect, &columns[0], &rest, insets.left, CGRectMinXEdge);
+        CGRectDivide(rest, &columns[2], &columns[1], insets.right, CGRectMaxXEdge);
+
+        for (size_t column = 0; column < 3; column++) {
+            CGRectDivide(columns[column], &slices[column], &rest, insets.top, CGRectMinYEdge);
+            CGRectDivide(rest, &slices[6 + column], &slices[3 + column], insets.bottom, CGRectMaxYEdge);
+        }
+    };
+
+    JSGBenchmarkRun("CGRectDivide per frame (100K frames)", 10, frameCount, [&] {
+        for (size_t i = 0; i < frameCount; i++) {
+            slice(regions[i], capInsets[i], &sourceSlices[i * JSG_NINE_SLICE_COUNT]);
+            slice(frames[i], capInsets[i], &destinationSlices[i * JSG_NINE_SLICE_COUNT]);
+        }
+        JSGBenchmarkKeep(destinationSlices);
+    });
+
+    JSGRectArray destinations;
+    JSGRectArray sources;
+    JSGRectArray sourceArray;
+    JSGRectArray destinationArray;
+    JSGRectArrayInit(&destinations);
+    JSGRectArrayInit(&sources);
+    JSGRectArrayInit(&sourceArray);
+    JSGRectArrayInit(&destinationArray);
+    JSGRectArraySetRects(&destinations, frames.data(), frameCount);
+    JSGRectArraySetRects(&sources, regions.data(), frameCount);
+
+    JSGBenchmarkRun("JSGRectArrayGetNineSlices (100K frames)", 10, frameCount, [&] {
+        JSGRectArrayGetNineSlices(&destinations, &sources, capInsets.data(), JSGCoordinateSystemOriginTopLeft, 0, &sourceArray, &destinationArray);
+        JSGBenchmarkKeep(destinationArray.x);
+    });
+
+    // Edges are computed from the frame's edges rather than by subtracting sizes, so they
+    // may differ in the last bits
+    auto close = [](CGRect a, CGRect b) {
+        return fabs(a.origin.x - b.origin.x) < 1e-9 && fabs(a.origin.y - b.origin.y) < 1e-9 && fabs(a.size.width - b.size.width) < 1e-9 && fabs(a.size.height - b.size.height) < 1e-9;
+    };
+
+    for (size_t i = 0; i < frameCount * JSG_NINE_SLICE_COUNT; i++) {
+        if (!close(JSGRectArrayGetRect(&sourceArray, i), sourceSlices[i]) || !close(JSGRectArrayGetRect(&destinationArray, i), destinationSlices[i])) {
+            std::printf("Slice %zu of frame %zu differs from CGRectDivide\n", i % JSG_NINE_SLICE_COUNT, i / JSG_NINE_SLICE_COUNT);
+            return 1;
+        }
+    }
+
+    JSGBenchmarkRun("JSGRectArrayGetNineSlices, snapped to 3x pixels (100K frames)", 10, frameCount, [&] {
+        JSGRectArrayGetNineSlices(&destinations, &sources, capInsets.data(), JSGCoordinateSystemOriginTopLeft, 3, &sourceArray, &destinationArray);
+        JSGBenchmarkKeep(destinationArray.x);
+    });
+
+    // Snapped slices must still tile each frame's snapped rect without gaps
+    for (size_t i = 0; i < frameCount; i++) {
+        CGFloat width = 0;
+        CGFloat height = 0;
+
+        for (size_t k = 0; k < 3; k++) {
+            width += destinationArray.width[i * JSG_NINE_SLICE_COUNT + k];
+            height += destinationArray.height[i * JSG_NINE_SLICE_COUNT + k * 3];
+        }
+
+        if (fabs(destinationArray.x[i * JSG_NINE_SLICE_COUNT + 2] + destinationArray.width[i * JSG_NINE_SLICE_COUNT + 2] - destinationArray.x[i * JSG_NINE_SLICE_COUNT] - width) > 1e-9 || fabs(height - (round(CGRectGetMaxY(frames[i]) * 3) - round(CGRectGetMinY(frames[i]) * 3)) / 3) > 1e-9) {
+            std::printf("Snapped slices of frame %zu leave gaps\n", i);
+            return 1;
+        }
+    }
+
+    JSGRectArrayDestroy(&destinations);
+    JSGRectArrayDestroy(&sources);
+    JSGRectArrayDestroy(&sourceArray);
+    JSGRectArrayDestroy(&destinationArray);
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryOccupancy.h"
+
+/**
+ *  Places stickers on a 2048x2048 canvas covered with 500 obstacles, using an occupancy grid
+ *  of 4x4 cells. Counting the occupied cells of candidate rects by scanning the bitmap is
+ *  compared with the summed-area table, along with incremental & full updates.
+ */
+
+int main()
+{
+    const size_t obstacleCount = 500;
+    const size_t candidateCount = 100000;
+    const CGRect canvas = CGRectMake(0, 0, 2048, 2048);
+    std::vector<CGRect> obstacles(obstacleCount);
+    std::vector<CGRect> candidates(candidateCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    for (size_t i = 0; i < obstacleCount; i++) {
+        obstacles[i] = CGRectMake(next() * 2000, next() * 2000, 4 + next() * 40, 4 + next() * 40);
+    }
+
+    for (size_t i = 0; i < candidateCount; i++) {
+        candidates[i] = CGRectMake(next() * 1900, next() * 1900, 32 + next() * 96, 32 + next() * 96);
+    }
+
+    JSGRectArray rects;
+    JSGRectArrayInit(&rects);
+    JSGRectArraySetRects(&rects, obstacles.data(), obstacleCount);
+
+    JSGOccupancyGrid grid;
+    JSGOccupancyGridInit(&grid, canvas, 4);
+
+    JSGBenchmarkRun("JSGOccupancyGridAddRects & full update (500 obstacles, 512x512)", 10, obstacleCount, [&] {
+        JSGOccupancyGridClear(&grid);
+        JSGOccupancyGridAddRects(&grid, &rects);
+        JSGOccupancyGridUpdate(&grid);
+        JSGBenchmarkKeep(grid.sums);
+    });
+
+    std::vector<size_t> expected(candidateCount);
+    std::vector<size_t> counts(candidateCount);
+
+    JSGBenchmarkRun("counting occupied cells, bitmap scan", 1, candidateCount, [&] {
+        for (size_t i = 0; i < candidateCount; i++) {
+            size_t firstColumn = (size_t)(CGRectGetMinX(candidates[i]) / 4);
+            size_t endColumn = (size_t)ceil(CGRectGetMaxX(candidates[i]) / 4);
+            size_t firstRow = (size_t)(CGRectGetMinY(candidates[i]) / 4);
+            size_t endRow = (size_t)ceil(CGRectGetMaxY(candidates[i]) / 4);
+            size_t count = 0;
+
+            for (size_t row = firstRow; row < endRow; row++) {
+                for (size_t column = firstColumn; column < endColumn; column++) {
+                    count += grid.cells[row * grid.columns + column];
+                }
+            }
+
+            expected[i] = count;
+        }
+        JSGBenchmarkKeep(expected);
+    });
+
+    JSGBenchmarkRun("JSGOccupancyGridCountOccupied", 10, candidateCount, [&] {
+        for (size_t i = 0; i < candidateCount; i++) {
+            counts[i] = JSGOccupancyGridCountOccupied(&grid, candidates[i]);
+        }
+        JSGBenchmarkKeep(counts);
+    });
+
+    for (size_t i = 0; i < candidateCount; i++) {
+        if (counts[i] != expected[i]) {
+            std::printf("Summed-area table counted %zu occupied cells instead of %zu\n", counts[i], expected[i]);
+            return 1;
+        }
+    }
+
+    // Moving an obstacle near the bottom of the canvas only recomputes the rows below it
+    JSGBenchmarkRun("JSGOccupancyGridSetRect & incremental update (bottom 10% of rows)", 100, 1, [&] {
+        CGRect obstacle = CGRectMake(next() * 2000, 1850 + next() * 150, 40, 40);
+        JSGOccupancyGridSetRect(&grid, obstacle, true);
+        JSGOccupancyGridUpdate(&grid);
+        JSGOccupancyGridSetRect(&grid, obstacle, false);
+        JSGOccupancyGridUpdate(&grid);
+        JSGBenchmarkKeep(grid.sums);
+    });
+
+    JSGOccupancyGridClear(&grid);
+    JSGOccupancyGridAddRects(&grid, &rects);
+    JSGOccupancyGridUpdate(&grid);
+
+    size_t placed = 0;
+
+    JSGBenchmarkRun("JSGOccupancyGridFindFreeRect, placing 200 stickers", 1, 200, [&] {
+        JSGOccupancyGrid stickers = grid;
+        std::vector<uint8_t> cells(grid.cells, grid.cells + grid.columns * grid.rows);
+        std::vector<uint32_t> sums(grid.sums, grid.sums + (grid.columns + 1) * (grid.rows + 1));
+        stickers.cells = cells.data();
+        stickers.sums = sums.data();
+        placed = 0;
+
+        for (size_t i = 0; i < 200; i++) {
+            CGPoint origin;
+
+            if (JSGOccupancyGridFindFreeRect(&stickers, CGSizeMake(120, 80), &origin)) {
+                JSGOccupancyGridSetRect(&stickers, CGRectMake(origin.x, origin.y, 120, 80), true);
+                JSGOccupancyGridUpdate(&stickers);
+                placed++;
+            }
+        }
+        JSGBenchmarkKeep(placed);
+    });
+
+    std::printf("%zu stickers placed\n", placed);
+
+    JSGOccupancyGridDestroy(&grid);
+    JSGRectArrayDestroy(&rects);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+"""
+Builds profile guided (and optionally BOLT) optimized JSGeometry binaries, trained
+on the synthetic layout workload from Benchmarks/LayoutWorkload.h, and prints a
+report comparing their benchmark results against a regular optimized build.
+
+Usage: PGOWorkflow.py [--work-dir DIR] [--bolt] [--native] [--lto] [-- extra CMake arguments]
+
+Steps:
+1. Build a baseline, using the regular Release configuration.
+2. Build instrumented binaries (JSG_PGO=GENERATE), and run the training workload
+   (LayoutBenchmark --train) to collect profiles.
+3. Rebuild the same binaries using the collected profiles (JSG_PGO=USE).
+4. With --bolt, relink the PGO binaries with relocations (JSG_BOLT=ON), instrument
+   them using llvm-bolt, run the training workload again, and optimize them.
+5. Run the benchmarks for every variant, and print a report.
+"""
+
+import argparse
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+REPOSITORY = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TRAINING_BENCHMARK = "LayoutBenchmark"
+RESULT = re.compile(r"^(.*?)\s+([0-9.]+) ns/iter")
+
+
+def run(command, **kwargs):
+    print("+ " + " ".join(command), file=sys.stderr)
+    subprocess.check_call(command, **kwargs)
+
+
+def configure_and_build(build, options):
+    run(["cmake", "-S", REPOSITORY, "-B", build, "-DCMAKE_BUILD_TYPE=Release"] + options, stdout=subprocess.DEVNULL)
+    run(["cmake", "--build", build, "--target", TRAINING_BENCHMARK, "-j", str(os.cpu_count() or 1)], stdout=subprocess.DEVNULL)
+
+    return os.path.join(build, TRAINING_BENCHMARK)
+
+
+def cache_value(build, name):
+    with open(os.path.join(build, "CMakeCache.txt")) as cache:
+        for line in cache:
+            if line.startswith(name + ":"):
+                return line.split("=", 1)[1].strip()
+
+    return ""
+
+
+def measure(binary):
+    output = subprocess.check_output([binary], universal_newlines=True)
+    results = {}
+
+    for line in output.splitlines():
+        match = RESULT.match(line)
+
+        if match:
+            results[match.group(1).strip()] = float(match.group(2))
+
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--work-dir", default=os.path.join(REPOSITORY, "_pgo_workflow"))
+    parser.add_argument("--bolt", action="store_true", help="Also produce BOLT optimized binaries")
+    parser.add_argument("--native", action="store_true", help="Build all variants with JSG_NATIVE=ON")
+    parser.add_argument("--lto", action="store_true", help="Build all variants with JSG_LTO=ON")
+    parser.add_argument("cmake_arguments", nargs="*")
+    arguments = parser.parse_args()
+
+    options = list(arguments.cmake_arguments)
+    options.append("-DJSG_NATIVE=%s" % ("ON" if arguments.native else "OFF"))
+    options.append("-DJSG_LTO=%s" % ("ON" if arguments.lto else "OFF"))
+
+    if os.path.exists(arguments.work_dir):
+        shutil.rmtree(arguments.work_dir)
+
+    profiles = os.path.join(arguments.work_dir, "profiles")
+    variants = []
+
+    baseline = configure_and_build(os.path.join(arguments.work_dir, "baseline"), options + ["-DJSG_PGO=OFF"])
+    variants.append(("baseline", baseline))
+
+    # The instrumented & optimized builds share a build directory, since GCC names
+    # its profiles after the paths of the object files they belong to.
+    pgo_build = os.path.join(arguments.work_dir, "pgo")
+    pgo_options = options + ["-DJSG_PGO_DIRECTORY=%s" % profiles]
+    instrumented = configure_and_build(pgo_build, pgo_options + ["-DJSG_PGO=GENERATE"])
+    run([instrumented, "--train"])
+
+    if "Clang" in cache_value(pgo_build, "CMAKE_CXX_COMPILER_ID") or glob.glob(os.path.join(profiles, "*.profraw")):
+        profdata = shutil.which("llvm-profdata") or "llvm-profdata"
+        run([profdata, "merge", "-o", os.path.join(profiles, "merged.profdata")] + glob.glob(os.path.join(profiles, "*.profraw")))
+
+    pgo = configure_and_build(pgo_build, pgo_options + ["-DJSG_PGO=USE", "-DJSG_BOLT=%s" % ("ON" if arguments.bolt else "OFF")])
+    variants.append(("pgo", pgo))
+
+    if arguments.bolt:
+        bolt = shutil.which("llvm-bolt")
+
+        if not bolt:
+            print("llvm-bolt not found, skipping the BOLT variant", file=sys.stderr)
+        else:
+            fdata = os.path.join(profiles, "bolt.fdata")
+            bolt_instrumented = pgo + ".bolt-instrumented"
+            bolt_optimized = pgo + ".bolt"
+            run([bolt, pgo, "-instrument", "-instrumentation-file=" + fdata, "-o", bolt_instrumented])
+            run([bolt_instrumented, "--train"])
+            run([bolt, pgo, "-data=" + fdata, "-reorder-blocks=ext-tsp", "-reorder-functions=hfsort", "-split-functions", "-split-all-cold", "-dyno-stats", "-o", bolt_optimized])
+            variants.append(("pgo+bolt", bolt_optimized))
+
+    results = [(name, measure(binary)) for name, binary in variants]
+    baseline_results = results[0][1]
+
+    print("| Benchmark | " + " | ".join("%s (ns/iter)" % name for name, _ in results) + " | " + " | ".join("%s speedup" % name for name, _ in results[1:]) + " |")
+    print("|---" * (len(results) * 2) + "|")
+
+    for benchmark, baseline_time in baseline_results.items():
+        times = [variant.get(benchmark, float("nan")) for _, variant in results]
+        speedups = ["%.2fx" % (baseline_time / time) if time else "-" for time in times[1:]]
+        print("| %s | %s | %s |" % (benchmark, " | ".join("%.1f" % time for time in times), " | ".join(speedups)))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryPlacement.h"
+
+/**
+ *  Places popovers next to anchors on a screen covered with obstacles. Trying each side in
+ *  turn, testing every obstacle, is compared with JSGPlacementFind using a spatial grid.
+ */
+
+static CGRect JSGTrialPlacement(CGRect anchor, CGSize size, CGFloat spacing, CGRect bounds, const std::vector<CGRect> &obstacles)
+{
+    CGRect candidates[4] = {
+        CGRectMake(CGRectGetMidX(anchor) - size.width / 2, CGRectGetMinY(anchor) - spacing - size.height, size.width, size.height),
+        CGRectMake(CGRectGetMidX(anchor) - size.width / 2, CGRectGetMaxY(anchor) + spacing, size.width, size.height),
+        CGRectMake(CGRectGetMaxX(anchor) + spacing, CGRectGetMidY(anchor) - size.height / 2, size.width, size.height),
+        CGRectMake(CGRectGetMinX(anchor) - spacing - size.width, CGRectGetMidY(anchor) - size.height / 2, size.width, size.height)
+    };
+
+    for (CGRect candidate : candidates) {
+        if (!CGRectContainsRect(bounds, candidate)) {
+            continue;
+        }
+
+        bool obstructed = false;
+
+        for (const CGRect &obstacle : obstacles) {
+            if (CGRectIntersectsRect(candidate, obstacle)) {
+                obstructed = true;
+                break;
+            }
+        }
+
+        if (!obstructed) {
+            return candidate;
+        }
+    }
+
+    return candidates[0];
+}
+
+int main()
+{
+    const size_t obstacleCount = 400;
+    const size_t anchorCount = 10000;
+    const CGRect bounds = CGRectMake(0, 0, 3840, 2160);
+    const CGSize size = CGSizeMake(240, 120);
+    std::vector<CGRect> obstacles(obstacleCount);
+    std::vector<CGRect> anchors(anchorCount);
+    std::vector<CGRect> frames(anchorCount);
+    JSGSpatialGrid grid;
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    JSGSpatialGridInit(&grid, bounds, 128);
+
+    for (size_t i = 0; i < obstacleCount; i++) {
+        obstacles[i] = CGRectMake(next() * 3840, next() * 2160, 20 + next() * 60, 20 + next() * 60);
+        JSGSpatialGridInsert(&grid, obstacles[i]);
+    }
+
+    for (size_t i = 0; i < anchorCount; i++) {
+        anchors[i] = CGRectMake(next() * 3800, next() * 2140, 40, 20);
+    }
+
+    JSGBenchmarkRun("trial placement, linear obstacle scan", 5, anchorCount, [&] {
+        for (size_t i = 0; i < anchorCount; i++) {
+            frames[i] = JSGTrialPlacement(anchors[i], size, 8, bounds, obstacles);
+        }
+        JSGBenchmarkKeep(frames);
+    });
+
+    JSGBenchmarkRun("JSGPlacementFind, spatial grid", 5, anchorCount, [&] {
+        for (size_t i = 0; i < anchorCount; i++) {
+            frames[i] = JSGPlacementFind(anchors[i], size, 8, bounds, &grid, JSGRectAlignmentTop, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginTopLeft, NULL).frame;
+        }
+        JSGBenchmarkKeep(frames);
+    });
+
+    size_t obstructedCount = 0;
+    size_t overflowingCount = 0;
+
+    for (size_t i = 0; i < anchorCount; i++) {
+        obstructedCount += JSGSpatialGridIntersectsRect(&grid, frames[i]);
+        overflowingCount += !CGRectContainsRect(bounds, frames[i]);
+    }
+
+    std::printf("%zu of %zu popovers overlap an obstacle, %zu overflow the bounds\n", obstructedCount, anchorCount, overflowingCount);
+
+    JSGSpatialGridDestroy(&grid);
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryRTree.h"
+
+/**
+ *  Maintains the frames of 100K views in a persistent R-tree, measuring inserts, moves &
+ *  queries, then moves frames while reader threads query snapshots of the tree
+ */
+
+int main()
+{
+    const size_t frameCount = 100000;
+    const size_t moveCount = 10000;
+    std::vector<CGRect> frames(frameCount);
+    std::vector<CGRect> moves(moveCount);
+    std::vector<CGRect> viewports(1000);
+    std::vector<size_t> found(frameCount);
+    uint64_t state = 88172645463325252ull;
+
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    auto randomFrame = [&]() {
+        return CGRectMake(next() * 10000, next() * 10000, 10 + next() * 90, 10 + next() * 60);
+    };
+
+    for (size_t i = 0; i < frameCount; i++) {
+        frames[i] = randomFrame();
+    }
+
+    for (size_t i = 0; i < moveCount; i++) {
+        moves[i] = randomFrame();
+    }
+
+    for (size_t i = 0; i < viewports.size(); i++) {
+        viewports[i] = CGRectMake(next() * 9000, next() * 9000, 1024, 768);
+    }
+
+    JSGRTree tree;
+    JSGRTreeInit(&tree);
+
+    JSGBenchmarkRun("JSGRTreeInsert (100K frames, publishing every 1000)", 1, frameCount, [&] {
+        JSGRTreeDestroy(&tree);
+        JSGRTreeInit(&tree);
+
+        for (size_t i = 0; i < frameCount; i++) {
+            JSGRTreeInsert(&tree, i, frames[i]);
+
+            if (i % 1000 == 999) {
+                JSGRTreePublish(&tree);
+            }
+        }
+
+        JSGRTreePublish(&tree);
+    });
+
+    size_t move = 0;
+
+    JSGBenchmarkRun("JSGRTreeRemove & JSGRTreeInsert, publishing every move", 1, moveCount, [&] {
+        for (size_t i = 0; i < moveCount; i++, move++) {
+            size_t item = (move * 7919) % frameCount;
+            JSGRTreeRemove(&tree, item, frames[item]);
+            frames[item] = moves[move % moveCount];
+            JSGRTreeInsert(&tree, item, frames[item]);
+            JSGRTreePublish(&tree);
+        }
+    });
+
+    size_t reader = 0;
+    JSGRTreeRegisterReader(&tree, &reader);
+
+    JSGBenchmarkRun("JSGRTreeQuery (1024x768 viewport)", 10, viewports.size(), [&] {
+        JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+
+        for (const CGRect &viewport : viewports) {
+            size_t count = JSGRTreeQuery(snapshot, viewport, found.data(), found.size());
+            JSGBenchmarkKeep(count);
+        }
+
+        JSGRTreeEndRead(&tree, reader);
+    });
+
+    JSGRTreeUnregisterReader(&tree, reader);
+
+    // Readers must always see complete versions while the writer keeps moving frames
+    std::atomic<bool> writing(true);
+    std::atomic<size_t> failures(0);
+    std::atomic<size_t> queries(0);
+    std::vector<std::thread> readers;
+
+    for (size_t i = 0; i < 3; i++) {
+        readers.emplace_back([&, i] {
+            size_t reader;
+            std::vector<size_t> items(frameCount);
+
+            if (!JSGRTreeRegisterReader(&tree, &reader)) {
+                failures++;
+                return;
+            }
+
+            for (size_t query = i; writing; query++) {
+                JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+                CGRect everything = CGRectMake(-1000, -1000, 20000, 20000);
+
+                failures += JSGRTreeQuery(snapshot, everything, items.data(), items.size()) != frameCount;
+                JSGRTreeQuery(snapshot, viewports[query % viewports.size()], items.data(), items.size());
+                JSGRTreeEndRead(&tree, reader);
+                queries++;
+            }
+
+            JSGRTreeUnregisterReader(&tree, reader);
+        });
+    }
+
+    JSGBenchmarkRun("JSGRTreeRemove & JSGRTreeInsert with 3 reader threads", 1, moveCount, [&] {
+        for (size_t i = 0; i < moveCount; i++, move++) {
+            size_t item = (move * 7919) % frameCount;
+            JSGRTreeRemove(&tree, item, frames[item]);
+            frames[item] = moves[(move * 31) % moveCount];
+            JSGRTreeInsert(&tree, item, frames[item]);
+            JSGRTreePublish(&tree);
+        }
+    });
+
+    writing = false;
+
+    for (std::thread &thread : readers) {
+        thread.join();
+    }
+
+    JSGRTreeReclaim(&tree);
+    std::printf("%zu concurrent queries\n", queries.load());
+
+    if (failures) {
+        std::printf("%zu queries saw an incomplete version of the tree\n", failures.load());
+        return 1;
+    }
+
+    // The final version must match a linear scan of the frames
+    JSGRTreeRegisterReader(&tree, &reader);
+    JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+
+    for (size_t i = 0; i < 100; i++) {
+        size_t expected = 0;
+
+        for (const CGRect &frame : frames) {
+            expected += !CGRectIsEmpty(CGRectIntersection(frame, viewports[i]));
+        }
+
+        size_t count = JSGRTreeQuery(snapshot, viewports[i], NULL, 0);
+
+        if (count != expected) {
+            std::printf("R-tree found %zu frames instead of %zu\n", count, expected);
+            return 1;
+        }
+    }
+
+    JSGRTreeEndRead(&tree, reader);
+    JSGRTreeUnregisterReader(&tree, reader);
+
+    // Removing every frame must leave an empty tree
+    for (size_t i = 0; i < frameCount; i++) {
+        if (!JSGRTreeRemove(&tree, i, frames[i])) {
+            std::printf("Frame %zu could not be removed\n", i);
+            return 1;
+        }
+    }
+
+    JSGRTreePublish(&tree);
+
+    if (tree.count != 0 || tree.root) {
+        std::printf("%zu frames remain after removing every frame\n", tree.count);
+        return 1;
+    }
+
+    JSGRTreeDestroy(&tree);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <cstring>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryReduction.h"
+
+/**
+ *  Compares computing the bounds of a large number of rects using a sequential
+ *  CGRectUnion loop with JSGRectArrayReduce, using one and all threads
+ */
+
+int main()
+{
+    const size_t count = 1 << 20;
+    std::vector<CGRect> rects(count);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake((i * 7919) % 10007, (i * 104729) % 10009, 1 + i % 97, 1 + i % 89);
+    }
+
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), count);
+
+    JSGBenchmarkRun("CGRectUnion loop", 20, count, [&] {
+        CGRect bounds = CGRectNull;
+
+        for (size_t i = 0; i < count; i++) {
+            bounds = CGRectUnion(bounds, rects[i]);
+        }
+
+        JSGBenchmarkKeep(bounds);
+    });
+
+    JSGRectArrayReduction reductions[2];
+
+    JSGBenchmarkRun("JSGRectArrayReduce (1 thread)", 50, count, [&] {
+        JSGRectArrayReduce(&array, 1, &reductions[0]);
+        JSGBenchmarkKeep(reductions[0]);
+    });
+
+    JSGBenchmarkRun("JSGRectArrayReduce (all threads)", 50, count, [&] {
+        JSGRectArrayReduce(&array, 0, &reductions[1]);
+        JSGBenchmarkKeep(reductions[1]);
+    });
+
+    JSGRectArrayDestroy(&array);
+
+    if (std::memcmp(&reductions[0], &reductions[1], sizeof(JSGRectArrayReduction)) != 0) {
+        std::printf("Reductions differ between thread counts\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometrySplitLayout.h"
+
+/**
+ *  Builds split trees by repeatedly splitting random panes, and measures relayouts on
+ *  container resizes. After each layout, panes & dividers are checked to exactly cover
+ *  the container, with integral frames.
+ */
+
+static bool JSGSplitTreeCheck(const JSGSplitTree &tree, const std::vector<size_t> &panes, CGRect container)
+{
+    CGFloat area = 0;
+
+    for (size_t pane : panes) {
+        CGRect frame = tree.nodes[pane].frame;
+
+        if (frame.size.width < 0 || frame.size.height < 0 || frame.origin.x != std::round(frame.origin.x) || frame.size.width != std::round(frame.size.width)) {
+            std::printf("Pane %zu has an invalid frame\n", pane);
+            return false;
+        }
+
+        area += frame.size.width * frame.size.height;
+    }
+
+    for (size_t i = 0; i < tree.count; i++) {
+        const JSGSplitNode &node = tree.nodes[i];
+
+        if (node.type != JSGSplitTypePane) {
+            CGRect divider = JSGSplitTreeGetDividerRect(&tree, i);
+            area += divider.size.width * divider.size.height;
+        }
+    }
+
+    if (area != container.size.width * container.size.height) {
+        std::printf("Panes & dividers cover %g instead of %g\n", area, container.size.width * container.size.height);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    const size_t counts[] = {16, 1024, 65536};
+
+    for (size_t count : counts) {
+        JSGSplitTree tree;
+        JSGSplitTreeInit(&tree, 1);
+        std::vector<size_t> panes(1);
+        JSGSplitTreeAddRootPane(&tree, &panes[0]);
+        uint64_t state = 88172645463325252ull;
+
+        while (panes.size() < count) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            size_t pane = panes[state % panes.size()];
+            JSGSplitType type = (state >> 20) & 1 ? JSGSplitTypeHorizontal : JSGSplitTypeVertical;
+            CGFloat ratio = 0.2 + ((state >> 24) % 61) / 100.0;
+            size_t newPane;
+
+            JSGSplitTreeSplitPane(&tree, pane, type, ratio, (state >> 32) & 1, &newPane);
+            tree.nodes[newPane].minSize = CGSizeMake((state >> 40) % 3, (state >> 44) % 3);
+            panes.push_back(newPane);
+        }
+
+        CGRect containers[] = {
+            CGRectMake(0, 0, 1280, 800), CGRectMake(0, 0, 1920, 1080), CGRectMake(0, 0, 3840, 2160), CGRectMake(0, 0, 1437, 913)
+        };
+
+        for (CGRect container : containers) {
+            JSGSplitTreeLayout(&tree, container, 1);
+
+            if (!JSGSplitTreeCheck(tree, panes, container)) {
+                return 1;
+            }
+        }
+
+        char name[96];
+        std::snprintf(name, sizeof(name), "JSGSplitTreeLayout resize (%zu panes)", count);
+        size_t resize = 0;
+
+        JSGBenchmarkRun(name, 20000000 / count + 1, 2 * count - 1, [&] {
+            resize++;
+            JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 3000 + resize % 840, 2000 + resize % 160), 1);
+            JSGBenchmarkKeep(tree.nodes);
+        });
+
+        JSGSplitTreeDestroy(&tree);
+    }
+
+    return 0;
+}
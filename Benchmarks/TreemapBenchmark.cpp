@@ -0,0 +1,133 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "JSGBenchmark.h"
+#include "../JSGeometryTreemap.h"
+
+/**
+ *  Lays out treemaps of 1M leaves, both flat and as a two level hierarchy, and compares
+ *  them with a naive recursive layout that splits the weights in two halves, adjusting
+ *  each tile with JSGRectChangeWidth & JSGRectChangeHeight
+ */
+
+static void JSGNaiveTreemap(const CGFloat *weights, const CGFloat *prefixSums, size_t start, size_t end, CGRect rect, CGRect *tiles)
+{
+    if (end - start == 1) {
+        tiles[start] = rect;
+        return;
+    }
+
+    size_t middle = start + (end - start) / 2;
+    CGFloat total = prefixSums[end] - prefixSums[start];
+    CGFloat fraction = total > 0 ? (prefixSums[middle] - prefixSums[start]) / total : 0.5;
+    CGRect first = rect, second = rect;
+
+    if (rect.size.width >= rect.size.height) {
+        first = JSGRectChangeWidth(rect, rect.size.width * fraction);
+        second = JSGRectChangeOriginX(JSGRectChangeWidth(rect, rect.size.width - first.size.width), rect.origin.x + first.size.width);
+    } else {
+        first = JSGRectChangeHeight(rect, rect.size.height * fraction);
+        second = JSGRectChangeOriginY(JSGRectChangeHeight(rect, rect.size.height - first.size.height), rect.origin.y + first.size.height);
+    }
+
+    JSGNaiveTreemap(weights, prefixSums, start, middle, first, tiles);
+    JSGNaiveTreemap(weights, prefixSums, middle, end, second, tiles);
+}
+
+static bool JSGTreemapCheck(const char *name, const CGRect *tiles, const size_t count, CGRect container)
+{
+    CGFloat area = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (tiles[i].size.width < 0 || tiles[i].size.height < 0 || (!CGRectIsEmpty(tiles[i]) && !CGRectContainsRect(CGRectInset(container, -1e-6, -1e-6), tiles[i]))) {
+            std::printf("%s: tile %zu is outside of the container\n", name, i);
+            return false;
+        }
+
+        area += tiles[i].size.width * tiles[i].size.height;
+    }
+
+    CGFloat expected = container.size.width * container.size.height;
+
+    if (std::fabs(area - expected) > expected * 1e-6) {
+        std::printf("%s: tiles cover %g instead of %g\n", name, area, expected);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    const size_t groupCount = 1000;
+    const size_t leafCount = groupCount * 1000;
+    const CGRect container = CGRectMake(0, 0, 3840, 2160);
+    std::vector<CGFloat> weights(leafCount);
+    std::vector<CGFloat> prefixSums(leafCount + 1);
+    std::vector<CGRect> tiles(leafCount);
+    uint64_t state = 88172645463325252ull;
+
+    for (size_t i = 0; i < leafCount; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Heavy-tailed weights, like file sizes
+        CGFloat uniform = (state >> 11) * (1.0 / 9007199254740992.0);
+        weights[i] = 1 / (0.001 + uniform * uniform);
+        prefixSums[i + 1] = prefixSums[i] + weights[i];
+    }
+
+    JSGBenchmarkRun("naive recursive layout (1M leaves)", 5, leafCount, [&] {
+        JSGNaiveTreemap(weights.data(), prefixSums.data(), 0, leafCount, container, tiles.data());
+        JSGBenchmarkKeep(tiles);
+    });
+
+    JSGBenchmarkRun("JSGTreemapLayoutRects slice & dice (1M leaves)", 5, leafCount, [&] {
+        JSGTreemapLayoutRects(weights.data(), leafCount, container, JSGTreemapLayoutSliceAndDice, tiles.data());
+        JSGBenchmarkKeep(tiles);
+    });
+
+    if (!JSGTreemapCheck("slice & dice", tiles.data(), leafCount, container)) {
+        return 1;
+    }
+
+    JSGBenchmarkRun("JSGTreemapLayoutRects squarified (1M leaves)", 5, leafCount, [&] {
+        JSGTreemapLayoutRects(weights.data(), leafCount, container, JSGTreemapLayoutSquarified, tiles.data());
+        JSGBenchmarkKeep(tiles);
+    });
+
+    if (!JSGTreemapCheck("squarified", tiles.data(), leafCount, container)) {
+        return 1;
+    }
+
+    // A root node, followed by the groups and then the leaves, in breadth-first order
+    size_t nodeCount = 1 + groupCount + leafCount;
+    std::vector<CGFloat> nodeWeights(nodeCount, 0);
+    std::vector<size_t> firstChildren(nodeCount, 0);
+    std::vector<size_t> childCounts(nodeCount, 0);
+    std::vector<CGRect> nodeTiles(nodeCount);
+
+    firstChildren[0] = 1;
+    childCounts[0] = groupCount;
+
+    for (size_t i = 0; i < groupCount; i++) {
+        firstChildren[1 + i] = 1 + groupCount + i * (leafCount / groupCount);
+        childCounts[1 + i] = leafCount / groupCount;
+    }
+
+    for (size_t i = 0; i < leafCount; i++) {
+        nodeWeights[1 + groupCount + i] = weights[i];
+    }
+
+    JSGBenchmarkRun("JSGTreemapLayoutHierarchy squarified (1K groups of 1K leaves)", 5, nodeCount, [&] {
+        JSGTreemapLayoutHierarchy(nodeWeights.data(), firstChildren.data(), childCounts.data(), nodeCount, container, JSGTreemapLayoutSquarified, 0, nodeTiles.data());
+        JSGBenchmarkKeep(nodeTiles);
+    });
+
+    if (!JSGTreemapCheck("nested squarified", nodeTiles.data() + 1 + groupCount, leafCount, container)) {
+        return 1;
+    }
+
+    return 0;
+}
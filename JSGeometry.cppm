@@ -0,0 +1,78 @@
+/**
+ *  The jsgeometry C++20 module
+ *
+ *  @discussion Exports everything declared by the JSGeometry headers, so that
+ *  C++20 code can use "import jsgeometry;" instead of including them. Macros, such as
+ *  JSGRectsFixed, can't be exported by a module; code that needs them should keep
+ *  including the headers, which remain fully supported.
+ *
+ *  All system headers used by the JSGeometry headers are included in the global module
+ *  fragment, so that only JSGeometry's own declarations end up in the export block below.
+ *
+ *  Where CoreGraphics isn't available, JSGeometryCoreGraphics.h is included by JSGeometry.h
+ *  within the export block, so its types, functions & constants, such as CGRect,
+ *  CGRectMake & CGRectNull, are owned & exported by the module. On Apple platforms,
+ *  CoreGraphics is included in the global module fragment instead, & only the types used
+ *  by the functions are exported. CoreGraphics declares its functions static inline, which
+ *  makes them local to each translation unit, so compilers that strictly enforce C++20's
+ *  rules against exposing such functions from a module may reject the module there; the
+ *  headers should be used in that case.
+ *
+ *  When adding a header to the module, add any system headers it includes here as well.
+ */
+module;
+
+#define JSG_INLINE inline
+
+#if defined(__APPLE__)
+#import <CoreGraphics/CGGeometry.h>
+#endif
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+export module jsgeometry;
+
+export extern "C++" {
+#include "JSGeometry.h"
+#include "JSGeometryBatch.h"
+#include "JSGeometryFixedBatch.h"
+#include "JSGeometryCommandBuffer.h"
+#include "JSGeometryRectArray.h"
+#include "JSGeometryParallel.h"
+#include "JSGeometryReduction.h"
+#include "JSGeometryClipping.h"
+#include "JSGeometryDetection.h"
+#include "JSGeometrySorting.h"
+#include "JSGeometryTreemap.h"
+#include "JSGeometrySplitLayout.h"
+#include "JSGeometrySpatialGrid.h"
+#include "JSGeometryPlacement.h"
+#include "JSGeometryEmptySpace.h"
+#include "JSGeometryLabels.h"
+#include "JSGeometryClustering.h"
+#include "JSGeometryComponents.h"
+#include "JSGeometryBVH.h"
+#include "JSGeometryRTree.h"
+#include "JSGeometryJoin.h"
+#include "JSGeometryCoverage.h"
+#include "JSGeometryOccupancy.h"
+#include "JSGeometryInsets.h"
+#include "JSGeometryClamping.h"
+#include "JSGeometryNineSlice.h"
+#include "JSGeometryAtlas.h"
+#include "JSGeometryMirroring.h"
+}
+
+#if defined(__APPLE__)
+export using ::CGFloat;
+export using ::CGPoint;
+export using ::CGSize;
+export using ::CGRect;
+#endif
@@ -1,22 +1,66 @@
 #ifndef JSGeometry
 #define JSGeometry
 
+#if defined(__APPLE__)
 #import <CoreGraphics/CGGeometry.h>
+#else
+#include "JSGeometryCoreGraphics.h"
+#endif
+
+/**
+ *  Specifier used for all JSGeometry functions
+ *
+ *  @discussion Defaults to CG_INLINE. It may be defined before including JSGeometry
+ *  to override it, which the jsgeometry C++ module does to give all functions
+ *  external linkage, so that they can be exported.
+ */
+#ifndef JSG_INLINE
+#define JSG_INLINE CG_INLINE
+#endif
+
+/**
+ *  Specifier used for the constant tables that JSGeometry functions look values up in
+ *
+ *  @discussion Tables are declared at namespace scope rather than as static locals of the
+ *  functions using them, since a module doesn't emit the static locals of the inline
+ *  functions it exports. From C++17 on, they're inline constexpr, which gives them a
+ *  single definition that is visible to code importing the jsgeometry module.
+ */
+#ifndef JSG_CONSTANT
+#if defined(__cplusplus) && __cplusplus >= 201703L
+#define JSG_CONSTANT inline constexpr
+#else
+#define JSG_CONSTANT static const
+#endif
+#endif
 
 #pragma mark - Enums
 
 /**
  *  Enum describing various alignments
  *
- *  @discussion Multiple values may be combined in a bitmask
+ *  @discussion Multiple values may be combined in a bitmask. The leading & trailing
+ *  alignments describe the start & end of a line of text, which depend on the layout
+ *  direction, and must be resolved to left or right alignments using
+ *  JSGRectAlignmentForLayoutDirection before being applied.
  */
 typedef enum : NSUInteger {
     JSGRectAlignmentTop = 1,
     JSGRectAlignmentRight = 1 << 1,
     JSGRectAlignmentBottom = 1 << 2,
-    JSGRectAlignmentLeft = 1 << 3
+    JSGRectAlignmentLeft = 1 << 3,
+    JSGRectAlignmentLeading = 1 << 4,
+    JSGRectAlignmentTrailing = 1 << 5
 } JSGRectAlignment;
 
+/**
+ *  Enum describing the horizontal directions that content may be laid out in
+ */
+typedef enum : NSUInteger {
+    JSGLayoutDirectionLeftToRight,
+    JSGLayoutDirectionRightToLeft
+} JSGLayoutDirection;
+
 /**
  *  Enum describing various coordinate system origins used
  *  on Apple platforms
@@ -36,7 +80,7 @@ typedef enum : NSUInteger {
  *  @discussion The point's x & y components will be rounded
  *  to their closest non-fractional value.
  */
-CG_INLINE CGPoint JSGPointIntegral(CGPoint point)
+JSG_INLINE CGPoint JSGPointIntegral(CGPoint point)
 {
     point.x = roundf(point.x);
     point.y = roundf(point.y);
@@ -53,7 +97,7 @@ CG_INLINE CGPoint JSGPointIntegral(CGPoint point)
  *  @discussion This function always returns the integral result of
  *  the generated point.
  */
-CG_INLINE CGPoint JSGCenterPointForSizeInSize(CGSize sizeA, CGSize sizeB)
+JSG_INLINE CGPoint JSGCenterPointForSizeInSize(CGSize sizeA, CGSize sizeB)
 {
     CGPoint centerPoint;
     
@@ -73,7 +117,7 @@ CG_INLINE CGPoint JSGCenterPointForSizeInSize(CGSize sizeA, CGSize sizeB)
  *  @discussion The size's width & height components will be
  *  rounded to their closest non-fractional value.
  */
-CG_INLINE CGSize JSGSizeIntegral(CGSize size)
+JSG_INLINE CGSize JSGSizeIntegral(CGSize size)
 {
     size.width = roundf(size.width);
     size.height = roundf(size.height);
@@ -91,7 +135,7 @@ CG_INLINE CGSize JSGSizeIntegral(CGSize size)
  *  @discussion This function always returns the integral result of
  *  the scaled size.
  */
-CG_INLINE CGSize JSGSizeScale(CGSize size, CGFloat scaleX, CGFloat scaleY)
+JSG_INLINE CGSize JSGSizeScale(CGSize size, CGFloat scaleX, CGFloat scaleY)
 {
     size.width *= scaleX;
     size.height *= scaleY;
@@ -107,7 +151,7 @@ CG_INLINE CGSize JSGSizeScale(CGSize size, CGFloat scaleX, CGFloat scaleY)
  *  @param rect The rect to change
  *  @param newOrigin The new origin that the rect should have
  */
-CG_INLINE CGRect JSGRectChangeOrigin(CGRect rect, CGPoint newOrigin)
+JSG_INLINE CGRect JSGRectChangeOrigin(CGRect rect, CGPoint newOrigin)
 {
     rect.origin = newOrigin;
     
@@ -120,7 +164,7 @@ CG_INLINE CGRect JSGRectChangeOrigin(CGRect rect, CGPoint newOrigin)
  *  @param rect The rect to change
  *  @param newOriginX The new x component that the rect's origin should have
  */
-CG_INLINE CGRect JSGRectChangeOriginX(CGRect rect, CGFloat newOriginX)
+JSG_INLINE CGRect JSGRectChangeOriginX(CGRect rect, CGFloat newOriginX)
 {
     rect.origin.x = newOriginX;
     
@@ -133,7 +177,7 @@ CG_INLINE CGRect JSGRectChangeOriginX(CGRect rect, CGFloat newOriginX)
  *  @param rect The rect to change
  *  @param newOriginY The new y component that the rect's origin should have
  */
-CG_INLINE CGRect JSGRectChangeOriginY(CGRect rect, CGFloat newOriginY)
+JSG_INLINE CGRect JSGRectChangeOriginY(CGRect rect, CGFloat newOriginY)
 {
     rect.origin.y = newOriginY;
     
@@ -146,7 +190,7 @@ CG_INLINE CGRect JSGRectChangeOriginY(CGRect rect, CGFloat newOriginY)
  *  @param rect The rect to change
  *  @param newSize The new size that the rect should have
  */
-CG_INLINE CGRect JSGRectChangeSize(CGRect rect, CGSize newSize)
+JSG_INLINE CGRect JSGRectChangeSize(CGRect rect, CGSize newSize)
 {
     rect.size = newSize;
     
@@ -159,7 +203,7 @@ CG_INLINE CGRect JSGRectChangeSize(CGRect rect, CGSize newSize)
  *  @param rect The rect to change
  *  @param newSize The new width that the rect should have
  */
-CG_INLINE CGRect JSGRectChangeWidth(CGRect rect, CGFloat newWidth)
+JSG_INLINE CGRect JSGRectChangeWidth(CGRect rect, CGFloat newWidth)
 {
     rect.size.width = newWidth;
     
@@ -172,7 +216,7 @@ CG_INLINE CGRect JSGRectChangeWidth(CGRect rect, CGFloat newWidth)
  *  @param rect The rect to change
  *  @param newSize The new height that the rect should have
  */
-CG_INLINE CGRect JSGRectChangeHeight(CGRect rect, CGFloat newHeight)
+JSG_INLINE CGRect JSGRectChangeHeight(CGRect rect, CGFloat newHeight)
 {
     rect.size.height = newHeight;
     
@@ -189,7 +233,7 @@ CG_INLINE CGRect JSGRectChangeHeight(CGRect rect, CGFloat newHeight)
  *  @discussion This function always returns the integral rect for the
  *  generated rect.
  */
-CG_INLINE CGRect JSGRectScale(CGRect rect, CGFloat scaleX, CGFloat scaleY)
+JSG_INLINE CGRect JSGRectScale(CGRect rect, CGFloat scaleX, CGFloat scaleY)
 {
     rect.size = JSGSizeScale(rect.size, scaleX, scaleY);
     
@@ -205,7 +249,7 @@ CG_INLINE CGRect JSGRectScale(CGRect rect, CGFloat scaleX, CGFloat scaleY)
  *  @discussion This function always returns the integral rect for the
  *  generated rect.
  */
-CG_INLINE CGRect JSGRectGetCenterInRect(CGRect rectA, CGRect rectB)
+JSG_INLINE CGRect JSGRectGetCenterInRect(CGRect rectA, CGRect rectB)
 {
     rectA.origin = JSGCenterPointForSizeInSize(rectA.size, rectB.size);
     
@@ -220,14 +264,15 @@ CG_INLINE CGRect JSGRectGetCenterInRect(CGRect rectA, CGRect rectB)
  *  @param alignment The alignment that should be applied to rectA. Multiple alignments
  *  may be combined in a bitmask. If the supplied bitmask contains both a top & bottom
  *  alignment, then only the bottom one will be used. If it contains both a left & right one,
- *  then only the right one will be used.
+ *  then only the right one will be used. Leading & trailing alignments are ignored, and
+ *  should be resolved using JSGRectAlignmentForLayoutDirection first.
  *  @param coordinateSystemOrigin The origin of the used coordinate system
  *
  *  @discussion For a simpler version of this function, see JSGRectAlignInRect.
  *
  *  @see JSRectAlignment, JSGCoordinateSystemOrigin
  */
-CG_INLINE CGRect JSGRectAlignInRectForCoordinateSystemOrigin(CGRect rectA, CGRect rectB, JSGRectAlignment alignment, JSGCoordinateSystemOrigin coordinateSystemOrigin)
+JSG_INLINE CGRect JSGRectAlignInRectForCoordinateSystemOrigin(CGRect rectA, CGRect rectB, JSGRectAlignment alignment, JSGCoordinateSystemOrigin coordinateSystemOrigin)
 {
     if (alignment & JSGRectAlignmentTop) {
         switch (coordinateSystemOrigin) {
@@ -278,7 +323,7 @@ CG_INLINE CGRect JSGRectAlignInRectForCoordinateSystemOrigin(CGRect rectA, CGRec
  *  an origin other than the default/assumed one, please use the JSGRectAlignInRectForCoordinateSystemOrigin
  *  function instead, that lets you specify what coordinate system origin to use.
  */
-CG_INLINE CGRect JSGRectAlignInRect(CGRect rectA, CGRect rectB, JSGRectAlignment alignment)
+JSG_INLINE CGRect JSGRectAlignInRect(CGRect rectA, CGRect rectB, JSGRectAlignment alignment)
 {
 #if TARGET_OS_IPHONE
     return JSGRectAlignInRectForCoordinateSystemOrigin(rectA, rectB, alignment, JSGCoordinateSystemOriginTopLeft);
@@ -287,4 +332,34 @@ CG_INLINE CGRect JSGRectAlignInRect(CGRect rectA, CGRect rectB, JSGRectAlignment
 #endif
 }
 
+/**
+ *  Resolve the leading & trailing alignments of an alignment to left & right ones,
+ *  according to a layout direction
+ *
+ *  @param alignment The alignment to resolve, which may combine multiple alignments
+ *  @param layoutDirection The direction that content is laid out in. Leading is left
+ *  & trailing is right from left to right, and the other way around from right to left.
+ *
+ *  @return The alignment with its leading & trailing alignments replaced, and all of its
+ *  other alignments kept as they are
+ *
+ *  @see JSGRectAlignment, JSGLayoutDirection
+ */
+JSG_INLINE JSGRectAlignment JSGRectAlignmentForLayoutDirection(JSGRectAlignment alignment, JSGLayoutDirection layoutDirection)
+{
+    NSUInteger resolved = alignment & ~(NSUInteger)(JSGRectAlignmentLeading | JSGRectAlignmentTrailing);
+    NSUInteger leading = layoutDirection == JSGLayoutDirectionRightToLeft ? JSGRectAlignmentRight : JSGRectAlignmentLeft;
+    NSUInteger trailing = layoutDirection == JSGLayoutDirectionRightToLeft ? JSGRectAlignmentLeft : JSGRectAlignmentRight;
+    
+    if (alignment & JSGRectAlignmentLeading) {
+        resolved |= leading;
+    }
+    
+    if (alignment & JSGRectAlignmentTrailing) {
+        resolved |= trailing;
+    }
+    
+    return (JSGRectAlignment)resolved;
+}
+
 #endif
@@ -0,0 +1,153 @@
+#ifndef JSGeometryAtlas
+#define JSGeometryAtlas
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  The number of vertices written for each sprite
+ */
+#define JSG_SPRITE_VERTEX_COUNT 4
+
+/**
+ *  The number of indices written for each sprite, to draw it as two triangles
+ */
+#define JSG_SPRITE_INDEX_COUNT 6
+
+/**
+ *  The number of sprites whose edges are computed at once, before being written out
+ */
+#define JSG_SPRITE_BLOCK_SIZE 64
+
+/**
+ *  A vertex made of a position & texture coordinates only, for vertex buffers that don't
+ *  need any other attributes
+ *
+ *  @discussion Pass sizeof(JSGSpriteVertex), offsetof(JSGSpriteVertex, x) &
+ *  offsetof(JSGSpriteVertex, u) as the layout of the vertex buffer.
+ */
+typedef struct {
+    float x;
+    float y;
+    float u;
+    float v;
+} JSGSpriteVertex;
+
+#pragma mark - Atlas functions
+
+/**
+ *  Write the vertices of textured quads for a batch of sprites to an interleaved vertex
+ *  buffer
+ *
+ *  @param frames The frames to draw the sprites in, which give the vertex positions
+ *  @param atlasRects The rects of the sprites in their texture atlas, in texels, one for
+ *  each frame
+ *  @param textureSize The size of the texture atlas, in texels
+ *  @param texelInset The distance to move the edges of each atlas rect inwards, in texels,
+ *  before converting them to texture coordinates. Pass 0.5 to sample at the centers of the
+ *  edge texels, so that linear filtering never bleeds in neighbouring sprites, or 0.
+ *  @param flipV Whether texture coordinates should increase from the maximum y edge of the
+ *  atlas, such as for OpenGL textures loaded from images stored from top to bottom
+ *  @param vertices The vertex buffer to write to. Must have room for
+ *  JSG_SPRITE_VERTEX_COUNT vertices per frame.
+ *  @param stride The size of each vertex in the buffer, in bytes
+ *  @param positionOffset The offset of the position in each vertex, made of 2 floats
+ *  @param textureCoordinateOffset The offset of the texture coordinates in each vertex,
+ *  made of 2 floats
+ *
+ *  @discussion The vertices of frame i start at vertex i * JSG_SPRITE_VERTEX_COUNT, at its
+ *  corners in the order (minX, minY), (maxX, minY), (minX, maxY) & (maxX, maxY), which can
+ *  be drawn as a triangle strip, or with the indices written by JSGSpriteIndicesFill.
+ *  Other attributes of the vertices are left untouched.
+ *
+ *  The edges of the frames & texture coordinates of the atlas rects are computed for blocks
+ *  of JSG_SPRITE_BLOCK_SIZE sprites at once, multiplying by the inverse of the texture size
+ *  rather than dividing, then each attribute is written with a fixed size copy that
+ *  compiles to a plain store.
+ */
+JSG_INLINE void JSGRectArrayWriteSpriteVertices(const JSGRectArray *frames, const JSGRectArray *atlasRects, CGSize textureSize, CGFloat texelInset, bool flipV, void *vertices, size_t stride, size_t positionOffset, size_t textureCoordinateOffset)
+{
+    const CGFloat scaleU = 1 / textureSize.width;
+    const CGFloat scaleV = flipV ? -1 / textureSize.height : 1 / textureSize.height;
+    const CGFloat offsetV = flipV ? 1 : 0;
+    unsigned char *bytes = (unsigned char *)vertices;
+
+    for (size_t start = 0; start < frames->count; start += JSG_SPRITE_BLOCK_SIZE) {
+        size_t count = frames->count - start < JSG_SPRITE_BLOCK_SIZE ? frames->count - start : JSG_SPRITE_BLOCK_SIZE;
+        float edges[8][JSG_SPRITE_BLOCK_SIZE];
+        const CGFloat *xs = frames->x + start;
+        const CGFloat *ys = frames->y + start;
+        const CGFloat *widths = frames->width + start;
+        const CGFloat *heights = frames->height + start;
+        const CGFloat *atlasXs = atlasRects->x + start;
+        const CGFloat *atlasYs = atlasRects->y + start;
+        const CGFloat *atlasWidths = atlasRects->width + start;
+        const CGFloat *atlasHeights = atlasRects->height + start;
+
+        // The edges of a block of sprites are computed in a loop that the compiler can
+        // vectorize, then written out to the vertices
+        for (size_t i = 0; i < count; i++) {
+            edges[0][i] = (float)xs[i];
+            edges[1][i] = (float)ys[i];
+            edges[2][i] = (float)(xs[i] + widths[i]);
+            edges[3][i] = (float)(ys[i] + heights[i]);
+            edges[4][i] = (float)((atlasXs[i] + texelInset) * scaleU);
+            edges[5][i] = (float)((atlasYs[i] + texelInset) * scaleV + offsetV);
+            edges[6][i] = (float)((atlasXs[i] + atlasWidths[i] - texelInset) * scaleU);
+            edges[7][i] = (float)((atlasYs[i] + atlasHeights[i] - texelInset) * scaleV + offsetV);
+        }
+
+        unsigned char *vertex = bytes + start * JSG_SPRITE_VERTEX_COUNT * stride;
+
+        for (size_t i = 0; i < count; i++) {
+            for (size_t corner = 0; corner < JSG_SPRITE_VERTEX_COUNT; corner++, vertex += stride) {
+                float position[2];
+                float textureCoordinate[2];
+
+                position[0] = edges[corner & 1 ? 2 : 0][i];
+                position[1] = edges[corner & 2 ? 3 : 1][i];
+                textureCoordinate[0] = edges[corner & 1 ? 6 : 4][i];
+                textureCoordinate[1] = edges[corner & 2 ? 7 : 5][i];
+
+                memcpy(vertex + positionOffset, position, sizeof(position));
+                memcpy(vertex + textureCoordinateOffset, textureCoordinate, sizeof(textureCoordinate));
+            }
+        }
+    }
+}
+
+/**
+ *  Write the indices that draw a batch of sprites as pairs of triangles
+ *
+ *  @param indices The index buffer to write to. Must have room for JSG_SPRITE_INDEX_COUNT
+ *  indices per sprite.
+ *  @param firstSprite The index of the first sprite to write indices for, within the vertex
+ *  buffer
+ *  @param spriteCount The number of sprites to write indices for
+ *
+ *  @discussion Both triangles of each sprite have the same winding order, as laid out by
+ *  JSGRectArrayWriteSpriteVertices. Since indices only depend on the number of sprites,
+ *  an index buffer can be filled once for the largest batch & reused.
+ */
+JSG_INLINE void JSGSpriteIndicesFill(uint32_t *indices, size_t firstSprite, size_t spriteCount)
+{
+    for (size_t i = 0; i < spriteCount; i++) {
+        uint32_t vertex = (uint32_t)((firstSprite + i) * JSG_SPRITE_VERTEX_COUNT);
+
+        indices[i * JSG_SPRITE_INDEX_COUNT] = vertex;
+        indices[i * JSG_SPRITE_INDEX_COUNT + 1] = vertex + 1;
+        indices[i * JSG_SPRITE_INDEX_COUNT + 2] = vertex + 2;
+        indices[i * JSG_SPRITE_INDEX_COUNT + 3] = vertex + 2;
+        indices[i * JSG_SPRITE_INDEX_COUNT + 4] = vertex + 1;
+        indices[i * JSG_SPRITE_INDEX_COUNT + 5] = vertex + 3;
+    }
+}
+
+#endif
@@ -0,0 +1,703 @@
+#ifndef JSGeometryBVH
+#define JSGeometryBVH
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryParallel.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  Index used for items & nodes that don't exist
+ */
+#define JSG_BVH_NONE ((size_t)-1)
+
+/**
+ *  The maximum number of items in a leaf that the SAH may choose not to split
+ */
+#define JSG_BVH_MAX_LEAF_SIZE 8
+
+/**
+ *  The number of bins that centroids are sorted into to evaluate split planes
+ */
+#define JSG_BVH_BIN_COUNT 16
+
+/**
+ *  The depth below which nodes are split in half rather than by the SAH, which bounds the
+ *  depth of the tree (& therefore the traversal stack) for pathological inputs
+ */
+#define JSG_BVH_MAX_SAH_DEPTH 48
+#define JSG_BVH_STACK_SIZE (JSG_BVH_MAX_SAH_DEPTH + 8 * sizeof(size_t) + 2)
+
+/**
+ *  A node of a bounding volume hierarchy
+ *
+ *  @discussion Nodes are stored in depth-first order, so the first child of an inner node
+ *  is the node right after it. For inner nodes, count is 0 & offset is the index of the
+ *  second child. For leaves, count is the number of items, & offset is the index of the
+ *  first one in the leaf ordered arrays of the hierarchy.
+ */
+typedef struct {
+    CGFloat minX;
+    CGFloat minY;
+    CGFloat maxX;
+    CGFloat maxY;
+    size_t offset;
+    size_t count;
+} JSGBVHNode;
+
+/**
+ *  A function that is called for each item found by a bounding volume hierarchy query
+ *
+ *  @param context The context that was passed to the query
+ *  @param item The index of the item
+ *  @param rect The rect of the item
+ *
+ *  @return Whether the query should continue
+ */
+typedef bool (*JSGBVHVisitor)(void *context, size_t item, CGRect rect);
+
+/**
+ *  A static spatial index of rects, using a bounding volume hierarchy
+ *
+ *  @discussion The hierarchy is built once from all of its rects, which makes it best for
+ *  scenes that rarely change, such as a document after it's loaded. The rects of the items
+ *  are copied in leaf order (items holds the index of each one), so that the items of a
+ *  leaf are tested from contiguous memory.
+ *
+ *  A hierarchy should be initialized using JSGBVHInit, and destroyed using JSGBVHDestroy
+ *  once it's no longer needed. Queries don't change the hierarchy, so they may be performed
+ *  from multiple threads at once.
+ */
+typedef struct {
+    JSGBVHNode *nodes;
+    size_t nodeCount;
+    size_t *items;
+    CGFloat *minXs;
+    CGFloat *minYs;
+    CGFloat *maxXs;
+    CGFloat *maxYs;
+    size_t count;
+} JSGBVH;
+
+typedef struct {
+    JSGBVHNode *nodes;
+    size_t count;
+    size_t capacity;
+} JSGBVHNodeBuffer;
+
+typedef struct {
+    size_t start;
+    size_t end;
+    size_t depth;
+    JSGBVHNodeBuffer buffer;
+} JSGBVHTask;
+
+typedef struct {
+    const CGFloat *minXs;
+    const CGFloat *minYs;
+    const CGFloat *maxXs;
+    const CGFloat *maxYs;
+    size_t *indices;
+    size_t taskSize;
+    JSGBVHTask *tasks;
+    size_t taskCount;
+    size_t taskCapacity;
+    bool failed;
+} JSGBVHBuilder;
+
+#pragma mark - Private functions
+
+JSG_INLINE size_t JSGBVHNodeBufferAppend(JSGBVHNodeBuffer *buffer)
+{
+    if (buffer->count == buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 64;
+        JSGBVHNode *nodes = (JSGBVHNode *)realloc(buffer->nodes, capacity * sizeof(JSGBVHNode));
+
+        if (!nodes) {
+            return JSG_BVH_NONE;
+        }
+
+        buffer->nodes = nodes;
+        buffer->capacity = capacity;
+    }
+
+    return buffer->count++;
+}
+
+JSG_INLINE size_t JSGBVHGetBin(CGFloat centroid, CGFloat minCentroid, CGFloat scale)
+{
+    CGFloat bin = (centroid - minCentroid) * scale;
+
+    // Negated so that NaN centroids, of rects with a NaN coordinate, go to the first bin
+    return !(bin > 0) ? 0 : bin >= JSG_BVH_BIN_COUNT - 1 ? JSG_BVH_BIN_COUNT - 1 : (size_t)bin;
+}
+
+/**
+ *  Compute the bounds of a range of items, & partition it using the binned SAH
+ *
+ *  @return The index at which the range is split, or end if the range should be a leaf
+ *
+ *  @discussion Rects are 2D, so the surface area of the SAH is the perimeter of a box. Split
+ *  planes are evaluated between bins of centroids on both axes, & the cheapest split is
+ *  taken if it's cheaper than a leaf. Centroids are doubled, to save a division per item.
+ */
+JSG_INLINE size_t JSGBVHPartition(const JSGBVHBuilder *builder, size_t start, size_t end, size_t depth, JSGBVHNode *node)
+{
+    size_t *indices = builder->indices;
+    size_t count = end - start;
+    CGFloat minX = CGFLOAT_MAX;
+    CGFloat minY = CGFLOAT_MAX;
+    CGFloat maxX = -CGFLOAT_MAX;
+    CGFloat maxY = -CGFLOAT_MAX;
+    CGFloat centroidMin[2] = {CGFLOAT_MAX, CGFLOAT_MAX};
+    CGFloat centroidMax[2] = {-CGFLOAT_MAX, -CGFLOAT_MAX};
+
+    for (size_t i = start; i < end; i++) {
+        size_t index = indices[i];
+        CGFloat itemMinX = builder->minXs[index];
+        CGFloat itemMinY = builder->minYs[index];
+        CGFloat itemMaxX = builder->maxXs[index];
+        CGFloat itemMaxY = builder->maxYs[index];
+        CGFloat centroidX = itemMinX + itemMaxX;
+        CGFloat centroidY = itemMinY + itemMaxY;
+
+        minX = itemMinX < minX ? itemMinX : minX;
+        minY = itemMinY < minY ? itemMinY : minY;
+        maxX = itemMaxX > maxX ? itemMaxX : maxX;
+        maxY = itemMaxY > maxY ? itemMaxY : maxY;
+        centroidMin[0] = centroidX < centroidMin[0] ? centroidX : centroidMin[0];
+        centroidMin[1] = centroidY < centroidMin[1] ? centroidY : centroidMin[1];
+        centroidMax[0] = centroidX > centroidMax[0] ? centroidX : centroidMax[0];
+        centroidMax[1] = centroidY > centroidMax[1] ? centroidY : centroidMax[1];
+    }
+
+    node->minX = minX;
+    node->minY = minY;
+    node->maxX = maxX;
+    node->maxY = maxY;
+
+    if (count <= 1) {
+        return end;
+    }
+
+    if (depth >= JSG_BVH_MAX_SAH_DEPTH) {
+        return start + count / 2;
+    }
+
+    CGFloat bestCost = CGFLOAT_MAX;
+    size_t bestAxis = 0;
+    size_t bestPlane = 0;
+
+    for (size_t axis = 0; axis < 2; axis++) {
+        CGFloat extent = centroidMax[axis] - centroidMin[axis];
+
+        if (!(extent > 0)) {
+            continue;
+        }
+
+        const CGFloat *mins = axis ? builder->minYs : builder->minXs;
+        const CGFloat *maxs = axis ? builder->maxYs : builder->maxXs;
+        CGFloat scale = JSG_BVH_BIN_COUNT / extent;
+        CGFloat bins[JSG_BVH_BIN_COUNT][4];
+        size_t binCounts[JSG_BVH_BIN_COUNT];
+        CGFloat rightCosts[JSG_BVH_BIN_COUNT];
+
+        for (size_t bin = 0; bin < JSG_BVH_BIN_COUNT; bin++) {
+            bins[bin][0] = CGFLOAT_MAX;
+            bins[bin][1] = CGFLOAT_MAX;
+            bins[bin][2] = -CGFLOAT_MAX;
+            bins[bin][3] = -CGFLOAT_MAX;
+            binCounts[bin] = 0;
+        }
+
+        for (size_t i = start; i < end; i++) {
+            size_t index = indices[i];
+            size_t bin = JSGBVHGetBin(mins[index] + maxs[index], centroidMin[axis], scale);
+            CGFloat *box = bins[bin];
+
+            box[0] = builder->minXs[index] < box[0] ? builder->minXs[index] : box[0];
+            box[1] = builder->minYs[index] < box[1] ? builder->minYs[index] : box[1];
+            box[2] = builder->maxXs[index] > box[2] ? builder->maxXs[index] : box[2];
+            box[3] = builder->maxYs[index] > box[3] ? builder->maxYs[index] : box[3];
+            binCounts[bin]++;
+        }
+
+        // Sweep from the right to get the cost of the items right of each plane, then from
+        // the left to get the total cost
+        CGFloat box[4] = {CGFLOAT_MAX, CGFLOAT_MAX, -CGFLOAT_MAX, -CGFLOAT_MAX};
+        size_t sideCount = 0;
+
+        for (size_t bin = JSG_BVH_BIN_COUNT - 1; bin > 0; bin--) {
+            box[0] = bins[bin][0] < box[0] ? bins[bin][0] : box[0];
+            box[1] = bins[bin][1] < box[1] ? bins[bin][1] : box[1];
+            box[2] = bins[bin][2] > box[2] ? bins[bin][2] : box[2];
+            box[3] = bins[bin][3] > box[3] ? bins[bin][3] : box[3];
+            sideCount += binCounts[bin];
+            rightCosts[bin] = sideCount ? (box[2] - box[0] + box[3] - box[1]) * sideCount : 0;
+        }
+
+        box[0] = CGFLOAT_MAX;
+        box[1] = CGFLOAT_MAX;
+        box[2] = -CGFLOAT_MAX;
+        box[3] = -CGFLOAT_MAX;
+        sideCount = 0;
+
+        for (size_t plane = 1; plane < JSG_BVH_BIN_COUNT; plane++) {
+            box[0] = bins[plane - 1][0] < box[0] ? bins[plane - 1][0] : box[0];
+            box[1] = bins[plane - 1][1] < box[1] ? bins[plane - 1][1] : box[1];
+            box[2] = bins[plane - 1][2] > box[2] ? bins[plane - 1][2] : box[2];
+            box[3] = bins[plane - 1][3] > box[3] ? bins[plane - 1][3] : box[3];
+            sideCount += binCounts[plane - 1];
+
+            if (sideCount == 0 || sideCount == count) {
+                continue;
+            }
+
+            CGFloat cost = (box[2] - box[0] + box[3] - box[1]) * sideCount + rightCosts[plane];
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestPlane = plane;
+            }
+        }
+    }
+
+    // All centroids are equal, so there's no plane to split them with
+    if (bestPlane == 0) {
+        return count <= JSG_BVH_MAX_LEAF_SIZE ? end : start + count / 2;
+    }
+
+    // A split costs a traversal step (counted as one test) plus the tests of its children,
+    // relative to the probability of hitting the node
+    CGFloat perimeter = maxX - minX + maxY - minY;
+
+    if (count <= JSG_BVH_MAX_LEAF_SIZE && perimeter + bestCost >= count * perimeter) {
+        return end;
+    }
+
+    const CGFloat *mins = bestAxis ? builder->minYs : builder->minXs;
+    const CGFloat *maxs = bestAxis ? builder->maxYs : builder->maxXs;
+    CGFloat scale = JSG_BVH_BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+    size_t left = start;
+    size_t right = end;
+
+    while (left < right) {
+        size_t index = indices[left];
+
+        if (JSGBVHGetBin(mins[index] + maxs[index], centroidMin[bestAxis], scale) < bestPlane) {
+            left++;
+        } else {
+            indices[left] = indices[--right];
+            indices[right] = index;
+        }
+    }
+
+    return left;
+}
+
+/**
+ *  Build the subtree of a range of items in depth-first order. When tasks are enabled,
+ *  ranges of at most taskSize items are left as placeholder nodes, to be built in parallel.
+ */
+JSG_INLINE bool JSGBVHBuildNode(JSGBVHBuilder *builder, JSGBVHNodeBuffer *buffer, size_t start, size_t end, size_t depth, bool tasks)
+{
+    size_t node = JSGBVHNodeBufferAppend(buffer);
+
+    if (node == JSG_BVH_NONE) {
+        return false;
+    }
+
+    if (tasks && end - start <= builder->taskSize) {
+        if (builder->taskCount == builder->taskCapacity) {
+            size_t capacity = builder->taskCapacity ? builder->taskCapacity * 2 : 16;
+            JSGBVHTask *newTasks = (JSGBVHTask *)realloc(builder->tasks, capacity * sizeof(JSGBVHTask));
+
+            if (!newTasks) {
+                return false;
+            }
+
+            builder->tasks = newTasks;
+            builder->taskCapacity = capacity;
+        }
+
+        JSGBVHTask *task = &builder->tasks[builder->taskCount];
+        memset(task, 0, sizeof(JSGBVHTask));
+        task->start = start;
+        task->end = end;
+        task->depth = depth;
+        buffer->nodes[node].offset = builder->taskCount++;
+        buffer->nodes[node].count = JSG_BVH_NONE;
+
+        return true;
+    }
+
+    JSGBVHNode bounds;
+    size_t middle = JSGBVHPartition(builder, start, end, depth, &bounds);
+
+    if (middle == end) {
+        bounds.offset = start;
+        bounds.count = end - start;
+        buffer->nodes[node] = bounds;
+
+        return true;
+    }
+
+    if (!JSGBVHBuildNode(builder, buffer, start, middle, depth + 1, tasks)) {
+        return false;
+    }
+
+    bounds.offset = buffer->count;
+    bounds.count = 0;
+    buffer->nodes[node] = bounds;
+
+    return JSGBVHBuildNode(builder, buffer, middle, end, depth + 1, tasks);
+}
+
+JSG_INLINE void JSGBVHBuildTask(void *context, size_t taskIndex)
+{
+    JSGBVHBuilder *builder = (JSGBVHBuilder *)context;
+    JSGBVHTask *task = &builder->tasks[taskIndex];
+
+    // A binary tree with at least one item per leaf has fewer than twice as many nodes
+    task->buffer.capacity = (task->end - task->start) * 2;
+    task->buffer.nodes = (JSGBVHNode *)malloc(task->buffer.capacity * sizeof(JSGBVHNode));
+
+    if (!task->buffer.nodes || !JSGBVHBuildNode(builder, &task->buffer, task->start, task->end, task->depth, false)) {
+        __atomic_store_n(&builder->failed, true, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ *  Copy the top of the tree to the final node array, replacing placeholders with the
+ *  subtrees built by their tasks
+ *
+ *  @return The index of the top node following the copied subtree
+ */
+JSG_INLINE size_t JSGBVHFlatten(const JSGBVHBuilder *builder, const JSGBVHNodeBuffer *top, size_t node, JSGBVH *bvh)
+{
+    JSGBVHNode copy = top->nodes[node];
+
+    if (copy.count == JSG_BVH_NONE) {
+        const JSGBVHNodeBuffer *buffer = &builder->tasks[copy.offset].buffer;
+        size_t base = bvh->nodeCount;
+
+        for (size_t i = 0; i < buffer->count; i++) {
+            JSGBVHNode taskNode = buffer->nodes[i];
+            taskNode.offset += taskNode.count ? 0 : base;
+            bvh->nodes[base + i] = taskNode;
+        }
+
+        bvh->nodeCount += buffer->count;
+
+        return node + 1;
+    }
+
+    size_t index = bvh->nodeCount++;
+    bvh->nodes[index] = copy;
+
+    if (copy.count) {
+        return node + 1;
+    }
+
+    size_t next = JSGBVHFlatten(builder, top, node + 1, bvh);
+    bvh->nodes[index].offset = bvh->nodeCount;
+
+    return JSGBVHFlatten(builder, top, next, bvh);
+}
+
+typedef struct {
+    size_t *items;
+    size_t capacity;
+    size_t count;
+} JSGBVHQueryContext;
+
+JSG_INLINE bool JSGBVHQueryVisitor(void *context, size_t item, CGRect rect)
+{
+    JSGBVHQueryContext *query = (JSGBVHQueryContext *)context;
+    (void)rect;
+
+    if (query->count < query->capacity) {
+        query->items[query->count] = item;
+    }
+
+    query->count++;
+
+    return true;
+}
+
+#pragma mark - Bounding volume hierarchy functions
+
+/**
+ *  Initialize a bounding volume hierarchy over a set of rects
+ *
+ *  @param bvh The hierarchy to initialize
+ *  @param rects The rects to index. Items are numbered after their index in this array.
+ *  Rects with a NaN coordinate may be indexed, but are never found by queries or hit tests.
+ *  @param threadCount The maximum number of threads to build with, including the calling
+ *  thread. Pass 0 to use JSGParallelGetDefaultThreadCount.
+ *
+ *  @return Whether the hierarchy could be initialized. This is only false if memory could
+ *  not be allocated, in which case the hierarchy doesn't need to be destroyed.
+ *
+ *  @discussion Nodes are split using a binned surface area heuristic (SAH), which minimizes
+ *  the expected cost of a query. The top of the tree is built on the calling thread, until
+ *  subtrees are small enough to be spread over threads, which build them independently.
+ *  Subtrees are then copied after their parents in depth-first order, so the hierarchy is
+ *  the same whatever the number of threads.
+ */
+JSG_INLINE bool JSGBVHInit(JSGBVH *bvh, const JSGRectArray *rects, size_t threadCount)
+{
+    size_t count = rects->count;
+    memset(bvh, 0, sizeof(JSGBVH));
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (threadCount == 0) {
+        threadCount = JSGParallelGetDefaultThreadCount();
+    }
+
+    JSGBVHBuilder builder;
+    JSGBVHNodeBuffer top = {NULL, 0, 0};
+    CGFloat *bounds = (CGFloat *)malloc(count * 8 * sizeof(CGFloat));
+    bool built = false;
+
+    memset(&builder, 0, sizeof(JSGBVHBuilder));
+    bvh->items = (size_t *)malloc(count * sizeof(size_t));
+    bvh->nodes = (JSGBVHNode *)malloc(count * 2 * sizeof(JSGBVHNode));
+
+    if (bounds && bvh->items && bvh->nodes) {
+        CGFloat *minXs = bounds + count * 4;
+        CGFloat *minYs = bounds + count * 5;
+        CGFloat *maxXs = bounds + count * 6;
+        CGFloat *maxYs = bounds + count * 7;
+
+        for (size_t i = 0; i < count; i++) {
+            minXs[i] = rects->x[i];
+            minYs[i] = rects->y[i];
+            maxXs[i] = rects->x[i] + rects->width[i];
+            maxYs[i] = rects->y[i] + rects->height[i];
+            bvh->items[i] = i;
+        }
+
+        // Several tasks per thread keep threads busy when subtrees are unbalanced
+        builder.minXs = minXs;
+        builder.minYs = minYs;
+        builder.maxXs = maxXs;
+        builder.maxYs = maxYs;
+        builder.indices = bvh->items;
+        builder.taskSize = count / (threadCount * 4) + 1;
+        builder.taskSize = builder.taskSize > 1024 ? builder.taskSize : 1024;
+
+        if (JSGBVHBuildNode(&builder, &top, 0, count, 0, true)) {
+            JSGParallelFor(builder.taskCount, threadCount, JSGBVHBuildTask, &builder);
+            built = !builder.failed;
+        }
+    }
+
+    if (built) {
+        JSGBVHFlatten(&builder, &top, 0, bvh);
+
+        bvh->minXs = bounds;
+        bvh->minYs = bounds + count;
+        bvh->maxXs = bounds + count * 2;
+        bvh->maxYs = bounds + count * 3;
+        bvh->count = count;
+
+        for (size_t i = 0; i < count; i++) {
+            size_t index = bvh->items[i];
+            bvh->minXs[i] = builder.minXs[index];
+            bvh->minYs[i] = builder.minYs[index];
+            bvh->maxXs[i] = builder.maxXs[index];
+            bvh->maxYs[i] = builder.maxYs[index];
+        }
+
+        // The build buffer is no longer needed once the rects are in leaf order
+        CGFloat *shrunk = (CGFloat *)realloc(bounds, count * 4 * sizeof(CGFloat));
+        JSGBVHNode *nodes = (JSGBVHNode *)realloc(bvh->nodes, bvh->nodeCount * sizeof(JSGBVHNode));
+
+        if (shrunk) {
+            bvh->minXs = shrunk;
+            bvh->minYs = shrunk + count;
+            bvh->maxXs = shrunk + count * 2;
+            bvh->maxYs = shrunk + count * 3;
+        }
+
+        bvh->nodes = nodes ? nodes : bvh->nodes;
+    }
+
+    for (size_t i = 0; i < builder.taskCount; i++) {
+        free(builder.tasks[i].buffer.nodes);
+    }
+
+    free(builder.tasks);
+    free(top.nodes);
+
+    if (!built) {
+        free(bounds);
+        free(bvh->items);
+        free(bvh->nodes);
+        memset(bvh, 0, sizeof(JSGBVH));
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Destroy a bounding volume hierarchy, freeing all of its memory
+ *
+ *  @param bvh The hierarchy to destroy
+ */
+JSG_INLINE void JSGBVHDestroy(JSGBVH *bvh)
+{
+    free(bvh->nodes);
+    free(bvh->items);
+    free(bvh->minXs);
+    memset(bvh, 0, sizeof(JSGBVH));
+}
+
+/**
+ *  Visit the items of a bounding volume hierarchy that intersect a rect
+ *
+ *  @param bvh The hierarchy to query
+ *  @param rect The rect to find intersecting items for
+ *  @param visitor The function to call for each item, which may stop the query by
+ *  returning false
+ *  @param context A pointer that is passed to the visitor
+ *
+ *  @discussion Items are intersecting when their interiors overlap, so items that only
+ *  touch the rect's edges are not visited. Nodes are visited depth-first using a fixed
+ *  size stack, so queries don't allocate. The order in which items are visited is
+ *  undefined.
+ */
+JSG_INLINE void JSGBVHVisit(const JSGBVH *bvh, CGRect rect, JSGBVHVisitor visitor, void *context)
+{
+    if (bvh->nodeCount == 0) {
+        return;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    size_t stack[JSG_BVH_STACK_SIZE];
+    size_t stackCount = 0;
+
+    stack[stackCount++] = 0;
+
+    while (stackCount) {
+        size_t index = stack[--stackCount];
+        const JSGBVHNode *node = &bvh->nodes[index];
+
+        if (node->minX >= maxX || node->minY >= maxY || node->maxX <= minX || node->maxY <= minY) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            stack[stackCount++] = node->offset;
+            stack[stackCount++] = index + 1;
+            continue;
+        }
+
+        for (size_t i = node->offset; i < node->offset + node->count; i++) {
+            // Negated so that rects with a NaN coordinate are never visited
+            if (!(bvh->minXs[i] < maxX && bvh->minYs[i] < maxY && bvh->maxXs[i] > minX && bvh->maxYs[i] > minY)) {
+                continue;
+            }
+
+            CGRect itemRect;
+            itemRect.origin.x = bvh->minXs[i];
+            itemRect.origin.y = bvh->minYs[i];
+            itemRect.size.width = bvh->maxXs[i] - bvh->minXs[i];
+            itemRect.size.height = bvh->maxYs[i] - bvh->minYs[i];
+
+            if (!visitor(context, bvh->items[i], itemRect)) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ *  Find the items of a bounding volume hierarchy that intersect a rect
+ *
+ *  @param bvh The hierarchy to query
+ *  @param rect The rect to find intersecting items for, such as the visible area
+ *  @param items The array to write the indices of the items to, or NULL
+ *  @param capacity The number of indices that the items array has room for
+ *
+ *  @return The number of intersecting items. If this is larger than capacity, only the
+ *  first capacity items were written.
+ *
+ *  @see JSGBVHVisit
+ */
+JSG_INLINE size_t JSGBVHQuery(const JSGBVH *bvh, CGRect rect, size_t *items, size_t capacity)
+{
+    JSGBVHQueryContext context = {items, items ? capacity : 0, 0};
+    JSGBVHVisit(bvh, rect, JSGBVHQueryVisitor, &context);
+
+    return context.count;
+}
+
+/**
+ *  Return the topmost item of a bounding volume hierarchy that contains a point
+ *
+ *  @param bvh The hierarchy to hit test
+ *  @param point The point to hit test
+ *
+ *  @return The index of the last item containing the point, as later items are drawn on
+ *  top of earlier ones, or JSG_BVH_NONE if no item contains the point
+ *
+ *  @discussion As with CGRectContainsPoint, rects contain points on their minimum edges,
+ *  but not on their maximum edges.
+ */
+JSG_INLINE size_t JSGBVHHitTest(const JSGBVH *bvh, CGPoint point)
+{
+    if (bvh->nodeCount == 0) {
+        return JSG_BVH_NONE;
+    }
+
+    size_t stack[JSG_BVH_STACK_SIZE];
+    size_t stackCount = 0;
+    size_t hit = JSG_BVH_NONE;
+
+    stack[stackCount++] = 0;
+
+    while (stackCount) {
+        size_t index = stack[--stackCount];
+        const JSGBVHNode *node = &bvh->nodes[index];
+
+        if (point.x < node->minX || point.y < node->minY || point.x >= node->maxX || point.y >= node->maxY) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            stack[stackCount++] = node->offset;
+            stack[stackCount++] = index + 1;
+            continue;
+        }
+
+        for (size_t i = node->offset; i < node->offset + node->count; i++) {
+            bool contains = (point.x >= bvh->minXs[i]) & (point.y >= bvh->minYs[i]) & (point.x < bvh->maxXs[i]) & (point.y < bvh->maxYs[i]);
+            size_t item = bvh->items[i];
+
+            hit = contains && (hit == JSG_BVH_NONE || item > hit) ? item : hit;
+        }
+    }
+
+    return hit;
+}
+
+#endif
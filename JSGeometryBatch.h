@@ -0,0 +1,240 @@
+#ifndef JSGeometryBatch
+#define JSGeometryBatch
+
+#include <stddef.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - CGRect batch functions
+
+/**
+ *  Change the origin of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newOrigins The new origins, one for each rect
+ *  @param count The number of rects & new origins
+ */
+JSG_INLINE void JSGRectsChangeOrigin(CGRect *rects, const CGPoint *newOrigins, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeOrigin(rects[i], newOrigins[i]);
+    }
+}
+
+/**
+ *  Change the x component of the origin of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newOriginXs The new x components, one for each rect
+ *  @param count The number of rects & new x components
+ */
+JSG_INLINE void JSGRectsChangeOriginX(CGRect *rects, const CGFloat *newOriginXs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeOriginX(rects[i], newOriginXs[i]);
+    }
+}
+
+/**
+ *  Change the y component of the origin of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newOriginYs The new y components, one for each rect
+ *  @param count The number of rects & new y components
+ */
+JSG_INLINE void JSGRectsChangeOriginY(CGRect *rects, const CGFloat *newOriginYs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeOriginY(rects[i], newOriginYs[i]);
+    }
+}
+
+/**
+ *  Change the size of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newSizes The new sizes, one for each rect
+ *  @param count The number of rects & new sizes
+ */
+JSG_INLINE void JSGRectsChangeSize(CGRect *rects, const CGSize *newSizes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeSize(rects[i], newSizes[i]);
+    }
+}
+
+/**
+ *  Change the width of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newWidths The new widths, one for each rect
+ *  @param count The number of rects & new widths
+ */
+JSG_INLINE void JSGRectsChangeWidth(CGRect *rects, const CGFloat *newWidths, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeWidth(rects[i], newWidths[i]);
+    }
+}
+
+/**
+ *  Change the height of each rect in an array
+ *
+ *  @param rects The rects to change
+ *  @param newHeights The new heights, one for each rect
+ *  @param count The number of rects & new heights
+ */
+JSG_INLINE void JSGRectsChangeHeight(CGRect *rects, const CGFloat *newHeights, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectChangeHeight(rects[i], newHeights[i]);
+    }
+}
+
+/**
+ *  Scale the size of each rect in an array
+ *
+ *  @param rects The rects to scale
+ *  @param count The number of rects
+ *  @param scaleX The horizontal scale to apply
+ *  @param scaleY The vertical scale to apply
+ *
+ *  @see JSGRectScale
+ */
+JSG_INLINE void JSGRectsScale(CGRect *rects, size_t count, CGFloat scaleX, CGFloat scaleY)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectScale(rects[i], scaleX, scaleY);
+    }
+}
+
+/**
+ *  Center each rect in an array within another rect
+ *
+ *  @param rects The rects to center
+ *  @param count The number of rects
+ *  @param rectB The rect in which the rects will be centered
+ *
+ *  @see JSGRectGetCenterInRect
+ */
+JSG_INLINE void JSGRectsGetCenterInRect(CGRect *rects, size_t count, CGRect rectB)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectGetCenterInRect(rects[i], rectB);
+    }
+}
+
+/**
+ *  Align each rect in an array within another rect, according to a coordinate system origin
+ *
+ *  @param rects The rects to align
+ *  @param count The number of rects
+ *  @param rectB The rect in which the rects will be aligned
+ *  @param alignment The alignment that should be applied to the rects
+ *  @param coordinateSystemOrigin The origin of the used coordinate system
+ *
+ *  @see JSGRectAlignInRectForCoordinateSystemOrigin
+ */
+JSG_INLINE void JSGRectsAlignInRectForCoordinateSystemOrigin(CGRect *rects, size_t count, CGRect rectB, JSGRectAlignment alignment, JSGCoordinateSystemOrigin coordinateSystemOrigin)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = JSGRectAlignInRectForCoordinateSystemOrigin(rects[i], rectB, alignment, coordinateSystemOrigin);
+    }
+}
+
+#pragma mark - Indexed CGRect batch functions
+
+/**
+ *  Change the origin of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newOrigins The new origins, one for each index
+ *  @param count The number of indices & new origins
+ *
+ *  @discussion Each rect is changed just like JSGRectChangeOrigin would. If an index
+ *  appears more than once, the last new origin supplied for it is the one that's kept.
+ */
+JSG_INLINE void JSGRectsChangeOriginAtIndices(CGRect *rects, const size_t *indices, const CGPoint *newOrigins, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeOrigin(rects[indices[i]], newOrigins[i]);
+    }
+}
+
+/**
+ *  Change the x component of the origin of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newOriginXs The new x components, one for each index
+ *  @param count The number of indices & new x components
+ */
+JSG_INLINE void JSGRectsChangeOriginXAtIndices(CGRect *rects, const size_t *indices, const CGFloat *newOriginXs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeOriginX(rects[indices[i]], newOriginXs[i]);
+    }
+}
+
+/**
+ *  Change the y component of the origin of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newOriginYs The new y components, one for each index
+ *  @param count The number of indices & new y components
+ */
+JSG_INLINE void JSGRectsChangeOriginYAtIndices(CGRect *rects, const size_t *indices, const CGFloat *newOriginYs, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeOriginY(rects[indices[i]], newOriginYs[i]);
+    }
+}
+
+/**
+ *  Change the size of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newSizes The new sizes, one for each index
+ *  @param count The number of indices & new sizes
+ */
+JSG_INLINE void JSGRectsChangeSizeAtIndices(CGRect *rects, const size_t *indices, const CGSize *newSizes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeSize(rects[indices[i]], newSizes[i]);
+    }
+}
+
+/**
+ *  Change the width of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newWidths The new widths, one for each index
+ *  @param count The number of indices & new widths
+ */
+JSG_INLINE void JSGRectsChangeWidthAtIndices(CGRect *rects, const size_t *indices, const CGFloat *newWidths, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeWidth(rects[indices[i]], newWidths[i]);
+    }
+}
+
+/**
+ *  Change the height of a number of rects in an array
+ *
+ *  @param rects The array containing the rects to change
+ *  @param indices The indices of the rects to change
+ *  @param newHeights The new heights, one for each index
+ *  @param count The number of indices & new heights
+ */
+JSG_INLINE void JSGRectsChangeHeightAtIndices(CGRect *rects, const size_t *indices, const CGFloat *newHeights, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        rects[indices[i]] = JSGRectChangeHeight(rects[indices[i]], newHeights[i]);
+    }
+}
+
+#endif
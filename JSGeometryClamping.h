@@ -0,0 +1,112 @@
+#ifndef JSGeometryClamping
+#define JSGeometryClamping
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryInsets.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  Enum describing how rects are kept within bounds
+ *
+ *  @discussion Both modes move rects by the smallest distance that brings them within the
+ *  bounds. Rects larger than the bounds keep their size when shifting, aligned with the
+ *  left & minimum y edges of the bounds, and are shrunk to the size of the bounds when
+ *  shrinking, so that shrunk rects always end up entirely within the bounds.
+ */
+typedef enum : NSUInteger {
+    JSGRectClampModeShift,
+    JSGRectClampModeShrink
+} JSGRectClampMode;
+
+#pragma mark - Private functions
+
+/**
+ *  Clamp a range of rects along one axis, between a minimum & maximum edge
+ */
+JSG_INLINE void JSGRectArrayClampAxis(CGFloat *origins, CGFloat *sizes, size_t count, CGFloat minimum, CGFloat maximum, JSGRectClampMode mode)
+{
+    // Margins larger than the bounds leave a zero size range at their midpoint
+    if (maximum < minimum) {
+        minimum = maximum = (minimum + maximum) * 0.5;
+    }
+
+    CGFloat available = maximum - minimum;
+
+    if (mode == JSGRectClampModeShrink) {
+        for (size_t i = 0; i < count; i++) {
+            CGFloat size = sizes[i] < available ? sizes[i] : available;
+            CGFloat origin = origins[i] < maximum - size ? origins[i] : maximum - size;
+
+            origins[i] = origin > minimum ? origin : minimum;
+            sizes[i] = size;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            CGFloat origin = origins[i] < maximum - sizes[i] ? origins[i] : maximum - sizes[i];
+
+            origins[i] = origin > minimum ? origin : minimum;
+        }
+    }
+}
+
+#pragma mark - Clamping functions
+
+/**
+ *  Keep a rect within a bounding rect, such as a dragged or popped up frame on screen
+ *
+ *  @param rect The rect to clamp
+ *  @param bounds The rect to keep the rect within
+ *  @param margins The distances to keep between the rect & each edge of the bounds. Pass
+ *  zero insets to let the rect touch the bounds' edges.
+ *  @param coordinateSystemOrigin The origin of the used coordinate system, which decides
+ *  whether the top margin applies to the minimum or maximum y edge
+ *  @param mode Whether rects larger than the bounds should keep their size or shrink
+ *
+ *  @return The clamped rect, in its standardized form
+ *
+ *  @see JSGRectClampMode
+ */
+JSG_INLINE CGRect JSGRectClampToRect(CGRect rect, CGRect bounds, JSGEdgeInsets margins, JSGCoordinateSystemOrigin coordinateSystemOrigin, JSGRectClampMode mode)
+{
+    bool topIsMinimum = coordinateSystemOrigin == JSGCoordinateSystemOriginTopLeft;
+    rect = CGRectStandardize(rect);
+    bounds = CGRectStandardize(bounds);
+
+    JSGRectArrayClampAxis(&rect.origin.x, &rect.size.width, 1, bounds.origin.x + margins.left, bounds.origin.x + bounds.size.width - margins.right, mode);
+    JSGRectArrayClampAxis(&rect.origin.y, &rect.size.height, 1, bounds.origin.y + (topIsMinimum ? margins.top : margins.bottom), bounds.origin.y + bounds.size.height - (topIsMinimum ? margins.bottom : margins.top), mode);
+
+    return rect;
+}
+
+/**
+ *  Keep each rect in a rect array within a bounding rect
+ *
+ *  @param array The rects to clamp
+ *  @param bounds The rect to keep the rects within
+ *  @param margins The distances to keep between the rects & each edge of the bounds. Pass
+ *  zero insets to let the rects touch the bounds' edges.
+ *  @param coordinateSystemOrigin The origin of the used coordinate system, which decides
+ *  whether the top margin applies to the minimum or maximum y edge
+ *  @param mode Whether rects larger than the bounds should keep their size or shrink
+ *
+ *  @discussion Each rect is clamped just like JSGRectClampToRect would. Each axis is
+ *  clamped in a separate branch-free loop, made only of minimums & maximums, that the
+ *  compiler can vectorize.
+ *
+ *  @see JSGRectClampMode
+ */
+JSG_INLINE void JSGRectArrayClampToRect(JSGRectArray *array, CGRect bounds, JSGEdgeInsets margins, JSGCoordinateSystemOrigin coordinateSystemOrigin, JSGRectClampMode mode)
+{
+    bool topIsMinimum = coordinateSystemOrigin == JSGCoordinateSystemOriginTopLeft;
+    bounds = CGRectStandardize(bounds);
+
+    JSGRectArrayClampAxis(array->x, array->width, array->count, bounds.origin.x + margins.left, bounds.origin.x + bounds.size.width - margins.right, mode);
+    JSGRectArrayClampAxis(array->y, array->height, array->count, bounds.origin.y + (topIsMinimum ? margins.top : margins.bottom), bounds.origin.y + bounds.size.height - (topIsMinimum ? margins.bottom : margins.top), mode);
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef JSGeometryClipping
+#define JSGeometryClipping
+
+#include <stddef.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Private constants
+
+/**
+ *  For each bitmask of the non-empty results of a group of four rects, the lanes to write
+ *  out, with the kept lanes first
+ */
+JSG_CONSTANT unsigned char JSGRectsClipCompressTable[16][4] = {
+    {0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0},
+    {2, 0, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 0}, {0, 1, 2, 0},
+    {3, 0, 0, 0}, {0, 3, 0, 0}, {1, 3, 0, 0}, {0, 1, 3, 0},
+    {2, 3, 0, 0}, {0, 2, 3, 0}, {1, 2, 3, 0}, {0, 1, 2, 3}
+};
+
+#pragma mark - Clipping functions
+
+/**
+ *  Clip an array of rects to a rect, keeping only the non-empty results
+ *
+ *  @param rects The rects to clip. They are expected to be standardized (with a
+ *  non-negative width & height), which frames always are.
+ *  @param count The number of rects
+ *  @param clipRect The rect to clip to
+ *  @param clippedRects The array to write the non-empty clipped rects to, in their original
+ *  order. Must have room for count rects. May be the same array as rects, to clip in place.
+ *  @param sourceIndices An array to write the index of each clipped rect's source rect to,
+ *  or NULL. Must have room for count indices.
+ *
+ *  @return The number of clipped rects that were written
+ *
+ *  @discussion Each clipped rect is the intersection of a rect & the clip rect, just like
+ *  CGRectIntersection would return. Rects that don't intersect the clip rect, or only touch
+ *  its edges, are dropped.
+ *
+ *  Rects are processed four at a time. For each group of four, a bitmask of the
+ *  non-empty results is used to look up which of them to keep in a compress table, and the
+ *  group is written out without any branches.
+ */
+JSG_INLINE size_t JSGRectsClipToRect(const CGRect *rects, size_t count, CGRect clipRect, CGRect *clippedRects, size_t *sourceIndices)
+{
+    clipRect = CGRectStandardize(clipRect);
+
+    if (CGRectIsNull(clipRect)) {
+        return 0;
+    }
+
+    CGFloat clipMinX = clipRect.origin.x;
+    CGFloat clipMinY = clipRect.origin.y;
+    CGFloat clipMaxX = clipMinX + clipRect.size.width;
+    CGFloat clipMaxY = clipMinY + clipRect.size.height;
+    size_t clippedCount = 0;
+    size_t groupedCount = count - count % 4;
+
+    for (size_t i = 0; i < groupedCount; i += 4) {
+        CGRect results[4];
+        unsigned int mask = 0;
+
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            CGRect rect = rects[i + lane];
+            CGFloat minX = rect.origin.x > clipMinX ? rect.origin.x : clipMinX;
+            CGFloat minY = rect.origin.y > clipMinY ? rect.origin.y : clipMinY;
+            CGFloat maxX = rect.origin.x + rect.size.width < clipMaxX ? rect.origin.x + rect.size.width : clipMaxX;
+            CGFloat maxY = rect.origin.y + rect.size.height < clipMaxY ? rect.origin.y + rect.size.height : clipMaxY;
+
+            results[lane].origin.x = minX;
+            results[lane].origin.y = minY;
+            results[lane].size.width = maxX - minX;
+            results[lane].size.height = maxY - minY;
+            mask |= (unsigned int)(maxX > minX && maxY > minY) << lane;
+        }
+
+        // Since clippedCount <= i, writing all four lanes never goes past the current
+        // group, which keeps this safe for in-place clipping, and for an output array
+        // that has room for exactly count rects.
+        const unsigned char *lanes = JSGRectsClipCompressTable[mask];
+
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            clippedRects[clippedCount + lane] = results[lanes[lane]];
+        }
+
+        if (sourceIndices) {
+            for (unsigned int lane = 0; lane < 4; lane++) {
+                sourceIndices[clippedCount + lane] = i + lanes[lane];
+            }
+        }
+
+        clippedCount += (mask & 1) + (mask >> 1 & 1) + (mask >> 2 & 1) + (mask >> 3);
+    }
+
+    for (size_t i = groupedCount; i < count; i++) {
+        CGRect rect = rects[i];
+        CGFloat minX = rect.origin.x > clipMinX ? rect.origin.x : clipMinX;
+        CGFloat minY = rect.origin.y > clipMinY ? rect.origin.y : clipMinY;
+        CGFloat maxX = rect.origin.x + rect.size.width < clipMaxX ? rect.origin.x + rect.size.width : clipMaxX;
+        CGFloat maxY = rect.origin.y + rect.size.height < clipMaxY ? rect.origin.y + rect.size.height : clipMaxY;
+
+        if (maxX > minX && maxY > minY) {
+            clippedRects[clippedCount].origin.x = minX;
+            clippedRects[clippedCount].origin.y = minY;
+            clippedRects[clippedCount].size.width = maxX - minX;
+            clippedRects[clippedCount].size.height = maxY - minY;
+
+            if (sourceIndices) {
+                sourceIndices[clippedCount] = i;
+            }
+
+            clippedCount++;
+        }
+    }
+
+    return clippedCount;
+}
+
+#endif
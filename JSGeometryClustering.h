@@ -0,0 +1,591 @@
+#ifndef JSGeometryClustering
+#define JSGeometryClustering
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Types
+
+/**
+ *  Index used for clusters that don't represent a single point
+ */
+#define JSG_CLUSTER_NONE ((size_t)-1)
+
+/**
+ *  The number of points stored in each leaf of the KD trees of a cluster index
+ */
+#define JSG_CLUSTER_NODE_SIZE 64
+
+/**
+ *  A cluster found in a cluster index
+ *
+ *  @discussion position is the average position of all points in the cluster. When count
+ *  is 1, point is the index of the single point that the cluster represents, otherwise it
+ *  is JSG_CLUSTER_NONE. identifier identifies the cluster within its zoom level, and can be
+ *  passed to JSGClusterIndexGetChildren & JSGClusterIndexGetExpansionZoom.
+ */
+typedef struct {
+    CGPoint position;
+    size_t count;
+    size_t point;
+    size_t identifier;
+} JSGCluster;
+
+/**
+ *  The clusters of a single zoom level, along with a KD tree to find them
+ */
+typedef struct {
+    CGFloat *x;
+    CGFloat *y;
+    size_t *counts;
+    size_t *points;
+    size_t *parents;
+    size_t *childOffsets;
+    size_t *children;
+    size_t count;
+    size_t *treeIdentifiers;
+    CGFloat *treeX;
+    CGFloat *treeY;
+} JSGClusterLevel;
+
+/**
+ *  A hierarchy of clusters of points, precomputed for a range of zoom levels
+ *
+ *  @discussion At each zoom level, points that are within a radius of each other are grouped
+ *  in clusters, which are then grouped in larger clusters at the next lower zoom level, and
+ *  so on. Each level has its own KD tree, so that the clusters in view can be found quickly
+ *  when panning & zooming, without clustering again.
+ *
+ *  An index should be initialized using JSGClusterIndexInit, and destroyed using
+ *  JSGClusterIndexDestroy once it's no longer needed. Queries don't change the index, so
+ *  they may be performed from multiple threads at once.
+ */
+typedef struct {
+    JSGClusterLevel *levels;
+    size_t minZoom;
+    size_t maxZoom;
+    CGFloat radius;
+} JSGClusterIndex;
+
+#pragma mark - Private functions
+
+JSG_INLINE void JSGClusterTreeSwap(JSGClusterLevel *level, size_t i, size_t j)
+{
+    size_t identifier = level->treeIdentifiers[i];
+    CGFloat x = level->treeX[i];
+    CGFloat y = level->treeY[i];
+
+    level->treeIdentifiers[i] = level->treeIdentifiers[j];
+    level->treeX[i] = level->treeX[j];
+    level->treeY[i] = level->treeY[j];
+    level->treeIdentifiers[j] = identifier;
+    level->treeX[j] = x;
+    level->treeY[j] = y;
+}
+
+/**
+ *  Partially sort a range of the tree, so that the element at index k is the one that
+ *  would be there if the range was sorted along an axis
+ */
+JSG_INLINE void JSGClusterTreeSelect(JSGClusterLevel *level, size_t k, size_t left, size_t right, int axis)
+{
+    const CGFloat *coordinates = axis ? level->treeY : level->treeX;
+
+    while (right > left) {
+        size_t middle = left + (right - left) / 2;
+
+        // Median of three pivot, moved to the left of the range
+        if (coordinates[middle] < coordinates[left]) {
+            JSGClusterTreeSwap(level, middle, left);
+        }
+
+        if (coordinates[right] < coordinates[left]) {
+            JSGClusterTreeSwap(level, right, left);
+        }
+
+        if (coordinates[right] < coordinates[middle]) {
+            JSGClusterTreeSwap(level, right, middle);
+        }
+
+        JSGClusterTreeSwap(level, left, middle);
+
+        CGFloat pivot = coordinates[left];
+        size_t i = left;
+        size_t j = right + 1;
+
+        for (;;) {
+            do {
+                i++;
+            } while (i <= right && coordinates[i] < pivot);
+
+            do {
+                j--;
+            } while (coordinates[j] > pivot);
+
+            if (i >= j) {
+                break;
+            }
+
+            JSGClusterTreeSwap(level, i, j);
+        }
+
+        JSGClusterTreeSwap(level, left, j);
+
+        if (j == k) {
+            return;
+        }
+
+        if (j < k) {
+            left = j + 1;
+        } else {
+            right = j - 1;
+        }
+    }
+}
+
+JSG_INLINE void JSGClusterTreeBuild(JSGClusterLevel *level, size_t left, size_t right, int axis)
+{
+    if (right - left <= JSG_CLUSTER_NODE_SIZE) {
+        return;
+    }
+
+    size_t middle = left + (right - left) / 2;
+    JSGClusterTreeSelect(level, middle, left, right, axis);
+    JSGClusterTreeBuild(level, left, middle - 1, 1 - axis);
+    JSGClusterTreeBuild(level, middle + 1, right, 1 - axis);
+}
+
+/**
+ *  Visit the identifiers of the clusters of a level within a rect, or within a radius of
+ *  the rect's origin when radius is positive. The visitor returns whether to continue.
+ */
+JSG_INLINE void JSGClusterTreeVisit(const JSGClusterLevel *level, CGFloat minX, CGFloat minY, CGFloat maxX, CGFloat maxY, CGFloat radius, bool (*visitor)(void *context, size_t identifier), void *context)
+{
+    if (level->count == 0) {
+        return;
+    }
+
+    // The depth of the tree is at most log2(count), so this stack can't overflow
+    size_t stack[3 * 128];
+    size_t stackCount = 0;
+    CGFloat centerX = minX;
+    CGFloat centerY = minY;
+    CGFloat radiusSquared = radius * radius;
+
+    if (radius > 0) {
+        minX = centerX - radius;
+        minY = centerY - radius;
+        maxX = centerX + radius;
+        maxY = centerY + radius;
+    }
+
+    stack[stackCount++] = 0;
+    stack[stackCount++] = level->count - 1;
+    stack[stackCount++] = 0;
+
+    while (stackCount) {
+        int axis = (int)stack[--stackCount];
+        size_t right = stack[--stackCount];
+        size_t left = stack[--stackCount];
+
+        if (right - left <= JSG_CLUSTER_NODE_SIZE) {
+            for (size_t i = left; i <= right; i++) {
+                CGFloat x = level->treeX[i];
+                CGFloat y = level->treeY[i];
+                bool inside = radius > 0 ? (x - centerX) * (x - centerX) + (y - centerY) * (y - centerY) <= radiusSquared : x >= minX && x <= maxX && y >= minY && y <= maxY;
+
+                if (inside && !visitor(context, level->treeIdentifiers[i])) {
+                    return;
+                }
+            }
+
+            continue;
+        }
+
+        size_t middle = left + (right - left) / 2;
+        CGFloat x = level->treeX[middle];
+        CGFloat y = level->treeY[middle];
+        bool inside = radius > 0 ? (x - centerX) * (x - centerX) + (y - centerY) * (y - centerY) <= radiusSquared : x >= minX && x <= maxX && y >= minY && y <= maxY;
+
+        if (inside && !visitor(context, level->treeIdentifiers[middle])) {
+            return;
+        }
+
+        CGFloat coordinate = axis ? y : x;
+
+        if ((axis ? minY : minX) <= coordinate && middle > left) {
+            stack[stackCount++] = left;
+            stack[stackCount++] = middle - 1;
+            stack[stackCount++] = (size_t)(1 - axis);
+        }
+
+        if ((axis ? maxY : maxX) >= coordinate) {
+            stack[stackCount++] = middle + 1;
+            stack[stackCount++] = right;
+            stack[stackCount++] = (size_t)(1 - axis);
+        }
+    }
+}
+
+JSG_INLINE void JSGClusterLevelDestroy(JSGClusterLevel *level)
+{
+    free(level->x);
+    free(level->y);
+    free(level->counts);
+    free(level->points);
+    free(level->parents);
+    free(level->childOffsets);
+    free(level->children);
+    free(level->treeIdentifiers);
+    free(level->treeX);
+    free(level->treeY);
+    memset(level, 0, sizeof(JSGClusterLevel));
+}
+
+/**
+ *  Allocate the arrays of a level with room for a number of clusters, and build its tree
+ *  once its positions are set
+ */
+JSG_INLINE bool JSGClusterLevelAllocate(JSGClusterLevel *level, size_t capacity)
+{
+    size_t size = capacity ? capacity : 1;
+
+    memset(level, 0, sizeof(JSGClusterLevel));
+    level->x = (CGFloat *)malloc(size * sizeof(CGFloat));
+    level->y = (CGFloat *)malloc(size * sizeof(CGFloat));
+    level->counts = (size_t *)malloc(size * sizeof(size_t));
+    level->points = (size_t *)malloc(size * sizeof(size_t));
+    level->parents = (size_t *)malloc(size * sizeof(size_t));
+    level->childOffsets = (size_t *)calloc(size + 1, sizeof(size_t));
+    level->treeIdentifiers = (size_t *)malloc(size * sizeof(size_t));
+    level->treeX = (CGFloat *)malloc(size * sizeof(CGFloat));
+    level->treeY = (CGFloat *)malloc(size * sizeof(CGFloat));
+
+    return level->x && level->y && level->counts && level->points && level->parents && level->childOffsets && level->treeIdentifiers && level->treeX && level->treeY;
+}
+
+JSG_INLINE void JSGClusterLevelBuildTree(JSGClusterLevel *level)
+{
+    for (size_t i = 0; i < level->count; i++) {
+        level->treeIdentifiers[i] = i;
+        level->treeX[i] = level->x[i];
+        level->treeY[i] = level->y[i];
+    }
+
+    if (level->count > 1) {
+        JSGClusterTreeBuild(level, 0, level->count - 1, 0);
+    }
+}
+
+typedef struct {
+    const JSGClusterLevel *level;
+    unsigned char *clustered;
+    size_t cluster;
+    CGFloat sumX;
+    CGFloat sumY;
+    size_t count;
+} JSGClusterNeighbors;
+
+JSG_INLINE bool JSGClusterAddNeighbor(void *context, size_t identifier)
+{
+    JSGClusterNeighbors *neighbors = (JSGClusterNeighbors *)context;
+    const JSGClusterLevel *level = neighbors->level;
+
+    if (!neighbors->clustered[identifier]) {
+        neighbors->clustered[identifier] = 1;
+        neighbors->sumX += level->x[identifier] * level->counts[identifier];
+        neighbors->sumY += level->y[identifier] * level->counts[identifier];
+        neighbors->count += level->counts[identifier];
+        level->parents[identifier] = neighbors->cluster;
+    }
+
+    return true;
+}
+
+typedef struct {
+    const JSGClusterLevel *level;
+    JSGCluster *clusters;
+    size_t capacity;
+    size_t count;
+} JSGClusterQuery;
+
+JSG_INLINE void JSGClusterQueryAdd(JSGClusterQuery *query, size_t identifier)
+{
+    if (query->count < query->capacity) {
+        JSGCluster *cluster = &query->clusters[query->count];
+        cluster->position.x = query->level->x[identifier];
+        cluster->position.y = query->level->y[identifier];
+        cluster->count = query->level->counts[identifier];
+        cluster->point = query->level->points[identifier];
+        cluster->identifier = identifier;
+    }
+
+    query->count++;
+}
+
+JSG_INLINE bool JSGClusterQueryVisitor(void *context, size_t identifier)
+{
+    JSGClusterQueryAdd((JSGClusterQuery *)context, identifier);
+
+    return true;
+}
+
+JSG_INLINE const JSGClusterLevel *JSGClusterIndexGetLevel(const JSGClusterIndex *index, size_t zoom)
+{
+    zoom = zoom < index->minZoom ? index->minZoom : zoom > index->maxZoom + 1 ? index->maxZoom + 1 : zoom;
+
+    return &index->levels[zoom - index->minZoom];
+}
+
+#pragma mark - Cluster index functions
+
+/**
+ *  Initialize a cluster index by clustering points at every zoom level of a range
+ *
+ *  @param index The index to initialize
+ *  @param points The points to cluster
+ *  @param count The number of points
+ *  @param radius The radius within which points are clustered at zoom level 0, in the units
+ *  of the points. The radius is halved at each following zoom level, so for points in a map
+ *  world that is 256 screen points wide at zoom level 0, a radius of 40 clusters points
+ *  within 40 screen points of each other at every zoom level. With a radius of 0 or less,
+ *  only points at the same position are clustered.
+ *  @param minZoom The lowest zoom level to cluster at
+ *  @param maxZoom The highest zoom level to cluster at. Above it, points are not clustered.
+ *
+ *  @return Whether the index could be initialized. This is only false if memory could not
+ *  be allocated, in which case the index doesn't need to be destroyed.
+ *
+ *  @discussion Clustering starts from the highest zoom level. At each level, the clusters of
+ *  the level above are visited in order, and each one that hasn't been clustered yet is
+ *  grouped with all unclustered neighbors within the level's radius, found using the KD
+ *  tree of the level above. Each level is therefore built in about O(n log n) time.
+ */
+JSG_INLINE bool JSGClusterIndexInit(JSGClusterIndex *index, const CGPoint *points, size_t count, CGFloat radius, size_t minZoom, size_t maxZoom)
+{
+    memset(index, 0, sizeof(JSGClusterIndex));
+    maxZoom = maxZoom > minZoom ? maxZoom : minZoom;
+
+    size_t levelCount = maxZoom - minZoom + 2;
+    index->levels = (JSGClusterLevel *)calloc(levelCount, sizeof(JSGClusterLevel));
+    index->minZoom = minZoom;
+    index->maxZoom = maxZoom;
+    index->radius = radius;
+
+    unsigned char *clustered = (unsigned char *)malloc(count ? count : 1);
+
+    if (!index->levels || !clustered) {
+        free(index->levels);
+        free(clustered);
+        memset(index, 0, sizeof(JSGClusterIndex));
+
+        return false;
+    }
+
+    JSGClusterLevel *leaves = &index->levels[levelCount - 1];
+    bool allocated = JSGClusterLevelAllocate(leaves, count);
+
+    for (size_t i = 0; allocated && i < count; i++) {
+        leaves->x[i] = points[i].x;
+        leaves->y[i] = points[i].y;
+        leaves->counts[i] = 1;
+        leaves->points[i] = i;
+    }
+
+    if (allocated) {
+        leaves->count = count;
+        JSGClusterLevelBuildTree(leaves);
+    }
+
+    for (size_t zoom = maxZoom + 1; allocated && zoom-- > minZoom;) {
+        JSGClusterLevel *previous = &index->levels[zoom + 1 - minZoom];
+        JSGClusterLevel *level = &index->levels[zoom - minZoom];
+        JSGClusterNeighbors neighbors;
+        CGFloat levelRadius = radius / pow(2, (CGFloat)zoom);
+
+        if (!JSGClusterLevelAllocate(level, previous->count)) {
+            allocated = false;
+            break;
+        }
+
+        memset(clustered, 0, previous->count);
+        neighbors.level = previous;
+        neighbors.clustered = clustered;
+
+        for (size_t i = 0; i < previous->count; i++) {
+            if (clustered[i]) {
+                continue;
+            }
+
+            neighbors.cluster = level->count;
+            neighbors.sumX = 0;
+            neighbors.sumY = 0;
+            neighbors.count = 0;
+            JSGClusterAddNeighbor(&neighbors, i);
+
+            // With a radius of 0 or less, the search falls back to the degenerate rect at the
+            // cluster's position, so that only coincident clusters are grouped
+            JSGClusterTreeVisit(previous, previous->x[i], previous->y[i], previous->x[i], previous->y[i], levelRadius, JSGClusterAddNeighbor, &neighbors);
+
+            size_t cluster = level->count++;
+            level->x[cluster] = neighbors.count == previous->counts[i] ? previous->x[i] : neighbors.sumX / neighbors.count;
+            level->y[cluster] = neighbors.count == previous->counts[i] ? previous->y[i] : neighbors.sumY / neighbors.count;
+            level->counts[cluster] = neighbors.count;
+            level->points[cluster] = neighbors.count == 1 ? previous->points[i] : JSG_CLUSTER_NONE;
+        }
+
+        // The children of each cluster are listed contiguously, by counting sort
+        level->children = (size_t *)malloc((previous->count ? previous->count : 1) * sizeof(size_t));
+
+        if (!level->children) {
+            allocated = false;
+            break;
+        }
+
+        for (size_t i = 0; i < previous->count; i++) {
+            level->childOffsets[previous->parents[i] + 1]++;
+        }
+
+        for (size_t i = 0; i < level->count; i++) {
+            level->childOffsets[i + 1] += level->childOffsets[i];
+        }
+
+        for (size_t i = 0; i < previous->count; i++) {
+            level->children[level->childOffsets[previous->parents[i]]++] = i;
+        }
+
+        for (size_t i = level->count; i > 0; i--) {
+            level->childOffsets[i] = level->childOffsets[i - 1];
+        }
+
+        level->childOffsets[0] = 0;
+
+        for (size_t i = 0; i < level->count; i++) {
+            level->parents[i] = JSG_CLUSTER_NONE;
+        }
+
+        JSGClusterLevelBuildTree(level);
+    }
+
+    free(clustered);
+
+    if (!allocated) {
+        for (size_t i = 0; i < levelCount; i++) {
+            JSGClusterLevelDestroy(&index->levels[i]);
+        }
+
+        free(index->levels);
+        memset(index, 0, sizeof(JSGClusterIndex));
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Destroy a cluster index, freeing all of its memory
+ *
+ *  @param index The index to destroy
+ */
+JSG_INLINE void JSGClusterIndexDestroy(JSGClusterIndex *index)
+{
+    if (index->levels) {
+        for (size_t i = 0; i < index->maxZoom - index->minZoom + 2; i++) {
+            JSGClusterLevelDestroy(&index->levels[i]);
+        }
+    }
+
+    free(index->levels);
+    memset(index, 0, sizeof(JSGClusterIndex));
+}
+
+/**
+ *  Find the clusters of a zoom level within a rect
+ *
+ *  @param index The index to query
+ *  @param rect The rect to find clusters in, such as the visible area of a map. Clusters on
+ *  the edges of the rect are included.
+ *  @param zoom The zoom level, which is clamped to the range of the index. Above the
+ *  highest zoom level, every point is its own cluster.
+ *  @param clusters The array to write the clusters to, or NULL
+ *  @param capacity The number of clusters that the array has room for
+ *
+ *  @return The number of clusters in the rect. If this is larger than capacity, only the
+ *  first capacity clusters were written.
+ */
+JSG_INLINE size_t JSGClusterIndexGetClusters(const JSGClusterIndex *index, CGRect rect, size_t zoom, JSGCluster *clusters, size_t capacity)
+{
+    JSGClusterQuery query = {JSGClusterIndexGetLevel(index, zoom), clusters, clusters ? capacity : 0, 0};
+    rect = CGRectStandardize(rect);
+
+    JSGClusterTreeVisit(query.level, rect.origin.x, rect.origin.y, rect.origin.x + rect.size.width, rect.origin.y + rect.size.height, 0, JSGClusterQueryVisitor, &query);
+
+    return query.count;
+}
+
+/**
+ *  Find the clusters that a cluster splits into at the next zoom level
+ *
+ *  @param index The index to query
+ *  @param zoom The zoom level of the cluster
+ *  @param identifier The identifier of the cluster
+ *  @param children The array to write the children to, or NULL
+ *  @param capacity The number of children that the array has room for
+ *
+ *  @return The number of children. If this is larger than capacity, only the first capacity
+ *  children were written.
+ */
+JSG_INLINE size_t JSGClusterIndexGetChildren(const JSGClusterIndex *index, size_t zoom, size_t identifier, JSGCluster *children, size_t capacity)
+{
+    const JSGClusterLevel *level = JSGClusterIndexGetLevel(index, zoom);
+
+    if (level == &index->levels[index->maxZoom + 1 - index->minZoom]) {
+        return 0;
+    }
+
+    JSGClusterQuery query = {level + 1, children, children ? capacity : 0, 0};
+
+    for (size_t i = level->childOffsets[identifier]; i < level->childOffsets[identifier + 1]; i++) {
+        JSGClusterQueryAdd(&query, level->children[i]);
+    }
+
+    return query.count;
+}
+
+/**
+ *  Return the zoom level at which a cluster splits into multiple clusters
+ *
+ *  @param index The index to query
+ *  @param zoom The zoom level of the cluster
+ *  @param identifier The identifier of the cluster
+ *
+ *  @discussion This is the zoom level to zoom to when a cluster is tapped. For a single
+ *  point, this is the zoom level above the highest zoom level of the index.
+ */
+JSG_INLINE size_t JSGClusterIndexGetExpansionZoom(const JSGClusterIndex *index, size_t zoom, size_t identifier)
+{
+    zoom = zoom < index->minZoom ? index->minZoom : zoom > index->maxZoom + 1 ? index->maxZoom + 1 : zoom;
+
+    while (zoom <= index->maxZoom) {
+        const JSGClusterLevel *level = &index->levels[zoom - index->minZoom];
+        size_t first = level->childOffsets[identifier];
+
+        zoom++;
+
+        if (level->childOffsets[identifier + 1] - first != 1) {
+            break;
+        }
+
+        identifier = level->children[first];
+    }
+
+    return zoom;
+}
+
+#endif
@@ -0,0 +1,525 @@
+#ifndef JSGeometryCommandBuffer
+#define JSGeometryCommandBuffer
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryBatch.h"
+
+#pragma mark - Enums
+
+/**
+ *  Enum describing the rect operations that can be recorded in a command buffer
+ *
+ *  @discussion Each operation corresponds to one of the JSGRectChange* functions.
+ */
+typedef enum : NSUInteger {
+    JSGRectOperationChangeOrigin,
+    JSGRectOperationChangeOriginX,
+    JSGRectOperationChangeOriginY,
+    JSGRectOperationChangeSize,
+    JSGRectOperationChangeWidth,
+    JSGRectOperationChangeHeight
+} JSGRectOperation;
+
+#define JSGRectOperationCount 6
+
+#pragma mark - Types
+
+/**
+ *  A queue of recorded commands that all share the same operation
+ *
+ *  @discussion The values are stored contiguously, so that a whole queue can be handed
+ *  to one of the indexed JSGRects* batch functions as-is.
+ */
+typedef struct {
+    size_t *indices;
+    union {
+        CGFloat *scalars;
+        CGPoint *points;
+        CGSize *sizes;
+    } values;
+    size_t count;
+    size_t capacity;
+} JSGRectOperationQueue;
+
+/**
+ *  A buffer that records rect changes, to later apply them all in batches
+ *
+ *  @discussion Commands are recorded using the JSGCommandBufferEnqueue* functions, and are
+ *  applied to an array of rects by JSGCommandBufferFlush. Rather than being applied one by
+ *  one, commands are grouped by operation, and each group is applied using a single batch
+ *  function call.
+ *
+ *  Grouping never changes the result compared to applying the commands in the order they
+ *  were recorded. When a command would write a rect component that a command with another
+ *  operation has already written to since the last group boundary, a new boundary is
+ *  inserted, so that the two commands get applied in order.
+ *
+ *  A buffer should be initialized using JSGCommandBufferInit, and destroyed using
+ *  JSGCommandBufferDestroy once it's no longer needed.
+ */
+typedef struct {
+    JSGRectOperationQueue queues[JSGRectOperationCount];
+    size_t *boundaries;
+    size_t boundaryCount;
+    size_t boundaryCapacity;
+    size_t *targetEpochs;
+    unsigned char *targetWriters;
+    size_t targetCapacity;
+    size_t epoch;
+    size_t targetLimit;
+} JSGCommandBuffer;
+
+#pragma mark - Private functions
+
+JSG_INLINE size_t JSGRectOperationValueSize(JSGRectOperation operation)
+{
+    switch (operation) {
+        case JSGRectOperationChangeOrigin:
+            return sizeof(CGPoint);
+        case JSGRectOperationChangeSize:
+            return sizeof(CGSize);
+        default:
+            return sizeof(CGFloat);
+    }
+}
+
+/**
+ *  Return a bitmask of the rect components (x, y, width, height) written by an operation
+ */
+JSG_INLINE unsigned int JSGRectOperationComponents(JSGRectOperation operation)
+{
+    switch (operation) {
+        case JSGRectOperationChangeOrigin:
+            return 1 | 1 << 1;
+        case JSGRectOperationChangeOriginX:
+            return 1;
+        case JSGRectOperationChangeOriginY:
+            return 1 << 1;
+        case JSGRectOperationChangeSize:
+            return 1 << 2 | 1 << 3;
+        case JSGRectOperationChangeWidth:
+            return 1 << 2;
+        case JSGRectOperationChangeHeight:
+            return 1 << 3;
+    }
+
+    return 0;
+}
+
+JSG_INLINE bool JSGRectOperationQueueReserve(JSGRectOperationQueue *queue, JSGRectOperation operation)
+{
+    if (queue->count < queue->capacity) {
+        return true;
+    }
+
+    size_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+    size_t *indices = (size_t *)realloc(queue->indices, capacity * sizeof(size_t));
+
+    if (!indices) {
+        return false;
+    }
+
+    queue->indices = indices;
+
+    void *values = realloc(queue->values.scalars, capacity * JSGRectOperationValueSize(operation));
+
+    if (!values) {
+        return false;
+    }
+
+    queue->values.scalars = (CGFloat *)values;
+    queue->capacity = capacity;
+
+    return true;
+}
+
+/**
+ *  Register a write by an operation to a target, inserting a group boundary if needed
+ */
+JSG_INLINE bool JSGCommandBufferTrackTarget(JSGCommandBuffer *buffer, size_t target, JSGRectOperation operation)
+{
+    if (target >= buffer->targetCapacity) {
+        // The capacity is doubled past target, & must then still be countable in bytes
+        if (target >= SIZE_MAX / (2 * sizeof(size_t))) {
+            return false;
+        }
+
+        size_t capacity = buffer->targetCapacity ? buffer->targetCapacity : 64;
+
+        while (capacity <= target) {
+            capacity *= 2;
+        }
+
+        size_t *epochs = (size_t *)realloc(buffer->targetEpochs, capacity * sizeof(size_t));
+
+        if (!epochs) {
+            return false;
+        }
+
+        buffer->targetEpochs = epochs;
+
+        unsigned char *writers = (unsigned char *)realloc(buffer->targetWriters, capacity * 4);
+
+        if (!writers) {
+            return false;
+        }
+
+        buffer->targetWriters = writers;
+        memset(epochs + buffer->targetCapacity, 0, (capacity - buffer->targetCapacity) * sizeof(size_t));
+        buffer->targetCapacity = capacity;
+    }
+
+    unsigned int components = JSGRectOperationComponents(operation);
+    unsigned char *writers = buffer->targetWriters + target * 4;
+    unsigned char writer = (unsigned char)(operation + 1);
+
+    if (buffer->targetEpochs[target] == buffer->epoch) {
+        bool conflict = false;
+
+        for (unsigned int component = 0; component < 4; component++) {
+            if ((components & (1u << component)) && writers[component] && writers[component] != writer) {
+                conflict = true;
+            }
+        }
+
+        if (conflict) {
+            if (buffer->boundaryCount == buffer->boundaryCapacity) {
+                size_t capacity = buffer->boundaryCapacity ? buffer->boundaryCapacity * 2 : 16;
+                size_t *boundaries = (size_t *)realloc(buffer->boundaries, capacity * JSGRectOperationCount * sizeof(size_t));
+
+                if (!boundaries) {
+                    return false;
+                }
+
+                buffer->boundaries = boundaries;
+                buffer->boundaryCapacity = capacity;
+            }
+
+            size_t *boundary = buffer->boundaries + buffer->boundaryCount * JSGRectOperationCount;
+
+            for (size_t i = 0; i < JSGRectOperationCount; i++) {
+                boundary[i] = buffer->queues[i].count;
+            }
+
+            buffer->boundaryCount++;
+            buffer->epoch++;
+        }
+    }
+
+    // The target is only recorded once every allocation has succeeded, so that a command
+    // that can't be recorded leaves the buffer as it was
+    if (target >= buffer->targetLimit) {
+        buffer->targetLimit = target + 1;
+    }
+
+    if (buffer->targetEpochs[target] != buffer->epoch) {
+        buffer->targetEpochs[target] = buffer->epoch;
+        memset(writers, 0, 4);
+    }
+
+    for (unsigned int component = 0; component < 4; component++) {
+        if (components & (1u << component)) {
+            writers[component] = writer;
+        }
+    }
+
+    return true;
+}
+
+JSG_INLINE JSGRectOperationQueue *JSGCommandBufferPrepareEnqueue(JSGCommandBuffer *buffer, size_t target, JSGRectOperation operation)
+{
+    JSGRectOperationQueue *queue = &buffer->queues[operation];
+
+    if (!JSGRectOperationQueueReserve(queue, operation)) {
+        return NULL;
+    }
+
+    if (!JSGCommandBufferTrackTarget(buffer, target, operation)) {
+        return NULL;
+    }
+
+    queue->indices[queue->count] = target;
+
+    return queue;
+}
+
+JSG_INLINE void JSGCommandBufferApplyRange(JSGCommandBuffer *buffer, CGRect *rects, const size_t *starts, const size_t *ends)
+{
+    for (size_t operation = 0; operation < JSGRectOperationCount; operation++) {
+        JSGRectOperationQueue *queue = &buffer->queues[operation];
+        size_t start = starts[operation];
+        size_t count = ends[operation] - start;
+
+        if (!count) {
+            continue;
+        }
+
+        switch ((JSGRectOperation)operation) {
+            case JSGRectOperationChangeOrigin:
+                JSGRectsChangeOriginAtIndices(rects, queue->indices + start, queue->values.points + start, count);
+                break;
+            case JSGRectOperationChangeOriginX:
+                JSGRectsChangeOriginXAtIndices(rects, queue->indices + start, queue->values.scalars + start, count);
+                break;
+            case JSGRectOperationChangeOriginY:
+                JSGRectsChangeOriginYAtIndices(rects, queue->indices + start, queue->values.scalars + start, count);
+                break;
+            case JSGRectOperationChangeSize:
+                JSGRectsChangeSizeAtIndices(rects, queue->indices + start, queue->values.sizes + start, count);
+                break;
+            case JSGRectOperationChangeWidth:
+                JSGRectsChangeWidthAtIndices(rects, queue->indices + start, queue->values.scalars + start, count);
+                break;
+            case JSGRectOperationChangeHeight:
+                JSGRectsChangeHeightAtIndices(rects, queue->indices + start, queue->values.scalars + start, count);
+                break;
+        }
+    }
+}
+
+#pragma mark - Command buffer functions
+
+/**
+ *  Initialize an empty command buffer
+ *
+ *  @param buffer The buffer to initialize
+ */
+JSG_INLINE void JSGCommandBufferInit(JSGCommandBuffer *buffer)
+{
+    memset(buffer, 0, sizeof(JSGCommandBuffer));
+    buffer->epoch = 1;
+}
+
+/**
+ *  Destroy a command buffer, freeing all of its memory
+ *
+ *  @param buffer The buffer to destroy
+ *
+ *  @discussion Any commands that haven't been flushed are discarded.
+ */
+JSG_INLINE void JSGCommandBufferDestroy(JSGCommandBuffer *buffer)
+{
+    for (size_t i = 0; i < JSGRectOperationCount; i++) {
+        free(buffer->queues[i].indices);
+        free(buffer->queues[i].values.scalars);
+    }
+
+    free(buffer->boundaries);
+    free(buffer->targetEpochs);
+    free(buffer->targetWriters);
+    memset(buffer, 0, sizeof(JSGCommandBuffer));
+}
+
+/**
+ *  Return the number of commands that are waiting to be flushed in a command buffer
+ *
+ *  @param buffer The buffer to get the number of commands for
+ */
+JSG_INLINE size_t JSGCommandBufferGetCount(const JSGCommandBuffer *buffer)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < JSGRectOperationCount; i++) {
+        count += buffer->queues[i].count;
+    }
+
+    return count;
+}
+
+/**
+ *  Discard all commands that are waiting to be flushed in a command buffer
+ *
+ *  @param buffer The buffer to clear
+ *
+ *  @discussion The buffer keeps its memory, to be reused by subsequent commands.
+ */
+JSG_INLINE void JSGCommandBufferClear(JSGCommandBuffer *buffer)
+{
+    for (size_t i = 0; i < JSGRectOperationCount; i++) {
+        buffer->queues[i].count = 0;
+    }
+
+    buffer->boundaryCount = 0;
+    buffer->targetLimit = 0;
+    buffer->epoch++;
+}
+
+/**
+ *  Record a change of the origin of a rect
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newOrigin The new origin that the rect should have
+ *
+ *  @return Whether the command could be recorded. This is only false if memory
+ *  could not be allocated, or if target is too large to ever be allocated for.
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeOrigin(JSGCommandBuffer *buffer, size_t target, CGPoint newOrigin)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeOrigin);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.points[queue->count++] = newOrigin;
+
+    return true;
+}
+
+/**
+ *  Record a change of the x component of a rect's origin
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newOriginX The new x component that the rect's origin should have
+ *
+ *  @return Whether the command could be recorded
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeOriginX(JSGCommandBuffer *buffer, size_t target, CGFloat newOriginX)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeOriginX);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.scalars[queue->count++] = newOriginX;
+
+    return true;
+}
+
+/**
+ *  Record a change of the y component of a rect's origin
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newOriginY The new y component that the rect's origin should have
+ *
+ *  @return Whether the command could be recorded
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeOriginY(JSGCommandBuffer *buffer, size_t target, CGFloat newOriginY)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeOriginY);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.scalars[queue->count++] = newOriginY;
+
+    return true;
+}
+
+/**
+ *  Record a change of the size of a rect
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newSize The new size that the rect should have
+ *
+ *  @return Whether the command could be recorded
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeSize(JSGCommandBuffer *buffer, size_t target, CGSize newSize)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeSize);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.sizes[queue->count++] = newSize;
+
+    return true;
+}
+
+/**
+ *  Record a change of the width of a rect
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newWidth The new width that the rect should have
+ *
+ *  @return Whether the command could be recorded
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeWidth(JSGCommandBuffer *buffer, size_t target, CGFloat newWidth)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeWidth);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.scalars[queue->count++] = newWidth;
+
+    return true;
+}
+
+/**
+ *  Record a change of the height of a rect
+ *
+ *  @param buffer The buffer to record the command in
+ *  @param target The index of the rect to change
+ *  @param newHeight The new height that the rect should have
+ *
+ *  @return Whether the command could be recorded
+ */
+JSG_INLINE bool JSGCommandBufferEnqueueChangeHeight(JSGCommandBuffer *buffer, size_t target, CGFloat newHeight)
+{
+    JSGRectOperationQueue *queue = JSGCommandBufferPrepareEnqueue(buffer, target, JSGRectOperationChangeHeight);
+
+    if (!queue) {
+        return false;
+    }
+
+    queue->values.scalars[queue->count++] = newHeight;
+
+    return true;
+}
+
+/**
+ *  Apply all recorded commands to an array of rects, and empty the buffer
+ *
+ *  @param buffer The buffer containing the commands to apply
+ *  @param rects The array of rects that the command targets index into
+ *  @param count The number of rects in the array
+ *
+ *  @return Whether the commands were applied. If any command targets an index that's
+ *  outside of the array, no commands are applied, and the buffer is left untouched.
+ *
+ *  @discussion The result is the same as if every recorded command had been applied
+ *  directly, in order, using its corresponding JSGRectChange* function.
+ */
+JSG_INLINE bool JSGCommandBufferFlush(JSGCommandBuffer *buffer, CGRect *rects, size_t count)
+{
+    if (buffer->targetLimit > count) {
+        return false;
+    }
+
+    size_t starts[JSGRectOperationCount] = {0};
+
+    for (size_t i = 0; i < buffer->boundaryCount; i++) {
+        const size_t *ends = buffer->boundaries + i * JSGRectOperationCount;
+        JSGCommandBufferApplyRange(buffer, rects, starts, ends);
+        memcpy(starts, ends, sizeof(starts));
+    }
+
+    size_t ends[JSGRectOperationCount];
+
+    for (size_t i = 0; i < JSGRectOperationCount; i++) {
+        ends[i] = buffer->queues[i].count;
+    }
+
+    JSGCommandBufferApplyRange(buffer, rects, starts, ends);
+    JSGCommandBufferClear(buffer);
+
+    return true;
+}
+
+#endif
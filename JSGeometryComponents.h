@@ -0,0 +1,161 @@
+#ifndef JSGeometryComponents
+#define JSGeometryComponents
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+#include "JSGeometrySorting.h"
+
+#pragma mark - Types
+
+/**
+ *  Group id used for rects whose group hasn't been numbered yet
+ */
+#define JSG_COMPONENT_NONE ((size_t)-1)
+
+#pragma mark - Private functions
+
+/**
+ *  Find the root of an element in a union-find forest, halving the path to it on the way
+ */
+JSG_INLINE size_t JSGComponentFind(size_t *parents, size_t element)
+{
+    while (parents[element] != element) {
+        parents[element] = parents[parents[element]];
+        element = parents[element];
+    }
+
+    return element;
+}
+
+/**
+ *  Merge the sets of two elements, keeping the smaller root so that roots stay stable
+ */
+JSG_INLINE void JSGComponentUnion(size_t *parents, size_t a, size_t b)
+{
+    a = JSGComponentFind(parents, a);
+    b = JSGComponentFind(parents, b);
+    parents[a > b ? a : b] = a < b ? a : b;
+}
+
+#pragma mark - Component functions
+
+/**
+ *  Group rects that overlap, directly or through other rects
+ *
+ *  @param rects The rects to group
+ *  @param groups The array to write the group id of each rect to. Must have room for the
+ *  array's count.
+ *  @param groupCount Set to the number of groups
+ *
+ *  @return Whether the rects could be grouped. This is only false if memory could not be
+ *  allocated.
+ *
+ *  @discussion Groups are the connected components of the graph whose edges link rects that
+ *  overlap. Rects that only touch don't overlap, so rects with a zero width or height are
+ *  always in groups of their own. Group ids go from 0 to groupCount - 1, numbered in order
+ *  of the first rect of each group.
+ *
+ *  Rather than testing every pair of rects, rects are sorted by their minimum x, and each
+ *  one is only tested against the following rects that start before it ends (sweep & prune).
+ *  Overlapping rects are merged in a union-find forest with path compression, so grouping
+ *  takes about O(n log n + k) time, where k is the number of pairs of rects that overlap
+ *  horizontally.
+ */
+JSG_INLINE bool JSGRectArrayGetOverlapGroups(const JSGRectArray *rects, size_t *groups, size_t *groupCount)
+{
+    size_t count = rects->count;
+    *groupCount = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+    CGFloat *sorted = (CGFloat *)malloc(count * 4 * sizeof(CGFloat));
+    size_t *parents = (size_t *)malloc(count * 2 * sizeof(size_t));
+
+    if (!order || !sorted || !parents) {
+        free(order);
+        free(sorted);
+        free(parents);
+
+        return false;
+    }
+
+    // Sorting by descending score, so scores are negated to get ascending minimum x
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = -rects->x[i];
+        order[i].index = i;
+    }
+
+    if (!JSGScoredIndicesSort(order, count)) {
+        free(order);
+        free(sorted);
+        free(parents);
+
+        return false;
+    }
+
+    CGFloat *minXs = sorted;
+    CGFloat *minYs = sorted + count;
+    CGFloat *maxXs = sorted + count * 2;
+    CGFloat *maxYs = sorted + count * 3;
+    size_t *positions = parents + count;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = order[i].index;
+        minXs[i] = rects->x[index];
+        minYs[i] = rects->y[index];
+        maxXs[i] = rects->x[index] + rects->width[index];
+        maxYs[i] = rects->y[index] + rects->height[index];
+        parents[i] = i;
+        positions[index] = i;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        CGFloat minY = minYs[i];
+        CGFloat maxX = maxXs[i];
+        CGFloat maxY = maxYs[i];
+
+        // Rects are sorted by minimum x, so the following rects always start at or after
+        // this one, & the intersection is only tested for a positive width & height
+        for (size_t j = i + 1; j < count && minXs[j] < maxX; j++) {
+            CGFloat top = minYs[j] > minY ? minYs[j] : minY;
+            CGFloat right = maxXs[j] < maxX ? maxXs[j] : maxX;
+            CGFloat bottom = maxYs[j] < maxY ? maxYs[j] : maxY;
+
+            if ((right > minXs[j]) & (bottom > top)) {
+                JSGComponentUnion(parents, i, j);
+            }
+        }
+    }
+
+    // Roots are numbered in order of the first rect of each group, reusing the sort buffer
+    size_t *ids = (size_t *)order;
+
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = JSG_COMPONENT_NONE;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t root = JSGComponentFind(parents, positions[i]);
+
+        if (ids[root] == JSG_COMPONENT_NONE) {
+            ids[root] = (*groupCount)++;
+        }
+
+        groups[i] = ids[root];
+    }
+
+    free(order);
+    free(sorted);
+    free(parents);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef JSGeometryCoreGraphics
+#define JSGeometryCoreGraphics
+
+/**
+ *  A minimal implementation of the CoreGraphics geometry API
+ *
+ *  @discussion This header is used in place of CoreGraphics/CGGeometry.h on platforms
+ *  where CoreGraphics isn't available (such as Linux), so that JSGeometry can be built,
+ *  benchmarked & profiled there. It implements the subset of CGGeometry that JSGeometry
+ *  uses, following the documented CoreGraphics semantics (for example, functions that
+ *  take a rect operate on its standardized form). Don't include it directly; it's
+ *  included by JSGeometry.h when needed.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ *  Specifiers used for the functions & constants of this header
+ *
+ *  @discussion In C, functions are static inline, since C's inline functions would need an
+ *  external definition in one translation unit. In C++, they're plain inline functions &
+ *  constants instead, which have external linkage, so that the jsgeometry module can export
+ *  them, along with the exported JSGeometry functions that call them. From C++17 on,
+ *  constants are inline constexpr, so that their values are known to code importing the
+ *  module; a plain inline const would only be initialized within the module's own object
+ *  file. Before C++17 they are static.
+ */
+#ifndef CG_INLINE
+#if defined(__cplusplus)
+#define CG_INLINE inline
+#else
+#define CG_INLINE static inline
+#endif
+#endif
+
+#if defined(__cplusplus) && __cplusplus >= 201703L
+#define CG_CONSTANT inline constexpr
+#else
+#define CG_CONSTANT static const
+#endif
+
+#pragma mark - Types
+
+#if defined(__LP64__) && __LP64__
+typedef double CGFloat;
+typedef unsigned long NSUInteger;
+#define CGFLOAT_MIN DBL_MIN
+#define CGFLOAT_MAX DBL_MAX
+#else
+typedef float CGFloat;
+typedef unsigned int NSUInteger;
+#define CGFLOAT_MIN FLT_MIN
+#define CGFLOAT_MAX FLT_MAX
+#endif
+
+struct CGPoint {
+    CGFloat x;
+    CGFloat y;
+};
+typedef struct CGPoint CGPoint;
+
+struct CGSize {
+    CGFloat width;
+    CGFloat height;
+};
+typedef struct CGSize CGSize;
+
+struct CGRect {
+    CGPoint origin;
+    CGSize size;
+};
+typedef struct CGRect CGRect;
+
+typedef enum : unsigned int {
+    CGRectMinXEdge,
+    CGRectMinYEdge,
+    CGRectMaxXEdge,
+    CGRectMaxYEdge
+} CGRectEdge;
+
+CG_CONSTANT CGPoint CGPointZero = {0, 0};
+CG_CONSTANT CGSize CGSizeZero = {0, 0};
+CG_CONSTANT CGRect CGRectZero = {{0, 0}, {0, 0}};
+CG_CONSTANT CGRect CGRectNull = {{INFINITY, INFINITY}, {0, 0}};
+
+#pragma mark - Constructors
+
+CG_INLINE CGPoint CGPointMake(CGFloat x, CGFloat y)
+{
+    CGPoint point;
+    point.x = x;
+    point.y = y;
+
+    return point;
+}
+
+CG_INLINE CGSize CGSizeMake(CGFloat width, CGFloat height)
+{
+    CGSize size;
+    size.width = width;
+    size.height = height;
+
+    return size;
+}
+
+CG_INLINE CGRect CGRectMake(CGFloat x, CGFloat y, CGFloat width, CGFloat height)
+{
+    CGRect rect;
+    rect.origin.x = x;
+    rect.origin.y = y;
+    rect.size.width = width;
+    rect.size.height = height;
+
+    return rect;
+}
+
+#pragma mark - Accessors
+
+CG_INLINE CGFloat CGRectGetMinX(CGRect rect)
+{
+    return rect.size.width < 0 ? rect.origin.x + rect.size.width : rect.origin.x;
+}
+
+CG_INLINE CGFloat CGRectGetMinY(CGRect rect)
+{
+    return rect.size.height < 0 ? rect.origin.y + rect.size.height : rect.origin.y;
+}
+
+CG_INLINE CGFloat CGRectGetMaxX(CGRect rect)
+{
+    return rect.size.width < 0 ? rect.origin.x : rect.origin.x + rect.size.width;
+}
+
+CG_INLINE CGFloat CGRectGetMaxY(CGRect rect)
+{
+    return rect.size.height < 0 ? rect.origin.y : rect.origin.y + rect.size.height;
+}
+
+CG_INLINE CGFloat CGRectGetMidX(CGRect rect)
+{
+    return rect.origin.x + rect.size.width / 2;
+}
+
+CG_INLINE CGFloat CGRectGetMidY(CGRect rect)
+{
+    return rect.origin.y + rect.size.height / 2;
+}
+
+CG_INLINE CGFloat CGRectGetWidth(CGRect rect)
+{
+    return fabs(rect.size.width);
+}
+
+CG_INLINE CGFloat CGRectGetHeight(CGRect rect)
+{
+    return fabs(rect.size.height);
+}
+
+#pragma mark - Comparisons
+
+CG_INLINE bool CGPointEqualToPoint(CGPoint point1, CGPoint point2)
+{
+    return point1.x == point2.x && point1.y == point2.y;
+}
+
+CG_INLINE bool CGSizeEqualToSize(CGSize size1, CGSize size2)
+{
+    return size1.width == size2.width && size1.height == size2.height;
+}
+
+CG_INLINE bool CGRectIsNull(CGRect rect)
+{
+    return isinf(rect.origin.x) || isinf(rect.origin.y);
+}
+
+CG_INLINE bool CGRectIsEmpty(CGRect rect)
+{
+    return CGRectIsNull(rect) || rect.size.width == 0 || rect.size.height == 0;
+}
+
+CG_INLINE CGRect CGRectStandardize(CGRect rect)
+{
+    if (CGRectIsNull(rect)) {
+        return rect;
+    }
+
+    return CGRectMake(CGRectGetMinX(rect), CGRectGetMinY(rect), CGRectGetWidth(rect), CGRectGetHeight(rect));
+}
+
+CG_INLINE bool CGRectEqualToRect(CGRect rect1, CGRect rect2)
+{
+    if (CGRectIsNull(rect1) || CGRectIsNull(rect2)) {
+        return CGRectIsNull(rect1) && CGRectIsNull(rect2);
+    }
+
+    rect1 = CGRectStandardize(rect1);
+    rect2 = CGRectStandardize(rect2);
+
+    return CGPointEqualToPoint(rect1.origin, rect2.origin) && CGSizeEqualToSize(rect1.size, rect2.size);
+}
+
+CG_INLINE bool CGRectContainsPoint(CGRect rect, CGPoint point)
+{
+    return !CGRectIsNull(rect)
+        && point.x >= CGRectGetMinX(rect) && point.x < CGRectGetMaxX(rect)
+        && point.y >= CGRectGetMinY(rect) && point.y < CGRectGetMaxY(rect);
+}
+
+CG_INLINE bool CGRectContainsRect(CGRect rect1, CGRect rect2)
+{
+    if (CGRectIsNull(rect1) || CGRectIsNull(rect2)) {
+        return false;
+    }
+
+    return CGRectGetMinX(rect2) >= CGRectGetMinX(rect1) && CGRectGetMaxX(rect2) <= CGRectGetMaxX(rect1)
+        && CGRectGetMinY(rect2) >= CGRectGetMinY(rect1) && CGRectGetMaxY(rect2) <= CGRectGetMaxY(rect1);
+}
+
+CG_INLINE bool CGRectIntersectsRect(CGRect rect1, CGRect rect2)
+{
+    if (CGRectIsEmpty(rect1) || CGRectIsEmpty(rect2)) {
+        return false;
+    }
+
+    return CGRectGetMinX(rect1) < CGRectGetMaxX(rect2) && CGRectGetMinX(rect2) < CGRectGetMaxX(rect1)
+        && CGRectGetMinY(rect1) < CGRectGetMaxY(rect2) && CGRectGetMinY(rect2) < CGRectGetMaxY(rect1);
+}
+
+#pragma mark - Transformations
+
+CG_INLINE CGRect CGRectOffset(CGRect rect, CGFloat dx, CGFloat dy)
+{
+    if (CGRectIsNull(rect)) {
+        return rect;
+    }
+
+    rect = CGRectStandardize(rect);
+    rect.origin.x += dx;
+    rect.origin.y += dy;
+
+    return rect;
+}
+
+CG_INLINE CGRect CGRectInset(CGRect rect, CGFloat dx, CGFloat dy)
+{
+    if (CGRectIsNull(rect)) {
+        return rect;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    if (rect.size.width < 2 * dx || rect.size.height < 2 * dy) {
+        return CGRectNull;
+    }
+
+    return CGRectMake(rect.origin.x + dx, rect.origin.y + dy, rect.size.width - 2 * dx, rect.size.height - 2 * dy);
+}
+
+CG_INLINE CGRect CGRectIntegral(CGRect rect)
+{
+    if (CGRectIsNull(rect)) {
+        return rect;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    CGFloat minX = floor(rect.origin.x);
+    CGFloat minY = floor(rect.origin.y);
+    CGFloat maxX = ceil(rect.origin.x + rect.size.width);
+    CGFloat maxY = ceil(rect.origin.y + rect.size.height);
+
+    return CGRectMake(minX, minY, maxX - minX, maxY - minY);
+}
+
+CG_INLINE CGRect CGRectUnion(CGRect rect1, CGRect rect2)
+{
+    if (CGRectIsNull(rect1)) {
+        return CGRectStandardize(rect2);
+    }
+
+    if (CGRectIsNull(rect2)) {
+        return CGRectStandardize(rect1);
+    }
+
+    CGFloat minX = fmin(CGRectGetMinX(rect1), CGRectGetMinX(rect2));
+    CGFloat minY = fmin(CGRectGetMinY(rect1), CGRectGetMinY(rect2));
+    CGFloat maxX = fmax(CGRectGetMaxX(rect1), CGRectGetMaxX(rect2));
+    CGFloat maxY = fmax(CGRectGetMaxY(rect1), CGRectGetMaxY(rect2));
+
+    return CGRectMake(minX, minY, maxX - minX, maxY - minY);
+}
+
+CG_INLINE CGRect CGRectIntersection(CGRect rect1, CGRect rect2)
+{
+    if (CGRectIsNull(rect1) || CGRectIsNull(rect2)) {
+        return CGRectNull;
+    }
+
+    CGFloat minX = fmax(CGRectGetMinX(rect1), CGRectGetMinX(rect2));
+    CGFloat minY = fmax(CGRectGetMinY(rect1), CGRectGetMinY(rect2));
+    CGFloat maxX = fmin(CGRectGetMaxX(rect1), CGRectGetMaxX(rect2));
+    CGFloat maxY = fmin(CGRectGetMaxY(rect1), CGRectGetMaxY(rect2));
+
+    if (maxX < minX || maxY < minY) {
+        return CGRectNull;
+    }
+
+    return CGRectMake(minX, minY, maxX - minX, maxY - minY);
+}
+
+CG_INLINE void CGRectDivide(CGRect rect, CGRect *slice, CGRect *remainder, CGFloat amount, CGRectEdge edge)
+{
+    if (CGRectIsNull(rect)) {
+        *slice = CGRectNull;
+        *remainder = CGRectNull;
+        return;
+    }
+
+    rect = CGRectStandardize(rect);
+    *slice = rect;
+    *remainder = rect;
+
+    switch (edge) {
+        case CGRectMinXEdge:
+        case CGRectMaxXEdge:
+            amount = fmin(fmax(amount, 0), rect.size.width);
+            slice->size.width = amount;
+            remainder->size.width -= amount;
+
+            if (edge == CGRectMinXEdge) {
+                remainder->origin.x += amount;
+            } else {
+                slice->origin.x += remainder->size.width;
+            }
+
+            break;
+        case CGRectMinYEdge:
+        case CGRectMaxYEdge:
+            amount = fmin(fmax(amount, 0), rect.size.height);
+            slice->size.height = amount;
+            remainder->size.height -= amount;
+
+            if (edge == CGRectMinYEdge) {
+                remainder->origin.y += amount;
+            } else {
+                slice->origin.y += remainder->size.height;
+            }
+
+            break;
+    }
+}
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef JSGeometryCoverage
+#define JSGeometryCoverage
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  A raster counting how many rects cover each pixel of an area, such as the frames drawn
+ *  on a screen, to find overdraw
+ *
+ *  @discussion counts holds width * height counts, row by row, starting with the row at
+ *  the minimum y of bounds. Each pixel is pixelSize points wide and tall, and a rect covers
+ *  the pixels whose center lies within it, so that rects sharing an edge never cover the
+ *  same pixel.
+ *
+ *  A raster should be initialized using JSGCoverageRasterInit, and destroyed using
+ *  JSGCoverageRasterDestroy once it's no longer needed.
+ */
+typedef struct {
+    CGRect bounds;
+    CGFloat pixelSize;
+    size_t width;
+    size_t height;
+    uint32_t *counts;
+    int32_t *differences;
+} JSGCoverageRaster;
+
+/**
+ *  Summary statistics of a coverage raster
+ *
+ *  @discussion coveredPixelCount is the number of pixels covered at least once, and
+ *  overdrawnPixelCount the number of pixels covered more than once. totalCount is the sum
+ *  of all counts, so totalCount / coveredPixelCount is the average coverage of covered
+ *  pixels.
+ */
+typedef struct {
+    size_t pixelCount;
+    size_t coveredPixelCount;
+    size_t overdrawnPixelCount;
+    uint64_t totalCount;
+    uint32_t maximumCount;
+} JSGCoverageStatistics;
+
+#pragma mark - Private functions
+
+/**
+ *  Convert a coordinate to the index of the first pixel whose center lies after it,
+ *  clamped to the pixels of the raster
+ */
+JSG_INLINE size_t JSGCoverageRasterGetPixel(CGFloat coordinate, CGFloat origin, CGFloat pixelSize, size_t pixelCount)
+{
+    CGFloat pixel = ceil((coordinate - origin) / pixelSize - 0.5);
+
+    return !(pixel > 0) ? 0 : pixel >= (CGFloat)pixelCount ? pixelCount : (size_t)pixel;
+}
+
+#pragma mark - Coverage functions
+
+/**
+ *  Initialize a coverage raster with all counts set to 0
+ *
+ *  @param raster The raster to initialize
+ *  @param bounds The area covered by the raster
+ *  @param pixelSize The size of each pixel, in points. Pass 1 for a raster of points, or
+ *  1 / the screen scale for a raster of screen pixels.
+ *
+ *  @return Whether the raster could be initialized. This is only false if memory could not
+ *  be allocated.
+ */
+JSG_INLINE bool JSGCoverageRasterInit(JSGCoverageRaster *raster, CGRect bounds, CGFloat pixelSize)
+{
+    memset(raster, 0, sizeof(JSGCoverageRaster));
+    bounds = CGRectStandardize(bounds);
+
+    CGFloat width = ceil(bounds.size.width / pixelSize);
+    CGFloat height = ceil(bounds.size.height / pixelSize);
+
+    raster->bounds = bounds;
+    raster->pixelSize = pixelSize;
+    raster->width = width > 0 ? (size_t)width : 0;
+    raster->height = height > 0 ? (size_t)height : 0;
+    raster->counts = (uint32_t *)calloc(raster->width * raster->height + 1, sizeof(uint32_t));
+    raster->differences = (int32_t *)calloc((raster->width + 1) * (raster->height + 2), sizeof(int32_t));
+
+    if (!raster->counts || !raster->differences) {
+        free(raster->counts);
+        free(raster->differences);
+        memset(raster, 0, sizeof(JSGCoverageRaster));
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Destroy a coverage raster, freeing all of its memory
+ *
+ *  @param raster The raster to destroy
+ */
+JSG_INLINE void JSGCoverageRasterDestroy(JSGCoverageRaster *raster)
+{
+    free(raster->counts);
+    free(raster->differences);
+    memset(raster, 0, sizeof(JSGCoverageRaster));
+}
+
+/**
+ *  Reset all counts of a coverage raster to 0
+ *
+ *  @param raster The raster to clear
+ */
+JSG_INLINE void JSGCoverageRasterClear(JSGCoverageRaster *raster)
+{
+    memset(raster->counts, 0, raster->width * raster->height * sizeof(uint32_t));
+}
+
+/**
+ *  Add the coverage of all rects in a rect array to the counts of a coverage raster
+ *
+ *  @param raster The raster to add the coverage to
+ *  @param rects The rects to add, which may lie partially or entirely outside the raster
+ *
+ *  @discussion Rather than filling the pixels of each rect, each rect only adds +1 & -1 to
+ *  the 4 corners of a 2D difference array, and summing the differences up then gives the
+ *  counts of all pixels at once. This takes O(rects + pixels) time, however large or
+ *  overlapping the rects are.
+ *
+ *  The differences of each row are added to the column sums of all rows above it, in a pass
+ *  that the compiler can vectorize & that clears the differences for the next call, then
+ *  a running sum along the column sums gives the coverage of each pixel of the row.
+ */
+JSG_INLINE void JSGCoverageRasterAddRects(JSGCoverageRaster *raster, const JSGRectArray *rects)
+{
+    size_t width = raster->width;
+    size_t height = raster->height;
+    size_t stride = width + 1;
+    int32_t *differences = raster->differences;
+    uint32_t *counts = raster->counts;
+    CGFloat originX = raster->bounds.origin.x;
+    CGFloat originY = raster->bounds.origin.y;
+    CGFloat pixelSize = raster->pixelSize;
+
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < rects->count; i++) {
+        CGFloat x = rects->x[i];
+        CGFloat y = rects->y[i];
+        CGFloat maxX = x + rects->width[i];
+        CGFloat maxY = y + rects->height[i];
+        size_t firstColumn = JSGCoverageRasterGetPixel(x < maxX ? x : maxX, originX, pixelSize, width);
+        size_t endColumn = JSGCoverageRasterGetPixel(x < maxX ? maxX : x, originX, pixelSize, width);
+        size_t firstRow = JSGCoverageRasterGetPixel(y < maxY ? y : maxY, originY, pixelSize, height);
+        size_t endRow = JSGCoverageRasterGetPixel(y < maxY ? maxY : y, originY, pixelSize, height);
+
+        if (firstColumn >= endColumn || firstRow >= endRow) {
+            continue;
+        }
+
+        differences[firstRow * stride + firstColumn]++;
+        differences[firstRow * stride + endColumn]--;
+        differences[endRow * stride + firstColumn]--;
+        differences[endRow * stride + endColumn]++;
+    }
+
+    // The row after the last one holds the column sums, which stay in cache
+    int32_t *columnSums = differences + (height + 1) * stride;
+    memset(columnSums, 0, stride * sizeof(int32_t));
+
+    for (size_t row = 0; row < height; row++) {
+        int32_t *rowDifferences = differences + row * stride;
+        uint32_t *rowCounts = counts + row * width;
+        int32_t coverage = 0;
+
+        for (size_t column = 0; column < width; column++) {
+            columnSums[column] += rowDifferences[column];
+            rowDifferences[column] = 0;
+        }
+
+        for (size_t column = 0; column < width; column++) {
+            coverage += columnSums[column];
+            rowCounts[column] += (uint32_t)coverage;
+        }
+    }
+
+    // The last column & row of differences are never summed up, only cleared
+    for (size_t row = 0; row < height; row++) {
+        differences[row * stride + width] = 0;
+    }
+
+    memset(differences + height * stride, 0, stride * sizeof(int32_t));
+}
+
+/**
+ *  Get the number of rects covering the pixel of a coverage raster that contains a point
+ *
+ *  @param raster The raster to read from
+ *  @param point The point to look up
+ *
+ *  @return The number of rects covering the pixel, or 0 if the point is outside the raster
+ */
+JSG_INLINE uint32_t JSGCoverageRasterGetCount(const JSGCoverageRaster *raster, CGPoint point)
+{
+    CGFloat column = floor((point.x - raster->bounds.origin.x) / raster->pixelSize);
+    CGFloat row = floor((point.y - raster->bounds.origin.y) / raster->pixelSize);
+
+    if (!(column >= 0 && column < (CGFloat)raster->width && row >= 0 && row < (CGFloat)raster->height)) {
+        return 0;
+    }
+
+    return raster->counts[(size_t)row * raster->width + (size_t)column];
+}
+
+/**
+ *  Compute the summary statistics of a coverage raster
+ *
+ *  @param raster The raster to summarize
+ *  @param statistics The statistics to write the result to
+ *  @param histogram An optional array of histogramCount pixel counts. Element i is set to
+ *  the number of pixels covered exactly i times, and the last element to the number of
+ *  pixels covered at least histogramCount - 1 times. Pass NULL to skip the histogram.
+ *  @param histogramCount The number of elements in histogram
+ */
+JSG_INLINE void JSGCoverageRasterGetStatistics(const JSGCoverageRaster *raster, JSGCoverageStatistics *statistics, size_t *histogram, size_t histogramCount)
+{
+    size_t pixelCount = raster->width * raster->height;
+    size_t uncoveredPixelCount = 0;
+    size_t singlePixelCount = 0;
+    uint64_t totalCount = 0;
+    uint32_t maximumCount = 0;
+
+    if (histogram) {
+        memset(histogram, 0, histogramCount * sizeof(size_t));
+    }
+
+    for (size_t i = 0; i < pixelCount; i++) {
+        uint32_t count = raster->counts[i];
+
+        uncoveredPixelCount += count == 0;
+        singlePixelCount += count == 1;
+        totalCount += count;
+        maximumCount = count > maximumCount ? count : maximumCount;
+    }
+
+    if (histogram && histogramCount) {
+        for (size_t i = 0; i < pixelCount; i++) {
+            uint32_t count = raster->counts[i];
+            histogram[count < histogramCount - 1 ? count : histogramCount - 1]++;
+        }
+    }
+
+    statistics->pixelCount = pixelCount;
+    statistics->coveredPixelCount = pixelCount - uncoveredPixelCount;
+    statistics->overdrawnPixelCount = pixelCount - uncoveredPixelCount - singlePixelCount;
+    statistics->totalCount = totalCount;
+    statistics->maximumCount = maximumCount;
+}
+
+#endif
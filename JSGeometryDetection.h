@@ -0,0 +1,361 @@
+#ifndef JSGeometryDetection
+#define JSGeometryDetection
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+#include "JSGeometrySorting.h"
+
+#pragma mark - Enums
+
+/**
+ *  Enum describing the ways in which soft non-maximum suppression can decay scores
+ *
+ *  @discussion With linear decay, the score of a box that overlaps a selected box by more
+ *  than a threshold is multiplied by (1 - IoU). With gaussian decay, the score of every box
+ *  is multiplied by exp(-IoU² / sigma).
+ */
+typedef enum : NSUInteger {
+    JSGSoftSuppressionLinear,
+    JSGSoftSuppressionGaussian
+} JSGSoftSuppression;
+
+#pragma mark - Private functions
+
+/**
+ *  Compute the intersection over union of a rect with a range of rects in a rect array
+ */
+JSG_INLINE void JSGRectArrayGetIntersectionOverUnionInRange(const JSGRectArray *boxes, size_t start, size_t end, CGRect rect, CGFloat *ious)
+{
+    const CGFloat *xs = boxes->x;
+    const CGFloat *ys = boxes->y;
+    const CGFloat *widths = boxes->width;
+    const CGFloat *heights = boxes->height;
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    CGFloat area = rect.size.width * rect.size.height;
+
+    for (size_t i = start; i < end; i++) {
+        CGFloat left = xs[i] > minX ? xs[i] : minX;
+        CGFloat top = ys[i] > minY ? ys[i] : minY;
+        CGFloat right = xs[i] + widths[i] < maxX ? xs[i] + widths[i] : maxX;
+        CGFloat bottom = ys[i] + heights[i] < maxY ? ys[i] + heights[i] : maxY;
+        CGFloat intersection = (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+        CGFloat unionArea = area + widths[i] * heights[i] - intersection;
+
+        ious[i - start] = unionArea > 0 ? intersection / unionArea : 0;
+    }
+}
+
+#pragma mark - Intersection over union functions
+
+/**
+ *  Return the intersection over union (also known as the Jaccard index) of two rects
+ *
+ *  @param rectA The first rect
+ *  @param rectB The second rect
+ *
+ *  @discussion The result is the area of the intersection of the rects, divided by the area
+ *  of their union, ranging from 0 (no overlap) to 1 (equal rects). If both rects are empty,
+ *  the result is 0.
+ */
+JSG_INLINE CGFloat JSGRectIntersectionOverUnion(CGRect rectA, CGRect rectB)
+{
+    rectA = CGRectStandardize(rectA);
+    rectB = CGRectStandardize(rectB);
+
+    CGFloat left = fmax(rectA.origin.x, rectB.origin.x);
+    CGFloat top = fmax(rectA.origin.y, rectB.origin.y);
+    CGFloat right = fmin(rectA.origin.x + rectA.size.width, rectB.origin.x + rectB.size.width);
+    CGFloat bottom = fmin(rectA.origin.y + rectA.size.height, rectB.origin.y + rectB.size.height);
+    CGFloat intersection = (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+    CGFloat unionArea = rectA.size.width * rectA.size.height + rectB.size.width * rectB.size.height - intersection;
+
+    return unionArea > 0 ? intersection / unionArea : 0;
+}
+
+/**
+ *  Compute the intersection over union of a rect with every rect in a rect array
+ *
+ *  @param boxes The rects to compare the rect with
+ *  @param rect The rect to compare
+ *  @param ious The array to write the results to. Must have room for the array's count.
+ *
+ *  @see JSGRectIntersectionOverUnion
+ */
+JSG_INLINE void JSGRectArrayGetIntersectionOverUnion(const JSGRectArray *boxes, CGRect rect, CGFloat *ious)
+{
+    JSGRectArrayGetIntersectionOverUnionInRange(boxes, 0, boxes->count, CGRectStandardize(rect), ious);
+}
+
+/**
+ *  Compute the intersection over union of every pair of rects in a rect array
+ *
+ *  @param boxes The rects to compare
+ *  @param matrix The array to write the results to, in row-major order, so that the result
+ *  for rects i & j is found at index i * count + j. Must have room for count * count values.
+ *
+ *  @discussion Since the matrix is symmetric, only its upper triangle is computed, and then
+ *  mirrored.
+ */
+JSG_INLINE void JSGRectArrayGetIntersectionOverUnionMatrix(const JSGRectArray *boxes, CGFloat *matrix)
+{
+    size_t count = boxes->count;
+
+    for (size_t i = 0; i < count; i++) {
+        CGFloat *row = matrix + i * count;
+        CGRect rect = JSGRectArrayGetRect(boxes, i);
+
+        for (size_t j = 0; j < i; j++) {
+            row[j] = matrix[j * count + i];
+        }
+
+        row[i] = rect.size.width * rect.size.height > 0 ? 1 : 0;
+        JSGRectArrayGetIntersectionOverUnionInRange(boxes, i + 1, count, rect, row + i + 1);
+    }
+}
+
+#pragma mark - Non-maximum suppression functions
+
+/**
+ *  Perform greedy non-maximum suppression over a set of scored boxes
+ *
+ *  @param boxes The boxes to suppress
+ *  @param scores The score of each box
+ *  @param iouThreshold The intersection over union above which a box is suppressed by a
+ *  box with a higher score
+ *  @param keptIndices The array to write the indices of the kept boxes to, by descending
+ *  score. Must have room for the array's count.
+ *  @param keptCount Set to the number of kept boxes
+ *
+ *  @return Whether suppression could be performed. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion Boxes are visited by descending score (ties are broken by index). Each box
+ *  that hasn't been suppressed yet is kept, and suppresses all lower scored boxes that it
+ *  overlaps by more than the threshold. The boxes are first sorted into a contiguous
+ *  structure of arrays, so that each box can be tested against all lower scored boxes
+ *  in a single branch-free, vectorizable pass.
+ */
+JSG_INLINE bool JSGRectArrayNonMaximumSuppression(const JSGRectArray *boxes, const CGFloat *scores, CGFloat iouThreshold, size_t *keptIndices, size_t *keptCount)
+{
+    size_t count = boxes->count;
+    *keptCount = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+    CGFloat *sorted = (CGFloat *)malloc(count * 5 * sizeof(CGFloat));
+    unsigned char *suppressed = (unsigned char *)calloc(count, 1);
+
+    if (!order || !sorted || !suppressed) {
+        free(order);
+        free(sorted);
+        free(suppressed);
+
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = scores[i];
+        order[i].index = i;
+    }
+
+    if (!JSGScoredIndicesSort(order, count)) {
+        free(order);
+        free(sorted);
+        free(suppressed);
+
+        return false;
+    }
+
+    CGFloat *minXs = sorted;
+    CGFloat *minYs = sorted + count;
+    CGFloat *maxXs = sorted + count * 2;
+    CGFloat *maxYs = sorted + count * 3;
+    CGFloat *areas = sorted + count * 4;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = order[i].index;
+        minXs[i] = boxes->x[index];
+        minYs[i] = boxes->y[index];
+        maxXs[i] = boxes->x[index] + boxes->width[index];
+        maxYs[i] = boxes->y[index] + boxes->height[index];
+        areas[i] = boxes->width[index] * boxes->height[index];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (suppressed[i]) {
+            continue;
+        }
+
+        keptIndices[(*keptCount)++] = order[i].index;
+
+        CGFloat minX = minXs[i];
+        CGFloat minY = minYs[i];
+        CGFloat maxX = maxXs[i];
+        CGFloat maxY = maxYs[i];
+        CGFloat area = areas[i];
+
+        // IoU > threshold is tested as intersection > threshold * union, to avoid divisions
+        for (size_t j = i + 1; j < count; j++) {
+            CGFloat left = minXs[j] > minX ? minXs[j] : minX;
+            CGFloat top = minYs[j] > minY ? minYs[j] : minY;
+            CGFloat right = maxXs[j] < maxX ? maxXs[j] : maxX;
+            CGFloat bottom = maxYs[j] < maxY ? maxYs[j] : maxY;
+            CGFloat intersection = (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+
+            suppressed[j] |= intersection > iouThreshold * (area + areas[j] - intersection);
+        }
+    }
+
+    free(order);
+    free(sorted);
+    free(suppressed);
+
+    return true;
+}
+
+/**
+ *  Perform soft non-maximum suppression over a set of scored boxes
+ *
+ *  @param boxes The boxes to suppress
+ *  @param scores The score of each box
+ *  @param method How to decay the scores of overlapping boxes
+ *  @param parameter For linear decay, the intersection over union above which scores are
+ *  decayed. For gaussian decay, the sigma of the gaussian.
+ *  @param scoreThreshold The score below which a box is discarded
+ *  @param keptIndices The array to write the indices of the kept boxes to, in the order in
+ *  which they were selected. Must have room for the array's count.
+ *  @param keptScores The array to write the decayed score of each kept box to, or NULL. Must
+ *  have room for the array's count.
+ *  @param keptCount Set to the number of kept boxes
+ *
+ *  @return Whether suppression could be performed. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion Rather than discarding boxes that overlap a selected box, their scores are
+ *  decayed according to how much they overlap it. The box with the highest remaining score
+ *  is selected in each round (ties are broken by index), until no box with a score of at
+ *  least the threshold remains.
+ *
+ *  @see JSGSoftSuppression
+ */
+JSG_INLINE bool JSGRectArraySoftNonMaximumSuppression(const JSGRectArray *boxes, const CGFloat *scores, JSGSoftSuppression method, CGFloat parameter, CGFloat scoreThreshold, size_t *keptIndices, CGFloat *keptScores, size_t *keptCount)
+{
+    size_t count = boxes->count;
+    *keptCount = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    CGFloat *working = (CGFloat *)malloc(count * 6 * sizeof(CGFloat));
+    size_t *indices = (size_t *)malloc(count * sizeof(size_t));
+
+    if (!working || !indices) {
+        free(working);
+        free(indices);
+
+        return false;
+    }
+
+    CGFloat *minXs = working;
+    CGFloat *minYs = working + count;
+    CGFloat *maxXs = working + count * 2;
+    CGFloat *maxYs = working + count * 3;
+    CGFloat *areas = working + count * 4;
+    CGFloat *remainingScores = working + count * 5;
+    size_t remaining = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        minXs[remaining] = boxes->x[i];
+        minYs[remaining] = boxes->y[i];
+        maxXs[remaining] = boxes->x[i] + boxes->width[i];
+        maxYs[remaining] = boxes->y[i] + boxes->height[i];
+        areas[remaining] = boxes->width[i] * boxes->height[i];
+        remainingScores[remaining] = scores[i];
+        indices[remaining] = i;
+        remaining += scores[i] >= scoreThreshold;
+    }
+
+    while (remaining > 0) {
+        size_t best = 0;
+
+        for (size_t i = 1; i < remaining; i++) {
+            if (remainingScores[i] > remainingScores[best] || (remainingScores[i] == remainingScores[best] && indices[i] < indices[best])) {
+                best = i;
+            }
+        }
+
+        if (keptScores) {
+            keptScores[*keptCount] = remainingScores[best];
+        }
+
+        keptIndices[(*keptCount)++] = indices[best];
+
+        CGFloat minX = minXs[best];
+        CGFloat minY = minYs[best];
+        CGFloat maxX = maxXs[best];
+        CGFloat maxY = maxYs[best];
+        CGFloat area = areas[best];
+
+        remaining--;
+        minXs[best] = minXs[remaining];
+        minYs[best] = minYs[remaining];
+        maxXs[best] = maxXs[remaining];
+        maxYs[best] = maxYs[remaining];
+        areas[best] = areas[remaining];
+        remainingScores[best] = remainingScores[remaining];
+        indices[best] = indices[remaining];
+
+        size_t kept = 0;
+
+        for (size_t i = 0; i < remaining; i++) {
+            CGFloat left = minXs[i] > minX ? minXs[i] : minX;
+            CGFloat top = minYs[i] > minY ? minYs[i] : minY;
+            CGFloat right = maxXs[i] < maxX ? maxXs[i] : maxX;
+            CGFloat bottom = maxYs[i] < maxY ? maxYs[i] : maxY;
+            CGFloat intersection = (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+            CGFloat unionArea = area + areas[i] - intersection;
+            CGFloat iou = unionArea > 0 ? intersection / unionArea : 0;
+            CGFloat weight;
+
+            if (method == JSGSoftSuppressionGaussian) {
+                weight = exp(-(iou * iou) / parameter);
+            } else {
+                weight = iou > parameter ? 1 - iou : 1;
+            }
+
+            CGFloat score = remainingScores[i] * weight;
+
+            // Compact the remaining boxes in place, dropping the ones below the threshold
+            minXs[kept] = minXs[i];
+            minYs[kept] = minYs[i];
+            maxXs[kept] = maxXs[i];
+            maxYs[kept] = maxYs[i];
+            areas[kept] = areas[i];
+            remainingScores[kept] = score;
+            indices[kept] = indices[i];
+            kept += score >= scoreThreshold;
+        }
+
+        remaining = kept;
+    }
+
+    free(working);
+    free(indices);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,559 @@
+#ifndef JSGeometryEmptySpace
+#define JSGeometryEmptySpace
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+#include "JSGeometrySorting.h"
+
+#pragma mark - Types
+
+/**
+ *  The empty space within a container rect, around a set of obstacles
+ *
+ *  @discussion The empty space is maintained as the set of all maximal empty rects: rects
+ *  within the container that don't overlap any obstacle, and that can't be grown in any
+ *  direction without overlapping one. Any empty area large enough to hold a window, sticker
+ *  or annotation is therefore contained in at least one of them.
+ *
+ *  Obstacles are numbered in the order in which they're added, and their rects can be read
+ *  from the obstacles array. Removed obstacles keep their index, with an empty rect.
+ *
+ *  An empty space should be initialized using JSGEmptySpaceInit, and destroyed using
+ *  JSGEmptySpaceDestroy once it's no longer needed.
+ */
+typedef struct {
+    CGRect container;
+    JSGRectArray obstacles;
+    JSGRectArray emptyRects;
+    JSGRectArray pieces;
+    JSGRectArray neighbors;
+    size_t *touching;
+    unsigned char *touchingMask;
+    size_t touchingCapacity;
+    unsigned char *applied;
+    size_t appliedCapacity;
+} JSGEmptySpace;
+
+#pragma mark - Private functions
+
+/**
+ *  Split the empty rects of an array from a given index on that overlap a rect around it,
+ *  keeping the array made of maximal empty rects only
+ */
+JSG_INLINE bool JSGEmptySpaceSplit(JSGEmptySpace *space, JSGRectArray *emptyRects, size_t start, CGRect rect)
+{
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    JSGRectArray *pieces = &space->pieces;
+    JSGRectArray *neighbors = &space->neighbors;
+    CGFloat *xs = emptyRects->x;
+    CGFloat *ys = emptyRects->y;
+    CGFloat *widths = emptyRects->width;
+    CGFloat *heights = emptyRects->height;
+
+    pieces->count = 0;
+    neighbors->count = 0;
+
+    if (rect.size.width <= 0 || rect.size.height <= 0) {
+        return true;
+    }
+
+    if (emptyRects->count > space->touchingCapacity) {
+        size_t capacity = emptyRects->count > space->touchingCapacity * 2 ? emptyRects->count : space->touchingCapacity * 2;
+        size_t *touching = (size_t *)realloc(space->touching, (capacity + 8) * sizeof(size_t));
+
+        if (!touching) {
+            return false;
+        }
+
+        space->touching = touching;
+
+        unsigned char *touchingMask = (unsigned char *)realloc(space->touchingMask, capacity + 8);
+
+        if (!touchingMask) {
+            return false;
+        }
+
+        space->touchingMask = touchingMask;
+        space->touchingCapacity = capacity;
+    }
+
+    // Finding the few empty rects that touch the rect is where almost all of the time goes,
+    // so it's done in a branch-free, vectorizable pass writing a mask, which is then
+    // scanned eight rects at a time
+    size_t *touching = space->touching;
+    unsigned char *touchingMask = space->touchingMask;
+    size_t touchingCount = 0;
+
+    for (size_t i = start; i < emptyRects->count; i++) {
+        touchingMask[i] = (xs[i] <= maxX) & (ys[i] <= maxY) & (xs[i] + widths[i] >= minX) & (ys[i] + heights[i] >= minY);
+    }
+
+    memset(touchingMask + emptyRects->count, 0, 8);
+
+    for (size_t i = start; i < emptyRects->count; i += 8) {
+        uint64_t mask;
+        memcpy(&mask, touchingMask + i, sizeof(mask));
+
+        if (!mask) {
+            continue;
+        }
+
+        for (size_t j = i; j < i + 8; j++) {
+            touching[touchingCount] = j;
+            touchingCount += touchingMask[j];
+        }
+    }
+
+    // Visiting the touching rects backwards lets split rects be replaced by the last rect,
+    // which has already been visited
+    for (size_t t = touchingCount; t-- > 0;) {
+        size_t i = touching[t];
+        CGFloat x = xs[i];
+        CGFloat y = ys[i];
+        CGFloat width = widths[i];
+        CGFloat height = heights[i];
+        CGFloat emptyMaxX = x + width;
+        CGFloat emptyMaxY = y + height;
+
+        if (x >= maxX || y >= maxY || emptyMaxX <= minX || emptyMaxY <= minY) {
+            // Empty rects that only touch the rect are the only ones that may contain the
+            // new pieces, since each piece lies along an edge of the rect
+            if (!JSGRectArraySetCount(neighbors, neighbors->count + 1)) {
+                return false;
+            }
+
+            neighbors->x[neighbors->count - 1] = x;
+            neighbors->y[neighbors->count - 1] = y;
+            neighbors->width[neighbors->count - 1] = width;
+            neighbors->height[neighbors->count - 1] = height;
+            continue;
+        }
+
+        size_t last = --emptyRects->count;
+        xs[i] = xs[last];
+        ys[i] = ys[last];
+        widths[i] = widths[last];
+        heights[i] = heights[last];
+
+        CGFloat pieceRects[4][4] = {
+            {x, y, minX - x, height},
+            {maxX, y, emptyMaxX - maxX, height},
+            {x, y, width, minY - y},
+            {x, maxY, width, emptyMaxY - maxY}
+        };
+
+        for (size_t j = 0; j < 4; j++) {
+            if (pieceRects[j][2] <= 0 || pieceRects[j][3] <= 0) {
+                continue;
+            }
+
+            if (!JSGRectArraySetCount(pieces, pieces->count + 1)) {
+                return false;
+            }
+
+            pieces->x[pieces->count - 1] = pieceRects[j][0];
+            pieces->y[pieces->count - 1] = pieceRects[j][1];
+            pieces->width[pieces->count - 1] = pieceRects[j][2];
+            pieces->height[pieces->count - 1] = pieceRects[j][3];
+        }
+    }
+
+    if (!JSGRectArrayReserve(emptyRects, emptyRects->count + pieces->count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pieces->count; i++) {
+        CGFloat x = pieces->x[i];
+        CGFloat y = pieces->y[i];
+        CGFloat pieceMaxX = x + pieces->width[i];
+        CGFloat pieceMaxY = y + pieces->height[i];
+        bool contained = false;
+
+        for (size_t j = 0; j < neighbors->count; j++) {
+            contained |= neighbors->x[j] <= x && neighbors->y[j] <= y && neighbors->x[j] + neighbors->width[j] >= pieceMaxX && neighbors->y[j] + neighbors->height[j] >= pieceMaxY;
+        }
+
+        // Pieces that contain each other are also pruned, keeping the first of equal pieces
+        for (size_t j = 0; j < pieces->count && !contained; j++) {
+            bool containedInPiece = pieces->x[j] <= x && pieces->y[j] <= y && pieces->x[j] + pieces->width[j] >= pieceMaxX && pieces->y[j] + pieces->height[j] >= pieceMaxY;
+            bool equal = pieces->x[j] == x && pieces->y[j] == y && pieces->width[j] == pieces->width[i] && pieces->height[j] == pieces->height[i];
+
+            contained = j != i && containedInPiece && (!equal || j < i);
+        }
+
+        if (!contained) {
+            size_t index = emptyRects->count++;
+            emptyRects->x[index] = x;
+            emptyRects->y[index] = y;
+            emptyRects->width[index] = pieces->width[i];
+            emptyRects->height[index] = pieces->height[i];
+        }
+    }
+
+    return true;
+}
+
+#pragma mark - Empty space functions
+
+/**
+ *  Initialize the empty space of a container without obstacles
+ *
+ *  @param space The empty space to initialize
+ *  @param container The rect within which to find empty space
+ *
+ *  @return Whether the empty space could be initialized. This is only false if memory could
+ *  not be allocated, in which case the empty space doesn't need to be destroyed.
+ */
+JSG_INLINE bool JSGEmptySpaceInit(JSGEmptySpace *space, CGRect container)
+{
+    memset(space, 0, sizeof(JSGEmptySpace));
+    space->container = CGRectStandardize(container);
+    JSGRectArrayInit(&space->obstacles);
+    JSGRectArrayInit(&space->emptyRects);
+    JSGRectArrayInit(&space->pieces);
+    JSGRectArrayInit(&space->neighbors);
+
+    if (space->container.size.width > 0 && space->container.size.height > 0) {
+        return JSGRectArrayAppend(&space->emptyRects, space->container);
+    }
+
+    return true;
+}
+
+/**
+ *  Destroy an empty space, freeing all of its memory
+ *
+ *  @param space The empty space to destroy
+ */
+JSG_INLINE void JSGEmptySpaceDestroy(JSGEmptySpace *space)
+{
+    JSGRectArrayDestroy(&space->obstacles);
+    JSGRectArrayDestroy(&space->emptyRects);
+    JSGRectArrayDestroy(&space->pieces);
+    JSGRectArrayDestroy(&space->neighbors);
+    free(space->touching);
+    free(space->touchingMask);
+    free(space->applied);
+    memset(space, 0, sizeof(JSGEmptySpace));
+}
+
+/**
+ *  Add an obstacle to an empty space
+ *
+ *  @param space The empty space to add the obstacle to
+ *  @param rect The rect of the obstacle, which will be stored in its standardized form
+ *
+ *  @return Whether the obstacle could be added. This is only false if memory could not be
+ *  allocated, in which case the empty space should be destroyed.
+ *
+ *  @discussion The index of the added obstacle is the number of obstacles that were added
+ *  before it. Only the maximal empty rects that touch the obstacle are updated: those that
+ *  it overlaps are split into the parts around it, which are kept if they aren't contained
+ *  in another maximal empty rect.
+ */
+JSG_INLINE bool JSGEmptySpaceAddObstacle(JSGEmptySpace *space, CGRect rect)
+{
+    if (!JSGRectArrayAppend(&space->obstacles, rect)) {
+        return false;
+    }
+
+    return JSGEmptySpaceSplit(space, &space->emptyRects, 0, JSGRectArrayGetRect(&space->obstacles, space->obstacles.count - 1));
+}
+
+/**
+ *  Add multiple obstacles to an empty space
+ *
+ *  @param space The empty space to add the obstacles to
+ *  @param rects The rects of the obstacles, which will be stored in their standardized form
+ *  @param count The number of obstacles
+ *
+ *  @return Whether the obstacles could be added. This is only false if memory could not be
+ *  allocated, in which case the empty space should be destroyed.
+ *
+ *  @discussion This gives the same result as adding the obstacles one by one, but much
+ *  faster for many obstacles. They're added from left to right, and the empty rects that
+ *  end before the next obstacle starts are set aside, since no later obstacle can touch
+ *  them. Only the empty rects around the sweep line are therefore visited.
+ */
+JSG_INLINE bool JSGEmptySpaceAddObstacles(JSGEmptySpace *space, const CGRect *rects, size_t count)
+{
+    JSGRectArray *obstacles = &space->obstacles;
+    size_t first = obstacles->count;
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (!JSGRectArrayReserve(obstacles, first + count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        JSGRectArrayAppend(obstacles, rects[i]);
+    }
+
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+
+    if (!order) {
+        return false;
+    }
+
+    // Sorting by descending negated minimum x gives ascending minimum x
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = -obstacles->x[first + i];
+        order[i].index = first + i;
+    }
+
+    if (!JSGScoredIndicesSort(order, count)) {
+        free(order);
+        return false;
+    }
+
+    JSGRectArray *emptyRects = &space->emptyRects;
+    size_t start = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!JSGEmptySpaceSplit(space, emptyRects, start, JSGRectArrayGetRect(obstacles, order[i].index))) {
+            free(order);
+            return false;
+        }
+
+        if (i + 1 == count) {
+            break;
+        }
+
+        CGFloat nextMinX = obstacles->x[order[i + 1].index];
+
+        for (size_t j = start; j < emptyRects->count; j++) {
+            if (emptyRects->x[j] + emptyRects->width[j] < nextMinX) {
+                CGRect finished = JSGRectArrayGetRect(emptyRects, j);
+                JSGRectArraySetRect(emptyRects, j, JSGRectArrayGetRect(emptyRects, start));
+                JSGRectArraySetRect(emptyRects, start, finished);
+                start++;
+            }
+        }
+    }
+
+    free(order);
+
+    return true;
+}
+
+/**
+ *  Remove an obstacle from an empty space
+ *
+ *  @param space The empty space to remove the obstacle from
+ *  @param obstacle The index of the obstacle
+ *
+ *  @return Whether the obstacle could be removed. This is only false if memory could not be
+ *  allocated, in which case the empty space should be destroyed.
+ *
+ *  @discussion Only the maximal empty rects that touch the obstacle can change. They're
+ *  replaced by the maximal empty rects that touch the obstacle once it's removed, which are
+ *  found by splitting the container around the obstacles closest to the removed obstacle,
+ *  keeping only the parts that touch it. The search area grows until no other obstacle can
+ *  split these parts.
+ */
+JSG_INLINE bool JSGEmptySpaceRemoveObstacle(JSGEmptySpace *space, size_t obstacle)
+{
+    JSGRectArray *obstacles = &space->obstacles;
+    CGRect rect = JSGRectArrayGetRect(obstacles, obstacle);
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+
+    obstacles->width[obstacle] = 0;
+    obstacles->height[obstacle] = 0;
+
+    if (rect.size.width <= 0 || rect.size.height <= 0) {
+        return true;
+    }
+
+    if (obstacles->count > space->appliedCapacity) {
+        unsigned char *applied = (unsigned char *)realloc(space->applied, obstacles->count);
+
+        if (!applied) {
+            return false;
+        }
+
+        space->applied = applied;
+        space->appliedCapacity = obstacles->count;
+    }
+
+    JSGRectArray local;
+    JSGRectArrayInit(&local);
+
+    if (!JSGRectArrayAppend(&local, space->container)) {
+        return false;
+    }
+
+    memset(space->applied, 0, obstacles->count);
+
+    CGFloat margin = rect.size.width > rect.size.height ? rect.size.width : rect.size.height;
+
+    for (;;) {
+        CGFloat areaMinX = minX - margin;
+        CGFloat areaMinY = minY - margin;
+        CGFloat areaMaxX = maxX + margin;
+        CGFloat areaMaxY = maxY + margin;
+
+        for (size_t i = 0; i < obstacles->count; i++) {
+            if (space->applied[i] || obstacles->x[i] >= areaMaxX || obstacles->y[i] >= areaMaxY || obstacles->x[i] + obstacles->width[i] <= areaMinX || obstacles->y[i] + obstacles->height[i] <= areaMinY) {
+                continue;
+            }
+
+            space->applied[i] = 1;
+
+            if (!JSGEmptySpaceSplit(space, &local, 0, JSGRectArrayGetRect(obstacles, i))) {
+                JSGRectArrayDestroy(&local);
+                return false;
+            }
+
+            // Only the parts that touch the removed obstacle are of interest
+            size_t keptCount = 0;
+
+            for (size_t j = 0; j < local.count; j++) {
+                bool touches = local.x[j] <= maxX && local.y[j] <= maxY && local.x[j] + local.width[j] >= minX && local.y[j] + local.height[j] >= minY;
+
+                local.x[keptCount] = local.x[j];
+                local.y[keptCount] = local.y[j];
+                local.width[keptCount] = local.width[j];
+                local.height[keptCount] = local.height[j];
+                keptCount += touches;
+            }
+
+            local.count = keptCount;
+        }
+
+        // Once the parts are within the search area, any obstacle that could split them has
+        // been applied
+        bool done = true;
+
+        for (size_t j = 0; j < local.count; j++) {
+            done &= local.x[j] >= areaMinX && local.y[j] >= areaMinY && local.x[j] + local.width[j] <= areaMaxX && local.y[j] + local.height[j] <= areaMaxY;
+        }
+
+        if (done) {
+            break;
+        }
+
+        margin *= 2;
+    }
+
+    JSGRectArray *emptyRects = &space->emptyRects;
+    size_t keptCount = 0;
+
+    for (size_t i = 0; i < emptyRects->count; i++) {
+        bool touches = emptyRects->x[i] <= maxX && emptyRects->y[i] <= maxY && emptyRects->x[i] + emptyRects->width[i] >= minX && emptyRects->y[i] + emptyRects->height[i] >= minY;
+
+        emptyRects->x[keptCount] = emptyRects->x[i];
+        emptyRects->y[keptCount] = emptyRects->y[i];
+        emptyRects->width[keptCount] = emptyRects->width[i];
+        emptyRects->height[keptCount] = emptyRects->height[i];
+        keptCount += !touches;
+    }
+
+    emptyRects->count = keptCount;
+
+    if (!JSGRectArrayReserve(emptyRects, keptCount + local.count)) {
+        JSGRectArrayDestroy(&local);
+        return false;
+    }
+
+    for (size_t i = 0; i < local.count; i++) {
+        size_t index = emptyRects->count++;
+        emptyRects->x[index] = local.x[i];
+        emptyRects->y[index] = local.y[i];
+        emptyRects->width[index] = local.width[i];
+        emptyRects->height[index] = local.height[i];
+    }
+
+    JSGRectArrayDestroy(&local);
+
+    return true;
+}
+
+/**
+ *  Move an obstacle of an empty space
+ *
+ *  @param space The empty space containing the obstacle
+ *  @param obstacle The index of the obstacle
+ *  @param rect The new rect of the obstacle, which will be stored in its standardized form
+ *
+ *  @return Whether the obstacle could be moved. This is only false if memory could not be
+ *  allocated, in which case the empty space should be destroyed.
+ */
+JSG_INLINE bool JSGEmptySpaceMoveObstacle(JSGEmptySpace *space, size_t obstacle, CGRect rect)
+{
+    if (!JSGEmptySpaceRemoveObstacle(space, obstacle)) {
+        return false;
+    }
+
+    JSGRectArraySetRect(&space->obstacles, obstacle, rect);
+
+    return JSGEmptySpaceSplit(space, &space->emptyRects, 0, JSGRectArrayGetRect(&space->obstacles, obstacle));
+}
+
+/**
+ *  Find the largest maximal empty rects of an empty space
+ *
+ *  @param space The empty space to search
+ *  @param minimumSize The size that the rects must be able to hold
+ *  @param maximumCount The maximum number of rects to find
+ *  @param rects The array to write the rects to, by descending area. Must have room for
+ *  maximumCount rects.
+ *  @param count Set to the number of rects that were found
+ *
+ *  @return Whether the rects could be found. This is only false if memory could not be
+ *  allocated.
+ */
+JSG_INLINE bool JSGEmptySpaceGetLargestRects(const JSGEmptySpace *space, CGSize minimumSize, size_t maximumCount, CGRect *rects, size_t *count)
+{
+    const JSGRectArray *emptyRects = &space->emptyRects;
+    *count = 0;
+
+    if (emptyRects->count == 0 || maximumCount == 0) {
+        return true;
+    }
+
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(emptyRects->count * sizeof(JSGScoredIndex));
+
+    if (!order) {
+        return false;
+    }
+
+    size_t candidateCount = 0;
+
+    for (size_t i = 0; i < emptyRects->count; i++) {
+        order[candidateCount].score = emptyRects->width[i] * emptyRects->height[i];
+        order[candidateCount].index = i;
+        candidateCount += emptyRects->width[i] >= minimumSize.width && emptyRects->height[i] >= minimumSize.height;
+    }
+
+    if (!JSGScoredIndicesSort(order, candidateCount)) {
+        free(order);
+        return false;
+    }
+
+    *count = candidateCount < maximumCount ? candidateCount : maximumCount;
+
+    for (size_t i = 0; i < *count; i++) {
+        rects[i] = JSGRectArrayGetRect(emptyRects, order[i].index);
+    }
+
+    free(order);
+
+    return true;
+}
+
+#endif
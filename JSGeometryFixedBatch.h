@@ -0,0 +1,109 @@
+#ifndef JSGeometryFixedBatch
+#define JSGeometryFixedBatch
+
+#include <stddef.h>
+
+#include "JSGeometry.h"
+
+/**
+ *  Fixed width batch functions
+ *
+ *  @discussion These functions are the fixed width counterparts of the JSGRects* functions
+ *  found in JSGeometryBatch.h, generated for batches of exactly 4, 8 and 16 rects. Since
+ *  the number of rects is known at compile time, the loops are fully unrolled, and all
+ *  input rects & values are loaded before any result is stored, which lets the compiler
+ *  keep a whole batch in registers without having to account for the output aliasing
+ *  the input.
+ *
+ *  Each function is named after its generic counterpart, with the batch width following
+ *  "JSGRects", for example JSGRects8ChangeWidth. Use JSGRectsFixed to pick a function by
+ *  width, for example JSGRectsFixed(8, ChangeWidth)(rects, newWidths).
+ *
+ *  Additional widths can be generated using JSG_DEFINE_FIXED_BATCH_FUNCTIONS.
+ */
+
+#if defined(__clang__)
+#define JSG_UNROLL _Pragma("clang loop unroll(full)")
+#elif defined(__GNUC__)
+#define JSG_UNROLL _Pragma("GCC unroll 16")
+#else
+#define JSG_UNROLL
+#endif
+
+/**
+ *  Return the fixed width batch function for an operation
+ *
+ *  @param N The batch width. Must be a literal for which the functions have been generated.
+ *  @param operation The operation name, for example ChangeWidth or Scale
+ */
+#define JSGRectsFixed(N, operation) JSGRects##N##operation
+
+#define JSG_FIXED_BATCH_APPLY(N, expression) \
+    CGRect results[N]; \
+    JSG_UNROLL \
+    for (size_t i = 0; i < N; i++) { \
+        results[i] = expression; \
+    } \
+    JSG_UNROLL \
+    for (size_t i = 0; i < N; i++) { \
+        rects[i] = results[i]; \
+    }
+
+/**
+ *  Generate all fixed width batch functions for a given width
+ *
+ *  @param N The batch width
+ */
+#define JSG_DEFINE_FIXED_BATCH_FUNCTIONS(N) \
+    JSG_INLINE void JSGRects##N##ChangeOrigin(CGRect *rects, const CGPoint *newOrigins) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeOrigin(rects[i], newOrigins[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##ChangeOriginX(CGRect *rects, const CGFloat *newOriginXs) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeOriginX(rects[i], newOriginXs[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##ChangeOriginY(CGRect *rects, const CGFloat *newOriginYs) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeOriginY(rects[i], newOriginYs[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##ChangeSize(CGRect *rects, const CGSize *newSizes) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeSize(rects[i], newSizes[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##ChangeWidth(CGRect *rects, const CGFloat *newWidths) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeWidth(rects[i], newWidths[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##ChangeHeight(CGRect *rects, const CGFloat *newHeights) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectChangeHeight(rects[i], newHeights[i])) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##Scale(CGRect *rects, CGFloat scaleX, CGFloat scaleY) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectScale(rects[i], scaleX, scaleY)) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##GetCenterInRect(CGRect *rects, CGRect rectB) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectGetCenterInRect(rects[i], rectB)) \
+    } \
+    \
+    JSG_INLINE void JSGRects##N##AlignInRectForCoordinateSystemOrigin(CGRect *rects, CGRect rectB, JSGRectAlignment alignment, JSGCoordinateSystemOrigin coordinateSystemOrigin) \
+    { \
+        JSG_FIXED_BATCH_APPLY(N, JSGRectAlignInRectForCoordinateSystemOrigin(rects[i], rectB, alignment, coordinateSystemOrigin)) \
+    }
+
+#pragma mark - Fixed width CGRect batch functions
+
+JSG_DEFINE_FIXED_BATCH_FUNCTIONS(4)
+JSG_DEFINE_FIXED_BATCH_FUNCTIONS(8)
+JSG_DEFINE_FIXED_BATCH_FUNCTIONS(16)
+
+#endif
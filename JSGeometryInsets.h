@@ -0,0 +1,216 @@
+#ifndef JSGeometryInsets
+#define JSGeometryInsets
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  The distances by which to move each edge of a rect inwards. Negative values move edges
+ *  outwards.
+ *
+ *  @discussion Which of the rect's y edges is the top one depends on the coordinate system
+ *  origin that the insets are applied for.
+ */
+typedef struct {
+    CGFloat top;
+    CGFloat left;
+    CGFloat bottom;
+    CGFloat right;
+} JSGEdgeInsets;
+
+#pragma mark - Private functions
+
+/**
+ *  Move the minimum & maximum edges of a range of rects along one axis, collapsing ranges
+ *  whose edges cross over to their midpoint
+ */
+JSG_INLINE void JSGRectArrayInsetAxis(CGFloat *origins, CGFloat *sizes, size_t count, CGFloat minimumInset, CGFloat maximumInset)
+{
+    CGFloat totalInset = minimumInset + maximumInset;
+
+    // Half the size is compared rather than the size, so that it's computed unconditionally;
+    // the compiler won't move floating point operations out of a conditional to vectorize
+    for (size_t i = 0; i < count; i++) {
+        CGFloat size = sizes[i] - totalInset;
+        CGFloat halfSize = size * 0.5;
+
+        origins[i] += minimumInset + (halfSize < 0 ? halfSize : 0);
+        sizes[i] = size < 0 ? 0 : size;
+    }
+}
+
+/**
+ *  Divide a range of rects along one axis, into slices of a given size taken from their
+ *  minimum or maximum edge & the remainders
+ */
+JSG_INLINE void JSGRectArrayDivideAxis(const CGFloat *origins, const CGFloat *sizes, size_t count, CGFloat amount, bool fromMaximum, CGFloat *sliceOrigins, CGFloat *sliceSizes, CGFloat *remainderOrigins, CGFloat *remainderSizes)
+{
+    amount = amount > 0 ? amount : 0;
+
+    // Whichever output replaces the rects being divided is written last
+    bool slicesLast = sliceOrigins == origins;
+
+    for (size_t pass = 0; pass < 2; pass++) {
+        if ((pass == 1) == slicesLast) {
+            if (sliceOrigins) {
+                for (size_t i = 0; i < count; i++) {
+                    CGFloat origin = origins[i];
+                    CGFloat size = sizes[i];
+                    CGFloat sliceSize = amount < size ? amount : size;
+
+                    sliceOrigins[i] = fromMaximum ? origin + size - sliceSize : origin;
+                    sliceSizes[i] = sliceSize;
+                }
+            }
+        } else if (remainderOrigins) {
+            for (size_t i = 0; i < count; i++) {
+                CGFloat origin = origins[i];
+                CGFloat size = sizes[i];
+                CGFloat sliceSize = amount < size ? amount : size;
+
+                remainderOrigins[i] = fromMaximum ? origin : origin + sliceSize;
+                remainderSizes[i] = size - sliceSize;
+            }
+        }
+    }
+}
+
+#pragma mark - Inset functions
+
+/**
+ *  Create edge insets
+ *
+ *  @param top The inset of the top edge
+ *  @param left The inset of the left edge
+ *  @param bottom The inset of the bottom edge
+ *  @param right The inset of the right edge
+ */
+JSG_INLINE JSGEdgeInsets JSGEdgeInsetsMake(CGFloat top, CGFloat left, CGFloat bottom, CGFloat right)
+{
+    JSGEdgeInsets insets;
+    insets.top = top;
+    insets.left = left;
+    insets.bottom = bottom;
+    insets.right = right;
+
+    return insets;
+}
+
+/**
+ *  Inset each rect in a rect array by the same amount on both sides of each axis
+ *
+ *  @param array The rects to inset
+ *  @param dx The distance to move the left & right edges inwards. Pass a negative value
+ *  to outset the rects instead.
+ *  @param dy The distance to move the top & bottom edges inwards. Pass a negative value
+ *  to outset the rects instead.
+ *
+ *  @discussion Unlike CGRectInset, which returns a null rect when a rect is too small for
+ *  the inset, rects that are too small collapse to a zero width or height at their center,
+ *  so that the array never contains null rects. Each component is processed in a separate
+ *  loop that the compiler can vectorize.
+ */
+JSG_INLINE void JSGRectArrayInset(JSGRectArray *array, CGFloat dx, CGFloat dy)
+{
+    JSGRectArrayInsetAxis(array->x, array->width, array->count, dx, dx);
+    JSGRectArrayInsetAxis(array->y, array->height, array->count, dy, dy);
+}
+
+/**
+ *  Inset each rect in a rect array by a distance per edge, according to a coordinate system
+ *  origin
+ *
+ *  @param array The rects to inset
+ *  @param insets The distance to move each edge inwards. Negative values move edges
+ *  outwards.
+ *  @param coordinateSystemOrigin The origin of the used coordinate system, which decides
+ *  whether the top inset applies to the minimum or maximum y edge
+ *
+ *  @discussion Rects whose edges cross over collapse to a zero width or height, halfway
+ *  between where the edges would have ended up.
+ *
+ *  @see JSGRectArrayInset
+ */
+JSG_INLINE void JSGRectArrayInsetByEdgeInsets(JSGRectArray *array, JSGEdgeInsets insets, JSGCoordinateSystemOrigin coordinateSystemOrigin)
+{
+    bool topIsMinimum = coordinateSystemOrigin == JSGCoordinateSystemOriginTopLeft;
+
+    JSGRectArrayInsetAxis(array->x, array->width, array->count, insets.left, insets.right);
+    JSGRectArrayInsetAxis(array->y, array->height, array->count, topIsMinimum ? insets.top : insets.bottom, topIsMinimum ? insets.bottom : insets.top);
+}
+
+/**
+ *  Divide each rect in a rect array in two, by slicing a given amount off one of its
+ *  edges, according to a coordinate system origin
+ *
+ *  @param array The rects to divide
+ *  @param amount The width or height of each slice. Rects smaller than this are sliced
+ *  entirely, leaving an empty remainder, just like CGRectDivide does.
+ *  @param edge The edge to slice off: one of JSGRectAlignmentTop, JSGRectAlignmentLeft,
+ *  JSGRectAlignmentBottom or JSGRectAlignmentRight
+ *  @param coordinateSystemOrigin The origin of the used coordinate system, which decides
+ *  whether the top edge is the minimum or maximum y edge
+ *  @param slices The array to write the slices to, or NULL. May be the same array as
+ *  array, to slice in place.
+ *  @param remainders The array to write the remainders to, or NULL. May be the same array
+ *  as array, to remove the slices in place.
+ *
+ *  @return Whether the rects could be divided. This is only false if memory could not be
+ *  allocated, in which case no array is changed.
+ *
+ *  @discussion The slices & remainders arrays are resized to the number of rects. For
+ *  example, slicing a 44 point header off the top of each frame in place is done by
+ *  passing 44, JSGRectAlignmentTop, NULL & the array of frames itself as remainders.
+ */
+JSG_INLINE bool JSGRectArrayDivide(JSGRectArray *array, CGFloat amount, JSGRectAlignment edge, JSGCoordinateSystemOrigin coordinateSystemOrigin, JSGRectArray *slices, JSGRectArray *remainders)
+{
+    size_t count = array->count;
+
+    if ((slices && !JSGRectArrayReserve(slices, count)) || (remainders && !JSGRectArrayReserve(remainders, count))) {
+        return false;
+    }
+
+    bool horizontal = (edge & (JSGRectAlignmentLeft | JSGRectAlignmentRight)) != 0;
+    bool fromMaximum;
+
+    if (horizontal) {
+        fromMaximum = (edge & JSGRectAlignmentRight) != 0;
+    } else {
+        fromMaximum = ((edge & JSGRectAlignmentBottom) != 0) == (coordinateSystemOrigin == JSGCoordinateSystemOriginTopLeft);
+    }
+
+    JSGRectArray *outputs[2] = {slices, remainders};
+
+    // The components across the axis are kept as they are
+    for (size_t i = 0; i < 2; i++) {
+        JSGRectArray *output = outputs[i];
+
+        if (!output) {
+            continue;
+        }
+
+        output->count = count;
+
+        if (output != array && count) {
+            memmove(horizontal ? output->y : output->x, horizontal ? array->y : array->x, count * sizeof(CGFloat));
+            memmove(horizontal ? output->height : output->width, horizontal ? array->height : array->width, count * sizeof(CGFloat));
+        }
+    }
+
+    CGFloat *sliceOrigins = slices ? (horizontal ? slices->x : slices->y) : NULL;
+    CGFloat *sliceSizes = slices ? (horizontal ? slices->width : slices->height) : NULL;
+    CGFloat *remainderOrigins = remainders ? (horizontal ? remainders->x : remainders->y) : NULL;
+    CGFloat *remainderSizes = remainders ? (horizontal ? remainders->width : remainders->height) : NULL;
+
+    JSGRectArrayDivideAxis(horizontal ? array->x : array->y, horizontal ? array->width : array->height, count, amount, fromMaximum, sliceOrigins, sliceSizes, remainderOrigins, remainderSizes);
+
+    return true;
+}
+
+#endif
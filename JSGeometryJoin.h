@@ -0,0 +1,451 @@
+#ifndef JSGeometryJoin
+#define JSGeometryJoin
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryParallel.h"
+#include "JSGeometryRectArray.h"
+#include "JSGeometrySorting.h"
+
+#pragma mark - Types
+
+/**
+ *  The number of rects that each tile of a join should hold on average. Results only
+ *  depend on this value, never on the number of threads that tiles are spread across.
+ */
+#define JSG_JOIN_RECTS_PER_TILE 256
+
+/**
+ *  The maximum number of tiles of a join on each axis
+ */
+#define JSG_JOIN_MAX_TILES 1024
+
+/**
+ *  A pair of overlapping rects, one from each of the arrays of a join
+ */
+typedef struct {
+    size_t first;
+    size_t second;
+} JSGRectPair;
+
+/**
+ *  An array of rect pairs
+ *
+ *  @discussion An array should be initialized using JSGRectPairArrayInit, and destroyed
+ *  using JSGRectPairArrayDestroy once it's no longer needed.
+ */
+typedef struct {
+    JSGRectPair *pairs;
+    size_t count;
+    size_t capacity;
+} JSGRectPairArray;
+
+typedef struct {
+    const JSGRectArray *arrays[2];
+    CGFloat originX;
+    CGFloat originY;
+    CGFloat tileWidth;
+    CGFloat tileHeight;
+    size_t columns;
+    size_t rows;
+    size_t *offsets[2];
+    size_t *entries[2];
+    JSGRectPairArray *tilePairs;
+    bool sweepY;
+    bool failed;
+} JSGJoinContext;
+
+#pragma mark - Private functions
+
+JSG_INLINE bool JSGRectPairArrayAppend(JSGRectPairArray *array, size_t first, size_t second)
+{
+    if (array->count == array->capacity) {
+        size_t capacity = array->capacity ? array->capacity * 2 : 64;
+        JSGRectPair *pairs = (JSGRectPair *)realloc(array->pairs, capacity * sizeof(JSGRectPair));
+
+        if (!pairs) {
+            return false;
+        }
+
+        array->pairs = pairs;
+        array->capacity = capacity;
+    }
+
+    array->pairs[array->count].first = first;
+    array->pairs[array->count].second = second;
+    array->count++;
+
+    return true;
+}
+
+JSG_INLINE size_t JSGJoinGetColumn(const JSGJoinContext *join, CGFloat x)
+{
+    CGFloat column = floor((x - join->originX) / join->tileWidth);
+
+    return column <= 0 ? 0 : column >= (CGFloat)(join->columns - 1) ? join->columns - 1 : (size_t)column;
+}
+
+JSG_INLINE size_t JSGJoinGetRow(const JSGJoinContext *join, CGFloat y)
+{
+    CGFloat row = floor((y - join->originY) / join->tileHeight);
+
+    return row <= 0 ? 0 : row >= (CGFloat)(join->rows - 1) ? join->rows - 1 : (size_t)row;
+}
+
+/**
+ *  Distribute the rects of one side of a join to the tiles that they overlap, as lists of
+ *  indices stored contiguously per tile
+ */
+JSG_INLINE bool JSGJoinDistribute(JSGJoinContext *join, size_t side, CGRect bounds)
+{
+    const JSGRectArray *array = join->arrays[side];
+    size_t tileCount = join->columns * join->rows;
+    size_t *offsets = (size_t *)calloc(tileCount + 1, sizeof(size_t));
+    size_t entryCount = 0;
+
+    join->offsets[side] = offsets;
+
+    if (!offsets) {
+        return false;
+    }
+
+    // The first pass counts the entries of each tile, the second one writes them
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < array->count; i++) {
+            CGFloat minX = array->x[i];
+            CGFloat minY = array->y[i];
+            CGFloat maxX = minX + array->width[i];
+            CGFloat maxY = minY + array->height[i];
+
+            // Rects outside of the other array's bounds can't overlap any of its rects
+            if (minX >= bounds.origin.x + bounds.size.width || minY >= bounds.origin.y + bounds.size.height || maxX <= bounds.origin.x || maxY <= bounds.origin.y || !(maxX > minX) || !(maxY > minY)) {
+                continue;
+            }
+
+            size_t firstColumn = JSGJoinGetColumn(join, minX);
+            size_t lastColumn = JSGJoinGetColumn(join, maxX);
+            size_t firstRow = JSGJoinGetRow(join, minY);
+            size_t lastRow = JSGJoinGetRow(join, maxY);
+
+            for (size_t row = firstRow; row <= lastRow; row++) {
+                for (size_t column = firstColumn; column <= lastColumn; column++) {
+                    size_t tile = row * join->columns + column;
+
+                    if (pass == 0) {
+                        offsets[tile + 1]++;
+                    } else {
+                        join->entries[side][offsets[tile]++] = i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (size_t tile = 0; tile < tileCount; tile++) {
+                offsets[tile + 1] += offsets[tile];
+            }
+
+            entryCount = offsets[tileCount];
+            join->entries[side] = (size_t *)malloc((entryCount ? entryCount : 1) * sizeof(size_t));
+
+            if (!join->entries[side]) {
+                return false;
+            }
+        }
+    }
+
+    // Writing advanced each offset to the start of the next tile, so they're shifted back
+    // by one tile, to end up at the start of their own tile
+    for (size_t tile = tileCount; tile > 0; tile--) {
+        offsets[tile] = offsets[tile - 1];
+    }
+
+    offsets[0] = 0;
+
+    return true;
+}
+
+/**
+ *  Gather the bounds of the rects of one side of a tile, sorted by their minimum along the
+ *  sweep axis. Bounds are stored as minimums along & across the axis, then maximums.
+ */
+JSG_INLINE bool JSGJoinGatherTile(const JSGJoinContext *join, size_t side, size_t tile, CGFloat *bounds, size_t *indices)
+{
+    const JSGRectArray *array = join->arrays[side];
+    size_t start = join->offsets[side][tile];
+    size_t count = join->offsets[side][tile + 1] - start;
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc((count ? count : 1) * sizeof(JSGScoredIndex));
+
+    if (!order) {
+        return false;
+    }
+
+    const CGFloat *along = join->sweepY ? array->y : array->x;
+    const CGFloat *across = join->sweepY ? array->x : array->y;
+    const CGFloat *alongSize = join->sweepY ? array->height : array->width;
+    const CGFloat *acrossSize = join->sweepY ? array->width : array->height;
+
+    // Sorting by descending score, so scores are negated to get ascending minimums
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = -along[join->entries[side][start + i]];
+        order[i].index = join->entries[side][start + i];
+    }
+
+    if (!JSGScoredIndicesSort(order, count)) {
+        free(order);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = order[i].index;
+        bounds[i] = along[index];
+        bounds[count + i] = across[index];
+        bounds[count * 2 + i] = along[index] + alongSize[index];
+        bounds[count * 3 + i] = across[index] + acrossSize[index];
+        indices[i] = index;
+    }
+
+    free(order);
+
+    return true;
+}
+
+/**
+ *  Find the overlapping pairs of a tile by sweeping both of its sorted lists at once
+ *
+ *  @discussion Each pair is found when the rect that starts first is swept, by scanning
+ *  the other list forward until rects start after it ends. Pairs that also overlap other
+ *  tiles are only reported by the tile that contains the top left corner of their
+ *  intersection, so no pair is reported twice.
+ */
+JSG_INLINE void JSGJoinTile(void *context, size_t tile)
+{
+    JSGJoinContext *join = (JSGJoinContext *)context;
+    size_t counts[2];
+    CGFloat *bounds[2];
+    size_t *indices[2];
+    size_t column = tile % join->columns;
+    size_t row = tile / join->columns;
+
+    counts[0] = join->offsets[0][tile + 1] - join->offsets[0][tile];
+    counts[1] = join->offsets[1][tile + 1] - join->offsets[1][tile];
+
+    if (counts[0] == 0 || counts[1] == 0) {
+        return;
+    }
+
+    bounds[0] = (CGFloat *)malloc(counts[0] * 4 * sizeof(CGFloat));
+    bounds[1] = (CGFloat *)malloc(counts[1] * 4 * sizeof(CGFloat));
+    indices[0] = (size_t *)malloc(counts[0] * sizeof(size_t));
+    indices[1] = (size_t *)malloc(counts[1] * sizeof(size_t));
+
+    bool succeeded = bounds[0] && bounds[1] && indices[0] && indices[1] && JSGJoinGatherTile(join, 0, tile, bounds[0], indices[0]) && JSGJoinGatherTile(join, 1, tile, bounds[1], indices[1]);
+    size_t positions[2] = {0, 0};
+
+    while (succeeded && positions[0] < counts[0] && positions[1] < counts[1]) {
+        // Sweep the rect that starts first, preferring the first array on ties
+        size_t side = bounds[0][positions[0]] <= bounds[1][positions[1]] ? 0 : 1;
+        size_t other = 1 - side;
+        size_t i = positions[side]++;
+        size_t count = counts[side];
+        size_t otherCount = counts[other];
+        CGFloat minAcross = bounds[side][count + i];
+        CGFloat maxAlong = bounds[side][count * 2 + i];
+        CGFloat maxAcross = bounds[side][count * 3 + i];
+        const CGFloat *otherMinAlongs = bounds[other];
+        const CGFloat *otherMinAcrosses = bounds[other] + otherCount;
+        const CGFloat *otherMaxAcrosses = bounds[other] + otherCount * 3;
+
+        for (size_t j = positions[other]; j < otherCount && otherMinAlongs[j] < maxAlong; j++) {
+            if (otherMinAcrosses[j] >= maxAcross || otherMaxAcrosses[j] <= minAcross) {
+                continue;
+            }
+
+            // The other rect starts last along the axis, so its minimum is the reference's
+            CGFloat referenceAlong = otherMinAlongs[j];
+            CGFloat referenceAcross = otherMinAcrosses[j] > minAcross ? otherMinAcrosses[j] : minAcross;
+            CGFloat referenceX = join->sweepY ? referenceAcross : referenceAlong;
+            CGFloat referenceY = join->sweepY ? referenceAlong : referenceAcross;
+
+            if (JSGJoinGetColumn(join, referenceX) != column || JSGJoinGetRow(join, referenceY) != row) {
+                continue;
+            }
+
+            size_t first = side == 0 ? indices[0][i] : indices[0][j];
+            size_t second = side == 0 ? indices[1][j] : indices[1][i];
+
+            if (!JSGRectPairArrayAppend(&join->tilePairs[tile], first, second)) {
+                succeeded = false;
+                break;
+            }
+        }
+    }
+
+    if (!succeeded) {
+        __atomic_store_n(&join->failed, true, __ATOMIC_RELAXED);
+    }
+
+    free(bounds[0]);
+    free(bounds[1]);
+    free(indices[0]);
+    free(indices[1]);
+}
+
+#pragma mark - Join functions
+
+/**
+ *  Initialize an empty rect pair array
+ *
+ *  @param array The array to initialize
+ */
+JSG_INLINE void JSGRectPairArrayInit(JSGRectPairArray *array)
+{
+    memset(array, 0, sizeof(JSGRectPairArray));
+}
+
+/**
+ *  Destroy a rect pair array, freeing all of its memory
+ *
+ *  @param array The array to destroy
+ */
+JSG_INLINE void JSGRectPairArrayDestroy(JSGRectPairArray *array)
+{
+    free(array->pairs);
+    memset(array, 0, sizeof(JSGRectPairArray));
+}
+
+/**
+ *  Find all pairs of overlapping rects between two rect arrays (a spatial join)
+ *
+ *  @param first The first array
+ *  @param second The second array
+ *  @param threadCount The maximum number of threads to use. Pass 0 to use the default
+ *  thread count, or 1 to only use the calling thread. Threads are created on each call,
+ *  see JSGParallelFor, so small arrays joined every frame are best joined with 1.
+ *  @param pairs The array to append the pairs to. Each pair holds the index of a rect in the
+ *  first array & the index of a rect in the second array that it overlaps.
+ *
+ *  @return Whether the pairs could be found. This is only false if memory could not be
+ *  allocated, in which case no pairs are appended.
+ *
+ *  @discussion Rects overlap when their interiors do, so rects that only touch don't form
+ *  a pair. The area shared by both arrays is partitioned into a grid of tiles, & each rect
+ *  is added to every tile it overlaps. Tiles are then joined independently in parallel,
+ *  using a plane sweep over both lists of rects sorted along the axis that rects are
+ *  shortest on, so that lines of text are swept from top to bottom. A pair that spans
+ *  several tiles is only reported by the tile containing the top left corner of its
+ *  intersection (its reference point), so no deduplication pass is needed.
+ *
+ *  Pairs are appended tile by tile, in an order that only depends on the arrays, never on
+ *  the number of threads.
+ */
+JSG_INLINE bool JSGRectArrayJoin(const JSGRectArray *first, const JSGRectArray *second, size_t threadCount, JSGRectPairArray *pairs)
+{
+    if (first->count == 0 || second->count == 0) {
+        return true;
+    }
+
+    JSGJoinContext join;
+    CGRect bounds[2];
+    CGFloat extents[2] = {0, 0};
+    memset(&join, 0, sizeof(JSGJoinContext));
+    join.arrays[0] = first;
+    join.arrays[1] = second;
+
+    for (size_t side = 0; side < 2; side++) {
+        CGFloat box[4] = {CGFLOAT_MAX, CGFLOAT_MAX, -CGFLOAT_MAX, -CGFLOAT_MAX};
+        const JSGRectArray *array = join.arrays[side];
+
+        for (size_t i = 0; i < array->count; i++) {
+            box[0] = array->x[i] < box[0] ? array->x[i] : box[0];
+            box[1] = array->y[i] < box[1] ? array->y[i] : box[1];
+            box[2] = array->x[i] + array->width[i] > box[2] ? array->x[i] + array->width[i] : box[2];
+            box[3] = array->y[i] + array->height[i] > box[3] ? array->y[i] + array->height[i] : box[3];
+            extents[0] += array->width[i];
+            extents[1] += array->height[i];
+        }
+
+        bounds[side].origin.x = box[0];
+        bounds[side].origin.y = box[1];
+        bounds[side].size.width = box[2] - box[0];
+        bounds[side].size.height = box[3] - box[1];
+    }
+
+    CGFloat sharedMinX = bounds[0].origin.x > bounds[1].origin.x ? bounds[0].origin.x : bounds[1].origin.x;
+    CGFloat sharedMinY = bounds[0].origin.y > bounds[1].origin.y ? bounds[0].origin.y : bounds[1].origin.y;
+    CGFloat sharedMaxX = bounds[0].origin.x + bounds[0].size.width < bounds[1].origin.x + bounds[1].size.width ? bounds[0].origin.x + bounds[0].size.width : bounds[1].origin.x + bounds[1].size.width;
+    CGFloat sharedMaxY = bounds[0].origin.y + bounds[0].size.height < bounds[1].origin.y + bounds[1].size.height ? bounds[0].origin.y + bounds[0].size.height : bounds[1].origin.y + bounds[1].size.height;
+
+    if (!(sharedMaxX > sharedMinX) || !(sharedMaxY > sharedMinY)) {
+        return true;
+    }
+
+    CGRect shared;
+    shared.origin.x = sharedMinX;
+    shared.origin.y = sharedMinY;
+    shared.size.width = sharedMaxX - sharedMinX;
+    shared.size.height = sharedMaxY - sharedMinY;
+
+    // Square-ish tiles over the shared area, sized to hold a fixed number of rects
+    CGFloat tileCount = (CGFloat)(first->count + second->count) / JSG_JOIN_RECTS_PER_TILE;
+    CGFloat tileSize = sqrt(shared.size.width * shared.size.height / (tileCount > 1 ? tileCount : 1));
+    CGFloat columns = ceil(shared.size.width / tileSize);
+    CGFloat rows = ceil(shared.size.height / tileSize);
+
+    join.columns = columns < 1 ? 1 : columns > JSG_JOIN_MAX_TILES ? JSG_JOIN_MAX_TILES : (size_t)columns;
+    join.rows = rows < 1 ? 1 : rows > JSG_JOIN_MAX_TILES ? JSG_JOIN_MAX_TILES : (size_t)rows;
+    join.originX = shared.origin.x;
+    join.originY = shared.origin.y;
+    join.tileWidth = shared.size.width / join.columns;
+    join.tileHeight = shared.size.height / join.rows;
+    join.sweepY = extents[1] < extents[0];
+    join.tilePairs = (JSGRectPairArray *)calloc(join.columns * join.rows, sizeof(JSGRectPairArray));
+
+    bool succeeded = join.tilePairs && JSGJoinDistribute(&join, 0, bounds[1]) && JSGJoinDistribute(&join, 1, bounds[0]);
+
+    if (succeeded) {
+        JSGParallelFor(join.columns * join.rows, threadCount, JSGJoinTile, &join);
+        succeeded = !join.failed;
+    }
+
+    size_t pairCount = pairs->count;
+
+    for (size_t tile = 0; succeeded && join.tilePairs && tile < join.columns * join.rows; tile++) {
+        pairCount += join.tilePairs[tile].count;
+    }
+
+    if (succeeded && pairCount > pairs->capacity) {
+        JSGRectPair *newPairs = (JSGRectPair *)realloc(pairs->pairs, pairCount * sizeof(JSGRectPair));
+
+        if (newPairs) {
+            pairs->pairs = newPairs;
+            pairs->capacity = pairCount;
+        } else {
+            succeeded = false;
+        }
+    }
+
+    for (size_t tile = 0; join.tilePairs && tile < join.columns * join.rows; tile++) {
+        if (succeeded && join.tilePairs[tile].count) {
+            memcpy(pairs->pairs + pairs->count, join.tilePairs[tile].pairs, join.tilePairs[tile].count * sizeof(JSGRectPair));
+            pairs->count += join.tilePairs[tile].count;
+        }
+
+        free(join.tilePairs[tile].pairs);
+    }
+
+    free(join.tilePairs);
+    free(join.offsets[0]);
+    free(join.offsets[1]);
+    free(join.entries[0]);
+    free(join.entries[1]);
+
+    return succeeded;
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef JSGeometryLabels
+#define JSGeometryLabels
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "JSGeometry.h"
+#include "JSGeometrySorting.h"
+#include "JSGeometrySpatialGrid.h"
+
+#pragma mark - Types
+
+/**
+ *  The number of positions in the default label position model
+ */
+#define JSG_LABEL_POSITION_COUNT 8
+
+#pragma mark - Private constants
+
+JSG_CONSTANT JSGRectAlignment JSGLabelDefaultPositions[JSG_LABEL_POSITION_COUNT] = {
+    (JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentRight),
+    (JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentLeft),
+    (JSGRectAlignment)(JSGRectAlignmentBottom | JSGRectAlignmentRight),
+    (JSGRectAlignment)(JSGRectAlignmentBottom | JSGRectAlignmentLeft),
+    JSGRectAlignmentRight,
+    JSGRectAlignmentTop,
+    JSGRectAlignmentLeft,
+    JSGRectAlignmentBottom
+};
+
+#pragma mark - Private functions
+
+JSG_INLINE CGRect JSGLabelGetFrame(CGPoint anchor, CGSize size, CGFloat offset, JSGRectAlignment position, JSGCoordinateSystemOrigin origin)
+{
+    CGRect frame;
+    frame.size = size;
+
+    if (position & JSGRectAlignmentRight) {
+        frame.origin.x = anchor.x + offset;
+    } else if (position & JSGRectAlignmentLeft) {
+        frame.origin.x = anchor.x - offset - size.width;
+    } else {
+        frame.origin.x = anchor.x - size.width / 2;
+    }
+
+    JSGRectAlignment above = origin == JSGCoordinateSystemOriginTopLeft ? JSGRectAlignmentTop : JSGRectAlignmentBottom;
+    JSGRectAlignment below = origin == JSGCoordinateSystemOriginTopLeft ? JSGRectAlignmentBottom : JSGRectAlignmentTop;
+
+    if (position & above) {
+        frame.origin.y = anchor.y - offset - size.height;
+    } else if (position & below) {
+        frame.origin.y = anchor.y + offset;
+    } else {
+        frame.origin.y = anchor.y - size.height / 2;
+    }
+
+    return frame;
+}
+
+#pragma mark - Label placement functions
+
+/**
+ *  Return the positions of the default label position model, by order of preference
+ *
+ *  @discussion This is the classic 8 position model used in cartography: top right, top
+ *  left, bottom right, bottom left, right, top, left & bottom. Each position is described
+ *  by the side(s) of the anchor point that the label is placed on.
+ */
+JSG_INLINE const JSGRectAlignment *JSGLabelPositionsDefault(void)
+{
+    return JSGLabelDefaultPositions;
+}
+
+/**
+ *  Place labels next to their anchor points, dropping those that can't be placed without
+ *  overlapping other labels
+ *
+ *  @param anchors The point that each label belongs to, such as a data point
+ *  @param sizes The size of each label
+ *  @param priorities The priority of each label, or NULL to give labels priority by index
+ *  @param count The number of labels
+ *  @param bounds The rect that labels must fit in
+ *  @param offset The distance between an anchor point & the sides of its label
+ *  @param positions The positions to try for each label, by order of preference, or NULL
+ *  to use JSGLabelPositionsDefault
+ *  @param positionCount The number of positions
+ *  @param origin The origin of the coordinate system, which determines where the top of an
+ *  anchor point is
+ *  @param obstacles A spatial grid of rects that labels must not overlap, such as data
+ *  markers, or NULL
+ *  @param frames The array to write the frame of each label to. Must have room for count
+ *  rects. Dropped labels get CGRectNull.
+ *  @param placedPositions The array to write the position of each label to, or NULL. Must
+ *  have room for count positions. Dropped labels get 0.
+ *  @param placedCount Set to the number of labels that were placed
+ *
+ *  @return Whether the labels could be placed. This is only false if memory could not be
+ *  allocated.
+ *
+ *  @discussion Labels are placed greedily, by descending priority (ties are broken by
+ *  index). Each label gets the first position that fits within the bounds without
+ *  overlapping an obstacle or a label placed before it. Placed labels are inserted in a
+ *  spatial grid sized after the average label, so that each test only looks at nearby
+ *  labels, and placing labels takes linear time rather than quadratic time.
+ */
+JSG_INLINE bool JSGLabelsPlace(const CGPoint *anchors, const CGSize *sizes, const CGFloat *priorities, size_t count, CGRect bounds, CGFloat offset, const JSGRectAlignment *positions, size_t positionCount, JSGCoordinateSystemOrigin origin, const JSGSpatialGrid *obstacles, CGRect *frames, JSGRectAlignment *placedPositions, size_t *placedCount)
+{
+    *placedCount = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (!positions) {
+        positions = JSGLabelPositionsDefault();
+        positionCount = JSG_LABEL_POSITION_COUNT;
+    }
+
+    bounds = CGRectStandardize(bounds);
+
+    CGFloat averageSize = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        averageSize += sizes[i].width > sizes[i].height ? sizes[i].width : sizes[i].height;
+    }
+
+    averageSize /= count;
+
+    // Tiny labels in large bounds would otherwise give a huge grid
+    CGFloat minimumCellSize = (bounds.size.width > bounds.size.height ? bounds.size.width : bounds.size.height) / 1024;
+    averageSize = averageSize > minimumCellSize ? averageSize : minimumCellSize;
+
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+    JSGSpatialGrid placed;
+
+    if (!order) {
+        return false;
+    }
+
+    if (!JSGSpatialGridInit(&placed, bounds, averageSize)) {
+        free(order);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = priorities ? priorities[i] : 0;
+        order[i].index = i;
+    }
+
+    if (priorities && !JSGScoredIndicesSort(order, count)) {
+        free(order);
+        JSGSpatialGridDestroy(&placed);
+        return false;
+    }
+
+    CGFloat boundsMaxX = bounds.origin.x + bounds.size.width;
+    CGFloat boundsMaxY = bounds.origin.y + bounds.size.height;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t label = order[i].index;
+
+        frames[label] = CGRectNull;
+
+        if (placedPositions) {
+            placedPositions[label] = (JSGRectAlignment)0;
+        }
+
+        for (size_t j = 0; j < positionCount; j++) {
+            CGRect frame = JSGLabelGetFrame(anchors[label], sizes[label], offset, positions[j], origin);
+
+            if (frame.origin.x < bounds.origin.x || frame.origin.y < bounds.origin.y || frame.origin.x + frame.size.width > boundsMaxX || frame.origin.y + frame.size.height > boundsMaxY) {
+                continue;
+            }
+
+            if (JSGSpatialGridIntersectsRect(&placed, frame) || (obstacles && JSGSpatialGridIntersectsRect(obstacles, frame))) {
+                continue;
+            }
+
+            if (!JSGSpatialGridInsert(&placed, frame)) {
+                free(order);
+                JSGSpatialGridDestroy(&placed);
+                return false;
+            }
+
+            frames[label] = frame;
+
+            if (placedPositions) {
+                placedPositions[label] = positions[j];
+            }
+
+            (*placedCount)++;
+            break;
+        }
+    }
+
+    free(order);
+    JSGSpatialGridDestroy(&placed);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef JSGeometryMirroring
+#define JSGeometryMirroring
+
+#include <stddef.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryInsets.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Private functions
+
+/**
+ *  Mirror a range of rects horizontally around a vertical axis, given as the sum of the
+ *  minimum & maximum x of the container they're mirrored in
+ */
+JSG_INLINE void JSGRectArrayMirrorAxis(CGFloat *xs, const CGFloat *widths, size_t count, CGFloat axis)
+{
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = axis - (xs[i] + widths[i]);
+    }
+}
+
+#pragma mark - Mirroring functions
+
+/**
+ *  Mirror a rect horizontally within a container, such as to turn a frame laid out from
+ *  left to right into the frame it has when laid out from right to left
+ *
+ *  @param rect The rect to mirror
+ *  @param container The rect to mirror the rect within, usually the bounds of the rect's
+ *  parent
+ *
+ *  @return The mirrored rect, in its standardized form, whose distance to the right edge
+ *  of the container is the original rect's distance to its left edge
+ */
+JSG_INLINE CGRect JSGRectMirrorInRect(CGRect rect, CGRect container)
+{
+    rect = CGRectStandardize(rect);
+    container = CGRectStandardize(container);
+
+    JSGRectArrayMirrorAxis(&rect.origin.x, &rect.size.width, 1, container.origin.x * 2 + container.size.width);
+
+    return rect;
+}
+
+/**
+ *  Mirror each rect in a rect array horizontally within the same container
+ *
+ *  @param array The rects to mirror, such as frames laid out from left to right
+ *  @param container The rect to mirror the rects within
+ *
+ *  @discussion Only the x component changes, in a single loop that the compiler can
+ *  vectorize, so a layout engine can lay out once in logical, left to right coordinates
+ *  & produce right to left frames in one pass. Mirroring twice gives back the original
+ *  rects, up to rounding.
+ *
+ *  @see JSGRectMirrorInRect
+ */
+JSG_INLINE void JSGRectArrayMirrorInRect(JSGRectArray *array, CGRect container)
+{
+    container = CGRectStandardize(container);
+
+    JSGRectArrayMirrorAxis(array->x, array->width, array->count, container.origin.x * 2 + container.size.width);
+}
+
+/**
+ *  Mirror each rect in a rect array horizontally within its own container
+ *
+ *  @param array The rects to mirror
+ *  @param containers The rects to mirror each rect within, one for each rect, such as the
+ *  bounds of the parents of frames that are relative to their parents. Must not be array.
+ *
+ *  @see JSGRectArrayMirrorInRect
+ */
+JSG_INLINE void JSGRectArrayMirrorInRects(JSGRectArray *array, const JSGRectArray *containers)
+{
+    CGFloat *xs = array->x;
+    const CGFloat *widths = array->width;
+    const CGFloat *containerXs = containers->x;
+    const CGFloat *containerWidths = containers->width;
+
+    for (size_t i = 0; i < array->count; i++) {
+        xs[i] = (containerXs[i] * 2 + containerWidths[i]) - (xs[i] + widths[i]);
+    }
+}
+
+/**
+ *  Resolve edge insets given in a layout direction to physical ones, taking left as the
+ *  leading edge & right as the trailing edge
+ *
+ *  @param insets The insets to resolve, such as the padding of a view laid out from left
+ *  to right
+ *  @param layoutDirection The direction that content is laid out in
+ *
+ *  @return The insets as they are from left to right, or with their left & right insets
+ *  swapped from right to left
+ */
+JSG_INLINE JSGEdgeInsets JSGEdgeInsetsForLayoutDirection(JSGEdgeInsets insets, JSGLayoutDirection layoutDirection)
+{
+    if (layoutDirection == JSGLayoutDirectionRightToLeft) {
+        CGFloat left = insets.left;
+        insets.left = insets.right;
+        insets.right = left;
+    }
+
+    return insets;
+}
+
+#endif
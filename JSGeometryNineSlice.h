@@ -0,0 +1,128 @@
+#ifndef JSGeometryNineSlice
+#define JSGeometryNineSlice
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryInsets.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  The number of slices that a stretchable image is drawn with
+ */
+#define JSG_NINE_SLICE_COUNT 9
+
+#pragma mark - Private functions
+
+/**
+ *  Compute the 4 edges of the 3 slices of a range along one axis, in ascending order,
+ *  shrinking the caps proportionally when they don't fit within the range
+ */
+JSG_INLINE void JSGNineSliceGetEdges(CGFloat origin, CGFloat size, CGFloat minimumCap, CGFloat maximumCap, CGFloat scale, CGFloat *edges)
+{
+    minimumCap = minimumCap > 0 ? minimumCap : 0;
+    maximumCap = maximumCap > 0 ? maximumCap : 0;
+
+    if (minimumCap + maximumCap > size) {
+        CGFloat shrink = minimumCap + maximumCap > 0 ? size / (minimumCap + maximumCap) : 0;
+        minimumCap *= shrink;
+        maximumCap *= shrink;
+    }
+
+    edges[0] = origin;
+    edges[1] = origin + minimumCap;
+    edges[2] = origin + size - maximumCap;
+    edges[3] = origin + size;
+
+    if (scale > 0) {
+        for (size_t i = 0; i < 4; i++) {
+            edges[i] = round(edges[i] * scale) / scale;
+        }
+    }
+}
+
+/**
+ *  Write the 9 slices described by the edges along each axis to a rect array, starting
+ *  at a given index
+ */
+JSG_INLINE void JSGNineSliceWrite(JSGRectArray *array, size_t start, const CGFloat *xEdges, const CGFloat *yEdges, bool topIsMinimum)
+{
+    for (size_t row = 0; row < 3; row++) {
+        size_t band = topIsMinimum ? row : 2 - row;
+
+        for (size_t column = 0; column < 3; column++) {
+            size_t index = start + row * 3 + column;
+
+            array->x[index] = xEdges[column];
+            array->y[index] = yEdges[band];
+            array->width[index] = xEdges[column + 1] - xEdges[column];
+            array->height[index] = yEdges[band + 1] - yEdges[band];
+        }
+    }
+}
+
+#pragma mark - Nine slice functions
+
+/**
+ *  Compute the source & destination slices for drawing stretchable images in bulk, with
+ *  fixed size caps & stretched edges and centers
+ *
+ *  @param destinations The frames that the images are drawn in
+ *  @param sources The rects of the images in their texture or atlas, one for each frame
+ *  @param capInsets The size of the caps of each image, one for each frame. The caps keep
+ *  their size in the destination frames, unless they don't fit, in which case the caps on
+ *  both sides of an axis are shrunk proportionally.
+ *  @param coordinateSystemOrigin The origin of the used coordinate system, which decides
+ *  whether the top cap is at the minimum or maximum y edge, for both the sources & the
+ *  destinations
+ *  @param scale The scale of the screen, which destination edges are rounded to the pixels
+ *  of, so that stretched slices never leave seams. Pass 0 to leave them unrounded.
+ *  @param sourceSlices The array to write the source slices to
+ *  @param destinationSlices The array to write the destination slices to
+ *
+ *  @return Whether the slices could be computed. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion Both arrays of slices are resized to JSG_NINE_SLICE_COUNT rects per frame.
+ *  The slices of frame i start at index i * JSG_NINE_SLICE_COUNT, from left to right in
+ *  rows from top to bottom, so that a sprite batcher can draw them in order, keeping the
+ *  order in which the frames overlap. Slices of caps with a zero size are included with a
+ *  zero width or height, so that each frame always has the same number of slices, and may
+ *  be skipped when drawing.
+ */
+JSG_INLINE bool JSGRectArrayGetNineSlices(const JSGRectArray *destinations, const JSGRectArray *sources, const JSGEdgeInsets *capInsets, JSGCoordinateSystemOrigin coordinateSystemOrigin, CGFloat scale, JSGRectArray *sourceSlices, JSGRectArray *destinationSlices)
+{
+    size_t count = destinations->count;
+    bool topIsMinimum = coordinateSystemOrigin == JSGCoordinateSystemOriginTopLeft;
+
+    if (!JSGRectArrayReserve(sourceSlices, count * JSG_NINE_SLICE_COUNT) || !JSGRectArrayReserve(destinationSlices, count * JSG_NINE_SLICE_COUNT)) {
+        return false;
+    }
+
+    sourceSlices->count = count * JSG_NINE_SLICE_COUNT;
+    destinationSlices->count = count * JSG_NINE_SLICE_COUNT;
+
+    for (size_t i = 0; i < count; i++) {
+        JSGEdgeInsets insets = capInsets[i];
+        CGFloat minimumYCap = topIsMinimum ? insets.top : insets.bottom;
+        CGFloat maximumYCap = topIsMinimum ? insets.bottom : insets.top;
+        CGFloat xEdges[4];
+        CGFloat yEdges[4];
+
+        JSGNineSliceGetEdges(sources->x[i], sources->width[i], insets.left, insets.right, 0, xEdges);
+        JSGNineSliceGetEdges(sources->y[i], sources->height[i], minimumYCap, maximumYCap, 0, yEdges);
+        JSGNineSliceWrite(sourceSlices, i * JSG_NINE_SLICE_COUNT, xEdges, yEdges, topIsMinimum);
+
+        JSGNineSliceGetEdges(destinations->x[i], destinations->width[i], insets.left, insets.right, scale, xEdges);
+        JSGNineSliceGetEdges(destinations->y[i], destinations->height[i], minimumYCap, maximumYCap, scale, yEdges);
+        JSGNineSliceWrite(destinationSlices, i * JSG_NINE_SLICE_COUNT, xEdges, yEdges, topIsMinimum);
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef JSGeometryOccupancy
+#define JSGeometryOccupancy
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  A bitmap of occupied cells over an area, with a summed-area table to count the occupied
+ *  cells of any rect in constant time
+ *
+ *  @discussion cells holds one byte per cell, row by row, starting with the row at the
+ *  minimum y of bounds, set to 1 for occupied cells. sums holds (columns + 1) * (rows + 1)
+ *  counts: the count at row r & column c is the number of occupied cells in the rows above
+ *  r & the columns before c.
+ *
+ *  Changing cells only marks the rows from the first changed one on as stale, and
+ *  JSGOccupancyGridUpdate then recomputes the sums of those rows only, so changes near the
+ *  bottom of the grid are cheap. Queries read the sums as of the last update, and don't
+ *  change the grid, so they may be performed from multiple threads at once.
+ *
+ *  A grid should be initialized using JSGOccupancyGridInit, and destroyed using
+ *  JSGOccupancyGridDestroy once it's no longer needed.
+ */
+typedef struct {
+    CGRect bounds;
+    CGFloat cellSize;
+    size_t columns;
+    size_t rows;
+    uint8_t *cells;
+    uint32_t *sums;
+    size_t firstStaleRow;
+} JSGOccupancyGrid;
+
+#pragma mark - Private functions
+
+/**
+ *  Convert the edges of a rect along one axis to the range of cells that its interior
+ *  overlaps, clipped to the grid
+ */
+JSG_INLINE void JSGOccupancyGridGetRange(CGFloat minimum, CGFloat maximum, CGFloat origin, CGFloat cellSize, size_t cellCount, size_t *first, size_t *end)
+{
+    // A range without an interior overlaps no cells, even if it lies inside of one
+    if (!(maximum > minimum)) {
+        *first = *end = 0;
+        return;
+    }
+
+    CGFloat firstCell = floor((minimum - origin) / cellSize);
+    CGFloat endCell = ceil((maximum - origin) / cellSize);
+
+    *first = !(firstCell > 0) ? 0 : firstCell >= (CGFloat)cellCount ? cellCount : (size_t)firstCell;
+    *end = !(endCell > 0) ? 0 : endCell >= (CGFloat)cellCount ? cellCount : (size_t)endCell;
+}
+
+JSG_INLINE uint32_t JSGOccupancyGridSum(const JSGOccupancyGrid *grid, size_t firstColumn, size_t endColumn, size_t firstRow, size_t endRow)
+{
+    size_t stride = grid->columns + 1;
+    const uint32_t *sums = grid->sums;
+
+    return sums[endRow * stride + endColumn] - sums[endRow * stride + firstColumn] - sums[firstRow * stride + endColumn] + sums[firstRow * stride + firstColumn];
+}
+
+#pragma mark - Occupancy functions
+
+/**
+ *  Initialize an occupancy grid with all cells free
+ *
+ *  @param grid The grid to initialize
+ *  @param bounds The area covered by the grid's cells
+ *  @param cellSize The width & height of each cell
+ *
+ *  @return Whether the grid could be initialized. This is only false if memory could not
+ *  be allocated, in which case the grid doesn't need to be destroyed.
+ */
+JSG_INLINE bool JSGOccupancyGridInit(JSGOccupancyGrid *grid, CGRect bounds, CGFloat cellSize)
+{
+    memset(grid, 0, sizeof(JSGOccupancyGrid));
+    bounds = CGRectStandardize(bounds);
+    grid->bounds = bounds;
+    grid->cellSize = cellSize > 0 ? cellSize : 1;
+
+    CGFloat columns = ceil(bounds.size.width / grid->cellSize);
+    CGFloat rows = ceil(bounds.size.height / grid->cellSize);
+    grid->columns = columns >= 1 ? (size_t)columns : 1;
+    grid->rows = rows >= 1 ? (size_t)rows : 1;
+    grid->firstStaleRow = grid->rows;
+    grid->cells = (uint8_t *)calloc(grid->columns * grid->rows, sizeof(uint8_t));
+    grid->sums = (uint32_t *)calloc((grid->columns + 1) * (grid->rows + 1), sizeof(uint32_t));
+
+    if (!grid->cells || !grid->sums) {
+        free(grid->cells);
+        free(grid->sums);
+        memset(grid, 0, sizeof(JSGOccupancyGrid));
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Destroy an occupancy grid, freeing all of its memory
+ *
+ *  @param grid The grid to destroy
+ */
+JSG_INLINE void JSGOccupancyGridDestroy(JSGOccupancyGrid *grid)
+{
+    free(grid->cells);
+    free(grid->sums);
+    memset(grid, 0, sizeof(JSGOccupancyGrid));
+}
+
+/**
+ *  Mark all cells of an occupancy grid as free
+ *
+ *  @param grid The grid to clear
+ */
+JSG_INLINE void JSGOccupancyGridClear(JSGOccupancyGrid *grid)
+{
+    memset(grid->cells, 0, grid->columns * grid->rows * sizeof(uint8_t));
+    memset(grid->sums, 0, (grid->columns + 1) * (grid->rows + 1) * sizeof(uint32_t));
+    grid->firstStaleRow = grid->rows;
+}
+
+/**
+ *  Mark the cells of an occupancy grid that a rect overlaps as occupied or free
+ *
+ *  @param grid The grid to change
+ *  @param rect The rect whose cells to change. Cells that only touch its edges are left
+ *  untouched, as are the parts of it outside of the grid.
+ *  @param occupied Whether the cells should be marked as occupied or as free
+ *
+ *  @discussion Cells are either occupied or free, so freeing the cells of one rect also
+ *  frees the parts of other rects sharing them. Call JSGOccupancyGridUpdate before querying
+ *  the grid.
+ */
+JSG_INLINE void JSGOccupancyGridSetRect(JSGOccupancyGrid *grid, CGRect rect, bool occupied)
+{
+    size_t firstColumn, endColumn, firstRow, endRow;
+    rect = CGRectStandardize(rect);
+
+    JSGOccupancyGridGetRange(rect.origin.x, rect.origin.x + rect.size.width, grid->bounds.origin.x, grid->cellSize, grid->columns, &firstColumn, &endColumn);
+    JSGOccupancyGridGetRange(rect.origin.y, rect.origin.y + rect.size.height, grid->bounds.origin.y, grid->cellSize, grid->rows, &firstRow, &endRow);
+
+    if (firstColumn >= endColumn || firstRow >= endRow) {
+        return;
+    }
+
+    for (size_t row = firstRow; row < endRow; row++) {
+        memset(grid->cells + row * grid->columns + firstColumn, occupied, endColumn - firstColumn);
+    }
+
+    grid->firstStaleRow = firstRow < grid->firstStaleRow ? firstRow : grid->firstStaleRow;
+}
+
+/**
+ *  Mark the cells of an occupancy grid that any rect of a rect array overlaps as occupied
+ *
+ *  @param grid The grid to change
+ *  @param rects The rects whose cells to mark as occupied
+ *
+ *  @see JSGOccupancyGridSetRect
+ */
+JSG_INLINE void JSGOccupancyGridAddRects(JSGOccupancyGrid *grid, const JSGRectArray *rects)
+{
+    for (size_t i = 0; i < rects->count; i++) {
+        JSGOccupancyGridSetRect(grid, JSGRectArrayGetRect(rects, i), true);
+    }
+}
+
+/**
+ *  Recompute the summed-area table of an occupancy grid after its cells changed
+ *
+ *  @param grid The grid to update
+ *
+ *  @discussion Only the rows from the first changed row on are recomputed. Each row of
+ *  sums is a running sum of the row's cells, plus the row above it in a separate pass that
+ *  the compiler can vectorize.
+ */
+JSG_INLINE void JSGOccupancyGridUpdate(JSGOccupancyGrid *grid)
+{
+    size_t columns = grid->columns;
+    size_t stride = columns + 1;
+
+    for (size_t row = grid->firstStaleRow; row < grid->rows; row++) {
+        const uint8_t *cells = grid->cells + row * columns;
+        const uint32_t *above = grid->sums + row * stride;
+        uint32_t *sums = grid->sums + (row + 1) * stride;
+        uint32_t running = 0;
+
+        for (size_t column = 0; column < columns; column++) {
+            running += cells[column];
+            sums[column + 1] = running;
+        }
+
+        for (size_t column = 1; column < stride; column++) {
+            sums[column] += above[column];
+        }
+    }
+
+    grid->firstStaleRow = grid->rows;
+}
+
+/**
+ *  Count the occupied cells of an occupancy grid that a rect overlaps
+ *
+ *  @param grid The grid to query, which must be up to date
+ *  @param rect The rect to count the occupied cells of. Cells that only touch its edges
+ *  aren't counted, and the parts of it outside of the grid count as free.
+ *
+ *  @return The number of occupied cells
+ */
+JSG_INLINE size_t JSGOccupancyGridCountOccupied(const JSGOccupancyGrid *grid, CGRect rect)
+{
+    size_t firstColumn, endColumn, firstRow, endRow;
+    rect = CGRectStandardize(rect);
+
+    JSGOccupancyGridGetRange(rect.origin.x, rect.origin.x + rect.size.width, grid->bounds.origin.x, grid->cellSize, grid->columns, &firstColumn, &endColumn);
+    JSGOccupancyGridGetRange(rect.origin.y, rect.origin.y + rect.size.height, grid->bounds.origin.y, grid->cellSize, grid->rows, &firstRow, &endRow);
+
+    if (firstColumn >= endColumn || firstRow >= endRow) {
+        return 0;
+    }
+
+    return JSGOccupancyGridSum(grid, firstColumn, endColumn, firstRow, endRow);
+}
+
+/**
+ *  Return whether all cells of an occupancy grid that a rect overlaps are free
+ *
+ *  @param grid The grid to query, which must be up to date
+ *  @param rect The rect to test
+ *
+ *  @see JSGOccupancyGridCountOccupied
+ */
+JSG_INLINE bool JSGOccupancyGridIsFree(const JSGOccupancyGrid *grid, CGRect rect)
+{
+    return JSGOccupancyGridCountOccupied(grid, rect) == 0;
+}
+
+/**
+ *  Find the first free area of an occupancy grid large enough to hold a size
+ *
+ *  @param grid The grid to search, which must be up to date
+ *  @param size The size to find room for
+ *  @param origin The origin of the free area, aligned to the cells of the grid, if one
+ *  is found
+ *
+ *  @return Whether a free area was found
+ *
+ *  @discussion Positions are tried row by row, from the minimum y of the grid, and from
+ *  the minimum x within each row. Each position is tested in constant time, and runs of
+ *  occupied cells are skipped over, so the search takes at most O(cells) time.
+ */
+JSG_INLINE bool JSGOccupancyGridFindFreeRect(const JSGOccupancyGrid *grid, CGSize size, CGPoint *origin)
+{
+    CGFloat width = ceil(fabs(size.width) / grid->cellSize);
+    CGFloat height = ceil(fabs(size.height) / grid->cellSize);
+
+    if (!(width <= (CGFloat)grid->columns && height <= (CGFloat)grid->rows)) {
+        return false;
+    }
+
+    size_t columnCount = width >= 1 ? (size_t)width : 1;
+    size_t rowCount = height >= 1 ? (size_t)height : 1;
+
+    for (size_t row = 0; row + rowCount <= grid->rows; row++) {
+        for (size_t column = 0; column + columnCount <= grid->columns; column++) {
+            if (JSGOccupancyGridSum(grid, column, column + columnCount, row, row + rowCount) == 0) {
+                origin->x = grid->bounds.origin.x + column * grid->cellSize;
+                origin->y = grid->bounds.origin.y + row * grid->cellSize;
+
+                return true;
+            }
+
+            // No position overlapping the last occupied column of this one can be free
+            size_t occupiedColumn = column + columnCount - 1;
+
+            while (JSGOccupancyGridSum(grid, occupiedColumn, occupiedColumn + 1, row, row + rowCount) == 0) {
+                occupiedColumn--;
+            }
+
+            column = occupiedColumn;
+        }
+    }
+
+    return false;
+}
+
+#endif
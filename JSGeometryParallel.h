@@ -0,0 +1,112 @@
+#ifndef JSGeometryParallel
+#define JSGeometryParallel
+
+#include <pthread.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Types
+
+/**
+ *  A function that performs one task of a parallel loop
+ *
+ *  @param context The context that was passed to JSGParallelFor
+ *  @param task The index of the task to perform
+ */
+typedef void (*JSGParallelFunction)(void *context, size_t task);
+
+typedef struct {
+    JSGParallelFunction function;
+    void *context;
+    size_t taskCount;
+    size_t nextTask;
+} JSGParallelLoop;
+
+#pragma mark - Private functions
+
+JSG_INLINE void JSGParallelLoopRun(JSGParallelLoop *loop)
+{
+    for (;;) {
+        size_t task = __atomic_fetch_add(&loop->nextTask, 1, __ATOMIC_RELAXED);
+
+        if (task >= loop->taskCount) {
+            return;
+        }
+
+        loop->function(loop->context, task);
+    }
+}
+
+JSG_INLINE void *JSGParallelLoopThread(void *loop)
+{
+    JSGParallelLoopRun((JSGParallelLoop *)loop);
+
+    return NULL;
+}
+
+#pragma mark - Parallel functions
+
+/**
+ *  Return the number of threads used by default by the parallel JSGeometry functions
+ *
+ *  @discussion This is the number of CPUs that are currently online.
+ */
+JSG_INLINE size_t JSGParallelGetDefaultThreadCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? (size_t)count : 1;
+}
+
+/**
+ *  Perform a number of tasks, using multiple threads
+ *
+ *  @param taskCount The number of tasks to perform
+ *  @param threadCount The maximum number of threads to use, including the calling thread.
+ *  Pass 0 to use JSGParallelGetDefaultThreadCount.
+ *  @param function The function to call for each task
+ *  @param context A pointer that is passed to the function
+ *
+ *  @discussion Tasks are handed out to threads dynamically, so the order in which they're
+ *  performed is undefined. To get deterministic results, each task should write its result
+ *  to a location of its own, to be combined in a fixed order once this function returns.
+ *  If threads can't be created, the remaining tasks are performed on the calling thread.
+ *
+ *  This isn't a thread pool: up to threadCount - 1 threads (at most 64) are created with
+ *  pthread_create on every call, & joined before it returns. Each call therefore pays the
+ *  cost of starting & joining its threads, typically 10 to 20 microseconds per thread on
+ *  Linux, so spreading work over threads only pays off for work that takes considerably
+ *  longer than that. Passing a threadCount of 1, or a single task, creates no threads.
+ */
+JSG_INLINE void JSGParallelFor(size_t taskCount, size_t threadCount, JSGParallelFunction function, void *context)
+{
+    if (threadCount == 0) {
+        threadCount = JSGParallelGetDefaultThreadCount();
+    }
+
+    if (threadCount > taskCount) {
+        threadCount = taskCount;
+    }
+
+    JSGParallelLoop loop = {function, context, taskCount, 0};
+    pthread_t threads[64];
+    size_t startedCount = 0;
+
+    for (size_t i = 1; i < threadCount && startedCount < 64; i++) {
+        if (pthread_create(&threads[startedCount], NULL, JSGParallelLoopThread, &loop) != 0) {
+            break;
+        }
+
+        startedCount++;
+    }
+
+    JSGParallelLoopRun(&loop);
+
+    for (size_t i = 0; i < startedCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef JSGeometryPlacement
+#define JSGeometryPlacement
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "JSGeometry.h"
+#include "JSGeometrySpatialGrid.h"
+
+#pragma mark - Enums
+
+/**
+ *  Enum describing how a popover is aligned along the side of its anchor
+ *
+ *  @discussion For the top & bottom sides, start aligns the left edges of the popover &
+ *  anchor, and end aligns their right edges. For the left & right sides, start aligns their
+ *  top edges, and end aligns their bottom edges.
+ */
+typedef enum : NSUInteger {
+    JSGPlacementAlignmentStart,
+    JSGPlacementAlignmentCenter,
+    JSGPlacementAlignmentEnd
+} JSGPlacementAlignment;
+
+#pragma mark - Types
+
+/**
+ *  The number of candidate placements evaluated for a popover: each alignment along each
+ *  side of the anchor
+ */
+#define JSG_PLACEMENT_CANDIDATE_COUNT 12
+
+/**
+ *  The costs used to score candidate placements
+ *
+ *  @discussion The cost of a candidate is the sum of:
+ *  - overflow, for each unit of area of the popover that is outside of the bounds
+ *  - obstruction, for each unit of area of the popover that overlaps obstacles
+ *  - shift, for each unit of distance that the popover was shifted to fit in the bounds
+ *  - flip, if the candidate is on the side opposite the preferred side
+ *  - side, if the candidate is on a side perpendicular to the preferred side
+ *  - alignment, if the candidate doesn't use the preferred alignment
+ *
+ *  The candidate with the lowest cost is picked.
+ */
+typedef struct {
+    CGFloat overflow;
+    CGFloat obstruction;
+    CGFloat shift;
+    CGFloat flip;
+    CGFloat side;
+    CGFloat alignment;
+} JSGPlacementCosts;
+
+/**
+ *  The placement picked for a popover
+ */
+typedef struct {
+    CGRect frame;
+    JSGRectAlignment side;
+    JSGPlacementAlignment alignment;
+    CGFloat cost;
+} JSGPlacement;
+
+typedef struct {
+    CGFloat minX[JSG_PLACEMENT_CANDIDATE_COUNT];
+    CGFloat minY[JSG_PLACEMENT_CANDIDATE_COUNT];
+    CGFloat maxX[JSG_PLACEMENT_CANDIDATE_COUNT];
+    CGFloat maxY[JSG_PLACEMENT_CANDIDATE_COUNT];
+    CGFloat obstruction[JSG_PLACEMENT_CANDIDATE_COUNT];
+} JSGPlacementCandidates;
+
+#pragma mark - Private constants
+
+/**
+ *  Coefficients of the anchor's size, the popover's size & the spacing that give the
+ *  offset of each candidate from the anchor's origin, in a top left coordinate system
+ */
+JSG_CONSTANT signed char JSGPlacementCoefficients[JSG_PLACEMENT_CANDIDATE_COUNT][6] = {
+    {0, 0, 0, 0, -2, -2}, {1, -1, 0, 0, -2, -2}, {2, -2, 0, 0, -2, -2},
+    {2, 0, 2, 0, 0, 0}, {2, 0, 2, 1, -1, 0}, {2, 0, 2, 2, -2, 0},
+    {0, 0, 0, 2, 0, 2}, {1, -1, 0, 2, 0, 2}, {2, -2, 0, 2, 0, 2},
+    {0, -2, -2, 0, 0, 0}, {0, -2, -2, 1, -1, 0}, {0, -2, -2, 2, -2, 0}
+};
+
+#pragma mark - Private functions
+
+JSG_INLINE size_t JSGPlacementGetSideIndex(JSGRectAlignment side)
+{
+    switch (side) {
+        case JSGRectAlignmentRight:
+            return 1;
+        case JSGRectAlignmentBottom:
+            return 2;
+        case JSGRectAlignmentLeft:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+JSG_INLINE bool JSGPlacementAccumulateObstruction(void *context, size_t item, CGRect rect)
+{
+    JSGPlacementCandidates *candidates = (JSGPlacementCandidates *)context;
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    (void)item;
+
+    for (size_t lane = 0; lane < JSG_PLACEMENT_CANDIDATE_COUNT; lane++) {
+        CGFloat left = candidates->minX[lane] > minX ? candidates->minX[lane] : minX;
+        CGFloat top = candidates->minY[lane] > minY ? candidates->minY[lane] : minY;
+        CGFloat right = candidates->maxX[lane] < maxX ? candidates->maxX[lane] : maxX;
+        CGFloat bottom = candidates->maxY[lane] < maxY ? candidates->maxY[lane] : maxY;
+
+        candidates->obstruction[lane] += (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+    }
+
+    return true;
+}
+
+#pragma mark - Placement functions
+
+/**
+ *  Return the default costs used to score candidate placements
+ *
+ *  @discussion Overflowing the bounds is much worse than covering obstacles, and any
+ *  overflow or obstruction outweighs a flip, which outweighs using a perpendicular side.
+ *  Shifting the popover by a few points is preferred to changing its alignment.
+ */
+JSG_INLINE JSGPlacementCosts JSGPlacementCostsDefault(void)
+{
+    JSGPlacementCosts costs;
+    costs.overflow = 10000;
+    costs.obstruction = 100;
+    costs.shift = 1;
+    costs.flip = 400;
+    costs.side = 800;
+    costs.alignment = 50;
+
+    return costs;
+}
+
+/**
+ *  Find the best placement for a popover next to an anchor
+ *
+ *  @param anchor The rect to place the popover next to
+ *  @param size The size of the popover
+ *  @param spacing The distance between the anchor & the popover
+ *  @param bounds The rect that the popover should stay within, such as the screen
+ *  @param obstacles A spatial grid of rects that the popover should avoid covering, or NULL.
+ *  It should not contain the anchor.
+ *  @param preferredSide The side of the anchor to place the popover on if possible. Must be
+ *  a single alignment.
+ *  @param preferredAlignment The alignment to use if possible
+ *  @param origin The origin of the coordinate system, which determines where the top side
+ *  of the anchor is
+ *  @param costs The costs used to score the candidates, or NULL to use the default costs
+ *
+ *  @discussion Each alignment along each side is a candidate. Every candidate is shifted
+ *  along its side to fit within the bounds, while still touching the anchor, and then
+ *  scored. All candidates are evaluated together: each step is performed on all of them
+ *  in a single branch-free loop, and the obstacles around the anchor are fetched from the
+ *  spatial grid in a single query.
+ *
+ *  @see JSGPlacementCosts
+ */
+JSG_INLINE JSGPlacement JSGPlacementFind(CGRect anchor, CGSize size, CGFloat spacing, CGRect bounds, const JSGSpatialGrid *obstacles, JSGRectAlignment preferredSide, JSGPlacementAlignment preferredAlignment, JSGCoordinateSystemOrigin origin, const JSGPlacementCosts *costs)
+{
+    JSGPlacementCosts defaultCosts = JSGPlacementCostsDefault();
+    costs = costs ? costs : &defaultCosts;
+    anchor = CGRectStandardize(anchor);
+    bounds = CGRectStandardize(bounds);
+
+    CGFloat boundsMinX = bounds.origin.x;
+    CGFloat boundsMinY = bounds.origin.y;
+    CGFloat boundsMaxX = boundsMinX + bounds.size.width;
+    CGFloat boundsMaxY = boundsMinY + bounds.size.height;
+    CGFloat anchorMinX = anchor.origin.x;
+    CGFloat anchorMinY = anchor.origin.y;
+    CGFloat anchorMaxX = anchorMinX + anchor.size.width;
+    CGFloat anchorMaxY = anchorMinY + anchor.size.height;
+    CGFloat width = size.width;
+    CGFloat height = size.height;
+    size_t preferredSideIndex = JSGPlacementGetSideIndex(preferredSide);
+    JSGPlacementCandidates candidates;
+    CGFloat shifts[JSG_PLACEMENT_CANDIDATE_COUNT];
+    CGFloat sideCosts[JSG_PLACEMENT_CANDIDATE_COUNT];
+
+    for (size_t lane = 0; lane < JSG_PLACEMENT_CANDIDATE_COUNT; lane++) {
+        // With a bottom left origin, the top & bottom sides are swapped, and so are the
+        // start & end alignments of the left & right sides
+        size_t side = lane / 3;
+        size_t alignment = lane % 3;
+        size_t row = origin == JSGCoordinateSystemOriginBottomLeft ? (side % 2 ? side * 3 + 2 - alignment : (side ^ 2) * 3 + alignment) : lane;
+        const signed char *k = JSGPlacementCoefficients[row];
+        bool shiftsHorizontally = side % 2 == 0;
+
+        CGFloat x = anchorMinX + (k[0] * anchor.size.width + k[1] * width + k[2] * spacing) / 2;
+        CGFloat y = anchorMinY + (k[3] * anchor.size.height + k[4] * height + k[5] * spacing) / 2;
+
+        // Shift into the bounds (favoring the top left edges when the popover doesn't
+        // fit), but never so far that the popover no longer touches the anchor
+        CGFloat shiftedX = x < boundsMaxX - width ? x : boundsMaxX - width;
+        CGFloat shiftedY = y < boundsMaxY - height ? y : boundsMaxY - height;
+        shiftedX = shiftedX > boundsMinX ? shiftedX : boundsMinX;
+        shiftedY = shiftedY > boundsMinY ? shiftedY : boundsMinY;
+        shiftedX = shiftedX > anchorMinX - width ? shiftedX : anchorMinX - width;
+        shiftedY = shiftedY > anchorMinY - height ? shiftedY : anchorMinY - height;
+        shiftedX = shiftedX < anchorMaxX ? shiftedX : anchorMaxX;
+        shiftedY = shiftedY < anchorMaxY ? shiftedY : anchorMaxY;
+
+        shifts[lane] = shiftsHorizontally ? fabs(shiftedX - x) : fabs(shiftedY - y);
+        x = shiftsHorizontally ? shiftedX : x;
+        y = shiftsHorizontally ? y : shiftedY;
+
+        candidates.minX[lane] = x;
+        candidates.minY[lane] = y;
+        candidates.maxX[lane] = x + width;
+        candidates.maxY[lane] = y + height;
+        candidates.obstruction[lane] = 0;
+
+        sideCosts[lane] = side == preferredSideIndex ? 0 : side == (preferredSideIndex ^ 2) ? costs->flip : costs->side;
+        sideCosts[lane] += alignment == preferredAlignment ? 0 : costs->alignment;
+    }
+
+    if (obstacles) {
+        CGRect area;
+        area.origin.x = anchorMinX - width - spacing;
+        area.origin.y = anchorMinY - height - spacing;
+        area.size.width = anchor.size.width + 2 * (width + spacing);
+        area.size.height = anchor.size.height + 2 * (height + spacing);
+
+        JSGSpatialGridVisit(obstacles, area, JSGPlacementAccumulateObstruction, &candidates);
+    }
+
+    CGFloat candidateCosts[JSG_PLACEMENT_CANDIDATE_COUNT];
+
+    for (size_t lane = 0; lane < JSG_PLACEMENT_CANDIDATE_COUNT; lane++) {
+        CGFloat left = candidates.minX[lane] > boundsMinX ? candidates.minX[lane] : boundsMinX;
+        CGFloat top = candidates.minY[lane] > boundsMinY ? candidates.minY[lane] : boundsMinY;
+        CGFloat right = candidates.maxX[lane] < boundsMaxX ? candidates.maxX[lane] : boundsMaxX;
+        CGFloat bottom = candidates.maxY[lane] < boundsMaxY ? candidates.maxY[lane] : boundsMaxY;
+        CGFloat overflow = width * height - (right > left ? right - left : 0) * (bottom > top ? bottom - top : 0);
+
+        candidateCosts[lane] = overflow * costs->overflow + candidates.obstruction[lane] * costs->obstruction + shifts[lane] * costs->shift + sideCosts[lane];
+    }
+
+    size_t best = 0;
+
+    for (size_t lane = 1; lane < JSG_PLACEMENT_CANDIDATE_COUNT; lane++) {
+        best = candidateCosts[lane] < candidateCosts[best] ? lane : best;
+    }
+
+    JSGPlacement placement;
+    placement.frame.origin.x = candidates.minX[best];
+    placement.frame.origin.y = candidates.minY[best];
+    placement.frame.size = size;
+    placement.side = (JSGRectAlignment)(1 << (best / 3));
+    placement.alignment = (JSGPlacementAlignment)(best % 3);
+    placement.cost = candidateCosts[best];
+
+    return placement;
+}
+
+#endif
@@ -0,0 +1,882 @@
+#ifndef JSGeometryRTree
+#define JSGeometryRTree
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Types
+
+/**
+ *  The maximum & minimum number of entries of an R-tree node. Only the root may have fewer
+ *  than the minimum.
+ */
+#define JSG_RTREE_NODE_CAPACITY 16
+#define JSG_RTREE_NODE_MINIMUM 6
+
+/**
+ *  The maximum height of an R-tree. Since every node but the root is at least minimally
+ *  filled, this is more than any tree that fits in memory can reach.
+ */
+#define JSG_RTREE_MAX_HEIGHT 32
+
+/**
+ *  The maximum number of readers that may be registered with an R-tree at once
+ */
+#define JSG_RTREE_MAX_READERS 64
+
+/**
+ *  A node of an R-tree
+ *
+ *  @discussion Nodes are immutable once published. Leaves (of height 0) hold the indices of
+ *  items, & other nodes hold their children, along with the bounds of each entry.
+ */
+typedef struct JSGRTreeNode {
+    CGFloat minXs[JSG_RTREE_NODE_CAPACITY + 1];
+    CGFloat minYs[JSG_RTREE_NODE_CAPACITY + 1];
+    CGFloat maxXs[JSG_RTREE_NODE_CAPACITY + 1];
+    CGFloat maxYs[JSG_RTREE_NODE_CAPACITY + 1];
+    struct JSGRTreeNode *children[JSG_RTREE_NODE_CAPACITY + 1];
+    size_t items[JSG_RTREE_NODE_CAPACITY + 1];
+    size_t count;
+    size_t height;
+    uint64_t version;
+    uint64_t retiredEpoch;
+    struct JSGRTreeNode *next;
+} JSGRTreeNode;
+
+/**
+ *  A function that is called for each item found by an R-tree query
+ *
+ *  @param context The context that was passed to the query
+ *  @param item The index of the item
+ *  @param rect The rect of the item
+ *
+ *  @return Whether the query should continue
+ */
+typedef bool (*JSGRTreeVisitor)(void *context, size_t item, CGRect rect);
+
+/**
+ *  A version of an R-tree, which doesn't change while it's being read
+ */
+typedef struct {
+    const JSGRTreeNode *root;
+} JSGRTreeSnapshot;
+
+typedef struct {
+    uint64_t epoch;
+    uint64_t used;
+    unsigned char padding[48];
+} JSGRTreeReaderSlot;
+
+/**
+ *  A persistent R-tree, which threads can read without locks while it's being written
+ *
+ *  @discussion Writes never change published nodes. Instead, each node on the path to a
+ *  change is copied (path copying), & the copies are published together with a new root
+ *  by JSGRTreePublish, using a single atomic store. Readers therefore always see a
+ *  complete version of the tree. Nodes created since the last publish are changed in place,
+ *  so a batch of writes only copies each node once.
+ *
+ *  Replaced nodes are freed using epoch-based reclamation: each reader announces the epoch
+ *  in which it started reading, & nodes are only freed once every reader has moved past
+ *  the epoch in which they were replaced.
+ *
+ *  A tree should be initialized using JSGRTreeInit, and destroyed using JSGRTreeDestroy
+ *  once it's no longer needed & no reader is reading it. Writes (inserting, removing,
+ *  publishing & reclaiming) must not be performed from multiple threads at once, but may be
+ *  performed while other threads read.
+ */
+typedef struct {
+    JSGRTreeNode *root;
+    JSGRTreeNode *pendingRoot;
+    size_t count;
+    uint64_t version;
+    uint64_t epoch;
+    JSGRTreeNode *pendingRetired;
+    JSGRTreeNode *retiredHead;
+    JSGRTreeNode *retiredTail;
+    JSGRTreeNode *spareNodes;
+    size_t spareCount;
+    JSGRTreeReaderSlot readers[JSG_RTREE_MAX_READERS];
+} JSGRTree;
+
+#pragma mark - Private functions
+
+JSG_INLINE void JSGRTreeFreeList(JSGRTreeNode *node)
+{
+    while (node) {
+        JSGRTreeNode *next = node->next;
+        free(node);
+        node = next;
+    }
+}
+
+JSG_INLINE void JSGRTreeFreeNodes(JSGRTreeNode *node)
+{
+    for (size_t i = 0; node->height > 0 && i < node->count; i++) {
+        JSGRTreeFreeNodes(node->children[i]);
+    }
+
+    free(node);
+}
+
+/**
+ *  Make sure that there are enough spare nodes for a write, so that writes can't fail
+ *  halfway through
+ */
+JSG_INLINE bool JSGRTreeReserveNodes(JSGRTree *tree, size_t count)
+{
+    while (tree->spareCount < count) {
+        JSGRTreeNode *node = (JSGRTreeNode *)malloc(sizeof(JSGRTreeNode));
+
+        if (!node) {
+            return false;
+        }
+
+        node->next = tree->spareNodes;
+        tree->spareNodes = node;
+        tree->spareCount++;
+    }
+
+    return true;
+}
+
+JSG_INLINE JSGRTreeNode *JSGRTreeTakeNode(JSGRTree *tree, size_t height)
+{
+    JSGRTreeNode *node = tree->spareNodes;
+
+    tree->spareNodes = node->next;
+    tree->spareCount--;
+    node->count = 0;
+    node->height = height;
+    node->version = tree->version;
+    node->next = NULL;
+
+    return node;
+}
+
+/**
+ *  Drop a node from the pending version. Nodes created since the last publish have never
+ *  been seen by readers, so they're reused right away, while published nodes are retired.
+ */
+JSG_INLINE void JSGRTreeDiscardNode(JSGRTree *tree, JSGRTreeNode *node)
+{
+    if (node->version == tree->version) {
+        node->next = tree->spareNodes;
+        tree->spareNodes = node;
+        tree->spareCount++;
+    } else {
+        node->next = tree->pendingRetired;
+        tree->pendingRetired = node;
+    }
+}
+
+JSG_INLINE JSGRTreeNode *JSGRTreeMakeWritable(JSGRTree *tree, JSGRTreeNode *node)
+{
+    if (node->version == tree->version) {
+        return node;
+    }
+
+    JSGRTreeNode *copy = JSGRTreeTakeNode(tree, node->height);
+    memcpy(copy, node, sizeof(JSGRTreeNode));
+    copy->version = tree->version;
+    copy->next = NULL;
+    JSGRTreeDiscardNode(tree, node);
+
+    return copy;
+}
+
+JSG_INLINE void JSGRTreeNodeCopyEntry(JSGRTreeNode *destination, size_t destinationIndex, const JSGRTreeNode *source, size_t sourceIndex)
+{
+    destination->minXs[destinationIndex] = source->minXs[sourceIndex];
+    destination->minYs[destinationIndex] = source->minYs[sourceIndex];
+    destination->maxXs[destinationIndex] = source->maxXs[sourceIndex];
+    destination->maxYs[destinationIndex] = source->maxYs[sourceIndex];
+    destination->children[destinationIndex] = source->children[sourceIndex];
+    destination->items[destinationIndex] = source->items[sourceIndex];
+}
+
+JSG_INLINE void JSGRTreeNodeRemoveEntry(JSGRTreeNode *node, size_t index)
+{
+    node->count--;
+
+    if (index != node->count) {
+        JSGRTreeNodeCopyEntry(node, index, node, node->count);
+    }
+}
+
+JSG_INLINE void JSGRTreeNodeGetBounds(const JSGRTreeNode *node, CGFloat *box)
+{
+    box[0] = CGFLOAT_MAX;
+    box[1] = CGFLOAT_MAX;
+    box[2] = -CGFLOAT_MAX;
+    box[3] = -CGFLOAT_MAX;
+
+    for (size_t i = 0; i < node->count; i++) {
+        box[0] = node->minXs[i] < box[0] ? node->minXs[i] : box[0];
+        box[1] = node->minYs[i] < box[1] ? node->minYs[i] : box[1];
+        box[2] = node->maxXs[i] > box[2] ? node->maxXs[i] : box[2];
+        box[3] = node->maxYs[i] > box[3] ? node->maxYs[i] : box[3];
+    }
+}
+
+JSG_INLINE void JSGRTreeNodeSetEntryBounds(JSGRTreeNode *node, size_t index, const CGFloat *box)
+{
+    node->minXs[index] = box[0];
+    node->minYs[index] = box[1];
+    node->maxXs[index] = box[2];
+    node->maxYs[index] = box[3];
+}
+
+JSG_INLINE CGFloat JSGRTreeGetUnionArea(const CGFloat *box, CGFloat minX, CGFloat minY, CGFloat maxX, CGFloat maxY)
+{
+    CGFloat width = (maxX > box[2] ? maxX : box[2]) - (minX < box[0] ? minX : box[0]);
+    CGFloat height = (maxY > box[3] ? maxY : box[3]) - (minY < box[1] ? minY : box[1]);
+
+    return width * height;
+}
+
+/**
+ *  Split an overflowing node in two
+ *
+ *  @discussion Entries are sorted by center on each axis, & the node is split at the
+ *  position that gives the least overlap between both halves, then the least total area,
+ *  as in the R*-tree.
+ */
+JSG_INLINE void JSGRTreeSplit(JSGRTreeNode *node, JSGRTreeNode *sibling)
+{
+    size_t count = node->count;
+    size_t orders[2][JSG_RTREE_NODE_CAPACITY + 1];
+    CGFloat prefixes[JSG_RTREE_NODE_CAPACITY + 1][4];
+    CGFloat bestOverlap = CGFLOAT_MAX;
+    CGFloat bestArea = CGFLOAT_MAX;
+    size_t bestAxis = 0;
+    size_t bestIndex = JSG_RTREE_NODE_MINIMUM;
+
+    for (size_t axis = 0; axis < 2; axis++) {
+        const CGFloat *mins = axis ? node->minYs : node->minXs;
+        const CGFloat *maxs = axis ? node->maxYs : node->maxXs;
+        size_t *order = orders[axis];
+
+        for (size_t i = 0; i < count; i++) {
+            size_t j = i;
+
+            for (; j > 0 && mins[order[j - 1]] + maxs[order[j - 1]] > mins[i] + maxs[i]; j--) {
+                order[j] = order[j - 1];
+            }
+
+            order[j] = i;
+        }
+
+        CGFloat box[4] = {CGFLOAT_MAX, CGFLOAT_MAX, -CGFLOAT_MAX, -CGFLOAT_MAX};
+
+        for (size_t i = 0; i < count; i++) {
+            size_t entry = order[i];
+            box[0] = node->minXs[entry] < box[0] ? node->minXs[entry] : box[0];
+            box[1] = node->minYs[entry] < box[1] ? node->minYs[entry] : box[1];
+            box[2] = node->maxXs[entry] > box[2] ? node->maxXs[entry] : box[2];
+            box[3] = node->maxYs[entry] > box[3] ? node->maxYs[entry] : box[3];
+            memcpy(prefixes[i], box, sizeof(box));
+        }
+
+        box[0] = CGFLOAT_MAX;
+        box[1] = CGFLOAT_MAX;
+        box[2] = -CGFLOAT_MAX;
+        box[3] = -CGFLOAT_MAX;
+
+        // Walking backwards, box holds the bounds of the entries from index on
+        for (size_t index = count - 1; index >= JSG_RTREE_NODE_MINIMUM; index--) {
+            size_t entry = order[index];
+            box[0] = node->minXs[entry] < box[0] ? node->minXs[entry] : box[0];
+            box[1] = node->minYs[entry] < box[1] ? node->minYs[entry] : box[1];
+            box[2] = node->maxXs[entry] > box[2] ? node->maxXs[entry] : box[2];
+            box[3] = node->maxYs[entry] > box[3] ? node->maxYs[entry] : box[3];
+
+            if (count - index < JSG_RTREE_NODE_MINIMUM) {
+                continue;
+            }
+
+            const CGFloat *left = prefixes[index - 1];
+            CGFloat overlapWidth = (left[2] < box[2] ? left[2] : box[2]) - (left[0] > box[0] ? left[0] : box[0]);
+            CGFloat overlapHeight = (left[3] < box[3] ? left[3] : box[3]) - (left[1] > box[1] ? left[1] : box[1]);
+            CGFloat overlap = overlapWidth > 0 && overlapHeight > 0 ? overlapWidth * overlapHeight : 0;
+            CGFloat area = (left[2] - left[0]) * (left[3] - left[1]) + (box[2] - box[0]) * (box[3] - box[1]);
+
+            if (overlap < bestOverlap || (overlap == bestOverlap && area < bestArea)) {
+                bestOverlap = overlap;
+                bestArea = area;
+                bestAxis = axis;
+                bestIndex = index;
+            }
+        }
+    }
+
+    JSGRTreeNode entries;
+    memcpy(&entries, node, sizeof(JSGRTreeNode));
+    node->count = bestIndex;
+    sibling->count = count - bestIndex;
+
+    for (size_t i = 0; i < count; i++) {
+        if (i < bestIndex) {
+            JSGRTreeNodeCopyEntry(node, i, &entries, orders[bestAxis][i]);
+        } else {
+            JSGRTreeNodeCopyEntry(sibling, i - bestIndex, &entries, orders[bestAxis][i]);
+        }
+    }
+}
+
+/**
+ *  Find the path to the leaf entry of an item, returning the depth of the leaf or
+ *  JSG_RTREE_MAX_HEIGHT if the item isn't in the subtree
+ */
+JSG_INLINE size_t JSGRTreeFind(JSGRTreeNode *node, size_t item, const CGFloat *box, size_t depth, JSGRTreeNode **path, size_t *slots)
+{
+    path[depth] = node;
+
+    for (size_t i = 0; i < node->count; i++) {
+        if (node->height == 0) {
+            if (node->items[i] == item && node->minXs[i] == box[0] && node->minYs[i] == box[1] && node->maxXs[i] == box[2] && node->maxYs[i] == box[3]) {
+                slots[depth] = i;
+                return depth;
+            }
+
+            continue;
+        }
+
+        if (node->minXs[i] <= box[0] && node->minYs[i] <= box[1] && node->maxXs[i] >= box[2] && node->maxYs[i] >= box[3]) {
+            slots[depth] = i;
+
+            size_t leaf = JSGRTreeFind(node->children[i], item, box, depth + 1, path, slots);
+
+            if (leaf != JSG_RTREE_MAX_HEIGHT) {
+                return leaf;
+            }
+        }
+    }
+
+    return JSG_RTREE_MAX_HEIGHT;
+}
+
+typedef struct {
+    size_t *items;
+    size_t capacity;
+    size_t count;
+} JSGRTreeQueryContext;
+
+JSG_INLINE bool JSGRTreeQueryVisitor(void *context, size_t item, CGRect rect)
+{
+    JSGRTreeQueryContext *query = (JSGRTreeQueryContext *)context;
+    (void)rect;
+
+    if (query->count < query->capacity) {
+        query->items[query->count] = item;
+    }
+
+    query->count++;
+
+    return true;
+}
+
+#pragma mark - Writer functions
+
+/**
+ *  Initialize an empty R-tree
+ *
+ *  @param tree The tree to initialize
+ */
+JSG_INLINE void JSGRTreeInit(JSGRTree *tree)
+{
+    memset(tree, 0, sizeof(JSGRTree));
+    tree->version = 1;
+    tree->epoch = 1;
+}
+
+/**
+ *  Destroy an R-tree, freeing all of its memory
+ *
+ *  @param tree The tree to destroy
+ *
+ *  @discussion No reader may be reading the tree.
+ */
+JSG_INLINE void JSGRTreeDestroy(JSGRTree *tree)
+{
+    // Published nodes are either shared with the pending version, or were retired by it
+    if (tree->pendingRoot) {
+        JSGRTreeFreeNodes(tree->pendingRoot);
+    }
+
+    JSGRTreeFreeList(tree->pendingRetired);
+    JSGRTreeFreeList(tree->retiredHead);
+    JSGRTreeFreeList(tree->spareNodes);
+    memset(tree, 0, sizeof(JSGRTree));
+}
+
+/**
+ *  Insert an item in the pending version of an R-tree
+ *
+ *  @param tree The tree to insert into
+ *  @param item The index of the item, which is reported by queries
+ *  @param rect The rect of the item
+ *
+ *  @return Whether the item could be inserted. This is only false if memory could not be
+ *  allocated, in which case the tree is left untouched.
+ *
+ *  @discussion The item isn't visible to readers until the tree is published.
+ */
+JSG_INLINE bool JSGRTreeInsert(JSGRTree *tree, size_t item, CGRect rect)
+{
+    size_t height = tree->pendingRoot ? tree->pendingRoot->height : 0;
+
+    // Each level may need a copy & a split, plus a new root
+    if (!JSGRTreeReserveNodes(tree, height * 2 + 4)) {
+        return false;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    JSGRTreeNode *path[JSG_RTREE_MAX_HEIGHT];
+    size_t slots[JSG_RTREE_MAX_HEIGHT];
+    size_t depth = 0;
+
+    if (!tree->pendingRoot) {
+        tree->pendingRoot = JSGRTreeTakeNode(tree, 0);
+    }
+
+    JSGRTreeNode *node = JSGRTreeMakeWritable(tree, tree->pendingRoot);
+    tree->pendingRoot = node;
+
+    // Descend into the child that needs the least enlargement, then has the least area
+    while (node->height > 0) {
+        size_t best = 0;
+        CGFloat bestEnlargement = CGFLOAT_MAX;
+        CGFloat bestArea = CGFLOAT_MAX;
+
+        for (size_t i = 0; i < node->count; i++) {
+            CGFloat box[4] = {node->minXs[i], node->minYs[i], node->maxXs[i], node->maxYs[i]};
+            CGFloat area = (box[2] - box[0]) * (box[3] - box[1]);
+            CGFloat enlargement = JSGRTreeGetUnionArea(box, minX, minY, maxX, maxY) - area;
+
+            if (enlargement < bestEnlargement || (enlargement == bestEnlargement && area < bestArea)) {
+                best = i;
+                bestEnlargement = enlargement;
+                bestArea = area;
+            }
+        }
+
+        node->minXs[best] = minX < node->minXs[best] ? minX : node->minXs[best];
+        node->minYs[best] = minY < node->minYs[best] ? minY : node->minYs[best];
+        node->maxXs[best] = maxX > node->maxXs[best] ? maxX : node->maxXs[best];
+        node->maxYs[best] = maxY > node->maxYs[best] ? maxY : node->maxYs[best];
+        node->children[best] = JSGRTreeMakeWritable(tree, node->children[best]);
+        path[depth] = node;
+        slots[depth] = best;
+        depth++;
+        node = node->children[best];
+    }
+
+    node->minXs[node->count] = minX;
+    node->minYs[node->count] = minY;
+    node->maxXs[node->count] = maxX;
+    node->maxYs[node->count] = maxY;
+    node->children[node->count] = NULL;
+    node->items[node->count] = item;
+    node->count++;
+
+    // Split overflowing nodes up the path, growing a new root if the root splits
+    while (node->count > JSG_RTREE_NODE_CAPACITY) {
+        JSGRTreeNode *sibling = JSGRTreeTakeNode(tree, node->height);
+        CGFloat box[4];
+
+        JSGRTreeSplit(node, sibling);
+
+        JSGRTreeNode *parent;
+        size_t slot;
+
+        if (depth == 0) {
+            parent = JSGRTreeTakeNode(tree, node->height + 1);
+            parent->count = 1;
+            parent->children[0] = node;
+            parent->items[0] = 0;
+            slot = 0;
+            tree->pendingRoot = parent;
+        } else {
+            depth--;
+            parent = path[depth];
+            slot = slots[depth];
+        }
+
+        JSGRTreeNodeGetBounds(node, box);
+        JSGRTreeNodeSetEntryBounds(parent, slot, box);
+        JSGRTreeNodeGetBounds(sibling, box);
+        JSGRTreeNodeSetEntryBounds(parent, parent->count, box);
+        parent->children[parent->count] = sibling;
+        parent->items[parent->count] = 0;
+        parent->count++;
+        node = parent;
+    }
+
+    tree->count++;
+
+    return true;
+}
+
+/**
+ *  Remove an item from the pending version of an R-tree
+ *
+ *  @param tree The tree to remove from
+ *  @param item The index of the item
+ *  @param rect The rect that the item was inserted with
+ *
+ *  @return Whether the item was removed. This is false if the tree has no item with this
+ *  index & rect, or if memory could not be allocated, in which case the tree is left
+ *  untouched.
+ *
+ *  @discussion A node left with fewer than JSG_RTREE_NODE_MINIMUM entries is merged into
+ *  the sibling whose bounds grow the least, or borrows entries from it when both don't fit
+ *  in a node, which keeps the tree balanced without reinserting items.
+ */
+JSG_INLINE bool JSGRTreeRemove(JSGRTree *tree, size_t item, CGRect rect)
+{
+    if (!tree->pendingRoot) {
+        return false;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    CGFloat box[4] = {rect.origin.x, rect.origin.y, rect.origin.x + rect.size.width, rect.origin.y + rect.size.height};
+    JSGRTreeNode *path[JSG_RTREE_MAX_HEIGHT];
+    size_t slots[JSG_RTREE_MAX_HEIGHT];
+    size_t depth = JSGRTreeFind(tree->pendingRoot, item, box, 0, path, slots);
+
+    // Each level may need a copy of the node on the path & of a sibling
+    if (depth == JSG_RTREE_MAX_HEIGHT || !JSGRTreeReserveNodes(tree, depth * 2 + 2)) {
+        return false;
+    }
+
+    path[0] = JSGRTreeMakeWritable(tree, path[0]);
+    tree->pendingRoot = path[0];
+
+    for (size_t i = 1; i <= depth; i++) {
+        path[i] = JSGRTreeMakeWritable(tree, path[i]);
+        path[i - 1]->children[slots[i - 1]] = path[i];
+    }
+
+    JSGRTreeNodeRemoveEntry(path[depth], slots[depth]);
+
+    for (size_t i = depth; i > 0; i--) {
+        JSGRTreeNode *node = path[i];
+        JSGRTreeNode *parent = path[i - 1];
+        size_t slot = slots[i - 1];
+        CGFloat nodeBox[4];
+
+        JSGRTreeNodeGetBounds(node, nodeBox);
+
+        if (node->count >= JSG_RTREE_NODE_MINIMUM || parent->count == 1) {
+            if (node->count == 0) {
+                JSGRTreeNodeRemoveEntry(parent, slot);
+                JSGRTreeDiscardNode(tree, node);
+            } else {
+                JSGRTreeNodeSetEntryBounds(parent, slot, nodeBox);
+            }
+
+            continue;
+        }
+
+        size_t sibling = slot == 0 ? 1 : 0;
+        CGFloat bestArea = CGFLOAT_MAX;
+
+        for (size_t j = 0; j < parent->count; j++) {
+            CGFloat siblingBox[4] = {parent->minXs[j], parent->minYs[j], parent->maxXs[j], parent->maxYs[j]};
+            CGFloat area = JSGRTreeGetUnionArea(siblingBox, nodeBox[0], nodeBox[1], nodeBox[2], nodeBox[3]);
+
+            if (j != slot && area < bestArea) {
+                sibling = j;
+                bestArea = area;
+            }
+        }
+
+        JSGRTreeNode *siblingNode = JSGRTreeMakeWritable(tree, parent->children[sibling]);
+        CGFloat siblingBox[4];
+        parent->children[sibling] = siblingNode;
+
+        if (siblingNode->count + node->count <= JSG_RTREE_NODE_CAPACITY) {
+            for (size_t j = 0; j < node->count; j++) {
+                JSGRTreeNodeCopyEntry(siblingNode, siblingNode->count++, node, j);
+            }
+
+            JSGRTreeNodeGetBounds(siblingNode, siblingBox);
+            JSGRTreeNodeSetEntryBounds(parent, sibling, siblingBox);
+            JSGRTreeNodeRemoveEntry(parent, slot);
+            JSGRTreeDiscardNode(tree, node);
+
+            continue;
+        }
+
+        // The sibling has more than the minimum to spare, so move its entries that grow the
+        // node the least
+        while (node->count < JSG_RTREE_NODE_MINIMUM) {
+            size_t best = 0;
+            CGFloat bestGrowth = CGFLOAT_MAX;
+
+            for (size_t j = 0; j < siblingNode->count; j++) {
+                CGFloat growth = JSGRTreeGetUnionArea(nodeBox, siblingNode->minXs[j], siblingNode->minYs[j], siblingNode->maxXs[j], siblingNode->maxYs[j]);
+
+                if (growth < bestGrowth) {
+                    best = j;
+                    bestGrowth = growth;
+                }
+            }
+
+            JSGRTreeNodeCopyEntry(node, node->count++, siblingNode, best);
+            JSGRTreeNodeRemoveEntry(siblingNode, best);
+            JSGRTreeNodeGetBounds(node, nodeBox);
+        }
+
+        JSGRTreeNodeGetBounds(siblingNode, siblingBox);
+        JSGRTreeNodeSetEntryBounds(parent, sibling, siblingBox);
+        JSGRTreeNodeSetEntryBounds(parent, slot, nodeBox);
+    }
+
+    // Shrink the tree while the root has a single child, & drop it when it's empty
+    JSGRTreeNode *root = tree->pendingRoot;
+
+    while (root->height > 0 && root->count == 1) {
+        tree->pendingRoot = root->children[0];
+        JSGRTreeDiscardNode(tree, root);
+        root = tree->pendingRoot;
+    }
+
+    if (root->count == 0) {
+        tree->pendingRoot = NULL;
+        JSGRTreeDiscardNode(tree, root);
+    }
+
+    tree->count--;
+
+    return true;
+}
+
+/**
+ *  Free the nodes that were replaced in epochs that all readers have moved past
+ *
+ *  @param tree The tree to reclaim memory from
+ *
+ *  @discussion This is done by JSGRTreePublish, but can also be called when the tree isn't
+ *  being changed, to free nodes that were still being read when it was last published.
+ */
+JSG_INLINE void JSGRTreeReclaim(JSGRTree *tree)
+{
+    uint64_t minimumEpoch = UINT64_MAX;
+
+    for (size_t i = 0; i < JSG_RTREE_MAX_READERS; i++) {
+        uint64_t epoch = __atomic_load_n(&tree->readers[i].epoch, __ATOMIC_SEQ_CST);
+        minimumEpoch = epoch && epoch < minimumEpoch ? epoch : minimumEpoch;
+    }
+
+    while (tree->retiredHead && tree->retiredHead->retiredEpoch < minimumEpoch) {
+        JSGRTreeNode *next = tree->retiredHead->next;
+        free(tree->retiredHead);
+        tree->retiredHead = next;
+    }
+
+    if (!tree->retiredHead) {
+        tree->retiredTail = NULL;
+    }
+}
+
+/**
+ *  Publish the pending version of an R-tree, making all writes since the last publish
+ *  visible to readers at once
+ *
+ *  @param tree The tree to publish
+ *
+ *  @discussion The new root is stored atomically, so readers see either the previous
+ *  version or this one. The nodes that this version replaced are retired in the current
+ *  epoch, which is then advanced, & nodes that no reader can still be reading are freed.
+ */
+JSG_INLINE void JSGRTreePublish(JSGRTree *tree)
+{
+    uint64_t epoch = tree->epoch;
+
+    __atomic_store_n(&tree->root, tree->pendingRoot, __ATOMIC_SEQ_CST);
+
+    while (tree->pendingRetired) {
+        JSGRTreeNode *node = tree->pendingRetired;
+        tree->pendingRetired = node->next;
+        node->retiredEpoch = epoch;
+        node->next = NULL;
+
+        if (tree->retiredTail) {
+            tree->retiredTail->next = node;
+        } else {
+            tree->retiredHead = node;
+        }
+
+        tree->retiredTail = node;
+    }
+
+    __atomic_store_n(&tree->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+    tree->version++;
+    JSGRTreeReclaim(tree);
+}
+
+#pragma mark - Reader functions
+
+/**
+ *  Register a reader with an R-tree
+ *
+ *  @param tree The tree to read
+ *  @param reader Set to the index of the reader, to pass to the other reader functions
+ *
+ *  @return Whether the reader could be registered. This is false if JSG_RTREE_MAX_READERS
+ *  readers are already registered.
+ *
+ *  @discussion This may be called from any thread. Each thread that reads the tree should
+ *  register its own reader.
+ */
+JSG_INLINE bool JSGRTreeRegisterReader(JSGRTree *tree, size_t *reader)
+{
+    for (size_t i = 0; i < JSG_RTREE_MAX_READERS; i++) {
+        uint64_t unused = 0;
+
+        if (__atomic_compare_exchange_n(&tree->readers[i].used, &unused, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            *reader = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ *  Unregister a reader from an R-tree
+ *
+ *  @param tree The tree that was read
+ *  @param reader The index of the reader, which must not be reading
+ */
+JSG_INLINE void JSGRTreeUnregisterReader(JSGRTree *tree, size_t reader)
+{
+    __atomic_store_n(&tree->readers[reader].used, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ *  Start reading the latest published version of an R-tree
+ *
+ *  @param tree The tree to read
+ *  @param reader The index of the reader
+ *
+ *  @return A snapshot of the tree, whose nodes won't be freed until JSGRTreeEndRead is
+ *  called. Snapshots may be queried with any of the query functions.
+ *
+ *  @discussion This doesn't take any lock, so it never waits for the writer.
+ */
+JSG_INLINE JSGRTreeSnapshot JSGRTreeBeginRead(JSGRTree *tree, size_t reader)
+{
+    JSGRTreeSnapshot snapshot;
+
+    // The epoch is announced before loading the root, so that the writer can't free the
+    // nodes of a root that was loaded after its scan of the readers
+    __atomic_store_n(&tree->readers[reader].epoch, __atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    snapshot.root = __atomic_load_n(&tree->root, __ATOMIC_SEQ_CST);
+
+    return snapshot;
+}
+
+/**
+ *  Stop reading an R-tree, allowing the nodes of the snapshot to be freed
+ *
+ *  @param tree The tree that was read
+ *  @param reader The index of the reader
+ */
+JSG_INLINE void JSGRTreeEndRead(JSGRTree *tree, size_t reader)
+{
+    __atomic_store_n(&tree->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ *  Visit the items of an R-tree snapshot that intersect a rect
+ *
+ *  @param snapshot The snapshot to query
+ *  @param rect The rect to find intersecting items for
+ *  @param visitor The function to call for each item, which may stop the query by
+ *  returning false
+ *  @param context A pointer that is passed to the visitor
+ *
+ *  @discussion Items are intersecting when their interiors overlap, so items that only
+ *  touch the rect's edges are not visited. The order in which items are visited is
+ *  undefined.
+ */
+JSG_INLINE void JSGRTreeVisit(JSGRTreeSnapshot snapshot, CGRect rect, JSGRTreeVisitor visitor, void *context)
+{
+    if (!snapshot.root) {
+        return;
+    }
+
+    rect = CGRectStandardize(rect);
+
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    const JSGRTreeNode *stack[JSG_RTREE_MAX_HEIGHT * JSG_RTREE_NODE_CAPACITY];
+    size_t stackCount = 0;
+
+    stack[stackCount++] = snapshot.root;
+
+    while (stackCount) {
+        const JSGRTreeNode *node = stack[--stackCount];
+
+        for (size_t i = 0; i < node->count; i++) {
+            if (node->minXs[i] >= maxX || node->minYs[i] >= maxY || node->maxXs[i] <= minX || node->maxYs[i] <= minY) {
+                continue;
+            }
+
+            if (node->height > 0) {
+                stack[stackCount++] = node->children[i];
+                continue;
+            }
+
+            CGRect itemRect;
+            itemRect.origin.x = node->minXs[i];
+            itemRect.origin.y = node->minYs[i];
+            itemRect.size.width = node->maxXs[i] - node->minXs[i];
+            itemRect.size.height = node->maxYs[i] - node->minYs[i];
+
+            if (!visitor(context, node->items[i], itemRect)) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ *  Find the items of an R-tree snapshot that intersect a rect
+ *
+ *  @param snapshot The snapshot to query
+ *  @param rect The rect to find intersecting items for
+ *  @param items The array to write the indices of the items to, or NULL
+ *  @param capacity The number of indices that the items array has room for
+ *
+ *  @return The number of intersecting items. If this is larger than capacity, only the
+ *  first capacity items were written.
+ *
+ *  @see JSGRTreeVisit
+ */
+JSG_INLINE size_t JSGRTreeQuery(JSGRTreeSnapshot snapshot, CGRect rect, size_t *items, size_t capacity)
+{
+    JSGRTreeQueryContext context = {items, items ? capacity : 0, 0};
+    JSGRTreeVisit(snapshot, rect, JSGRTreeQueryVisitor, &context);
+
+    return context.count;
+}
+
+#endif
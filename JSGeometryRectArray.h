@@ -0,0 +1,210 @@
+#ifndef JSGeometryRectArray
+#define JSGeometryRectArray
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Types
+
+/**
+ *  An array of rects, stored as a structure of arrays
+ *
+ *  @discussion Rather than storing CGRects one after the other, each component (x, y,
+ *  width & height) is stored in an array of its own. This lets batch functions operate
+ *  on many rects at once using SIMD instructions. Rects are stored in their standardized
+ *  form (with a non-negative width & height), and the array should not contain null rects.
+ *
+ *  An array should be initialized using JSGRectArrayInit, and destroyed using
+ *  JSGRectArrayDestroy once it's no longer needed. The component arrays may be read &
+ *  written directly, for indices below count.
+ */
+typedef struct {
+    CGFloat *x;
+    CGFloat *y;
+    CGFloat *width;
+    CGFloat *height;
+    size_t count;
+    size_t capacity;
+} JSGRectArray;
+
+#pragma mark - Rect array functions
+
+/**
+ *  Initialize an empty rect array
+ *
+ *  @param array The array to initialize
+ */
+JSG_INLINE void JSGRectArrayInit(JSGRectArray *array)
+{
+    memset(array, 0, sizeof(JSGRectArray));
+}
+
+/**
+ *  Destroy a rect array, freeing all of its memory
+ *
+ *  @param array The array to destroy
+ */
+JSG_INLINE void JSGRectArrayDestroy(JSGRectArray *array)
+{
+    free(array->x);
+    free(array->y);
+    free(array->width);
+    free(array->height);
+    memset(array, 0, sizeof(JSGRectArray));
+}
+
+/**
+ *  Make sure that a rect array can hold a given number of rects without allocating
+ *
+ *  @param array The array to reserve capacity in
+ *  @param capacity The number of rects the array should be able to hold
+ *
+ *  @return Whether the capacity could be reserved. This is only false if memory
+ *  could not be allocated, in which case the array is left untouched.
+ */
+JSG_INLINE bool JSGRectArrayReserve(JSGRectArray *array, size_t capacity)
+{
+    if (capacity <= array->capacity) {
+        return true;
+    }
+
+    CGFloat **components[4] = {&array->x, &array->y, &array->width, &array->height};
+    CGFloat *reallocated[4];
+
+    for (size_t i = 0; i < 4; i++) {
+        reallocated[i] = (CGFloat *)malloc(capacity * sizeof(CGFloat));
+
+        if (!reallocated[i]) {
+            for (size_t j = 0; j < i; j++) {
+                free(reallocated[j]);
+            }
+
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        if (array->count) {
+            memcpy(reallocated[i], *components[i], array->count * sizeof(CGFloat));
+        }
+
+        free(*components[i]);
+        *components[i] = reallocated[i];
+    }
+
+    array->capacity = capacity;
+
+    return true;
+}
+
+/**
+ *  Change the number of rects in a rect array
+ *
+ *  @param array The array to resize
+ *  @param count The new number of rects. Any added rects have undefined values.
+ *
+ *  @return Whether the array could be resized
+ */
+JSG_INLINE bool JSGRectArraySetCount(JSGRectArray *array, size_t count)
+{
+    if (count > array->capacity && !JSGRectArrayReserve(array, count > array->capacity * 2 ? count : array->capacity * 2)) {
+        return false;
+    }
+
+    array->count = count;
+
+    return true;
+}
+
+/**
+ *  Return the rect at a given index in a rect array
+ *
+ *  @param array The array to get the rect from
+ *  @param index The index of the rect. Must be less than the array's count.
+ */
+JSG_INLINE CGRect JSGRectArrayGetRect(const JSGRectArray *array, size_t index)
+{
+    CGRect rect;
+    rect.origin.x = array->x[index];
+    rect.origin.y = array->y[index];
+    rect.size.width = array->width[index];
+    rect.size.height = array->height[index];
+
+    return rect;
+}
+
+/**
+ *  Replace the rect at a given index in a rect array
+ *
+ *  @param array The array to change
+ *  @param index The index of the rect. Must be less than the array's count.
+ *  @param rect The new rect, which will be stored in its standardized form
+ */
+JSG_INLINE void JSGRectArraySetRect(JSGRectArray *array, size_t index, CGRect rect)
+{
+    rect = CGRectStandardize(rect);
+    array->x[index] = rect.origin.x;
+    array->y[index] = rect.origin.y;
+    array->width[index] = rect.size.width;
+    array->height[index] = rect.size.height;
+}
+
+/**
+ *  Append a rect to the end of a rect array
+ *
+ *  @param array The array to append to
+ *  @param rect The rect to append, which will be stored in its standardized form
+ *
+ *  @return Whether the rect could be appended
+ */
+JSG_INLINE bool JSGRectArrayAppend(JSGRectArray *array, CGRect rect)
+{
+    if (!JSGRectArraySetCount(array, array->count + 1)) {
+        return false;
+    }
+
+    JSGRectArraySetRect(array, array->count - 1, rect);
+
+    return true;
+}
+
+/**
+ *  Replace the contents of a rect array with an array of CGRects
+ *
+ *  @param array The array to change
+ *  @param rects The rects to store
+ *  @param count The number of rects
+ *
+ *  @return Whether the rects could be stored
+ */
+JSG_INLINE bool JSGRectArraySetRects(JSGRectArray *array, const CGRect *rects, size_t count)
+{
+    if (!JSGRectArraySetCount(array, count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        JSGRectArraySetRect(array, i, rects[i]);
+    }
+
+    return true;
+}
+
+/**
+ *  Copy the contents of a rect array into an array of CGRects
+ *
+ *  @param array The array to copy from
+ *  @param rects The array to copy to. Must have room for the rect array's count.
+ */
+JSG_INLINE void JSGRectArrayGetRects(const JSGRectArray *array, CGRect *rects)
+{
+    for (size_t i = 0; i < array->count; i++) {
+        rects[i] = JSGRectArrayGetRect(array, i);
+    }
+}
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef JSGeometryReduction
+#define JSGeometryReduction
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryParallel.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  The result of reducing a rect array
+ *
+ *  @discussion bounds is the union of all rects. The smallest & largest values of each
+ *  edge that aren't part of the bounds are also available: largestMinX, largestMinY,
+ *  smallestMaxX & smallestMaxY. When largestMinX < smallestMaxX and largestMinY < smallestMaxY,
+ *  they describe the area that all rects have in common.
+ *
+ *  centroid is the average of the center points of all rects.
+ *
+ *  For an empty array, bounds is CGRectNull and centroid is CGPointZero.
+ */
+typedef struct {
+    size_t count;
+    CGRect bounds;
+    CGFloat largestMinX;
+    CGFloat largestMinY;
+    CGFloat smallestMaxX;
+    CGFloat smallestMaxY;
+    CGPoint centroid;
+} JSGRectArrayReduction;
+
+typedef struct {
+    CGFloat minX;
+    CGFloat minY;
+    CGFloat maxX;
+    CGFloat maxY;
+    CGFloat largestMinX;
+    CGFloat largestMinY;
+    CGFloat smallestMaxX;
+    CGFloat smallestMaxY;
+    CGFloat sumX;
+    CGFloat sumY;
+} JSGRectArrayPartialReduction;
+
+/**
+ *  The number of independent accumulators used per component when reducing. Each
+ *  accumulator maps to a SIMD lane, so that the compiler can vectorize the reduction.
+ */
+#define JSG_REDUCTION_LANES 4
+
+/**
+ *  The number of rects reduced by each task. Results only depend on this value, never
+ *  on the number of threads that the tasks are spread across.
+ */
+#define JSG_REDUCTION_BLOCK_SIZE 16384
+
+#pragma mark - Private functions
+
+JSG_INLINE void JSGRectArrayPartialReductionInit(JSGRectArrayPartialReduction *partial)
+{
+    partial->minX = partial->minY = partial->smallestMaxX = partial->smallestMaxY = INFINITY;
+    partial->maxX = partial->maxY = partial->largestMinX = partial->largestMinY = -INFINITY;
+    partial->sumX = partial->sumY = 0;
+}
+
+JSG_INLINE void JSGRectArrayPartialReductionCombine(JSGRectArrayPartialReduction *partial, const JSGRectArrayPartialReduction *other)
+{
+    partial->minX = other->minX < partial->minX ? other->minX : partial->minX;
+    partial->minY = other->minY < partial->minY ? other->minY : partial->minY;
+    partial->maxX = other->maxX > partial->maxX ? other->maxX : partial->maxX;
+    partial->maxY = other->maxY > partial->maxY ? other->maxY : partial->maxY;
+    partial->largestMinX = other->largestMinX > partial->largestMinX ? other->largestMinX : partial->largestMinX;
+    partial->largestMinY = other->largestMinY > partial->largestMinY ? other->largestMinY : partial->largestMinY;
+    partial->smallestMaxX = other->smallestMaxX < partial->smallestMaxX ? other->smallestMaxX : partial->smallestMaxX;
+    partial->smallestMaxY = other->smallestMaxY < partial->smallestMaxY ? other->smallestMaxY : partial->smallestMaxY;
+    partial->sumX += other->sumX;
+    partial->sumY += other->sumY;
+}
+
+JSG_INLINE void JSGRectArrayReduceRange(const JSGRectArray *array, size_t start, size_t end, JSGRectArrayPartialReduction *partial)
+{
+    const CGFloat *xs = array->x;
+    const CGFloat *ys = array->y;
+    const CGFloat *widths = array->width;
+    const CGFloat *heights = array->height;
+    CGFloat minX[JSG_REDUCTION_LANES], minY[JSG_REDUCTION_LANES], maxX[JSG_REDUCTION_LANES], maxY[JSG_REDUCTION_LANES];
+    CGFloat largestMinX[JSG_REDUCTION_LANES], largestMinY[JSG_REDUCTION_LANES], smallestMaxX[JSG_REDUCTION_LANES], smallestMaxY[JSG_REDUCTION_LANES];
+    CGFloat sumX[JSG_REDUCTION_LANES], sumY[JSG_REDUCTION_LANES];
+
+    for (size_t lane = 0; lane < JSG_REDUCTION_LANES; lane++) {
+        minX[lane] = minY[lane] = smallestMaxX[lane] = smallestMaxY[lane] = INFINITY;
+        maxX[lane] = maxY[lane] = largestMinX[lane] = largestMinY[lane] = -INFINITY;
+        sumX[lane] = sumY[lane] = 0;
+    }
+
+    size_t i = start;
+
+    for (; i + JSG_REDUCTION_LANES <= end; i += JSG_REDUCTION_LANES) {
+        for (size_t lane = 0; lane < JSG_REDUCTION_LANES; lane++) {
+            CGFloat x0 = xs[i + lane];
+            CGFloat y0 = ys[i + lane];
+            CGFloat x1 = x0 + widths[i + lane];
+            CGFloat y1 = y0 + heights[i + lane];
+
+            minX[lane] = x0 < minX[lane] ? x0 : minX[lane];
+            minY[lane] = y0 < minY[lane] ? y0 : minY[lane];
+            maxX[lane] = x1 > maxX[lane] ? x1 : maxX[lane];
+            maxY[lane] = y1 > maxY[lane] ? y1 : maxY[lane];
+            largestMinX[lane] = x0 > largestMinX[lane] ? x0 : largestMinX[lane];
+            largestMinY[lane] = y0 > largestMinY[lane] ? y0 : largestMinY[lane];
+            smallestMaxX[lane] = x1 < smallestMaxX[lane] ? x1 : smallestMaxX[lane];
+            smallestMaxY[lane] = y1 < smallestMaxY[lane] ? y1 : smallestMaxY[lane];
+            sumX[lane] += x0 + x1;
+            sumY[lane] += y0 + y1;
+        }
+    }
+
+    for (size_t lane = 0; i < end; i++, lane++) {
+        CGFloat x0 = xs[i];
+        CGFloat y0 = ys[i];
+        CGFloat x1 = x0 + widths[i];
+        CGFloat y1 = y0 + heights[i];
+
+        minX[lane] = x0 < minX[lane] ? x0 : minX[lane];
+        minY[lane] = y0 < minY[lane] ? y0 : minY[lane];
+        maxX[lane] = x1 > maxX[lane] ? x1 : maxX[lane];
+        maxY[lane] = y1 > maxY[lane] ? y1 : maxY[lane];
+        largestMinX[lane] = x0 > largestMinX[lane] ? x0 : largestMinX[lane];
+        largestMinY[lane] = y0 > largestMinY[lane] ? y0 : largestMinY[lane];
+        smallestMaxX[lane] = x1 < smallestMaxX[lane] ? x1 : smallestMaxX[lane];
+        smallestMaxY[lane] = y1 < smallestMaxY[lane] ? y1 : smallestMaxY[lane];
+        sumX[lane] += x0 + x1;
+        sumY[lane] += y0 + y1;
+    }
+
+    JSGRectArrayPartialReductionInit(partial);
+
+    for (size_t lane = 0; lane < JSG_REDUCTION_LANES; lane++) {
+        JSGRectArrayPartialReduction lanePartial = {
+            minX[lane], minY[lane], maxX[lane], maxY[lane],
+            largestMinX[lane], largestMinY[lane], smallestMaxX[lane], smallestMaxY[lane],
+            sumX[lane], sumY[lane]
+        };
+
+        JSGRectArrayPartialReductionCombine(partial, &lanePartial);
+    }
+}
+
+typedef struct {
+    const JSGRectArray *array;
+    JSGRectArrayPartialReduction *partials;
+} JSGRectArrayReductionContext;
+
+JSG_INLINE void JSGRectArrayReduceBlock(void *context, size_t block)
+{
+    JSGRectArrayReductionContext *reduction = (JSGRectArrayReductionContext *)context;
+    size_t start = block * JSG_REDUCTION_BLOCK_SIZE;
+    size_t end = start + JSG_REDUCTION_BLOCK_SIZE;
+
+    if (end > reduction->array->count) {
+        end = reduction->array->count;
+    }
+
+    JSGRectArrayReduceRange(reduction->array, start, end, &reduction->partials[block]);
+}
+
+#pragma mark - Reduction functions
+
+/**
+ *  Compute the union bounds, edge extremes & centroid of all rects in a rect array
+ *
+ *  @param array The array to reduce
+ *  @param threadCount The maximum number of threads to use. Pass 0 to use the default
+ *  thread count, or 1 to only use the calling thread. Threads are created on each call,
+ *  see JSGParallelFor, so small arrays processed every frame are best reduced with 1.
+ *  @param reduction The reduction to write the result to
+ *
+ *  @return Whether the array could be reduced. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion The array is split into fixed size blocks, that are reduced in parallel
+ *  and then combined pairwise, in a fixed order. The result is therefore always exactly
+ *  the same for a given array, no matter how many threads are used.
+ *
+ *  @see JSGRectArrayReduction
+ */
+JSG_INLINE bool JSGRectArrayReduce(const JSGRectArray *array, size_t threadCount, JSGRectArrayReduction *reduction)
+{
+    size_t blockCount = (array->count + JSG_REDUCTION_BLOCK_SIZE - 1) / JSG_REDUCTION_BLOCK_SIZE;
+    JSGRectArrayPartialReduction result;
+
+    if (blockCount <= 1) {
+        JSGRectArrayReduceRange(array, 0, array->count, &result);
+    } else {
+        JSGRectArrayPartialReduction *partials = (JSGRectArrayPartialReduction *)malloc(blockCount * sizeof(JSGRectArrayPartialReduction));
+
+        if (!partials) {
+            return false;
+        }
+
+        JSGRectArrayReductionContext context = {array, partials};
+        JSGParallelFor(blockCount, threadCount, JSGRectArrayReduceBlock, &context);
+
+        for (size_t stride = 1; stride < blockCount; stride *= 2) {
+            for (size_t i = 0; i + stride < blockCount; i += stride * 2) {
+                JSGRectArrayPartialReductionCombine(&partials[i], &partials[i + stride]);
+            }
+        }
+
+        result = partials[0];
+        free(partials);
+    }
+
+    reduction->count = array->count;
+
+    if (array->count == 0) {
+        reduction->bounds = CGRectNull;
+        reduction->largestMinX = reduction->largestMinY = reduction->smallestMaxX = reduction->smallestMaxY = 0;
+        reduction->centroid = CGPointZero;
+
+        return true;
+    }
+
+    reduction->bounds.origin.x = result.minX;
+    reduction->bounds.origin.y = result.minY;
+    reduction->bounds.size.width = result.maxX - result.minX;
+    reduction->bounds.size.height = result.maxY - result.minY;
+    reduction->largestMinX = result.largestMinX;
+    reduction->largestMinY = result.largestMinY;
+    reduction->smallestMaxX = result.smallestMaxX;
+    reduction->smallestMaxY = result.smallestMaxY;
+    reduction->centroid.x = result.sumX / (2 * (CGFloat)array->count);
+    reduction->centroid.y = result.sumY / (2 * (CGFloat)array->count);
+
+    return true;
+}
+
+#endif
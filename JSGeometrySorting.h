@@ -0,0 +1,168 @@
+#ifndef JSGeometrySorting
+#define JSGeometrySorting
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Types
+
+/**
+ *  An index paired with a score (or weight, priority...), used to sort items by score
+ */
+typedef struct {
+    CGFloat score;
+    size_t index;
+} JSGScoredIndex;
+
+/**
+ *  Arrays of at most this many scored indices are sorted with an insertion sort
+ */
+#define JSG_SORTING_INSERTION_THRESHOLD 64
+
+/**
+ *  The number of bits of the scores that are sorted on in each radix sort pass
+ */
+#define JSG_SORTING_RADIX_BITS 11
+#define JSG_SORTING_RADIX_SIZE (1 << JSG_SORTING_RADIX_BITS)
+#define JSG_SORTING_RADIX_PASSES ((64 + JSG_SORTING_RADIX_BITS - 1) / JSG_SORTING_RADIX_BITS)
+
+#pragma mark - Private functions
+
+/**
+ *  Map a score to an unsigned key, so that keys are in ascending order when scores are in
+ *  descending order
+ */
+JSG_INLINE uint64_t JSGScoredIndexGetKey(CGFloat score)
+{
+    double value = score == 0 ? 0 : (double)score;
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // Flipping the sign bit of positive values & all bits of negative values maps doubles
+    // to keys in ascending order, which are then inverted to get descending order
+    return (bits >> 63) ? bits : ~(bits | 0x8000000000000000ull);
+}
+
+#pragma mark - Sorting functions
+
+/**
+ *  Order scored indices by descending score, and then by ascending index
+ *
+ *  @discussion This is a comparison function for qsort. Breaking ties by index makes the
+ *  resulting order fully deterministic.
+ */
+JSG_INLINE int JSGScoredIndexCompare(const void *a, const void *b)
+{
+    const JSGScoredIndex *first = (const JSGScoredIndex *)a;
+    const JSGScoredIndex *second = (const JSGScoredIndex *)b;
+
+    if (first->score != second->score) {
+        return first->score > second->score ? -1 : 1;
+    }
+
+    return first->index < second->index ? -1 : first->index > second->index;
+}
+
+/**
+ *  Sort an array of scored indices by descending score
+ *
+ *  @param scoredIndices The scored indices to sort
+ *  @param count The number of scored indices
+ *
+ *  @return Whether the scored indices could be sorted. This is only false if memory could
+ *  not be allocated, in which case the array is left untouched.
+ *
+ *  @discussion The sort is stable, so scored indices with the same score keep their
+ *  relative order. When the indices are in ascending order beforehand, the result is the
+ *  same as sorting with JSGScoredIndexCompare.
+ *
+ *  Small arrays are sorted with an insertion sort. Larger arrays are sorted with a least
+ *  significant digit radix sort on the bits of the scores, in at most
+ *  JSG_SORTING_RADIX_PASSES passes, skipping passes over digits that all scores have in
+ *  common. This takes linear time, and is several times faster than qsort for large arrays.
+ */
+JSG_INLINE bool JSGScoredIndicesSort(JSGScoredIndex *scoredIndices, size_t count)
+{
+    if (count <= JSG_SORTING_INSERTION_THRESHOLD) {
+        for (size_t i = 1; i < count; i++) {
+            JSGScoredIndex scoredIndex = scoredIndices[i];
+            size_t j = i;
+
+            for (; j > 0 && scoredIndices[j - 1].score < scoredIndex.score; j--) {
+                scoredIndices[j] = scoredIndices[j - 1];
+            }
+
+            scoredIndices[j] = scoredIndex;
+        }
+
+        return true;
+    }
+
+    JSGScoredIndex *scratch = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+    size_t (*histograms)[JSG_SORTING_RADIX_SIZE] = (size_t (*)[JSG_SORTING_RADIX_SIZE])calloc(JSG_SORTING_RADIX_PASSES, sizeof(*histograms));
+
+    if (!scratch || !histograms) {
+        free(scratch);
+        free(histograms);
+
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = JSGScoredIndexGetKey(scoredIndices[i].score);
+
+        for (size_t pass = 0; pass < JSG_SORTING_RADIX_PASSES; pass++) {
+            histograms[pass][(key >> (pass * JSG_SORTING_RADIX_BITS)) & (JSG_SORTING_RADIX_SIZE - 1)]++;
+        }
+    }
+
+    JSGScoredIndex *source = scoredIndices;
+    JSGScoredIndex *destination = scratch;
+
+    for (size_t pass = 0; pass < JSG_SORTING_RADIX_PASSES; pass++) {
+        size_t *histogram = histograms[pass];
+        size_t offset = 0;
+        bool skip = false;
+
+        for (size_t digit = 0; digit < JSG_SORTING_RADIX_SIZE; digit++) {
+            size_t digitCount = histogram[digit];
+
+            if (digitCount == count) {
+                skip = true;
+                break;
+            }
+
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        if (skip) {
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t key = JSGScoredIndexGetKey(source[i].score);
+            destination[histogram[(key >> (pass * JSG_SORTING_RADIX_BITS)) & (JSG_SORTING_RADIX_SIZE - 1)]++] = source[i];
+        }
+
+        JSGScoredIndex *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != scoredIndices) {
+        memcpy(scoredIndices, source, count * sizeof(JSGScoredIndex));
+    }
+
+    free(scratch);
+    free(histograms);
+
+    return true;
+}
+
+#endif
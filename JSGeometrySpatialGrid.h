@@ -0,0 +1,313 @@
+#ifndef JSGeometrySpatialGrid
+#define JSGeometrySpatialGrid
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+#include "JSGeometryRectArray.h"
+
+#pragma mark - Types
+
+/**
+ *  A function that is called for each item found by a spatial grid query
+ *
+ *  @param context The context that was passed to the query
+ *  @param item The index of the item
+ *  @param rect The rect of the item
+ *
+ *  @return Whether the query should continue
+ */
+typedef bool (*JSGSpatialGridVisitor)(void *context, size_t item, CGRect rect);
+
+typedef struct {
+    size_t item;
+    size_t next;
+} JSGSpatialGridEntry;
+
+/**
+ *  A spatial index of rects, using a uniform grid of square cells
+ *
+ *  @discussion Each item is added to every cell that its rect overlaps, using a linked list
+ *  per cell, so that items can be inserted incrementally. Items are numbered in the order
+ *  in which they're inserted, and their rects can be read from the items array. Items
+ *  outside of the grid's bounds are added to the closest cells, so they're still found,
+ *  but work best when the bounds cover most items.
+ *
+ *  A grid should be initialized using JSGSpatialGridInit, and destroyed using
+ *  JSGSpatialGridDestroy once it's no longer needed. Queries don't change the grid, so
+ *  they may be performed from multiple threads at once.
+ */
+typedef struct {
+    CGRect bounds;
+    CGFloat cellSize;
+    size_t columns;
+    size_t rows;
+    size_t *cells;
+    JSGSpatialGridEntry *entries;
+    size_t entryCount;
+    size_t entryCapacity;
+    JSGRectArray items;
+} JSGSpatialGrid;
+
+/**
+ *  Index used by grid cells & entries that don't link to an entry
+ */
+#define JSG_SPATIAL_GRID_NONE ((size_t)-1)
+
+#pragma mark - Private functions
+
+JSG_INLINE size_t JSGSpatialGridGetColumn(const JSGSpatialGrid *grid, CGFloat x)
+{
+    CGFloat column = floor((x - grid->bounds.origin.x) / grid->cellSize);
+
+    return column <= 0 ? 0 : column >= (CGFloat)(grid->columns - 1) ? grid->columns - 1 : (size_t)column;
+}
+
+JSG_INLINE size_t JSGSpatialGridGetRow(const JSGSpatialGrid *grid, CGFloat y)
+{
+    CGFloat row = floor((y - grid->bounds.origin.y) / grid->cellSize);
+
+    return row <= 0 ? 0 : row >= (CGFloat)(grid->rows - 1) ? grid->rows - 1 : (size_t)row;
+}
+
+typedef struct {
+    size_t *items;
+    size_t capacity;
+    size_t count;
+} JSGSpatialGridQueryContext;
+
+JSG_INLINE bool JSGSpatialGridQueryVisitor(void *context, size_t item, CGRect rect)
+{
+    JSGSpatialGridQueryContext *query = (JSGSpatialGridQueryContext *)context;
+    (void)rect;
+
+    if (query->count < query->capacity) {
+        query->items[query->count] = item;
+    }
+
+    query->count++;
+
+    return true;
+}
+
+JSG_INLINE bool JSGSpatialGridIntersectsVisitor(void *context, size_t item, CGRect rect)
+{
+    (void)item;
+    (void)rect;
+    *(bool *)context = true;
+
+    return false;
+}
+
+#pragma mark - Spatial grid functions
+
+/**
+ *  Initialize an empty spatial grid
+ *
+ *  @param grid The grid to initialize
+ *  @param bounds The area covered by the grid's cells
+ *  @param cellSize The width & height of each cell. A good value is about the size of
+ *  the items that will be inserted.
+ *
+ *  @return Whether the grid could be initialized. This is only false if memory could not
+ *  be allocated, in which case the grid doesn't need to be destroyed.
+ */
+JSG_INLINE bool JSGSpatialGridInit(JSGSpatialGrid *grid, CGRect bounds, CGFloat cellSize)
+{
+    memset(grid, 0, sizeof(JSGSpatialGrid));
+    bounds = CGRectStandardize(bounds);
+    grid->bounds = bounds;
+    grid->cellSize = cellSize > 0 ? cellSize : 1;
+
+    CGFloat columns = ceil(bounds.size.width / grid->cellSize);
+    CGFloat rows = ceil(bounds.size.height / grid->cellSize);
+    grid->columns = columns >= 1 ? (size_t)columns : 1;
+    grid->rows = rows >= 1 ? (size_t)rows : 1;
+    grid->cells = (size_t *)malloc(grid->columns * grid->rows * sizeof(size_t));
+
+    if (!grid->cells) {
+        return false;
+    }
+
+    // All bytes set gives JSG_SPATIAL_GRID_NONE
+    memset(grid->cells, 0xFF, grid->columns * grid->rows * sizeof(size_t));
+    JSGRectArrayInit(&grid->items);
+
+    return true;
+}
+
+/**
+ *  Destroy a spatial grid, freeing all of its memory
+ *
+ *  @param grid The grid to destroy
+ */
+JSG_INLINE void JSGSpatialGridDestroy(JSGSpatialGrid *grid)
+{
+    free(grid->cells);
+    free(grid->entries);
+    JSGRectArrayDestroy(&grid->items);
+    memset(grid, 0, sizeof(JSGSpatialGrid));
+}
+
+/**
+ *  Remove all items from a spatial grid, keeping its memory for reuse
+ *
+ *  @param grid The grid to clear
+ */
+JSG_INLINE void JSGSpatialGridClear(JSGSpatialGrid *grid)
+{
+    memset(grid->cells, 0xFF, grid->columns * grid->rows * sizeof(size_t));
+    grid->entryCount = 0;
+    grid->items.count = 0;
+}
+
+/**
+ *  Insert a rect into a spatial grid
+ *
+ *  @param grid The grid to insert into
+ *  @param rect The rect to insert. It will be stored in its standardized form, and should
+ *  not be null.
+ *
+ *  @return Whether the rect could be inserted. This is only false if memory could not be
+ *  allocated, in which case the grid is left untouched.
+ *
+ *  @discussion The index of the inserted item is the number of items that the grid
+ *  contained before inserting it.
+ */
+JSG_INLINE bool JSGSpatialGridInsert(JSGSpatialGrid *grid, CGRect rect)
+{
+    rect = CGRectStandardize(rect);
+
+    size_t firstColumn = JSGSpatialGridGetColumn(grid, rect.origin.x);
+    size_t lastColumn = JSGSpatialGridGetColumn(grid, rect.origin.x + rect.size.width);
+    size_t firstRow = JSGSpatialGridGetRow(grid, rect.origin.y);
+    size_t lastRow = JSGSpatialGridGetRow(grid, rect.origin.y + rect.size.height);
+    size_t entryCount = grid->entryCount + (lastColumn - firstColumn + 1) * (lastRow - firstRow + 1);
+
+    if (entryCount > grid->entryCapacity) {
+        size_t capacity = entryCount > grid->entryCapacity * 2 ? entryCount : grid->entryCapacity * 2;
+        JSGSpatialGridEntry *entries = (JSGSpatialGridEntry *)realloc(grid->entries, capacity * sizeof(JSGSpatialGridEntry));
+
+        if (!entries) {
+            return false;
+        }
+
+        grid->entries = entries;
+        grid->entryCapacity = capacity;
+    }
+
+    size_t item = grid->items.count;
+
+    if (!JSGRectArrayAppend(&grid->items, rect)) {
+        return false;
+    }
+
+    for (size_t row = firstRow; row <= lastRow; row++) {
+        for (size_t column = firstColumn; column <= lastColumn; column++) {
+            size_t *cell = &grid->cells[row * grid->columns + column];
+            grid->entries[grid->entryCount].item = item;
+            grid->entries[grid->entryCount].next = *cell;
+            *cell = grid->entryCount++;
+        }
+    }
+
+    return true;
+}
+
+/**
+ *  Visit every item of a spatial grid that intersects a rect
+ *
+ *  @param grid The grid to query
+ *  @param rect The rect to find intersecting items for
+ *  @param visitor The function to call for each item, which may stop the query by
+ *  returning false
+ *  @param context A pointer that is passed to the visitor
+ *
+ *  @discussion Items are intersecting when their interiors overlap, so items that only
+ *  touch the rect's edges are not visited. Each item is visited exactly once, even when it
+ *  spans multiple cells: it's only visited from the cell that contains the top left corner
+ *  of its intersection with the rect, so no bookkeeping of visited items is needed. The
+ *  order in which items are visited is undefined.
+ */
+JSG_INLINE void JSGSpatialGridVisit(const JSGSpatialGrid *grid, CGRect rect, JSGSpatialGridVisitor visitor, void *context)
+{
+    rect = CGRectStandardize(rect);
+
+    CGFloat minX = rect.origin.x;
+    CGFloat minY = rect.origin.y;
+    CGFloat maxX = minX + rect.size.width;
+    CGFloat maxY = minY + rect.size.height;
+    size_t firstColumn = JSGSpatialGridGetColumn(grid, minX);
+    size_t lastColumn = JSGSpatialGridGetColumn(grid, maxX);
+    size_t firstRow = JSGSpatialGridGetRow(grid, minY);
+    size_t lastRow = JSGSpatialGridGetRow(grid, maxY);
+    const JSGRectArray *items = &grid->items;
+
+    for (size_t row = firstRow; row <= lastRow; row++) {
+        for (size_t column = firstColumn; column <= lastColumn; column++) {
+            for (size_t entry = grid->cells[row * grid->columns + column]; entry != JSG_SPATIAL_GRID_NONE; entry = grid->entries[entry].next) {
+                size_t item = grid->entries[entry].item;
+                CGFloat itemMinX = items->x[item];
+                CGFloat itemMinY = items->y[item];
+
+                if (itemMinX >= maxX || itemMinY >= maxY || itemMinX + items->width[item] <= minX || itemMinY + items->height[item] <= minY) {
+                    continue;
+                }
+
+                CGFloat referenceX = itemMinX > minX ? itemMinX : minX;
+                CGFloat referenceY = itemMinY > minY ? itemMinY : minY;
+
+                if (JSGSpatialGridGetColumn(grid, referenceX) != column || JSGSpatialGridGetRow(grid, referenceY) != row) {
+                    continue;
+                }
+
+                if (!visitor(context, item, JSGRectArrayGetRect(items, item))) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  Find the items of a spatial grid that intersect a rect
+ *
+ *  @param grid The grid to query
+ *  @param rect The rect to find intersecting items for
+ *  @param items The array to write the indices of the items to, or NULL
+ *  @param capacity The number of indices that the items array has room for
+ *
+ *  @return The number of intersecting items. If this is larger than capacity, only the
+ *  first capacity items were written.
+ *
+ *  @see JSGSpatialGridVisit
+ */
+JSG_INLINE size_t JSGSpatialGridQuery(const JSGSpatialGrid *grid, CGRect rect, size_t *items, size_t capacity)
+{
+    JSGSpatialGridQueryContext context = {items, items ? capacity : 0, 0};
+    JSGSpatialGridVisit(grid, rect, JSGSpatialGridQueryVisitor, &context);
+
+    return context.count;
+}
+
+/**
+ *  Return whether any item of a spatial grid intersects a rect
+ *
+ *  @param grid The grid to query
+ *  @param rect The rect to test
+ *
+ *  @discussion The query stops at the first intersecting item.
+ */
+JSG_INLINE bool JSGSpatialGridIntersectsRect(const JSGSpatialGrid *grid, CGRect rect)
+{
+    bool intersects = false;
+    JSGSpatialGridVisit(grid, rect, JSGSpatialGridIntersectsVisitor, &intersects);
+
+    return intersects;
+}
+
+#endif
@@ -0,0 +1,447 @@
+#ifndef JSGeometrySplitLayout
+#define JSGeometrySplitLayout
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSGeometry.h"
+
+#pragma mark - Enums
+
+/**
+ *  Enum describing the types of nodes in a split tree
+ *
+ *  @discussion A pane is a leaf of the tree. A horizontal split places its first child to
+ *  the left of its second child, and a vertical split places its first child above its
+ *  second child (in a top-left coordinate system).
+ */
+typedef enum : NSUInteger {
+    JSGSplitTypePane,
+    JSGSplitTypeHorizontal,
+    JSGSplitTypeVertical
+} JSGSplitType;
+
+#pragma mark - Types
+
+/**
+ *  Index used for nodes that don't exist, such as the parent of the root node
+ */
+#define JSG_SPLIT_NODE_NONE ((size_t)-1)
+
+/**
+ *  A node of a split tree
+ *
+ *  @discussion ratio is the fraction of the available length (excluding the divider) that a
+ *  split would like to give its first child. It is only a preference: the panes' minimum &
+ *  maximum sizes take precedence over it, and it is left untouched by layouts, so that
+ *  growing a container back to its previous size restores the previous layout.
+ *
+ *  minSize & maxSize are the size constraints of a pane, and are computed for splits when
+ *  laying out. frame is set by JSGSplitTreeLayout.
+ */
+typedef struct {
+    JSGSplitType type;
+    size_t parent;
+    size_t children[2];
+    CGFloat ratio;
+    CGSize minSize;
+    CGSize maxSize;
+    CGRect frame;
+} JSGSplitNode;
+
+/**
+ *  A binary space partition tree of split panes
+ *
+ *  @discussion All nodes are stored in a single arena, and refer to each other by index.
+ *  The index of a pane never changes while it's part of the tree, so it may be used to
+ *  identify the pane. The indices of removed nodes are reused for new nodes.
+ *
+ *  A tree should be initialized using JSGSplitTreeInit, and destroyed using
+ *  JSGSplitTreeDestroy once it's no longer needed. The ratio of splits & size constraints
+ *  of panes may be changed directly, and take effect on the next layout.
+ */
+typedef struct {
+    JSGSplitNode *nodes;
+    size_t *order;
+    size_t count;
+    size_t capacity;
+    size_t root;
+    size_t freeNode;
+    CGFloat dividerThickness;
+} JSGSplitTree;
+
+#pragma mark - Private functions
+
+JSG_INLINE CGFloat JSGSplitTreeSnap(CGFloat value, CGFloat scale)
+{
+    return scale > 0 ? round(value * scale) / scale : value;
+}
+
+JSG_INLINE size_t JSGSplitTreeAllocateNode(JSGSplitTree *tree)
+{
+    if (tree->freeNode != JSG_SPLIT_NODE_NONE) {
+        size_t node = tree->freeNode;
+        tree->freeNode = tree->nodes[node].children[0];
+
+        return node;
+    }
+
+    if (tree->count == tree->capacity) {
+        size_t capacity = tree->capacity ? tree->capacity * 2 : 16;
+        JSGSplitNode *nodes = (JSGSplitNode *)realloc(tree->nodes, capacity * sizeof(JSGSplitNode));
+
+        if (!nodes) {
+            return JSG_SPLIT_NODE_NONE;
+        }
+
+        tree->nodes = nodes;
+
+        size_t *order = (size_t *)realloc(tree->order, capacity * sizeof(size_t));
+
+        if (!order) {
+            return JSG_SPLIT_NODE_NONE;
+        }
+
+        tree->order = order;
+        tree->capacity = capacity;
+    }
+
+    return tree->count++;
+}
+
+JSG_INLINE void JSGSplitTreeFreeNode(JSGSplitTree *tree, size_t node)
+{
+    tree->nodes[node].parent = JSG_SPLIT_NODE_NONE;
+    tree->nodes[node].children[0] = tree->freeNode;
+    tree->freeNode = node;
+}
+
+JSG_INLINE void JSGSplitTreeInitPane(JSGSplitNode *node, size_t parent)
+{
+    memset(node, 0, sizeof(JSGSplitNode));
+    node->type = JSGSplitTypePane;
+    node->parent = parent;
+    node->children[0] = node->children[1] = JSG_SPLIT_NODE_NONE;
+    node->maxSize.width = node->maxSize.height = CGFLOAT_MAX;
+}
+
+/**
+ *  Return the length to give the first child of a split, given the available length and
+ *  the minimum & maximum lengths of both children
+ */
+JSG_INLINE CGFloat JSGSplitTreeResolveLength(CGFloat available, CGFloat ratio, CGFloat firstMin, CGFloat firstMax, CGFloat secondMin, CGFloat secondMax)
+{
+    CGFloat length = available * ratio;
+
+    // The second child's constraints are applied first, so that when they can't all be
+    // satisfied, the first child's constraints win
+    length = available - length < secondMin ? available - secondMin : length;
+    length = available - length > secondMax ? available - secondMax : length;
+    length = length < firstMin ? firstMin : length;
+    length = length > firstMax ? firstMax : length;
+    length = length > available ? available : length;
+
+    return length > 0 ? length : 0;
+}
+
+#pragma mark - Split tree functions
+
+/**
+ *  Initialize an empty split tree
+ *
+ *  @param tree The tree to initialize
+ *  @param dividerThickness The thickness of the dividers between the children of splits
+ */
+JSG_INLINE void JSGSplitTreeInit(JSGSplitTree *tree, CGFloat dividerThickness)
+{
+    memset(tree, 0, sizeof(JSGSplitTree));
+    tree->root = JSG_SPLIT_NODE_NONE;
+    tree->freeNode = JSG_SPLIT_NODE_NONE;
+    tree->dividerThickness = dividerThickness;
+}
+
+/**
+ *  Destroy a split tree, freeing all of its memory
+ *
+ *  @param tree The tree to destroy
+ */
+JSG_INLINE void JSGSplitTreeDestroy(JSGSplitTree *tree)
+{
+    free(tree->nodes);
+    free(tree->order);
+    JSGSplitTreeInit(tree, 0);
+}
+
+/**
+ *  Add the root pane to an empty split tree
+ *
+ *  @param tree The tree to add the pane to. Must be empty.
+ *  @param pane Set to the index of the new pane
+ *
+ *  @return Whether the pane could be added. This is only false if memory could not be
+ *  allocated.
+ */
+JSG_INLINE bool JSGSplitTreeAddRootPane(JSGSplitTree *tree, size_t *pane)
+{
+    size_t node = JSGSplitTreeAllocateNode(tree);
+
+    if (node == JSG_SPLIT_NODE_NONE) {
+        return false;
+    }
+
+    JSGSplitTreeInitPane(&tree->nodes[node], JSG_SPLIT_NODE_NONE);
+    tree->root = node;
+    *pane = node;
+
+    return true;
+}
+
+/**
+ *  Split a pane in two, adding a new pane next to it
+ *
+ *  @param tree The tree containing the pane
+ *  @param pane The index of the pane to split
+ *  @param type The type of split to perform. Must not be JSGSplitTypePane.
+ *  @param ratio The fraction of the available length to give the first child of the split
+ *  @param newPaneFirst Whether the new pane should be the first child of the split (to the
+ *  left or above), rather than the second
+ *  @param newPane Set to the index of the new pane
+ *
+ *  @return Whether the pane could be split. This is only false if memory could not be
+ *  allocated, in which case the tree is left untouched.
+ *
+ *  @discussion A new split node takes the place of the pane in the tree, so that the pane
+ *  keeps its index. The new pane has no size constraints.
+ */
+JSG_INLINE bool JSGSplitTreeSplitPane(JSGSplitTree *tree, size_t pane, JSGSplitType type, CGFloat ratio, bool newPaneFirst, size_t *newPane)
+{
+    size_t split = JSGSplitTreeAllocateNode(tree);
+
+    if (split == JSG_SPLIT_NODE_NONE) {
+        return false;
+    }
+
+    size_t added = JSGSplitTreeAllocateNode(tree);
+
+    if (added == JSG_SPLIT_NODE_NONE) {
+        JSGSplitTreeFreeNode(tree, split);
+        return false;
+    }
+
+    JSGSplitNode *nodes = tree->nodes;
+    size_t parent = nodes[pane].parent;
+
+    memset(&nodes[split], 0, sizeof(JSGSplitNode));
+    nodes[split].type = type;
+    nodes[split].parent = parent;
+    nodes[split].children[0] = newPaneFirst ? added : pane;
+    nodes[split].children[1] = newPaneFirst ? pane : added;
+    nodes[split].ratio = ratio;
+    nodes[split].frame = nodes[pane].frame;
+
+    if (parent == JSG_SPLIT_NODE_NONE) {
+        tree->root = split;
+    } else {
+        nodes[parent].children[nodes[parent].children[0] == pane ? 0 : 1] = split;
+    }
+
+    JSGSplitTreeInitPane(&nodes[added], split);
+    nodes[pane].parent = split;
+    *newPane = added;
+
+    return true;
+}
+
+/**
+ *  Remove a pane from a split tree
+ *
+ *  @param tree The tree containing the pane
+ *  @param pane The index of the pane to remove
+ *
+ *  @discussion The split containing the pane is removed as well, and the pane's sibling
+ *  takes its place in the tree. Removing the root pane leaves the tree empty.
+ */
+JSG_INLINE void JSGSplitTreeRemovePane(JSGSplitTree *tree, size_t pane)
+{
+    JSGSplitNode *nodes = tree->nodes;
+    size_t split = nodes[pane].parent;
+
+    JSGSplitTreeFreeNode(tree, pane);
+
+    if (split == JSG_SPLIT_NODE_NONE) {
+        tree->root = JSG_SPLIT_NODE_NONE;
+        return;
+    }
+
+    size_t sibling = nodes[split].children[0] == pane ? nodes[split].children[1] : nodes[split].children[0];
+    size_t parent = nodes[split].parent;
+
+    nodes[sibling].parent = parent;
+
+    if (parent == JSG_SPLIT_NODE_NONE) {
+        tree->root = sibling;
+    } else {
+        nodes[parent].children[nodes[parent].children[0] == split ? 0 : 1] = sibling;
+    }
+
+    JSGSplitTreeFreeNode(tree, split);
+}
+
+/**
+ *  Lay out all nodes of a split tree in a container rect
+ *
+ *  @param tree The tree to lay out
+ *  @param container The rect to lay out the root node in
+ *  @param scale The number of pixels per point, used to snap frames to pixel boundaries.
+ *  Pass 1 to snap to integral values, or 0 to leave frames unsnapped.
+ *
+ *  @discussion Every node is visited twice, without allocating: once from the panes up to
+ *  compute the size constraints of splits, and once from the root down to compute frames.
+ *
+ *  Rather than snapping sizes, the position of each split line is snapped, and both
+ *  children are laid out up to it. Adjacent frames therefore share their edges exactly,
+ *  so that panes & dividers never overlap or leave gaps, no matter the container size,
+ *  even when frames aren't snapped.
+ *  When the container is too small to satisfy the minimum sizes of all panes, the panes
+ *  that come first are given precedence.
+ */
+JSG_INLINE void JSGSplitTreeLayout(JSGSplitTree *tree, CGRect container, CGFloat scale)
+{
+    if (tree->root == JSG_SPLIT_NODE_NONE) {
+        return;
+    }
+
+    JSGSplitNode *nodes = tree->nodes;
+    size_t *order = tree->order;
+    size_t orderCount = 1;
+    CGFloat divider = tree->dividerThickness;
+
+    // Breadth-first order, which lists every node before its children
+    order[0] = tree->root;
+
+    for (size_t i = 0; i < orderCount; i++) {
+        const JSGSplitNode *node = &nodes[order[i]];
+
+        if (node->type != JSGSplitTypePane) {
+            order[orderCount++] = node->children[0];
+            order[orderCount++] = node->children[1];
+        }
+    }
+
+    for (size_t i = orderCount; i-- > 0;) {
+        JSGSplitNode *node = &nodes[order[i]];
+
+        if (node->type == JSGSplitTypePane) {
+            continue;
+        }
+
+        const JSGSplitNode *first = &nodes[node->children[0]];
+        const JSGSplitNode *second = &nodes[node->children[1]];
+        bool horizontal = node->type == JSGSplitTypeHorizontal;
+        CGFloat firstMinLength = horizontal ? first->minSize.width : first->minSize.height;
+        CGFloat secondMinLength = horizontal ? second->minSize.width : second->minSize.height;
+        CGFloat firstMaxLength = horizontal ? first->maxSize.width : first->maxSize.height;
+        CGFloat secondMaxLength = horizontal ? second->maxSize.width : second->maxSize.height;
+        CGFloat firstMinBreadth = horizontal ? first->minSize.height : first->minSize.width;
+        CGFloat secondMinBreadth = horizontal ? second->minSize.height : second->minSize.width;
+        CGFloat firstMaxBreadth = horizontal ? first->maxSize.height : first->maxSize.width;
+        CGFloat secondMaxBreadth = horizontal ? second->maxSize.height : second->maxSize.width;
+        CGFloat minLength = firstMinLength + secondMinLength + divider;
+        CGFloat maxLength = firstMaxLength >= CGFLOAT_MAX - secondMaxLength - divider ? CGFLOAT_MAX : firstMaxLength + secondMaxLength + divider;
+        CGFloat minBreadth = firstMinBreadth > secondMinBreadth ? firstMinBreadth : secondMinBreadth;
+        CGFloat maxBreadth = firstMaxBreadth < secondMaxBreadth ? firstMaxBreadth : secondMaxBreadth;
+        maxBreadth = maxBreadth > minBreadth ? maxBreadth : minBreadth;
+
+        node->minSize.width = horizontal ? minLength : minBreadth;
+        node->minSize.height = horizontal ? minBreadth : minLength;
+        node->maxSize.width = horizontal ? maxLength : maxBreadth;
+        node->maxSize.height = horizontal ? maxBreadth : maxLength;
+    }
+
+    container = CGRectStandardize(container);
+
+    CGFloat minX = JSGSplitTreeSnap(container.origin.x, scale);
+    CGFloat minY = JSGSplitTreeSnap(container.origin.y, scale);
+    nodes[order[0]].frame.origin.x = minX;
+    nodes[order[0]].frame.origin.y = minY;
+    nodes[order[0]].frame.size.width = JSGSplitTreeSnap(container.origin.x + container.size.width, scale) - minX;
+    nodes[order[0]].frame.size.height = JSGSplitTreeSnap(container.origin.y + container.size.height, scale) - minY;
+
+    for (size_t i = 0; i < orderCount; i++) {
+        const JSGSplitNode *node = &nodes[order[i]];
+
+        if (node->type == JSGSplitTypePane) {
+            continue;
+        }
+
+        JSGSplitNode *first = &nodes[node->children[0]];
+        JSGSplitNode *second = &nodes[node->children[1]];
+        CGRect frame = node->frame;
+        first->frame = frame;
+        second->frame = frame;
+
+        if (node->type == JSGSplitTypeHorizontal) {
+            CGFloat start = frame.origin.x;
+            CGFloat end = JSGSplitTreeSnap(start + frame.size.width, scale);
+            CGFloat available = end - start - divider;
+            CGFloat length = JSGSplitTreeResolveLength(available > 0 ? available : 0, node->ratio, first->minSize.width, first->maxSize.width, second->minSize.width, second->maxSize.width);
+            CGFloat split = JSGSplitTreeSnap(start + length, scale);
+            CGFloat secondStart = JSGSplitTreeSnap(split + divider, scale);
+            secondStart = secondStart < end ? secondStart : end;
+            split = split < secondStart ? split : secondStart;
+
+            first->frame.size.width = split - start;
+            second->frame.origin.x = secondStart;
+            second->frame.size.width = end - secondStart;
+        } else {
+            CGFloat start = frame.origin.y;
+            CGFloat end = JSGSplitTreeSnap(start + frame.size.height, scale);
+            CGFloat available = end - start - divider;
+            CGFloat length = JSGSplitTreeResolveLength(available > 0 ? available : 0, node->ratio, first->minSize.height, first->maxSize.height, second->minSize.height, second->maxSize.height);
+            CGFloat split = JSGSplitTreeSnap(start + length, scale);
+            CGFloat secondStart = JSGSplitTreeSnap(split + divider, scale);
+            secondStart = secondStart < end ? secondStart : end;
+            split = split < secondStart ? split : secondStart;
+
+            first->frame.size.height = split - start;
+            second->frame.origin.y = secondStart;
+            second->frame.size.height = end - secondStart;
+        }
+    }
+}
+
+/**
+ *  Return the rect of the divider between the children of a split
+ *
+ *  @param tree The tree containing the split
+ *  @param split The index of the split
+ *
+ *  @discussion The result is only valid after laying out the tree. It can be used to draw
+ *  the divider, or to hit test it when the user drags it.
+ */
+JSG_INLINE CGRect JSGSplitTreeGetDividerRect(const JSGSplitTree *tree, size_t split)
+{
+    const JSGSplitNode *node = &tree->nodes[split];
+    const CGRect first = tree->nodes[node->children[0]].frame;
+    const CGRect second = tree->nodes[node->children[1]].frame;
+    CGRect divider = node->frame;
+
+    // The end of the first child is rebuilt from its origin & size, which can round past
+    // the start of the second child when the split line is at a fractional position
+    if (node->type == JSGSplitTypeHorizontal) {
+        CGFloat firstEnd = first.origin.x + first.size.width;
+        divider.origin.x = firstEnd < second.origin.x ? firstEnd : second.origin.x;
+        divider.size.width = second.origin.x - divider.origin.x;
+    } else {
+        CGFloat firstEnd = first.origin.y + first.size.height;
+        divider.origin.y = firstEnd < second.origin.y ? firstEnd : second.origin.y;
+        divider.size.height = second.origin.y - divider.origin.y;
+    }
+
+    return divider;
+}
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef JSGeometryTreemap
+#define JSGeometryTreemap
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "JSGeometry.h"
+#include "JSGeometrySorting.h"
+
+#pragma mark - Enums
+
+/**
+ *  Enum describing the algorithms that can be used to lay out a treemap
+ *
+ *  @discussion Squarified layouts keep tiles as close to square as possible, by placing
+ *  them by descending weight in rows along the shorter side of the remaining space. The
+ *  order of the tiles is therefore not preserved. Slice & dice layouts keep the tiles in
+ *  order, slicing the container into vertical strips, and alternating with horizontal
+ *  strips at each level of a hierarchy.
+ */
+typedef enum : NSUInteger {
+    JSGTreemapLayoutSquarified,
+    JSGTreemapLayoutSliceAndDice
+} JSGTreemapLayout;
+
+#pragma mark - Private functions
+
+/**
+ *  Lay out tiles in a rect using the squarified algorithm
+ *
+ *  @discussion The scored indices must be sorted by descending weight, and their scores
+ *  must have been scaled so that they add up to the area of the rect.
+ */
+JSG_INLINE void JSGTreemapSquarify(const JSGScoredIndex *order, size_t count, CGRect rect, CGRect *tiles)
+{
+    CGFloat x = rect.origin.x;
+    CGFloat y = rect.origin.y;
+    CGFloat width = rect.size.width;
+    CGFloat height = rect.size.height;
+    size_t i = 0;
+
+    while (i < count && order[i].score > 0) {
+        // Grow the row for as long as adding a tile improves its worst aspect ratio, which
+        // for a row of total area s, laid along a side of length l, with tile areas between
+        // min & max, is max(l² * max / s², s² / (l² * min)).
+        CGFloat side = width < height ? width : height;
+        CGFloat sideSquared = side * side;
+        CGFloat rowArea = order[i].score;
+        CGFloat rowMinArea = rowArea;
+        CGFloat rowMaxArea = rowArea;
+        CGFloat worst = sideSquared / rowArea > rowArea / sideSquared ? sideSquared / rowArea : rowArea / sideSquared;
+        size_t end = i + 1;
+
+        for (; end < count && order[end].score > 0; end++) {
+            CGFloat area = order[end].score;
+            CGFloat nextArea = rowArea + area;
+            CGFloat nextMinArea = area < rowMinArea ? area : rowMinArea;
+            CGFloat nextMaxArea = area > rowMaxArea ? area : rowMaxArea;
+            CGFloat nextAreaSquared = nextArea * nextArea;
+            CGFloat first = sideSquared * nextMaxArea / nextAreaSquared;
+            CGFloat second = nextAreaSquared / (sideSquared * nextMinArea);
+            CGFloat nextWorst = first > second ? first : second;
+
+            if (nextWorst > worst) {
+                break;
+            }
+
+            rowArea = nextArea;
+            rowMinArea = nextMinArea;
+            rowMaxArea = nextMaxArea;
+            worst = nextWorst;
+        }
+
+        bool lastRow = end == count || order[end].score <= 0;
+        bool vertical = width >= height;
+        CGFloat thickness = side > 0 ? rowArea / side : 0;
+        CGFloat offset = 0;
+
+        // The last row takes up all of the remaining space, so that rounding errors never
+        // leave a gap at the far edge of the rect
+        if (lastRow) {
+            thickness = vertical ? width : height;
+        }
+
+        for (size_t j = i; j < end; j++) {
+            CGFloat length = thickness > 0 ? order[j].score / thickness : 0;
+            CGRect *tile = &tiles[order[j].index];
+
+            if (j == end - 1) {
+                length = side - offset;
+            }
+
+            if (vertical) {
+                tile->origin.x = x;
+                tile->origin.y = y + offset;
+                tile->size.width = thickness;
+                tile->size.height = length;
+            } else {
+                tile->origin.x = x + offset;
+                tile->origin.y = y;
+                tile->size.width = length;
+                tile->size.height = thickness;
+            }
+
+            offset += length;
+        }
+
+        if (vertical) {
+            x += thickness;
+            width -= thickness;
+        } else {
+            y += thickness;
+            height -= thickness;
+        }
+
+        i = end;
+    }
+
+    // Tiles without a positive weight are given an empty rect where the layout ended
+    for (; i < count; i++) {
+        CGRect *tile = &tiles[order[i].index];
+        tile->origin.x = x;
+        tile->origin.y = y;
+        tile->size.width = 0;
+        tile->size.height = 0;
+    }
+}
+
+/**
+ *  Lay out tiles in a rect, in order, as vertical or horizontal strips
+ *
+ *  @discussion The weights must add up to total, which must be positive.
+ */
+JSG_INLINE void JSGTreemapSlice(const CGFloat *weights, size_t count, CGFloat total, CGRect rect, bool vertical, CGRect *tiles)
+{
+    CGFloat length = vertical ? rect.size.width : rect.size.height;
+    CGFloat sum = 0;
+    CGFloat start = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        CGFloat weight = weights[i] > 0 ? weights[i] : 0;
+        // Positioning tiles by their running sum rather than accumulating lengths keeps
+        // rounding errors from building up. Once the sum reaches the total, which it does
+        // exactly since it's added up in the same order, the tiles end at the far edge, so
+        // that trailing tiles without weight are empty rather than off by a rounding error.
+        sum += weight;
+        CGFloat end = sum < total ? length * sum / total : length;
+
+        tiles[i] = rect;
+
+        if (vertical) {
+            tiles[i].origin.x = rect.origin.x + start;
+            tiles[i].size.width = end - start;
+        } else {
+            tiles[i].origin.y = rect.origin.y + start;
+            tiles[i].size.height = end - start;
+        }
+
+        start = end;
+    }
+}
+
+/**
+ *  Lay out a single level of tiles in a rect
+ *
+ *  @discussion order is scratch space with room for count scored indices. Returns false if
+ *  memory could not be allocated.
+ */
+JSG_INLINE bool JSGTreemapLayoutLevel(const CGFloat *weights, size_t count, CGRect rect, JSGTreemapLayout layout, bool vertical, JSGScoredIndex *order, CGRect *tiles)
+{
+    CGFloat total = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        total += weights[i] > 0 ? weights[i] : 0;
+    }
+
+    if (total <= 0) {
+        for (size_t i = 0; i < count; i++) {
+            tiles[i].origin = rect.origin;
+            tiles[i].size.width = 0;
+            tiles[i].size.height = 0;
+        }
+
+        return true;
+    }
+
+    if (layout == JSGTreemapLayoutSliceAndDice) {
+        JSGTreemapSlice(weights, count, total, rect, vertical, tiles);
+
+        return true;
+    }
+
+    CGFloat scale = rect.size.width * rect.size.height / total;
+
+    for (size_t i = 0; i < count; i++) {
+        order[i].score = weights[i] > 0 ? weights[i] * scale : 0;
+        order[i].index = i;
+    }
+
+    if (!JSGScoredIndicesSort(order, count)) {
+        return false;
+    }
+
+    JSGTreemapSquarify(order, count, rect, tiles);
+
+    return true;
+}
+
+#pragma mark - Treemap functions
+
+/**
+ *  Lay out a treemap of weighted tiles in a container rect
+ *
+ *  @param weights The weight of each tile. Tiles without a positive weight get an empty rect.
+ *  @param count The number of tiles
+ *  @param container The rect to fill with tiles
+ *  @param layout The algorithm to use
+ *  @param tiles The array to write the rect of each tile to, in the same order as the
+ *  weights. Must have room for count rects.
+ *
+ *  @return Whether the treemap could be laid out. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion The area of each tile is proportional to its weight, and the tiles exactly
+ *  cover the container.
+ */
+JSG_INLINE bool JSGTreemapLayoutRects(const CGFloat *weights, size_t count, CGRect container, JSGTreemapLayout layout, CGRect *tiles)
+{
+    JSGScoredIndex *order = NULL;
+
+    if (layout == JSGTreemapLayoutSquarified && count > 0) {
+        order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+
+        if (!order) {
+            return false;
+        }
+    }
+
+    bool laidOut = JSGTreemapLayoutLevel(weights, count, CGRectStandardize(container), layout, true, order, tiles);
+    free(order);
+
+    return laidOut;
+}
+
+/**
+ *  Lay out a nested treemap of a hierarchy of weighted nodes in a container rect
+ *
+ *  @param weights The weight of each node. Only the weights of leaves are used, the weight
+ *  of other nodes is the sum of the weights of their children.
+ *  @param firstChildren The index of the first child of each node
+ *  @param childCounts The number of children of each node. The children of a node are the
+ *  nodes from firstChildren[i] to firstChildren[i] + childCounts[i] (exclusive), which must
+ *  all have a greater index than the node itself. This is the case when nodes are stored in
+ *  breadth-first order.
+ *  @param count The number of nodes
+ *  @param container The rect to lay out the root node in. The root node is the node at
+ *  index 0.
+ *  @param layout The algorithm to use
+ *  @param padding The amount by which the tile of a node is inset before laying out its
+ *  children
+ *  @param tiles The array to write the rect of each node to. Must have room for count rects.
+ *
+ *  @return Whether the treemap could be laid out. This is only false if memory could not
+ *  be allocated.
+ *
+ *  @discussion Nodes are visited in a single pass by increasing index, and the children of
+ *  each node are laid out in its tile. With a slice & dice layout, the children of nodes at
+ *  even depths are laid out in vertical strips, and those at odd depths in horizontal strips.
+ */
+JSG_INLINE bool JSGTreemapLayoutHierarchy(const CGFloat *weights, const size_t *firstChildren, const size_t *childCounts, size_t count, CGRect container, JSGTreemapLayout layout, CGFloat padding, CGRect *tiles)
+{
+    if (count == 0) {
+        return true;
+    }
+
+    CGFloat *totals = (CGFloat *)malloc(count * sizeof(CGFloat));
+    unsigned char *vertical = (unsigned char *)malloc(count);
+    JSGScoredIndex *order = (JSGScoredIndex *)malloc(count * sizeof(JSGScoredIndex));
+
+    if (!totals || !vertical || !order) {
+        free(totals);
+        free(vertical);
+        free(order);
+
+        return false;
+    }
+
+    // Since children always come after their parent, visiting nodes backwards computes
+    // the total weight of every child before it's added to its parent
+    for (size_t i = count; i-- > 0;) {
+        if (childCounts[i] == 0) {
+            totals[i] = weights[i] > 0 ? weights[i] : 0;
+            continue;
+        }
+
+        CGFloat total = 0;
+
+        for (size_t j = firstChildren[i]; j < firstChildren[i] + childCounts[i]; j++) {
+            total += totals[j];
+        }
+
+        totals[i] = total;
+    }
+
+    tiles[0] = CGRectStandardize(container);
+    vertical[0] = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        if (childCounts[i] == 0) {
+            continue;
+        }
+
+        CGRect rect = tiles[i];
+        CGFloat insetX = rect.size.width > 2 * padding ? padding : rect.size.width / 2;
+        CGFloat insetY = rect.size.height > 2 * padding ? padding : rect.size.height / 2;
+        rect.origin.x += insetX;
+        rect.origin.y += insetY;
+        rect.size.width -= 2 * insetX;
+        rect.size.height -= 2 * insetY;
+
+        size_t first = firstChildren[i];
+
+        if (!JSGTreemapLayoutLevel(totals + first, childCounts[i], rect, layout, vertical[i], order, tiles + first)) {
+            free(totals);
+            free(vertical);
+            free(order);
+
+            return false;
+        }
+
+        for (size_t j = first; j < first + childCounts[i]; j++) {
+            vertical[j] = !vertical[i];
+        }
+    }
+
+    free(totals);
+    free(vertical);
+    free(order);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include <cstddef>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryAtlas.h"
+
+/**
+ *  Tests that sprite vertices hold the corners of each frame & inset atlas rect, in any
+ *  vertex layout & across blocks, without touching other attributes, & that sprite indices
+ *  draw both triangles of each sprite with the same winding order.
+ */
+
+/**
+ *  A vertex with extra attributes around the position & texture coordinates, which must be
+ *  left untouched
+ */
+struct Vertex {
+    float color[3];
+    float u;
+    float v;
+    float normal;
+    float x;
+    float y;
+};
+
+static const float sentinel = -7.5f;
+
+static bool CheckVertices(const std::vector<CGRect> &frames, const std::vector<CGRect> &atlasRects, CGSize textureSize, CGFloat texelInset, bool flipV)
+{
+    JSGRectArray frameArray, atlasArray;
+    JSGRectArrayInit(&frameArray);
+    JSGRectArrayInit(&atlasArray);
+    JSGRectArraySetRects(&frameArray, frames.data(), frames.size());
+    JSGRectArraySetRects(&atlasArray, atlasRects.data(), atlasRects.size());
+
+    // One more sprite than needed, which must not be written to
+    Vertex filled = {{sentinel, sentinel, sentinel}, sentinel, sentinel, sentinel, sentinel, sentinel};
+    std::vector<Vertex> vertices((frames.size() + 1) * JSG_SPRITE_VERTEX_COUNT, filled);
+    JSGRectArrayWriteSpriteVertices(&frameArray, &atlasArray, textureSize, texelInset, flipV, vertices.data(), sizeof(Vertex), offsetof(Vertex, x), offsetof(Vertex, u));
+
+    bool matches = true;
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        CGRect frame = frames[i];
+        CGRect atlasRect = CGRectInset(atlasRects[i], texelInset, texelInset);
+
+        for (size_t corner = 0; corner < JSG_SPRITE_VERTEX_COUNT; corner++) {
+            const Vertex &vertex = vertices[i * JSG_SPRITE_VERTEX_COUNT + corner];
+            bool maxX = corner == 1 || corner == 3;
+            bool maxY = corner >= 2;
+            CGFloat v = (maxY ? CGRectGetMaxY(atlasRect) : CGRectGetMinY(atlasRect)) / textureSize.height;
+
+            matches &= vertex.x == (float)(maxX ? CGRectGetMaxX(frame) : CGRectGetMinX(frame)) && vertex.y == (float)(maxY ? CGRectGetMaxY(frame) : CGRectGetMinY(frame));
+            matches &= vertex.u == (float)((maxX ? CGRectGetMaxX(atlasRect) : CGRectGetMinX(atlasRect)) / textureSize.width) && vertex.v == (float)(flipV ? 1 - v : v);
+            matches &= vertex.color[0] == sentinel && vertex.color[1] == sentinel && vertex.color[2] == sentinel && vertex.normal == sentinel;
+        }
+    }
+
+    for (size_t i = frames.size() * JSG_SPRITE_VERTEX_COUNT; i < vertices.size(); i++) {
+        matches &= vertices[i].x == sentinel && vertices[i].u == sentinel;
+    }
+
+    JSGRectArrayDestroy(&frameArray);
+    JSGRectArrayDestroy(&atlasArray);
+
+    return matches;
+}
+
+static void TestRandomSprites()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, JSG_SPRITE_BLOCK_SIZE - 1, JSG_SPRITE_BLOCK_SIZE, JSG_SPRITE_BLOCK_SIZE + 1, 300};
+    bool matches = true;
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        std::vector<CGRect> frames(counts[i]);
+        std::vector<CGRect> atlasRects(counts[i]);
+
+        // Quarter coordinates & power of 2 texture sizes, so that texture coordinates are
+        // computed exactly whether they're divided or multiplied by the inverse size
+        for (size_t j = 0; j < counts[i]; j++) {
+            frames[j] = CGRectMake(random.below(4000) * 0.25, random.below(4000) * 0.25, random.below(400) * 0.25, random.below(400) * 0.25);
+            atlasRects[j] = CGRectMake(random.below(900), random.below(400), 1 + random.below(100), 1 + random.below(100));
+        }
+
+        matches &= CheckVertices(frames, atlasRects, CGSizeMake(1024, 512), 0, false);
+        matches &= CheckVertices(frames, atlasRects, CGSizeMake(1024, 512), 0.5, false);
+        matches &= CheckVertices(frames, atlasRects, CGSizeMake(1024, 512), 0.5, true);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestIndices()
+{
+    const size_t spriteCount = 5;
+    const size_t firstSprite = 3;
+    std::vector<uint32_t> indices(spriteCount * JSG_SPRITE_INDEX_COUNT);
+    JSGSpriteIndicesFill(indices.data(), firstSprite, spriteCount);
+
+    // The corners of a unit quad, in the order the vertices are written in
+    const CGFloat xs[] = {0, 1, 0, 1};
+    const CGFloat ys[] = {0, 0, 1, 1};
+    bool matches = true;
+
+    for (size_t i = 0; i < spriteCount; i++) {
+        const uint32_t *sprite = indices.data() + i * JSG_SPRITE_INDEX_COUNT;
+        CGFloat windings[2] = {0, 0};
+        bool used[JSG_SPRITE_VERTEX_COUNT] = {false};
+
+        for (size_t triangle = 0; triangle < 2; triangle++) {
+            size_t a = sprite[triangle * 3] - (firstSprite + i) * JSG_SPRITE_VERTEX_COUNT;
+            size_t b = sprite[triangle * 3 + 1] - (firstSprite + i) * JSG_SPRITE_VERTEX_COUNT;
+            size_t c = sprite[triangle * 3 + 2] - (firstSprite + i) * JSG_SPRITE_VERTEX_COUNT;
+
+            if (a >= JSG_SPRITE_VERTEX_COUNT || b >= JSG_SPRITE_VERTEX_COUNT || c >= JSG_SPRITE_VERTEX_COUNT) {
+                matches = false;
+                continue;
+            }
+
+            windings[triangle] = (xs[b] - xs[a]) * (ys[c] - ys[a]) - (ys[b] - ys[a]) * (xs[c] - xs[a]);
+            used[a] = used[b] = used[c] = true;
+        }
+
+        // Both triangles are non degenerate, have the same winding & cover the whole quad
+        matches &= windings[0] != 0 && windings[0] == windings[1];
+        matches &= used[0] && used[1] && used[2] && used[3];
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+int main()
+{
+    JSGTestRun("Atlas random sprites", TestRandomSprites);
+    JSGTestRun("Atlas indices", TestIndices);
+
+    return JSGTestExitStatus();
+}
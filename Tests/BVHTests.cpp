@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryBVH.h"
+
+/**
+ *  Tests that queries & hit tests of a bounding volume hierarchy match brute force, for
+ *  hierarchies built with any number of threads, including degenerate & NaN rects.
+ */
+
+static const CGRect everything = CGRectMake(-1e9, -1e9, 2e9, 2e9);
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height;
+}
+
+static bool Contains(CGRect rect, CGPoint point)
+{
+    return point.x >= rect.origin.x && point.y >= rect.origin.y && point.x < rect.origin.x + rect.size.width && point.y < rect.origin.y + rect.size.height;
+}
+
+static std::vector<size_t> Query(const JSGBVH *bvh, CGRect rect)
+{
+    std::vector<size_t> items(JSGBVHQuery(bvh, rect, NULL, 0));
+    JSGBVHQuery(bvh, rect, items.data(), items.size());
+    std::sort(items.begin(), items.end());
+
+    return items;
+}
+
+static std::vector<size_t> BruteForceQuery(const std::vector<CGRect> &rects, CGRect rect)
+{
+    std::vector<size_t> items;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        if (Overlaps(rects[i], rect)) {
+            items.push_back(i);
+        }
+    }
+
+    return items;
+}
+
+static size_t BruteForceHitTest(const std::vector<CGRect> &rects, CGPoint point)
+{
+    size_t hit = JSG_BVH_NONE;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        if (Contains(rects[i], point)) {
+            hit = i;
+        }
+    }
+
+    return hit;
+}
+
+/**
+ *  Random rects with some that are large, some with a zero width and/or height, some
+ *  stacked exactly on top of each other, and some with a NaN coordinate
+ */
+static std::vector<CGRect> RandomRects(JSGTestRandom &random, size_t count)
+{
+    const CGFloat nan = std::numeric_limits<CGFloat>::quiet_NaN();
+    std::vector<CGRect> rects(count);
+
+    for (size_t i = 0; i < count; i++) {
+        CGRect rect = CGRectMake(random.next() * 1000, random.next() * 1000, 1 + random.next() * 30, 1 + random.next() * 30);
+
+        switch (i % 20) {
+            case 0:
+                rect.size = CGSizeMake(200 + random.next() * 400, 200 + random.next() * 400);
+                break;
+            case 1:
+                rect.size.width = 0;
+                break;
+            case 2:
+                rect.size = CGSizeZero;
+                break;
+            case 3:
+                rect = CGRectMake(500, 500, 10, 10);
+                break;
+            case 4:
+                rect.origin.x = nan;
+                break;
+            case 5:
+                rect.size.height = nan;
+                break;
+        }
+
+        rects[i] = rect;
+    }
+
+    return rects;
+}
+
+static void CheckBVH(JSGTestRandom &random, const std::vector<CGRect> &rects, size_t threadCount)
+{
+    JSGRectArray array;
+    JSGBVH bvh;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+    JSG_TEST_CHECK(JSGBVHInit(&bvh, &array, threadCount));
+    JSG_TEST_CHECK(Query(&bvh, everything) == BruteForceQuery(rects, everything));
+
+    for (size_t i = 0; i < 300; i++) {
+        CGRect rect = CGRectMake(random.next() * 1100 - 50, random.next() * 1100 - 50, random.next() * 100, random.next() * 100);
+        JSG_TEST_CHECK(Query(&bvh, rect) == BruteForceQuery(rects, rect));
+    }
+
+    for (size_t i = 0; i < 1000; i++) {
+        CGPoint point = CGPointMake(random.next() * 1100 - 50, random.next() * 1100 - 50);
+        JSG_TEST_CHECK(JSGBVHHitTest(&bvh, point) == BruteForceHitTest(rects, point));
+    }
+
+    // Points on the edges of the stacked rects are only contained by their minimum edges
+    JSG_TEST_CHECK(JSGBVHHitTest(&bvh, CGPointMake(500, 500)) == BruteForceHitTest(rects, CGPointMake(500, 500)));
+    JSG_TEST_CHECK(JSGBVHHitTest(&bvh, CGPointMake(510, 505)) == BruteForceHitTest(rects, CGPointMake(510, 505)));
+
+    JSGBVHDestroy(&bvh);
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestSmall()
+{
+    JSGTestRandom random;
+
+    for (size_t count = 0; count < 40; count++) {
+        CheckBVH(random, RandomRects(random, count), 1);
+    }
+}
+
+static void TestThreadCounts()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 20000);
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+    CheckBVH(random, rects, 1);
+    CheckBVH(random, rects, 4);
+    CheckBVH(random, rects, 0);
+
+    // The hierarchy is the same whatever the number of threads
+    JSGBVH single, parallel;
+    JSGBVHInit(&single, &array, 1);
+    JSGBVHInit(&parallel, &array, 4);
+    JSG_TEST_CHECK(single.nodeCount == parallel.nodeCount);
+    JSG_TEST_CHECK(std::equal(single.items, single.items + single.count, parallel.items));
+
+    JSGBVHDestroy(&single);
+    JSGBVHDestroy(&parallel);
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestAllNaN()
+{
+    JSGTestRandom random;
+    const CGFloat nan = std::numeric_limits<CGFloat>::quiet_NaN();
+    std::vector<CGRect> rects(2000, CGRectMake(nan, nan, nan, nan));
+
+    CheckBVH(random, rects, 2);
+}
+
+static void TestIdenticalRects()
+{
+    JSGTestRandom random;
+
+    // Identical centroids can't be separated by any plane, & are split in half instead
+    CheckBVH(random, std::vector<CGRect>(5000, CGRectMake(10, 20, 30, 40)), 2);
+}
+
+static bool StopAfterThree(void *context, size_t item, CGRect rect)
+{
+    (void)item;
+    (void)rect;
+
+    return ++*(size_t *)context < 3;
+}
+
+static void TestStoppingVisit()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 1000);
+    JSGRectArray array;
+    JSGBVH bvh;
+    size_t visited = 0;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+    JSGBVHInit(&bvh, &array, 1);
+
+    JSGBVHVisit(&bvh, everything, StopAfterThree, &visited);
+    JSG_TEST_CHECK(visited == 3);
+
+    JSGBVHDestroy(&bvh);
+    JSGRectArrayDestroy(&array);
+}
+
+int main()
+{
+    JSGTestRun("BVH small hierarchies", TestSmall);
+    JSGTestRun("BVH thread counts", TestThreadCounts);
+    JSGTestRun("BVH all NaN rects", TestAllNaN);
+    JSGTestRun("BVH identical rects", TestIdenticalRects);
+    JSGTestRun("BVH stopping a visit", TestStoppingVisit);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,112 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryClamping.h"
+
+/**
+ *  Tests that clamped rects are moved by the smallest distance into their bounds, shrunk
+ *  only when they don't fit, & that clamping a rect array gives the same rects as clamping
+ *  each rect on its own.
+ */
+
+/**
+ *  Clamp a range along one axis, moving it inside [minimum, maximum] if it fits, & aligning
+ *  it with the minimum otherwise
+ */
+static void BruteForceClampAxis(CGFloat *origin, CGFloat *size, CGFloat minimum, CGFloat maximum, JSGRectClampMode mode)
+{
+    if (maximum < minimum) {
+        minimum = maximum = (minimum + maximum) / 2;
+    }
+
+    if (mode == JSGRectClampModeShrink && *size > maximum - minimum) {
+        *size = maximum - minimum;
+    }
+
+    if (*size > maximum - minimum || *origin < minimum) {
+        *origin = minimum;
+    } else if (*origin + *size > maximum) {
+        *origin = maximum - *size;
+    }
+}
+
+static CGRect BruteForceClamp(CGRect rect, CGRect bounds, JSGEdgeInsets margins, JSGCoordinateSystemOrigin origin, JSGRectClampMode mode)
+{
+    CGFloat minimumYMargin = origin == JSGCoordinateSystemOriginTopLeft ? margins.top : margins.bottom;
+    CGFloat maximumYMargin = origin == JSGCoordinateSystemOriginTopLeft ? margins.bottom : margins.top;
+    rect = CGRectStandardize(rect);
+    bounds = CGRectStandardize(bounds);
+
+    BruteForceClampAxis(&rect.origin.x, &rect.size.width, CGRectGetMinX(bounds) + margins.left, CGRectGetMaxX(bounds) - margins.right, mode);
+    BruteForceClampAxis(&rect.origin.y, &rect.size.height, CGRectGetMinY(bounds) + minimumYMargin, CGRectGetMaxY(bounds) - maximumYMargin, mode);
+
+    return rect;
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    bool matches = true;
+
+    for (size_t iteration = 0; iteration < 200; iteration++) {
+        // Quarter coordinates, so that clamped edges are computed exactly
+        CGRect bounds = CGRectMake(random.below(400) * 0.25 - 50, random.below(400) * 0.25 - 50, random.below(800) * 0.25 - 40, random.below(800) * 0.25 - 40);
+        JSGEdgeInsets margins = JSGEdgeInsetsMake(random.below(40) * 0.25, random.below(40) * 0.25, random.below(40) * 0.25, random.below(40) * 0.25);
+        JSGCoordinateSystemOrigin origin = iteration % 2 ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+        JSGRectClampMode mode = iteration % 4 < 2 ? JSGRectClampModeShift : JSGRectClampModeShrink;
+        std::vector<CGRect> rects(random.below(40));
+        std::vector<CGRect> expected(rects.size());
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            rects[i] = CGRectMake(random.below(1200) * 0.25 - 150, random.below(1200) * 0.25 - 150, random.below(600) * 0.25 - 30, random.below(600) * 0.25 - 30);
+            expected[i] = BruteForceClamp(rects[i], bounds, margins, origin, mode);
+            matches &= CGRectEqualToRect(JSGRectClampToRect(rects[i], bounds, margins, origin, mode), expected[i]);
+        }
+
+        JSGRectArray array;
+        JSGRectArrayInit(&array);
+        JSGRectArraySetRects(&array, rects.data(), rects.size());
+        JSGRectArrayClampToRect(&array, bounds, margins, origin, mode);
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            matches &= CGRectEqualToRect(JSGRectArrayGetRect(&array, i), expected[i]);
+        }
+
+        JSGRectArrayDestroy(&array);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestModes()
+{
+    CGRect bounds = CGRectMake(0, 0, 100, 50);
+    JSGEdgeInsets margins = JSGEdgeInsetsMake(5, 0, 0, 0);
+
+    // A rect that fits is moved back inside, by the smallest distance
+    CGRect rect = JSGRectClampToRect(CGRectMake(90, -10, 20, 20), bounds, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShift);
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(80, 5, 20, 20)));
+
+    // The top margin is at the maximum y with a bottom left origin
+    rect = JSGRectClampToRect(CGRectMake(90, 40, 20, 20), bounds, margins, JSGCoordinateSystemOriginBottomLeft, JSGRectClampModeShift);
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(80, 25, 20, 20)));
+
+    // A rect larger than the bounds keeps its size when shifting, & shrinks otherwise
+    rect = JSGRectClampToRect(CGRectMake(-30, 10, 200, 10), bounds, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShift);
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(0, 10, 200, 10)));
+
+    rect = JSGRectClampToRect(CGRectMake(-30, 10, 200, 10), bounds, margins, JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShrink);
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(0, 10, 100, 10)));
+
+    // Margins larger than the bounds leave an empty range at their midpoint
+    rect = JSGRectClampToRect(CGRectMake(10, 10, 10, 10), bounds, JSGEdgeInsetsMake(0, 80, 0, 40), JSGCoordinateSystemOriginTopLeft, JSGRectClampModeShrink);
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(70, 10, 0, 10)));
+}
+
+int main()
+{
+    JSGTestRun("Clamping random rects", TestRandomRects);
+    JSGTestRun("Clamping modes", TestModes);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,115 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryClipping.h"
+
+/**
+ *  Tests that clipping rects keeps exactly the non-empty intersections that CGRectIntersection
+ *  gives, in order, for any number of rects around the groups of four, & in place.
+ */
+
+static void BruteForce(const std::vector<CGRect> &rects, CGRect clipRect, std::vector<CGRect> *clippedRects, std::vector<size_t> *sourceIndices)
+{
+    for (size_t i = 0; i < rects.size(); i++) {
+        CGRect intersection = CGRectIntersection(rects[i], clipRect);
+
+        if (!CGRectIsNull(intersection) && intersection.size.width > 0 && intersection.size.height > 0) {
+            clippedRects->push_back(intersection);
+            sourceIndices->push_back(i);
+        }
+    }
+}
+
+/**
+ *  Random rects around a 100 by 100 clip rect, with quarter coordinates so that some only
+ *  touch its edges, & some with a zero width or height
+ */
+static std::vector<CGRect> RandomRects(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGRect> rects(count);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(random.below(640) * 0.25 - 30, random.below(640) * 0.25 - 30, random.below(160) * 0.25, random.below(160) * 0.25);
+
+        if (random.below(10) == 0) {
+            rects[i].size.width = 0;
+        }
+    }
+
+    return rects;
+}
+
+static void CheckClip(const std::vector<CGRect> &rects, CGRect clipRect)
+{
+    std::vector<CGRect> expectedRects;
+    std::vector<size_t> expectedIndices;
+    BruteForce(rects, clipRect, &expectedRects, &expectedIndices);
+
+    // Sized to exactly count, so that writing past the end is caught by the sanitizers
+    std::vector<CGRect> clippedRects(rects.size());
+    std::vector<size_t> sourceIndices(rects.size());
+    size_t count = JSGRectsClipToRect(rects.data(), rects.size(), clipRect, clippedRects.data(), sourceIndices.data());
+    clippedRects.resize(count);
+    sourceIndices.resize(count);
+
+    bool matches = clippedRects.size() == expectedRects.size() && sourceIndices == expectedIndices;
+
+    for (size_t i = 0; matches && i < count; i++) {
+        matches &= CGRectEqualToRect(clippedRects[i], expectedRects[i]);
+    }
+
+    JSG_TEST_CHECK(matches);
+
+    // In place & without source indices
+    std::vector<CGRect> inPlace = rects;
+    inPlace.resize(JSGRectsClipToRect(inPlace.data(), inPlace.size(), clipRect, inPlace.data(), NULL));
+    matches = inPlace.size() == expectedRects.size();
+
+    for (size_t i = 0; matches && i < inPlace.size(); i++) {
+        matches &= CGRectEqualToRect(inPlace[i], expectedRects[i]);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestCounts()
+{
+    JSGTestRandom random;
+
+    // Every remainder of the groups of four, & larger arrays
+    for (size_t count = 0; count < 14; count++) {
+        for (size_t i = 0; i < 20; i++) {
+            CheckClip(RandomRects(random, count), CGRectMake(0, 0, 100, 100));
+        }
+    }
+
+    CheckClip(RandomRects(random, 1001), CGRectMake(0, 0, 100, 100));
+    CheckClip(RandomRects(random, 4096), CGRectMake(20.5, -10, 40, 200));
+}
+
+static void TestClipRects()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 203);
+
+    // A clip rect with a negative size is standardized
+    CheckClip(rects, CGRectMake(100, 100, -100, -100));
+
+    std::vector<CGRect> clippedRects(rects.size());
+    JSG_TEST_CHECK(JSGRectsClipToRect(rects.data(), rects.size(), CGRectNull, clippedRects.data(), NULL) == 0);
+    JSG_TEST_CHECK(JSGRectsClipToRect(rects.data(), rects.size(), CGRectMake(10, 10, 0, 50), clippedRects.data(), NULL) == 0);
+
+    // Rects that only touch the clip rect's edges are dropped
+    CGRect touching[] = {CGRectMake(-10, 0, 10, 10), CGRectMake(100, 0, 10, 10), CGRectMake(0, 100, 10, 10), CGRectMake(0, -10, 10, 10), CGRectMake(99, 99, 10, 10)};
+    size_t sourceIndices[5];
+    JSG_TEST_CHECK(JSGRectsClipToRect(touching, 5, CGRectMake(0, 0, 100, 100), clippedRects.data(), sourceIndices) == 1);
+    JSG_TEST_CHECK(sourceIndices[0] == 4 && CGRectEqualToRect(clippedRects[0], CGRectMake(99, 99, 1, 1)));
+}
+
+int main()
+{
+    JSGTestRun("Clipping counts", TestCounts);
+    JSGTestRun("Clipping clip rects", TestClipRects);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,216 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryClustering.h"
+
+/**
+ *  Tests that the clusters of a cluster index form a hierarchy, in which each cluster is the
+ *  weighted average of its children at the next zoom level, down to the points themselves.
+ */
+
+static const CGRect everything = CGRectMake(-1e9, -1e9, 2e9, 2e9);
+
+static std::vector<JSGCluster> Clusters(const JSGClusterIndex *index, size_t zoom)
+{
+    std::vector<JSGCluster> clusters(JSGClusterIndexGetClusters(index, everything, zoom, NULL, 0));
+    JSGClusterIndexGetClusters(index, everything, zoom, clusters.data(), clusters.size());
+
+    return clusters;
+}
+
+static std::vector<JSGCluster> Children(const JSGClusterIndex *index, size_t zoom, size_t identifier)
+{
+    std::vector<JSGCluster> children(JSGClusterIndexGetChildren(index, zoom, identifier, NULL, 0));
+    JSGClusterIndexGetChildren(index, zoom, identifier, children.data(), children.size());
+
+    return children;
+}
+
+static bool Near(CGFloat a, CGFloat b)
+{
+    return std::fabs(a - b) <= 1e-9 * (1 + std::fabs(a) + std::fabs(b));
+}
+
+static std::vector<CGPoint> RandomPoints(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGPoint> points(count);
+
+    for (size_t i = 0; i < count; i++) {
+        points[i] = CGPointMake(random.next() * 256, random.next() * 256);
+    }
+
+    return points;
+}
+
+static void TestHierarchy()
+{
+    JSGTestRandom random;
+    std::vector<CGPoint> points = RandomPoints(random, 2000);
+    JSGClusterIndex index;
+    const size_t minZoom = 0, maxZoom = 16;
+    const CGFloat radius = 40;
+
+    JSG_TEST_CHECK(JSGClusterIndexInit(&index, points.data(), points.size(), radius, minZoom, maxZoom));
+
+    // Above the highest zoom level, every point is its own cluster
+    std::vector<JSGCluster> leaves = Clusters(&index, maxZoom + 1);
+    std::vector<bool> found(points.size(), false);
+    JSG_TEST_CHECK(leaves.size() == points.size());
+
+    for (size_t i = 0; i < leaves.size(); i++) {
+        JSG_TEST_CHECK(leaves[i].count == 1 && leaves[i].point < points.size() && !found[leaves[i].point]);
+        JSG_TEST_CHECK(leaves[i].point < points.size() && CGPointEqualToPoint(leaves[i].position, points[leaves[i].point]));
+
+        if (leaves[i].point < points.size()) {
+            found[leaves[i].point] = true;
+        }
+    }
+
+    size_t previousCount = 1;
+
+    for (size_t zoom = minZoom; zoom <= maxZoom; zoom++) {
+        std::vector<JSGCluster> clusters = Clusters(&index, zoom);
+        std::vector<size_t> parentCounts(Clusters(&index, zoom + 1).size(), 0);
+        CGFloat levelRadius = radius / pow(2, (CGFloat)zoom);
+        size_t total = 0;
+
+        // Clusters only split as the zoom level increases
+        JSG_TEST_CHECK(clusters.size() >= previousCount);
+        previousCount = clusters.size();
+
+        for (size_t i = 0; i < clusters.size(); i++) {
+            std::vector<JSGCluster> children = Children(&index, zoom, clusters[i].identifier);
+            size_t count = 0;
+            CGFloat sumX = 0, sumY = 0;
+
+            total += clusters[i].count;
+            JSG_TEST_CHECK(!children.empty());
+            JSG_TEST_CHECK((clusters[i].count == 1) == (clusters[i].point != JSG_CLUSTER_NONE));
+
+            for (size_t j = 0; j < children.size(); j++) {
+                count += children[j].count;
+                sumX += children[j].position.x * children[j].count;
+                sumY += children[j].position.y * children[j].count;
+                parentCounts[children[j].identifier]++;
+
+                // Children are all within the radius of the first child, so of each other
+                for (size_t k = 0; k < j; k++) {
+                    JSG_TEST_CHECK(std::hypot(children[j].position.x - children[k].position.x, children[j].position.y - children[k].position.y) <= 2 * levelRadius);
+                }
+            }
+
+            JSG_TEST_CHECK(count == clusters[i].count);
+            JSG_TEST_CHECK(Near(clusters[i].position.x, sumX / count) && Near(clusters[i].position.y, sumY / count));
+
+            if (children.size() == 1) {
+                JSG_TEST_CHECK(children[0].point == clusters[i].point);
+            }
+
+            // A cluster expands at the first zoom level where it has more than one child
+            size_t expansionZoom = zoom + 1;
+            size_t identifier = clusters[i].identifier;
+
+            for (std::vector<JSGCluster> descendants = children; descendants.size() == 1 && expansionZoom <= maxZoom; expansionZoom++) {
+                identifier = descendants[0].identifier;
+                descendants = Children(&index, expansionZoom, identifier);
+            }
+
+            JSG_TEST_CHECK(JSGClusterIndexGetExpansionZoom(&index, zoom, clusters[i].identifier) == expansionZoom);
+        }
+
+        JSG_TEST_CHECK(total == points.size());
+
+        for (size_t i = 0; i < parentCounts.size(); i++) {
+            JSG_TEST_CHECK(parentCounts[i] == 1);
+        }
+    }
+
+    JSG_TEST_CHECK(previousCount > 1);
+    JSG_TEST_CHECK(Clusters(&index, minZoom).size() < 50);
+
+    JSGClusterIndexDestroy(&index);
+}
+
+static void TestQueries()
+{
+    JSGTestRandom random;
+    std::vector<CGPoint> points = RandomPoints(random, 2000);
+    JSGClusterIndex index;
+    JSGClusterIndexInit(&index, points.data(), points.size(), 40, 2, 10);
+
+    // Zoom levels are clamped to the range of the index
+    JSG_TEST_CHECK(Clusters(&index, 0).size() == Clusters(&index, 2).size());
+    JSG_TEST_CHECK(Clusters(&index, 20).size() == points.size());
+
+    for (size_t zoom = 2; zoom <= 11; zoom++) {
+        std::vector<JSGCluster> all = Clusters(&index, zoom);
+
+        for (size_t round = 0; round < 20; round++) {
+            CGRect rect = CGRectMake(random.next() * 256, random.next() * 256, random.next() * 100, random.next() * 100);
+            size_t expected = 0;
+
+            // Clusters on the edges of the rect are included
+            for (size_t i = 0; i < all.size(); i++) {
+                expected += all[i].position.x >= CGRectGetMinX(rect) && all[i].position.x <= CGRectGetMaxX(rect) && all[i].position.y >= CGRectGetMinY(rect) && all[i].position.y <= CGRectGetMaxY(rect);
+            }
+
+            JSG_TEST_CHECK(JSGClusterIndexGetClusters(&index, rect, zoom, NULL, 0) == expected);
+        }
+
+        // Only the first capacity clusters are written
+        JSGCluster first[3];
+        JSG_TEST_CHECK(JSGClusterIndexGetClusters(&index, everything, zoom, first, 3) == all.size());
+    }
+
+    JSGClusterIndexDestroy(&index);
+}
+
+static void TestZeroRadius()
+{
+    // Without a radius, each point only searches its own position, wherever it is relative to
+    // the origin
+    CGPoint points[] = {CGPointMake(-10, -10), CGPointMake(-5, -5), CGPointMake(-1, -1), CGPointMake(-5, -5), CGPointMake(3, 4)};
+    JSGClusterIndex index;
+
+    for (CGFloat radius = 0; radius >= -1; radius--) {
+        JSG_TEST_CHECK(JSGClusterIndexInit(&index, points, 3, radius, 0, 0));
+        JSG_TEST_CHECK(Clusters(&index, 0).size() == 3);
+        JSGClusterIndexDestroy(&index);
+    }
+
+    // Only coincident points are clustered
+    JSGClusterIndexInit(&index, points, 5, 0, 0, 4);
+
+    for (size_t zoom = 0; zoom <= 4; zoom++) {
+        std::vector<JSGCluster> clusters = Clusters(&index, zoom);
+        JSG_TEST_CHECK(clusters.size() == 4);
+
+        for (size_t i = 0; i < clusters.size(); i++) {
+            JSG_TEST_CHECK(clusters[i].count == (CGPointEqualToPoint(clusters[i].position, CGPointMake(-5, -5)) ? 2u : 1u));
+        }
+    }
+
+    JSGClusterIndexDestroy(&index);
+}
+
+static void TestEmpty()
+{
+    JSGClusterIndex index;
+
+    JSG_TEST_CHECK(JSGClusterIndexInit(&index, NULL, 0, 40, 0, 16));
+    JSG_TEST_CHECK(Clusters(&index, 0).empty());
+    JSG_TEST_CHECK(Clusters(&index, 17).empty());
+
+    JSGClusterIndexDestroy(&index);
+}
+
+int main()
+{
+    JSGTestRun("Clustering hierarchy", TestHierarchy);
+    JSGTestRun("Clustering queries", TestQueries);
+    JSGTestRun("Clustering zero radius", TestZeroRadius);
+    JSGTestRun("Clustering empty index", TestEmpty);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,344 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometry.h"
+#include "../JSGeometryBatch.h"
+
+/**
+ *  The number of successful reallocations left before the next one fails, or -1 for none
+ */
+static long reallocCountdown = -1;
+
+static void *JSGTestRealloc(void *pointer, size_t size)
+{
+    if (reallocCountdown == 0) {
+        reallocCountdown = -1;
+        return NULL;
+    }
+
+    if (reallocCountdown > 0) {
+        reallocCountdown--;
+    }
+
+    return realloc(pointer, size);
+}
+
+// Route the command buffer's allocations through JSGTestRealloc, so that they can be failed
+#define realloc JSGTestRealloc
+#include "../JSGeometryCommandBuffer.h"
+#undef realloc
+
+/**
+ *  Tests that flushing a command buffer gives the same rects as applying its commands in
+ *  order, across conflicts between operations, epochs & allocation failures.
+ */
+
+struct Command {
+    JSGRectOperation operation;
+    size_t target;
+    CGPoint value;
+};
+
+static bool Enqueue(JSGCommandBuffer *buffer, const Command &command)
+{
+    switch (command.operation) {
+        case JSGRectOperationChangeOrigin:
+            return JSGCommandBufferEnqueueChangeOrigin(buffer, command.target, command.value);
+        case JSGRectOperationChangeOriginX:
+            return JSGCommandBufferEnqueueChangeOriginX(buffer, command.target, command.value.x);
+        case JSGRectOperationChangeOriginY:
+            return JSGCommandBufferEnqueueChangeOriginY(buffer, command.target, command.value.x);
+        case JSGRectOperationChangeSize:
+            return JSGCommandBufferEnqueueChangeSize(buffer, command.target, CGSizeMake(command.value.x, command.value.y));
+        case JSGRectOperationChangeWidth:
+            return JSGCommandBufferEnqueueChangeWidth(buffer, command.target, command.value.x);
+        case JSGRectOperationChangeHeight:
+            return JSGCommandBufferEnqueueChangeHeight(buffer, command.target, command.value.x);
+    }
+
+    return false;
+}
+
+static void Apply(std::vector<CGRect> &rects, const Command &command)
+{
+    CGRect &rect = rects[command.target];
+
+    switch (command.operation) {
+        case JSGRectOperationChangeOrigin:
+            rect = JSGRectChangeOrigin(rect, command.value);
+            break;
+        case JSGRectOperationChangeOriginX:
+            rect = JSGRectChangeOriginX(rect, command.value.x);
+            break;
+        case JSGRectOperationChangeOriginY:
+            rect = JSGRectChangeOriginY(rect, command.value.x);
+            break;
+        case JSGRectOperationChangeSize:
+            rect = JSGRectChangeSize(rect, CGSizeMake(command.value.x, command.value.y));
+            break;
+        case JSGRectOperationChangeWidth:
+            rect = JSGRectChangeWidth(rect, command.value.x);
+            break;
+        case JSGRectOperationChangeHeight:
+            rect = JSGRectChangeHeight(rect, command.value.x);
+            break;
+    }
+}
+
+static Command MakeCommand(JSGRectOperation operation, size_t target, CGFloat x, CGFloat y)
+{
+    Command command = {operation, target, CGPointMake(x, y)};
+
+    return command;
+}
+
+static std::vector<Command> RandomCommands(JSGTestRandom &random, size_t count, size_t targetCount)
+{
+    std::vector<Command> commands(count);
+
+    for (size_t i = 0; i < count; i++) {
+        commands[i] = MakeCommand((JSGRectOperation)random.below(JSGRectOperationCount), random.below(targetCount), (CGFloat)i, (CGFloat)(i + 1));
+    }
+
+    return commands;
+}
+
+static std::vector<CGRect> InitialRects(size_t count)
+{
+    std::vector<CGRect> rects(count);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(-(CGFloat)i, -(CGFloat)i, (CGFloat)i, (CGFloat)i);
+    }
+
+    return rects;
+}
+
+static bool Equal(const std::vector<CGRect> &a, const std::vector<CGRect> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!CGRectEqualToRect(a[i], b[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void TestRandomSequences()
+{
+    JSGTestRandom random;
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+
+    // The same buffer is reused across flushes of different sizes & target counts
+    for (size_t round = 0; round < 50; round++) {
+        size_t targetCount = 1 + random.below(round % 2 ? 8 : 500);
+        std::vector<Command> commands = RandomCommands(random, random.below(2000), targetCount);
+        std::vector<CGRect> rects = InitialRects(targetCount), expected = rects;
+
+        for (size_t i = 0; i < commands.size(); i++) {
+            JSG_TEST_CHECK(Enqueue(&buffer, commands[i]));
+            Apply(expected, commands[i]);
+        }
+
+        JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == commands.size());
+        JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+        JSG_TEST_CHECK(Equal(rects, expected));
+        JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == 0);
+    }
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+static void TestConflicts()
+{
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+    std::vector<CGRect> rects = InitialRects(4), expected = rects;
+    Command commands[] = {
+        // Operations writing different components of a rect don't conflict
+        MakeCommand(JSGRectOperationChangeWidth, 0, 10, 0),
+        MakeCommand(JSGRectOperationChangeHeight, 0, 20, 0),
+        MakeCommand(JSGRectOperationChangeOriginX, 0, 1, 0),
+        MakeCommand(JSGRectOperationChangeOriginX, 0, 2, 0),
+        MakeCommand(JSGRectOperationChangeWidth, 1, 30, 0),
+        // Origin writes the x component already written by OriginX, & the other way around
+        MakeCommand(JSGRectOperationChangeOrigin, 0, 3, 4),
+        MakeCommand(JSGRectOperationChangeOriginX, 0, 5, 0),
+        // Width was written to target 1 before the last boundary, so Size doesn't conflict
+        MakeCommand(JSGRectOperationChangeSize, 1, 40, 50),
+    };
+    size_t boundaryCounts[] = {0, 0, 0, 0, 0, 1, 2, 2};
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        JSG_TEST_CHECK(Enqueue(&buffer, commands[i]));
+        JSG_TEST_CHECK(buffer.boundaryCount == boundaryCounts[i]);
+        Apply(expected, commands[i]);
+    }
+
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(Equal(rects, expected));
+    JSG_TEST_CHECK(CGRectEqualToRect(rects[0], CGRectMake(5, 4, 10, 20)));
+    JSG_TEST_CHECK(CGRectEqualToRect(rects[1], CGRectMake(-1, -1, 40, 50)));
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+static void TestEpochs()
+{
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+    std::vector<CGRect> rects = InitialRects(2);
+
+    // Writes that were cleared or flushed can't conflict with later ones
+    JSGCommandBufferEnqueueChangeOriginX(&buffer, 0, 1);
+    JSGCommandBufferClear(&buffer);
+    JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == 0);
+
+    JSGCommandBufferEnqueueChangeOrigin(&buffer, 0, CGPointMake(2, 3));
+    JSG_TEST_CHECK(buffer.boundaryCount == 0);
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(CGRectEqualToRect(rects[0], CGRectMake(2, 3, 0, 0)));
+
+    JSGCommandBufferEnqueueChangeOriginY(&buffer, 0, 4);
+    JSG_TEST_CHECK(buffer.boundaryCount == 0);
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(CGRectEqualToRect(rects[0], CGRectMake(2, 4, 0, 0)));
+
+    // Flushing an empty buffer changes nothing
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(CGRectEqualToRect(rects[0], CGRectMake(2, 4, 0, 0)));
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, NULL, 0));
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+static void TestOutOfRangeFlush()
+{
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+    std::vector<CGRect> rects = InitialRects(6), original = rects;
+
+    JSGCommandBufferEnqueueChangeWidth(&buffer, 1, 10);
+    JSGCommandBufferEnqueueChangeOriginX(&buffer, 5, 10);
+
+    // No command is applied if any targets a rect outside of the array
+    JSG_TEST_CHECK(!JSGCommandBufferFlush(&buffer, rects.data(), 5));
+    JSG_TEST_CHECK(Equal(rects, original));
+    JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == 2);
+
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), 6));
+    JSG_TEST_CHECK(rects[1].size.width == 10 && rects[5].origin.x == 10);
+
+    // Clearing forgets the targets of discarded commands
+    JSGCommandBufferEnqueueChangeWidth(&buffer, 100, 10);
+    JSGCommandBufferClear(&buffer);
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), 6));
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+static void TestAllocationFailures()
+{
+    JSGTestRandom random;
+    const size_t targetCount = 300;
+    std::vector<Command> commands = RandomCommands(random, 600, targetCount);
+
+    // Fail each of the first reallocations made by each command in turn. A command that
+    // can't be recorded must leave the buffer as it was, so the flush then gives the same
+    // result as applying every other command.
+    for (size_t failing = 0; failing < commands.size(); failing++) {
+        for (long failure = 0; failure < 4; failure++) {
+            JSGCommandBuffer buffer;
+            JSGCommandBufferInit(&buffer);
+            std::vector<CGRect> rects = InitialRects(targetCount), expected = rects;
+
+            for (size_t i = 0; i < commands.size(); i++) {
+                if (i != failing) {
+                    JSG_TEST_CHECK(Enqueue(&buffer, commands[i]));
+                    Apply(expected, commands[i]);
+                    continue;
+                }
+
+                size_t count = JSGCommandBufferGetCount(&buffer);
+                size_t boundaryCount = buffer.boundaryCount;
+                size_t targetLimit = buffer.targetLimit;
+
+                reallocCountdown = failure;
+
+                if (Enqueue(&buffer, commands[i])) {
+                    Apply(expected, commands[i]);
+                } else {
+                    JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == count);
+                    JSG_TEST_CHECK(buffer.boundaryCount == boundaryCount);
+                    JSG_TEST_CHECK(buffer.targetLimit == targetLimit);
+                }
+
+                reallocCountdown = -1;
+            }
+
+            JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+            JSG_TEST_CHECK(Equal(rects, expected));
+            JSGCommandBufferDestroy(&buffer);
+        }
+    }
+
+    // A target that can't be tracked doesn't prevent flushing into a smaller array
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+    std::vector<CGRect> rects = InitialRects(2);
+
+    JSGCommandBufferEnqueueChangeWidth(&buffer, 1, 10);
+    reallocCountdown = 0;
+    JSG_TEST_CHECK(!JSGCommandBufferEnqueueChangeWidth(&buffer, 100000, 10));
+    reallocCountdown = -1;
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(rects[1].size.width == 10);
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+static void TestHugeTargets()
+{
+    JSGCommandBuffer buffer;
+    JSGCommandBufferInit(&buffer);
+    std::vector<CGRect> rects = InitialRects(2);
+    const size_t targets[] = {SIZE_MAX, SIZE_MAX / 2 + 1, SIZE_MAX / 2, SIZE_MAX / (2 * sizeof(size_t))};
+
+    JSG_TEST_CHECK(JSGCommandBufferEnqueueChangeWidth(&buffer, 1, 10));
+
+    size_t targetCapacity = buffer.targetCapacity;
+
+    // Targets whose tracking memory can't even be counted are rejected without allocating
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        for (int operation = 0; operation < JSGRectOperationCount; operation++) {
+            JSG_TEST_CHECK(!Enqueue(&buffer, MakeCommand((JSGRectOperation)operation, targets[i], 1, 2)));
+            JSG_TEST_CHECK(JSGCommandBufferGetCount(&buffer) == 1);
+            JSG_TEST_CHECK(buffer.targetCapacity == targetCapacity && buffer.targetLimit == 2);
+        }
+    }
+
+    JSG_TEST_CHECK(JSGCommandBufferFlush(&buffer, rects.data(), rects.size()));
+    JSG_TEST_CHECK(rects[1].size.width == 10);
+
+    JSGCommandBufferDestroy(&buffer);
+}
+
+int main()
+{
+    JSGTestRun("CommandBuffer random sequences", TestRandomSequences);
+    JSGTestRun("CommandBuffer conflicts", TestConflicts);
+    JSGTestRun("CommandBuffer epochs", TestEpochs);
+    JSGTestRun("CommandBuffer out of range flush", TestOutOfRangeFlush);
+    JSGTestRun("CommandBuffer allocation failures", TestAllocationFailures);
+    JSGTestRun("CommandBuffer huge targets", TestHugeTargets);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,131 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryComponents.h"
+
+/**
+ *  Tests that overlap groups match the connected components found by testing every pair of
+ *  rects, numbered in order of their first rect, including rects that only touch & rects
+ *  without an area.
+ */
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height && a.size.width > 0 && a.size.height > 0 && b.size.width > 0 && b.size.height > 0;
+}
+
+/**
+ *  Number the connected components of the overlap graph with a depth-first search from
+ *  each rect that isn't in a group yet
+ */
+static std::vector<size_t> BruteForceGroups(const std::vector<CGRect> &rects, size_t *groupCount)
+{
+    std::vector<size_t> groups(rects.size(), JSG_COMPONENT_NONE);
+    *groupCount = 0;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        if (groups[i] != JSG_COMPONENT_NONE) {
+            continue;
+        }
+
+        std::vector<size_t> stack(1, i);
+        groups[i] = *groupCount;
+
+        while (!stack.empty()) {
+            size_t rect = stack.back();
+            stack.pop_back();
+
+            for (size_t j = 0; j < rects.size(); j++) {
+                if (groups[j] == JSG_COMPONENT_NONE && Overlaps(rects[rect], rects[j])) {
+                    groups[j] = *groupCount;
+                    stack.push_back(j);
+                }
+            }
+        }
+
+        (*groupCount)++;
+    }
+
+    return groups;
+}
+
+static bool CheckGroups(const std::vector<CGRect> &rects)
+{
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+    std::vector<size_t> groups(rects.size() + 1);
+    size_t groupCount = JSG_COMPONENT_NONE;
+    size_t expectedCount;
+    std::vector<size_t> expected = BruteForceGroups(rects, &expectedCount);
+
+    bool matches = JSGRectArrayGetOverlapGroups(&array, groups.data(), &groupCount);
+    matches &= groupCount == expectedCount && std::vector<size_t>(groups.begin(), groups.begin() + rects.size()) == expected;
+
+    JSGRectArrayDestroy(&array);
+
+    return matches;
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, 2, 3, 10, 100, 1000};
+    bool matches = true;
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        for (size_t iteration = 0; iteration < 20; iteration++) {
+            std::vector<CGRect> rects(counts[i]);
+
+            // Integer coordinates on a small grid, so that many rects share edges or have
+            // the same minimum x, & some have a zero width or height
+            for (size_t j = 0; j < counts[i]; j++) {
+                CGFloat range = 20 + iteration * 10;
+                rects[j] = CGRectMake(random.below((size_t)range), random.below((size_t)range), random.below(8), random.below(8));
+            }
+
+            matches &= CheckGroups(rects);
+        }
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestChains()
+{
+    std::vector<CGRect> rects;
+
+    // A chain of overlapping rects is a single group, even though its ends are far apart
+    for (size_t i = 0; i < 50; i++) {
+        rects.push_back(CGRectMake(i * 9, (i % 2) * 5, 10, 10));
+    }
+
+    // Rects that only touch stay apart, & so do empty rects inside other rects
+    rects.push_back(CGRectMake(1000, 0, 10, 10));
+    rects.push_back(CGRectMake(1010, 0, 10, 10));
+    rects.push_back(CGRectMake(1000, 10, 10, 10));
+    rects.push_back(CGRectMake(1002, 2, 0, 5));
+
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+    std::vector<size_t> groups(rects.size());
+    size_t groupCount;
+    JSG_TEST_CHECK(JSGRectArrayGetOverlapGroups(&array, groups.data(), &groupCount));
+    JSG_TEST_CHECK(groupCount == 5 && groups[0] == 0 && groups[49] == 0);
+    JSG_TEST_CHECK(groups[50] == 1 && groups[51] == 2 && groups[52] == 3 && groups[53] == 4);
+
+    JSGRectArrayDestroy(&array);
+
+    JSG_TEST_CHECK(CheckGroups(rects));
+}
+
+int main()
+{
+    JSGTestRun("Components random rects", TestRandomRects);
+    JSGTestRun("Components chains", TestChains);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,164 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryCoverage.h"
+
+/**
+ *  Tests that coverage counts & statistics match counting, for every pixel, the rects that
+ *  contain its center, including rects partially outside the raster, rects with negative
+ *  sizes & several batches of rects.
+ */
+
+/**
+ *  Count the rects containing the center of each pixel. A rect contains the centers from
+ *  its minimum edges (inclusive) to its maximum edges (exclusive).
+ */
+static void AddBruteForceCounts(const JSGCoverageRaster *raster, const std::vector<CGRect> &rects, std::vector<uint32_t> *counts)
+{
+    for (size_t i = 0; i < rects.size(); i++) {
+        CGRect rect = CGRectStandardize(rects[i]);
+
+        for (size_t row = 0; row < raster->height; row++) {
+            for (size_t column = 0; column < raster->width; column++) {
+                CGFloat x = raster->bounds.origin.x + (column + 0.5) * raster->pixelSize;
+                CGFloat y = raster->bounds.origin.y + (row + 0.5) * raster->pixelSize;
+
+                if (x >= CGRectGetMinX(rect) && x < CGRectGetMaxX(rect) && y >= CGRectGetMinY(rect) && y < CGRectGetMaxY(rect)) {
+                    (*counts)[row * raster->width + column]++;
+                }
+            }
+        }
+    }
+}
+
+static bool CheckCounts(const JSGCoverageRaster *raster, const std::vector<uint32_t> &counts)
+{
+    const size_t histogramCount = 4;
+    JSGCoverageStatistics statistics;
+    size_t histogram[histogramCount];
+    size_t expectedHistogram[histogramCount] = {0};
+    size_t covered = 0, overdrawn = 0;
+    uint64_t total = 0;
+    uint32_t maximum = 0;
+    bool matches = counts.size() == raster->width * raster->height;
+
+    for (size_t row = 0; matches && row < raster->height; row++) {
+        for (size_t column = 0; column < raster->width; column++) {
+            uint32_t count = counts[row * raster->width + column];
+            CGPoint center = CGPointMake(raster->bounds.origin.x + (column + 0.5) * raster->pixelSize, raster->bounds.origin.y + (row + 0.5) * raster->pixelSize);
+
+            matches &= raster->counts[row * raster->width + column] == count && JSGCoverageRasterGetCount(raster, center) == count;
+            covered += count > 0;
+            overdrawn += count > 1;
+            total += count;
+            maximum = count > maximum ? count : maximum;
+            expectedHistogram[count < histogramCount - 1 ? count : histogramCount - 1]++;
+        }
+    }
+
+    JSGCoverageRasterGetStatistics(raster, &statistics, histogram, histogramCount);
+    matches &= statistics.pixelCount == counts.size() && statistics.coveredPixelCount == covered && statistics.overdrawnPixelCount == overdrawn;
+    matches &= statistics.totalCount == total && statistics.maximumCount == maximum;
+
+    for (size_t i = 0; i < histogramCount; i++) {
+        matches &= histogram[i] == expectedHistogram[i];
+    }
+
+    return matches;
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    CGRect allBounds[] = {CGRectMake(0, 0, 64, 48), CGRectMake(-10.25, 7.5, 33.75, 20.5), CGRectMake(5, 5, 1, 0.25)};
+    CGFloat pixelSizes[] = {1, 0.5, 2};
+    bool matches = true;
+
+    for (size_t i = 0; i < sizeof(allBounds) / sizeof(allBounds[0]); i++) {
+        for (size_t j = 0; j < sizeof(pixelSizes) / sizeof(pixelSizes[0]); j++) {
+            JSGCoverageRaster raster;
+            JSG_TEST_CHECK(JSGCoverageRasterInit(&raster, allBounds[i], pixelSizes[j]));
+
+            JSGRectArray array;
+            JSGRectArrayInit(&array);
+            std::vector<uint32_t> counts(raster.width * raster.height);
+
+            // Batches are added on top of each other, & the last one after clearing
+            for (size_t batch = 0; batch < 4; batch++) {
+                std::vector<CGRect> rects(batch * 40);
+
+                // Quarter coordinates, so that edges often fall exactly on pixel centers,
+                // within a range reaching past the bounds
+                for (size_t k = 0; k < rects.size(); k++) {
+                    CGFloat x = allBounds[i].origin.x - 8 + random.below((size_t)(allBounds[i].size.width + 16) * 4) * 0.25;
+                    CGFloat y = allBounds[i].origin.y - 8 + random.below((size_t)(allBounds[i].size.height + 16) * 4) * 0.25;
+                    CGFloat width = (random.below(120) - 20.0) * 0.25;
+                    CGFloat height = (random.below(120) - 20.0) * 0.25;
+                    rects[k] = CGRectMake(x, y, width, height);
+                }
+
+                if (batch == 3) {
+                    JSGCoverageRasterClear(&raster);
+                    counts.assign(counts.size(), 0);
+                }
+
+                JSGRectArraySetRects(&array, rects.data(), rects.size());
+                JSGCoverageRasterAddRects(&raster, &array);
+                AddBruteForceCounts(&raster, rects, &counts);
+                matches &= CheckCounts(&raster, counts);
+            }
+
+            JSGRectArrayDestroy(&array);
+            JSGCoverageRasterDestroy(&raster);
+        }
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestEdges()
+{
+    JSGCoverageRaster raster;
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSG_TEST_CHECK(JSGCoverageRasterInit(&raster, CGRectMake(0, 0, 10, 10), 1));
+
+    // Rects sharing an edge never cover the same pixel, & rects between two pixel centers
+    // cover nothing
+    CGRect rects[] = {CGRectMake(0, 0, 5, 10), CGRectMake(5, 0, 5, 10), CGRectMake(2.6, 2.6, 0.8, 0.8), CGRectMake(-1e6, -1e6, 2e6, 2e6)};
+    JSGRectArraySetRects(&array, rects, 3);
+    JSGCoverageRasterAddRects(&raster, &array);
+
+    JSGCoverageStatistics statistics;
+    JSGCoverageRasterGetStatistics(&raster, &statistics, NULL, 0);
+    JSG_TEST_CHECK(statistics.coveredPixelCount == 100 && statistics.overdrawnPixelCount == 0 && statistics.maximumCount == 1);
+
+    // Points outside the raster have no coverage
+    JSG_TEST_CHECK(JSGCoverageRasterGetCount(&raster, CGPointMake(4.5, 9.5)) == 1);
+    JSG_TEST_CHECK(JSGCoverageRasterGetCount(&raster, CGPointMake(10, 5)) == 0 && JSGCoverageRasterGetCount(&raster, CGPointMake(-0.5, 5)) == 0);
+
+    // A rect covering everything, clamped to the raster
+    JSGRectArraySetRects(&array, rects + 3, 1);
+    JSGCoverageRasterAddRects(&raster, &array);
+    JSGCoverageRasterGetStatistics(&raster, &statistics, NULL, 0);
+    JSG_TEST_CHECK(statistics.overdrawnPixelCount == 100 && statistics.totalCount == 200);
+
+    JSGCoverageRasterDestroy(&raster);
+
+    // An empty raster has no pixels
+    JSG_TEST_CHECK(JSGCoverageRasterInit(&raster, CGRectMake(3, 3, 0, 10), 1));
+    JSGCoverageRasterAddRects(&raster, &array);
+    JSGCoverageRasterGetStatistics(&raster, &statistics, NULL, 0);
+    JSG_TEST_CHECK(raster.width == 0 && statistics.pixelCount == 0 && statistics.totalCount == 0);
+    JSGCoverageRasterDestroy(&raster);
+
+    JSGRectArrayDestroy(&array);
+}
+
+int main()
+{
+    JSGTestRun("Coverage random rects", TestRandomRects);
+    JSGTestRun("Coverage edges", TestEdges);
+
+    return JSGTestExitStatus();
+}
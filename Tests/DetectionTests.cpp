@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryDetection.h"
+
+/**
+ *  Tests that intersection over union & non-maximum suppression match a direct
+ *  implementation, for scores with ties & box counts on both sides of the sort's insertion
+ *  threshold.
+ */
+
+static CGFloat BruteForceIntersectionOverUnion(CGRect a, CGRect b)
+{
+    CGRect intersection = CGRectIntersection(a, b);
+    CGFloat intersectionArea = CGRectIsNull(intersection) ? 0 : intersection.size.width * intersection.size.height;
+    CGFloat unionArea = a.size.width * a.size.height + b.size.width * b.size.height - intersectionArea;
+
+    return unionArea > 0 ? intersectionArea / unionArea : 0;
+}
+
+static bool Close(CGFloat a, CGFloat b)
+{
+    return std::fabs(a - b) <= 1e-12;
+}
+
+/**
+ *  Random boxes clustered around a few centers, so that many of them overlap, with some
+ *  empty ones & some exact duplicates
+ */
+static std::vector<CGRect> RandomBoxes(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGRect> boxes(count);
+
+    for (size_t i = 0; i < count; i++) {
+        CGFloat centerX = 100 * random.below(4);
+        CGFloat centerY = 100 * random.below(3);
+        boxes[i] = CGRectMake(centerX + random.next() * 40, centerY + random.next() * 40, 20 + random.next() * 60, 20 + random.next() * 60);
+
+        if (i % 17 == 3) {
+            boxes[i].size.height = 0;
+        } else if (i % 13 == 5 && i > 0) {
+            boxes[i] = boxes[i - 1];
+        }
+    }
+
+    return boxes;
+}
+
+/**
+ *  Random scores, from a small set of values so that there are ties
+ */
+static std::vector<CGFloat> RandomScores(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGFloat> scores(count);
+
+    for (size_t i = 0; i < count; i++) {
+        scores[i] = random.below(40) * 0.025 - 0.1;
+    }
+
+    return scores;
+}
+
+static std::vector<size_t> BruteForceSuppression(const std::vector<CGRect> &boxes, const std::vector<CGFloat> &scores, CGFloat iouThreshold)
+{
+    std::vector<size_t> order(boxes.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a] > scores[b]; });
+
+    std::vector<bool> suppressed(boxes.size());
+    std::vector<size_t> kept;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if (suppressed[i]) {
+            continue;
+        }
+
+        kept.push_back(order[i]);
+
+        for (size_t j = i + 1; j < order.size(); j++) {
+            suppressed[j] = suppressed[j] || BruteForceIntersectionOverUnion(boxes[order[i]], boxes[order[j]]) > iouThreshold;
+        }
+    }
+
+    return kept;
+}
+
+static void BruteForceSoftSuppression(const std::vector<CGRect> &boxes, std::vector<CGFloat> scores, JSGSoftSuppression method, CGFloat parameter, CGFloat scoreThreshold, std::vector<size_t> *keptIndices, std::vector<CGFloat> *keptScores)
+{
+    std::vector<bool> remaining(boxes.size());
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        remaining[i] = scores[i] >= scoreThreshold;
+    }
+
+    while (true) {
+        size_t best = boxes.size();
+
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (remaining[i] && (best == boxes.size() || scores[i] > scores[best])) {
+                best = i;
+            }
+        }
+
+        if (best == boxes.size()) {
+            break;
+        }
+
+        keptIndices->push_back(best);
+        keptScores->push_back(scores[best]);
+        remaining[best] = false;
+
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (remaining[i]) {
+                CGFloat iou = BruteForceIntersectionOverUnion(boxes[best], boxes[i]);
+                scores[i] *= method == JSGSoftSuppressionGaussian ? std::exp(-(iou * iou) / parameter) : iou > parameter ? 1 - iou : 1;
+                remaining[i] = scores[i] >= scoreThreshold;
+            }
+        }
+    }
+}
+
+static void TestIntersectionOverUnion()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> boxes = RandomBoxes(random, 150);
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, boxes.data(), boxes.size());
+
+    std::vector<CGFloat> matrix(boxes.size() * boxes.size());
+    JSGRectArrayGetIntersectionOverUnionMatrix(&array, matrix.data());
+    bool matches = true;
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        std::vector<CGFloat> ious(boxes.size());
+        JSGRectArrayGetIntersectionOverUnion(&array, boxes[i], ious.data());
+
+        for (size_t j = 0; j < boxes.size(); j++) {
+            CGFloat expected = BruteForceIntersectionOverUnion(boxes[i], boxes[j]);
+            matches &= Close(JSGRectIntersectionOverUnion(boxes[i], boxes[j]), expected);
+            matches &= Close(ious[j], expected);
+            matches &= matrix[i * boxes.size() + j] == matrix[j * boxes.size() + i] && Close(matrix[i * boxes.size() + j], expected);
+        }
+    }
+
+    JSG_TEST_CHECK(matches);
+
+    // Rects with a negative size are standardized, & empty rects have no overlap
+    JSG_TEST_CHECK(JSGRectIntersectionOverUnion(CGRectMake(10, 10, -10, -10), CGRectMake(0, 0, 10, 10)) == 1);
+    JSG_TEST_CHECK(JSGRectIntersectionOverUnion(CGRectMake(0, 0, 10, 10), CGRectMake(5, 0, 10, 10)) == 5.0 / 15.0);
+    JSG_TEST_CHECK(JSGRectIntersectionOverUnion(CGRectZero, CGRectZero) == 0);
+
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestSuppression()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, 2, 10, 64, 65, 500};
+    CGFloat thresholds[] = {0, 0.3, 0.5, 1};
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        std::vector<CGRect> boxes = RandomBoxes(random, counts[i]);
+        std::vector<CGFloat> scores = RandomScores(random, counts[i]);
+        JSGRectArraySetRects(&array, boxes.data(), boxes.size());
+
+        for (size_t j = 0; j < sizeof(thresholds) / sizeof(thresholds[0]); j++) {
+            std::vector<size_t> keptIndices(counts[i]);
+            size_t keptCount = 0;
+
+            JSG_TEST_CHECK(JSGRectArrayNonMaximumSuppression(&array, scores.data(), thresholds[j], keptIndices.data(), &keptCount));
+            keptIndices.resize(keptCount);
+            JSG_TEST_CHECK(keptIndices == BruteForceSuppression(boxes, scores, thresholds[j]));
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestSoftSuppression()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, 7, 200};
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        std::vector<CGRect> boxes = RandomBoxes(random, counts[i]);
+        std::vector<CGFloat> scores = RandomScores(random, counts[i]);
+        JSGRectArraySetRects(&array, boxes.data(), boxes.size());
+
+        for (size_t method = 0; method < 2; method++) {
+            JSGSoftSuppression suppression = method ? JSGSoftSuppressionGaussian : JSGSoftSuppressionLinear;
+            CGFloat parameter = method ? 0.5 : 0.3;
+            std::vector<size_t> keptIndices(counts[i]), expectedIndices;
+            std::vector<CGFloat> keptScores(counts[i]), expectedScores;
+            size_t keptCount = 0;
+
+            JSG_TEST_CHECK(JSGRectArraySoftNonMaximumSuppression(&array, scores.data(), suppression, parameter, 0.2, keptIndices.data(), keptScores.data(), &keptCount));
+            BruteForceSoftSuppression(boxes, scores, suppression, parameter, 0.2, &expectedIndices, &expectedScores);
+            keptIndices.resize(keptCount);
+            keptScores.resize(keptCount);
+
+            bool matches = keptIndices == expectedIndices;
+
+            for (size_t j = 0; matches && j < keptCount; j++) {
+                matches &= Close(keptScores[j], expectedScores[j]) && keptScores[j] >= 0.2;
+            }
+
+            JSG_TEST_CHECK(matches);
+
+            // The kept scores are optional
+            size_t count = 0;
+            JSG_TEST_CHECK(JSGRectArraySoftNonMaximumSuppression(&array, scores.data(), suppression, parameter, 0.2, keptIndices.data(), NULL, &count));
+            JSG_TEST_CHECK(count == keptCount);
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+}
+
+int main()
+{
+    JSGTestRun("Detection intersection over union", TestIntersectionOverUnion);
+    JSGTestRun("Detection non-maximum suppression", TestSuppression);
+    JSGTestRun("Detection soft non-maximum suppression", TestSoftSuppression);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryEmptySpace.h"
+
+/**
+ *  Tests that the maximal empty rects of an empty space match those found from scratch by
+ *  brute force, as obstacles are added, removed & moved, one by one or in bulk.
+ */
+
+static bool Less(CGRect a, CGRect b)
+{
+    if (a.origin.x != b.origin.x) {
+        return a.origin.x < b.origin.x;
+    }
+
+    if (a.origin.y != b.origin.y) {
+        return a.origin.y < b.origin.y;
+    }
+
+    if (a.size.width != b.size.width) {
+        return a.size.width < b.size.width;
+    }
+
+    return a.size.height < b.size.height;
+}
+
+static bool Equal(CGRect a, CGRect b)
+{
+    return CGRectEqualToRect(a, b);
+}
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height;
+}
+
+static bool OverlapsAny(CGRect rect, const std::vector<CGRect> &obstacles)
+{
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        if (Overlaps(rect, obstacles[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ *  Find the maximal empty rects around obstacles with integral edges, by testing every rect
+ *  between the edges of the container & obstacles
+ */
+static std::vector<CGRect> BruteForce(CGRect container, const std::vector<CGRect> &obstacles)
+{
+    std::vector<CGFloat> xs, ys;
+    xs.push_back(CGRectGetMinX(container));
+    xs.push_back(CGRectGetMaxX(container));
+    ys.push_back(CGRectGetMinY(container));
+    ys.push_back(CGRectGetMaxY(container));
+
+    for (size_t i = 0; i < obstacles.size(); i++) {
+        xs.push_back(CGRectGetMinX(obstacles[i]));
+        xs.push_back(CGRectGetMaxX(obstacles[i]));
+        ys.push_back(CGRectGetMinY(obstacles[i]));
+        ys.push_back(CGRectGetMaxY(obstacles[i]));
+    }
+
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+    std::vector<CGRect> rects;
+
+    for (size_t x1 = 0; x1 < xs.size(); x1++) {
+        for (size_t x2 = x1 + 1; x2 < xs.size(); x2++) {
+            for (size_t y1 = 0; y1 < ys.size(); y1++) {
+                for (size_t y2 = y1 + 1; y2 < ys.size(); y2++) {
+                    CGRect rect = CGRectMake(xs[x1], ys[y1], xs[x2] - xs[x1], ys[y2] - ys[y1]);
+
+                    if (OverlapsAny(rect, obstacles)) {
+                        continue;
+                    }
+
+                    // A rect is maximal when a thin strip along each of its edges either
+                    // leaves the container or overlaps an obstacle
+                    bool left = xs[x1] == CGRectGetMinX(container) || OverlapsAny(CGRectMake(xs[x1] - 0.5, ys[y1], 0.5, rect.size.height), obstacles);
+                    bool right = xs[x2] == CGRectGetMaxX(container) || OverlapsAny(CGRectMake(xs[x2], ys[y1], 0.5, rect.size.height), obstacles);
+                    bool top = ys[y1] == CGRectGetMinY(container) || OverlapsAny(CGRectMake(xs[x1], ys[y1] - 0.5, rect.size.width, 0.5), obstacles);
+                    bool bottom = ys[y2] == CGRectGetMaxY(container) || OverlapsAny(CGRectMake(xs[x1], ys[y2], rect.size.width, 0.5), obstacles);
+
+                    if (left && right && top && bottom) {
+                        rects.push_back(rect);
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(rects.begin(), rects.end(), Less);
+
+    return rects;
+}
+
+static std::vector<CGRect> EmptyRects(const JSGEmptySpace *space)
+{
+    std::vector<CGRect> rects(space->emptyRects.count);
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        rects[i] = JSGRectArrayGetRect(&space->emptyRects, i);
+    }
+
+    std::sort(rects.begin(), rects.end(), Less);
+
+    return rects;
+}
+
+static std::vector<CGRect> Obstacles(const JSGEmptySpace *space)
+{
+    std::vector<CGRect> obstacles;
+
+    for (size_t i = 0; i < space->obstacles.count; i++) {
+        CGRect rect = JSGRectArrayGetRect(&space->obstacles, i);
+
+        if (rect.size.width > 0 && rect.size.height > 0) {
+            obstacles.push_back(rect);
+        }
+    }
+
+    return obstacles;
+}
+
+static bool MatchesBruteForce(const JSGEmptySpace *space)
+{
+    std::vector<CGRect> expected = BruteForce(space->container, Obstacles(space));
+    std::vector<CGRect> actual = EmptyRects(space);
+
+    return actual.size() == expected.size() && std::equal(actual.begin(), actual.end(), expected.begin(), Equal);
+}
+
+static CGRect RandomObstacle(JSGTestRandom &random)
+{
+    CGFloat width = 1 + (CGFloat)random.below(8);
+    CGFloat height = 1 + (CGFloat)random.below(8);
+
+    return CGRectMake((CGFloat)random.below(40 - (size_t)width + 1), (CGFloat)random.below(30 - (size_t)height + 1), width, height);
+}
+
+static void TestSingleObstacle()
+{
+    JSGEmptySpace space;
+    JSG_TEST_CHECK(JSGEmptySpaceInit(&space, CGRectMake(0, 0, 10, 10)));
+    JSG_TEST_CHECK(space.emptyRects.count == 1);
+
+    JSG_TEST_CHECK(JSGEmptySpaceAddObstacle(&space, CGRectMake(4, 4, 2, 2)));
+
+    std::vector<CGRect> rects = EmptyRects(&space);
+    JSG_TEST_CHECK(rects.size() == 4);
+
+    if (rects.size() == 4) {
+        JSG_TEST_CHECK(CGRectEqualToRect(rects[0], CGRectMake(0, 0, 4, 10)));
+        JSG_TEST_CHECK(CGRectEqualToRect(rects[1], CGRectMake(0, 0, 10, 4)));
+        JSG_TEST_CHECK(CGRectEqualToRect(rects[2], CGRectMake(0, 6, 10, 4)));
+        JSG_TEST_CHECK(CGRectEqualToRect(rects[3], CGRectMake(6, 0, 4, 10)));
+    }
+
+    // Removing the only obstacle leaves the whole container empty again
+    JSG_TEST_CHECK(JSGEmptySpaceRemoveObstacle(&space, 0));
+    rects = EmptyRects(&space);
+    JSG_TEST_CHECK(rects.size() == 1 && CGRectEqualToRect(rects[0], CGRectMake(0, 0, 10, 10)));
+
+    JSGEmptySpaceDestroy(&space);
+}
+
+static void TestSplitAndRemove()
+{
+    JSGTestRandom random;
+
+    for (size_t round = 0; round < 20; round++) {
+        JSGEmptySpace space;
+        JSGEmptySpaceInit(&space, CGRectMake(0, 0, 40, 30));
+
+        for (size_t i = 0; i < 12; i++) {
+            JSG_TEST_CHECK(JSGEmptySpaceAddObstacle(&space, RandomObstacle(random)));
+            JSG_TEST_CHECK(MatchesBruteForce(&space));
+        }
+
+        for (size_t i = 0; i < 8; i++) {
+            JSG_TEST_CHECK(JSGEmptySpaceMoveObstacle(&space, random.below(12), RandomObstacle(random)));
+            JSG_TEST_CHECK(MatchesBruteForce(&space));
+        }
+
+        std::vector<size_t> order;
+
+        for (size_t i = 0; i < 12; i++) {
+            order.push_back(i);
+        }
+
+        for (size_t i = order.size() - 1; i > 0; i--) {
+            std::swap(order[i], order[random.below(i + 1)]);
+        }
+
+        for (size_t i = 0; i < order.size(); i++) {
+            JSG_TEST_CHECK(JSGEmptySpaceRemoveObstacle(&space, order[i]));
+            JSG_TEST_CHECK(MatchesBruteForce(&space));
+        }
+
+        JSG_TEST_CHECK(space.obstacles.count == 12);
+        JSG_TEST_CHECK(space.emptyRects.count == 1);
+        JSGEmptySpaceDestroy(&space);
+    }
+}
+
+static void TestBulkAdd()
+{
+    JSGTestRandom random;
+
+    for (size_t round = 0; round < 20; round++) {
+        std::vector<CGRect> obstacles;
+
+        for (size_t i = 0; i < 16; i++) {
+            obstacles.push_back(RandomObstacle(random));
+        }
+
+        JSGEmptySpace bulk, incremental;
+        JSGEmptySpaceInit(&bulk, CGRectMake(0, 0, 40, 30));
+        JSGEmptySpaceInit(&incremental, CGRectMake(0, 0, 40, 30));
+
+        JSG_TEST_CHECK(JSGEmptySpaceAddObstacles(&bulk, obstacles.data(), obstacles.size()));
+
+        for (size_t i = 0; i < obstacles.size(); i++) {
+            JSGEmptySpaceAddObstacle(&incremental, obstacles[i]);
+        }
+
+        JSG_TEST_CHECK(MatchesBruteForce(&bulk));
+
+        std::vector<CGRect> bulkRects = EmptyRects(&bulk);
+        std::vector<CGRect> incrementalRects = EmptyRects(&incremental);
+        JSG_TEST_CHECK(bulkRects.size() == incrementalRects.size() && std::equal(bulkRects.begin(), bulkRects.end(), incrementalRects.begin(), Equal));
+
+        // Obstacles keep the indices they were given in the bulk add
+        for (size_t i = 0; i < obstacles.size(); i++) {
+            JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&bulk.obstacles, i), obstacles[i]));
+        }
+
+        JSGEmptySpaceDestroy(&bulk);
+        JSGEmptySpaceDestroy(&incremental);
+    }
+}
+
+static void TestLargestRects()
+{
+    JSGTestRandom random;
+    JSGEmptySpace space;
+    JSGEmptySpaceInit(&space, CGRectMake(0, 0, 40, 30));
+
+    for (size_t i = 0; i < 10; i++) {
+        JSGEmptySpaceAddObstacle(&space, RandomObstacle(random));
+    }
+
+    std::vector<CGRect> all = EmptyRects(&space);
+    CGRect rects[8];
+    size_t count;
+
+    JSG_TEST_CHECK(JSGEmptySpaceGetLargestRects(&space, CGSizeMake(5, 5), 8, rects, &count));
+
+    size_t candidateCount = 0;
+    CGFloat largestArea = 0;
+
+    for (size_t i = 0; i < all.size(); i++) {
+        if (all[i].size.width >= 5 && all[i].size.height >= 5) {
+            candidateCount++;
+            largestArea = std::max(largestArea, all[i].size.width * all[i].size.height);
+        }
+    }
+
+    JSG_TEST_CHECK(count == std::min(candidateCount, (size_t)8));
+    JSG_TEST_CHECK(count == 0 || rects[0].size.width * rects[0].size.height == largestArea);
+
+    for (size_t i = 0; i < count; i++) {
+        JSG_TEST_CHECK(rects[i].size.width >= 5 && rects[i].size.height >= 5);
+        JSG_TEST_CHECK(i == 0 || rects[i - 1].size.width * rects[i - 1].size.height >= rects[i].size.width * rects[i].size.height);
+    }
+
+    JSGEmptySpaceDestroy(&space);
+}
+
+int main()
+{
+    JSGTestRun("EmptySpace single obstacle", TestSingleObstacle);
+    JSGTestRun("EmptySpace split & remove", TestSplitAndRemove);
+    JSGTestRun("EmptySpace bulk add", TestBulkAdd);
+    JSGTestRun("EmptySpace largest rects", TestLargestRects);
+
+    return JSGTestExitStatus();
+}
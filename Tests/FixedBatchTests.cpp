@@ -0,0 +1,98 @@
+#include "JSGTest.h"
+#include "../JSGeometryFixedBatch.h"
+
+/**
+ *  Tests that every fixed width batch function gives, for each width, exactly the rects
+ *  that its single rect counterpart gives for each rect of the batch.
+ */
+
+template <size_t N>
+struct Batch {
+    CGRect rects[N];
+    CGPoint origins[N];
+    CGSize sizes[N];
+    CGFloat values[N];
+
+    explicit Batch(JSGTestRandom &random)
+    {
+        for (size_t i = 0; i < N; i++) {
+            rects[i] = CGRectMake(random.next() * 200 - 100, random.next() * 200 - 100, random.next() * 50, random.next() * 50);
+            origins[i] = CGPointMake(random.next() * 100, random.next() * 100);
+            sizes[i] = CGSizeMake(random.next() * 30, random.next() * 30);
+            values[i] = random.next() * 80 - 40;
+        }
+    }
+};
+
+/**
+ *  Apply a fixed width function to a copy of the batch, & compare each rect with the
+ *  result of a single rect function
+ */
+template <size_t N, typename Fixed, typename Single>
+static bool Matches(const CGRect *rects, Fixed fixed, Single single)
+{
+    CGRect results[N];
+    bool matches = true;
+
+    for (size_t i = 0; i < N; i++) {
+        results[i] = rects[i];
+    }
+
+    fixed(results);
+
+    for (size_t i = 0; i < N; i++) {
+        matches &= CGRectEqualToRect(results[i], single(rects[i], i));
+    }
+
+    return matches;
+}
+
+#define JSG_TEST_FIXED_BATCH(N) \
+    static bool Test##N(JSGTestRandom &random) \
+    { \
+        Batch<N> batch(random); \
+        CGRect rectB = CGRectMake(10, 20, 300, 200); \
+        bool matches = true; \
+        \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeOrigin(rects, batch.origins); }, [&](CGRect rect, size_t i) { return JSGRectChangeOrigin(rect, batch.origins[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeOriginX(rects, batch.values); }, [&](CGRect rect, size_t i) { return JSGRectChangeOriginX(rect, batch.values[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeOriginY(rects, batch.values); }, [&](CGRect rect, size_t i) { return JSGRectChangeOriginY(rect, batch.values[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeSize(rects, batch.sizes); }, [&](CGRect rect, size_t i) { return JSGRectChangeSize(rect, batch.sizes[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeWidth(rects, batch.values); }, [&](CGRect rect, size_t i) { return JSGRectChangeWidth(rect, batch.values[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##ChangeHeight(rects, batch.values); }, [&](CGRect rect, size_t i) { return JSGRectChangeHeight(rect, batch.values[i]); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##Scale(rects, 1.5, 0.75); }, [&](CGRect rect, size_t) { return JSGRectScale(rect, 1.5, 0.75); }); \
+        matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRects##N##GetCenterInRect(rects, rectB); }, [&](CGRect rect, size_t) { return JSGRectGetCenterInRect(rect, rectB); }); \
+        \
+        for (size_t alignment = 0; alignment < 16; alignment++) { \
+            for (size_t origin = 0; origin < 2; origin++) { \
+                JSGRectAlignment rectAlignment = (JSGRectAlignment)alignment; \
+                JSGCoordinateSystemOrigin coordinateSystemOrigin = origin ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft; \
+                matches &= Matches<N>(batch.rects, [&](CGRect *rects) { JSGRectsFixed(N, AlignInRectForCoordinateSystemOrigin)(rects, rectB, rectAlignment, coordinateSystemOrigin); }, [&](CGRect rect, size_t) { return JSGRectAlignInRectForCoordinateSystemOrigin(rect, rectB, rectAlignment, coordinateSystemOrigin); }); \
+            } \
+        } \
+        \
+        return matches; \
+    }
+
+JSG_TEST_FIXED_BATCH(4)
+JSG_TEST_FIXED_BATCH(8)
+JSG_TEST_FIXED_BATCH(16)
+
+static void TestWidths()
+{
+    JSGTestRandom random;
+    bool matches = true;
+
+    for (size_t iteration = 0; iteration < 100; iteration++) {
+        matches &= Test4(random) && Test8(random) && Test16(random);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+int main()
+{
+    JSGTestRun("FixedBatch widths", TestWidths);
+
+    return JSGTestExitStatus();
+}
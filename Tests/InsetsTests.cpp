@@ -0,0 +1,197 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryInsets.h"
+
+/**
+ *  Tests that insetting & dividing rect arrays gives the same rects as CGRectInset &
+ *  CGRectDivide, except that rects too small for an inset collapse at their center.
+ */
+
+static std::vector<CGRect> RandomRects(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGRect> rects(count);
+
+    // Quarters are exact, so the results can be compared exactly
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(random.below(4000) * 0.25 - 500, random.below(4000) * 0.25 - 500, random.below(400) * 0.25, random.below(400) * 0.25);
+    }
+
+    return rects;
+}
+
+static std::vector<CGRect> Rects(const JSGRectArray *array)
+{
+    std::vector<CGRect> rects(array->count);
+    JSGRectArrayGetRects(array, rects.data());
+
+    return rects;
+}
+
+/**
+ *  Inset one axis of a rect, collapsing it at the midpoint of its moved edges if they cross
+ */
+static void InsetAxis(CGFloat *origin, CGFloat *size, CGFloat minimumInset, CGFloat maximumInset)
+{
+    CGFloat minimum = *origin + minimumInset;
+    CGFloat maximum = *origin + *size - maximumInset;
+
+    if (maximum < minimum) {
+        minimum = maximum = (minimum + maximum) * 0.5;
+    }
+
+    *origin = minimum;
+    *size = maximum - minimum;
+}
+
+static void TestInset()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 1001);
+    CGFloat insets[] = {0, 3.5, -7.25, 40, 60};
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+
+    for (size_t i = 0; i < sizeof(insets) / sizeof(insets[0]); i++) {
+        for (size_t j = 0; j < sizeof(insets) / sizeof(insets[0]); j++) {
+            JSGRectArraySetRects(&array, rects.data(), rects.size());
+            JSGRectArrayInset(&array, insets[i], insets[j]);
+
+            std::vector<CGRect> inset = Rects(&array);
+            bool matches = true;
+
+            for (size_t k = 0; k < rects.size(); k++) {
+                CGRect expected = CGRectInset(rects[k], insets[i], insets[j]);
+
+                if (CGRectIsNull(expected)) {
+                    // Too small for the inset, so collapsed at the center along that axis
+                    expected = rects[k];
+                    InsetAxis(&expected.origin.x, &expected.size.width, insets[i], insets[i]);
+                    InsetAxis(&expected.origin.y, &expected.size.height, insets[j], insets[j]);
+                }
+
+                matches &= CGRectEqualToRect(inset[k], expected);
+                matches &= CGPointEqualToPoint(CGPointMake(CGRectGetMidX(inset[k]), CGRectGetMidY(inset[k])), CGPointMake(CGRectGetMidX(rects[k]), CGRectGetMidY(rects[k])));
+            }
+
+            JSG_TEST_CHECK(matches);
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestInsetByEdgeInsets()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 1001);
+    JSGEdgeInsets insets = JSGEdgeInsetsMake(10, -2.5, 30.25, 45);
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+
+    for (size_t origin = 0; origin < 2; origin++) {
+        JSGCoordinateSystemOrigin coordinateSystemOrigin = origin ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+        JSGRectArraySetRects(&array, rects.data(), rects.size());
+        JSGRectArrayInsetByEdgeInsets(&array, insets, coordinateSystemOrigin);
+
+        std::vector<CGRect> inset = Rects(&array);
+        bool matches = true;
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            CGRect expected = rects[i];
+            InsetAxis(&expected.origin.x, &expected.size.width, insets.left, insets.right);
+            InsetAxis(&expected.origin.y, &expected.size.height, origin ? insets.bottom : insets.top, origin ? insets.top : insets.bottom);
+            matches &= CGRectEqualToRect(inset[i], expected);
+            matches &= inset[i].size.width >= 0 && inset[i].size.height >= 0;
+        }
+
+        JSG_TEST_CHECK(matches);
+    }
+
+    // Insetting by the negated insets of a rect that didn't collapse restores it
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+    JSGRectArrayInsetByEdgeInsets(&array, JSGEdgeInsetsMake(1, 2, 3, 4), JSGCoordinateSystemOriginTopLeft);
+    JSGRectArrayInsetByEdgeInsets(&array, JSGEdgeInsetsMake(-1, -2, -3, -4), JSGCoordinateSystemOriginTopLeft);
+
+    std::vector<CGRect> restored = Rects(&array);
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        if (rects[i].size.width >= 6 && rects[i].size.height >= 4) {
+            JSG_TEST_CHECK(CGRectEqualToRect(restored[i], rects[i]));
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestDivide()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 1001);
+    JSGRectAlignment edges[] = {JSGRectAlignmentTop, JSGRectAlignmentLeft, JSGRectAlignmentBottom, JSGRectAlignmentRight};
+    CGFloat amounts[] = {-5, 0, 12.5, 1000};
+    JSGRectArray array, slices, remainders;
+    JSGRectArrayInit(&array);
+    JSGRectArrayInit(&slices);
+    JSGRectArrayInit(&remainders);
+
+    for (size_t origin = 0; origin < 2; origin++) {
+        JSGCoordinateSystemOrigin coordinateSystemOrigin = origin ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+
+        for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+            CGRectEdge edge;
+
+            switch (edges[i]) {
+                case JSGRectAlignmentLeft:
+                    edge = CGRectMinXEdge;
+                    break;
+                case JSGRectAlignmentRight:
+                    edge = CGRectMaxXEdge;
+                    break;
+                case JSGRectAlignmentTop:
+                    edge = origin ? CGRectMaxYEdge : CGRectMinYEdge;
+                    break;
+                default:
+                    edge = origin ? CGRectMinYEdge : CGRectMaxYEdge;
+                    break;
+            }
+
+            for (size_t j = 0; j < sizeof(amounts) / sizeof(amounts[0]); j++) {
+                // Into separate arrays, in place as the slices & in place as the remainders
+                for (size_t mode = 0; mode < 3; mode++) {
+                    JSGRectArraySetRects(&array, rects.data(), rects.size());
+                    JSGRectArray *sliceArray = mode == 1 ? &array : &slices;
+                    JSGRectArray *remainderArray = mode == 2 ? &array : &remainders;
+
+                    JSG_TEST_CHECK(JSGRectArrayDivide(&array, amounts[j], edges[i], coordinateSystemOrigin, sliceArray, mode == 1 ? NULL : remainderArray));
+
+                    std::vector<CGRect> sliced = Rects(sliceArray);
+                    std::vector<CGRect> remaining = Rects(remainderArray);
+                    bool matches = sliced.size() == rects.size() && (mode == 1 || remaining.size() == rects.size());
+
+                    for (size_t k = 0; matches && k < rects.size(); k++) {
+                        CGRect slice, remainder;
+                        CGRectDivide(rects[k], &slice, &remainder, amounts[j], edge);
+                        matches &= CGRectEqualToRect(sliced[k], slice);
+                        matches &= mode == 1 || CGRectEqualToRect(remaining[k], remainder);
+                    }
+
+                    JSG_TEST_CHECK(matches);
+                }
+            }
+        }
+    }
+
+    JSGRectArrayDestroy(&array);
+    JSGRectArrayDestroy(&slices);
+    JSGRectArrayDestroy(&remainders);
+}
+
+int main()
+{
+    JSGTestRun("Insets inset", TestInset);
+    JSGTestRun("Insets inset by edge insets", TestInsetByEdgeInsets);
+    JSGTestRun("Insets divide", TestDivide);
+
+    return JSGTestExitStatus();
+}
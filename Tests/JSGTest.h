@@ -0,0 +1,88 @@
+#ifndef JSGTest
+#define JSGTest
+
+#include <cstddef>
+#include <cstdio>
+
+/**
+ *  The number of checks that failed in the current test executable
+ */
+inline size_t &JSGTestFailureCount()
+{
+    static size_t count = 0;
+
+    return count;
+}
+
+/**
+ *  Record the result of a check, printing its location when it failed
+ *
+ *  @return Whether the check passed
+ */
+inline bool JSGTestCheck(bool passed, const char *expression, const char *file, int line)
+{
+    if (!passed) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+        JSGTestFailureCount()++;
+    }
+
+    return passed;
+}
+
+/**
+ *  Check that a condition holds, continuing the test either way
+ */
+#define JSG_TEST_CHECK(condition) JSGTestCheck((condition) ? true : false, #condition, __FILE__, __LINE__)
+
+/**
+ *  Run a test function, and print whether it passed
+ *
+ *  @param name The name to print for the test
+ *  @param test The function to run
+ */
+template <typename Test>
+inline void JSGTestRun(const char *name, Test test)
+{
+    size_t failures = JSGTestFailureCount();
+
+    test();
+
+    std::printf("%-56s %s\n", name, JSGTestFailureCount() == failures ? "passed" : "FAILED");
+}
+
+/**
+ *  Return the exit status of a test executable, which is non-zero if any check failed
+ */
+inline int JSGTestExitStatus()
+{
+    return JSGTestFailureCount() == 0 ? 0 : 1;
+}
+
+/**
+ *  A xorshift random number generator, so that tests are reproducible on any platform
+ */
+struct JSGTestRandom {
+    unsigned long long state = 88172645463325252ull;
+
+    /**
+     *  Return a random number in [0, 1)
+     */
+    double next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        return (state >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     *  Return a random integer in [0, bound)
+     */
+    size_t below(size_t bound)
+    {
+        return (size_t)(next() * bound);
+    }
+};
+
+#endif
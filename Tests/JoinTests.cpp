@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryJoin.h"
+
+/**
+ *  Tests that a spatial join finds every pair of overlapping rects exactly once, including
+ *  pairs that span many tiles, and that its output doesn't depend on the thread count.
+ */
+
+typedef std::vector<std::pair<size_t, size_t> > Pairs;
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height;
+}
+
+static Pairs BruteForce(const std::vector<CGRect> &first, const std::vector<CGRect> &second)
+{
+    Pairs pairs;
+
+    for (size_t i = 0; i < first.size(); i++) {
+        for (size_t j = 0; j < second.size(); j++) {
+            if (Overlaps(first[i], second[j])) {
+                pairs.push_back(std::make_pair(i, j));
+            }
+        }
+    }
+
+    return pairs;
+}
+
+static Pairs Join(const std::vector<CGRect> &first, const std::vector<CGRect> &second, size_t threadCount, bool sorted)
+{
+    JSGRectArray firstArray, secondArray;
+    JSGRectPairArray result;
+    JSGRectArrayInit(&firstArray);
+    JSGRectArrayInit(&secondArray);
+    JSGRectPairArrayInit(&result);
+    JSGRectArraySetRects(&firstArray, first.data(), first.size());
+    JSGRectArraySetRects(&secondArray, second.data(), second.size());
+
+    JSG_TEST_CHECK(JSGRectArrayJoin(&firstArray, &secondArray, threadCount, &result));
+
+    Pairs pairs;
+
+    for (size_t i = 0; i < result.count; i++) {
+        pairs.push_back(std::make_pair(result.pairs[i].first, result.pairs[i].second));
+    }
+
+    if (sorted) {
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    JSGRectPairArrayDestroy(&result);
+    JSGRectArrayDestroy(&firstArray);
+    JSGRectArrayDestroy(&secondArray);
+
+    return pairs;
+}
+
+static void CheckJoin(const std::vector<CGRect> &first, const std::vector<CGRect> &second)
+{
+    Pairs pairs = Join(first, second, 1, true);
+
+    // The brute force pairs are unique & sorted, so any duplicate found by the join fails
+    JSG_TEST_CHECK(std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end());
+    JSG_TEST_CHECK(pairs == BruteForce(first, second));
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> first(3000), second(2000);
+
+    // Mostly small rects, spread over many tiles, with a few large ones spanning many tiles
+    for (size_t i = 0; i < first.size(); i++) {
+        CGFloat size = i % 50 == 0 ? 300 : 5 + random.next() * 20;
+        first[i] = CGRectMake(random.next() * 1000, random.next() * 1000, size, size * (0.5 + random.next()));
+    }
+
+    for (size_t i = 0; i < second.size(); i++) {
+        CGFloat size = i % 40 == 0 ? 400 : 5 + random.next() * 20;
+        second[i] = CGRectMake(random.next() * 1000, random.next() * 1000, size * (0.5 + random.next()), size);
+    }
+
+    CheckJoin(first, second);
+    CheckJoin(second, first);
+}
+
+static void TestRectsSpanningAllTiles()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> first(600), second(600);
+
+    // Small rects force many tiles, & the large ones overlap all of them
+    for (size_t i = 0; i < first.size(); i++) {
+        first[i] = i % 2 ? CGRectMake(-10, -10, 1020, 1020) : CGRectMake(random.next() * 1000, random.next() * 1000, 2, 2);
+        second[i] = i % 3 ? CGRectMake(random.next() * 1000, random.next() * 1000, 2, 2) : CGRectMake(-5, -5, 1010, 1010);
+    }
+
+    CheckJoin(first, second);
+}
+
+static void TestTouchingRects()
+{
+    std::vector<CGRect> first, second;
+
+    // Rects sharing an edge or a corner don't overlap
+    first.push_back(CGRectMake(0, 0, 10, 10));
+    second.push_back(CGRectMake(10, 0, 10, 10));
+    second.push_back(CGRectMake(0, 10, 10, 10));
+    second.push_back(CGRectMake(10, 10, 10, 10));
+    second.push_back(CGRectMake(9.5, 9.5, 10, 10));
+
+    Pairs pairs = Join(first, second, 1, true);
+    JSG_TEST_CHECK(pairs.size() == 1 && pairs[0] == std::make_pair((size_t)0, (size_t)3));
+
+    JSG_TEST_CHECK(Join(first, std::vector<CGRect>(), 1, true).empty());
+    JSG_TEST_CHECK(Join(std::vector<CGRect>(), second, 1, true).empty());
+}
+
+static void TestAppending()
+{
+    JSGRectArray array;
+    JSGRectPairArray pairs;
+    JSGRectArrayInit(&array);
+    JSGRectPairArrayInit(&pairs);
+    JSGRectArrayAppend(&array, CGRectMake(0, 0, 10, 10));
+    JSGRectArrayAppend(&array, CGRectMake(5, 5, 10, 10));
+
+    JSG_TEST_CHECK(JSGRectArrayJoin(&array, &array, 1, &pairs));
+    JSG_TEST_CHECK(pairs.count == 4);
+    JSG_TEST_CHECK(JSGRectArrayJoin(&array, &array, 1, &pairs));
+    JSG_TEST_CHECK(pairs.count == 8);
+
+    for (size_t i = 0; i < 4; i++) {
+        JSG_TEST_CHECK(pairs.pairs[i].first == pairs.pairs[i + 4].first && pairs.pairs[i].second == pairs.pairs[i + 4].second);
+    }
+
+    JSGRectPairArrayDestroy(&pairs);
+    JSGRectArrayDestroy(&array);
+}
+
+static void TestThreadCountIndependence()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> first(5000), second(5000);
+
+    for (size_t i = 0; i < first.size(); i++) {
+        first[i] = CGRectMake(random.next() * 2000, random.next() * 2000, 1 + random.next() * 30, 1 + random.next() * 30);
+        second[i] = CGRectMake(random.next() * 2000, random.next() * 2000, 1 + random.next() * 30, 1 + random.next() * 30);
+    }
+
+    Pairs single = Join(first, second, 1, false);
+
+    JSG_TEST_CHECK(Join(first, second, 2, false) == single);
+    JSG_TEST_CHECK(Join(first, second, 4, false) == single);
+    JSG_TEST_CHECK(Join(first, second, 0, false) == single);
+}
+
+int main()
+{
+    JSGTestRun("Join random rects", TestRandomRects);
+    JSGTestRun("Join rects spanning all tiles", TestRectsSpanningAllTiles);
+    JSGTestRun("Join touching rects", TestTouchingRects);
+    JSGTestRun("Join appending", TestAppending);
+    JSGTestRun("Join thread count independence", TestThreadCountIndependence);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryLabels.h"
+
+/**
+ *  Tests that greedy label placement places & drops the same labels as testing every
+ *  candidate frame against every placed label & obstacle, for both coordinate system
+ *  origins, with & without priorities.
+ */
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height;
+}
+
+static CGRect BruteForceFrame(CGPoint anchor, CGSize size, CGFloat offset, JSGRectAlignment position, JSGCoordinateSystemOrigin origin)
+{
+    CGFloat x = anchor.x - size.width / 2;
+    CGFloat y = anchor.y - size.height / 2;
+    bool top = (position & JSGRectAlignmentTop) != 0;
+    bool bottom = (position & JSGRectAlignmentBottom) != 0;
+
+    if (position & JSGRectAlignmentRight) {
+        x = anchor.x + offset;
+    } else if (position & JSGRectAlignmentLeft) {
+        x = anchor.x - offset - size.width;
+    }
+
+    // Labels above their anchor have a smaller y in a top left coordinate system
+    if (top || bottom) {
+        bool smallerY = top == (origin == JSGCoordinateSystemOriginTopLeft);
+        y = smallerY ? anchor.y - offset - size.height : anchor.y + offset;
+    }
+
+    return CGRectMake(x, y, size.width, size.height);
+}
+
+struct Placement {
+    std::vector<CGRect> frames;
+    std::vector<JSGRectAlignment> positions;
+    size_t count;
+};
+
+static Placement BruteForcePlacement(const std::vector<CGPoint> &anchors, const std::vector<CGSize> &sizes, const CGFloat *priorities, CGRect bounds, CGFloat offset, const std::vector<JSGRectAlignment> &positions, JSGCoordinateSystemOrigin origin, const std::vector<CGRect> &obstacles)
+{
+    std::vector<size_t> order(anchors.size());
+    Placement placement;
+    placement.frames.assign(anchors.size(), CGRectNull);
+    placement.positions.assign(anchors.size(), (JSGRectAlignment)0);
+    placement.count = 0;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    if (priorities) {
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return priorities[a] > priorities[b]; });
+    }
+
+    std::vector<CGRect> placed = obstacles;
+
+    for (size_t i = 0; i < order.size(); i++) {
+        size_t label = order[i];
+
+        for (size_t j = 0; j < positions.size(); j++) {
+            CGRect frame = BruteForceFrame(anchors[label], sizes[label], offset, positions[j], origin);
+            bool fits = CGRectContainsRect(bounds, frame);
+
+            for (size_t k = 0; fits && k < placed.size(); k++) {
+                fits = !Overlaps(frame, placed[k]);
+            }
+
+            if (fits) {
+                placed.push_back(frame);
+                placement.frames[label] = frame;
+                placement.positions[label] = positions[j];
+                placement.count++;
+                break;
+            }
+        }
+    }
+
+    return placement;
+}
+
+static void CheckPlacement(const std::vector<CGPoint> &anchors, const std::vector<CGSize> &sizes, const CGFloat *priorities, CGRect bounds, CGFloat offset, const std::vector<JSGRectAlignment> *positions, JSGCoordinateSystemOrigin origin, const JSGSpatialGrid *obstacles)
+{
+    std::vector<CGRect> obstacleRects;
+    std::vector<JSGRectAlignment> defaultPositions(JSGLabelPositionsDefault(), JSGLabelPositionsDefault() + JSG_LABEL_POSITION_COUNT);
+
+    for (size_t i = 0; obstacles && i < obstacles->items.count; i++) {
+        obstacleRects.push_back(JSGRectArrayGetRect(&obstacles->items, i));
+    }
+
+    Placement expected = BruteForcePlacement(anchors, sizes, priorities, bounds, offset, positions ? *positions : defaultPositions, origin, obstacleRects);
+
+    std::vector<CGRect> frames(anchors.size());
+    std::vector<JSGRectAlignment> placedPositions(anchors.size());
+    size_t placedCount = 0;
+
+    JSG_TEST_CHECK(JSGLabelsPlace(anchors.data(), sizes.data(), priorities, anchors.size(), bounds, offset, positions ? positions->data() : NULL, positions ? positions->size() : 0, origin, obstacles, frames.data(), placedPositions.data(), &placedCount));
+
+    bool matches = placedCount == expected.count && placedPositions == expected.positions;
+
+    for (size_t i = 0; matches && i < anchors.size(); i++) {
+        matches &= CGRectEqualToRect(frames[i], expected.frames[i]);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestRandomLabels()
+{
+    JSGTestRandom random;
+    CGRect bounds = CGRectMake(0, 0, 600, 400);
+    JSGSpatialGrid obstacles;
+    JSGSpatialGridInit(&obstacles, bounds, 30);
+
+    // Markers at some of the anchors
+    for (size_t i = 0; i < 30; i++) {
+        JSGSpatialGridInsert(&obstacles, CGRectMake(random.below(600), random.below(400), 6, 6));
+    }
+
+    std::vector<JSGRectAlignment> positions;
+    positions.push_back(JSGRectAlignmentBottom);
+    positions.push_back((JSGRectAlignment)(JSGRectAlignmentTop | JSGRectAlignmentLeft));
+    positions.push_back((JSGRectAlignment)0);
+
+    size_t counts[] = {0, 1, 10, 64, 65, 400};
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        std::vector<CGPoint> anchors(counts[i]);
+        std::vector<CGSize> sizes(counts[i]);
+        std::vector<CGFloat> priorities(counts[i]);
+
+        // Quarter coordinates, so that frames are computed exactly & some touch exactly
+        for (size_t j = 0; j < counts[i]; j++) {
+            anchors[j] = CGPointMake(random.below(2400) * 0.25, random.below(1600) * 0.25);
+            sizes[j] = CGSizeMake(10 + random.below(240) * 0.25, 6 + random.below(60) * 0.25);
+            priorities[j] = random.below(5);
+        }
+
+        for (size_t origin = 0; origin < 2; origin++) {
+            JSGCoordinateSystemOrigin coordinateSystemOrigin = origin ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+
+            CheckPlacement(anchors, sizes, NULL, bounds, 4, NULL, coordinateSystemOrigin, NULL);
+            CheckPlacement(anchors, sizes, priorities.data(), bounds, 4, NULL, coordinateSystemOrigin, &obstacles);
+            CheckPlacement(anchors, sizes, priorities.data(), bounds, 0, &positions, coordinateSystemOrigin, &obstacles);
+        }
+    }
+
+    JSGSpatialGridDestroy(&obstacles);
+}
+
+static void TestPositions()
+{
+    CGPoint anchor = CGPointMake(100, 100);
+    CGSize size = CGSizeMake(40, 10);
+    CGRect frames[2];
+    JSGRectAlignment positions[2];
+    size_t placedCount;
+
+    // The first position of the default model is top right
+    JSG_TEST_CHECK(JSGLabelsPlace(&anchor, &size, NULL, 1, CGRectMake(0, 0, 200, 200), 2, NULL, 0, JSGCoordinateSystemOriginTopLeft, NULL, frames, positions, &placedCount));
+    JSG_TEST_CHECK(placedCount == 1 && CGRectEqualToRect(frames[0], CGRectMake(102, 88, 40, 10)));
+    JSG_TEST_CHECK(positions[0] == (JSGRectAlignmentTop | JSGRectAlignmentRight));
+
+    JSG_TEST_CHECK(JSGLabelsPlace(&anchor, &size, NULL, 1, CGRectMake(0, 0, 200, 200), 2, NULL, 0, JSGCoordinateSystemOriginBottomLeft, NULL, frames, positions, &placedCount));
+    JSG_TEST_CHECK(CGRectEqualToRect(frames[0], CGRectMake(102, 102, 40, 10)));
+
+    // The second of two identical labels doesn't fit anywhere with a single position, &
+    // the one with the higher priority wins
+    CGPoint anchors[] = {anchor, anchor};
+    CGSize sizes[] = {size, size};
+    CGFloat priorities[] = {1, 2};
+    JSGRectAlignment right = JSGRectAlignmentRight;
+    JSG_TEST_CHECK(JSGLabelsPlace(anchors, sizes, priorities, 2, CGRectMake(0, 0, 200, 200), 2, &right, 1, JSGCoordinateSystemOriginTopLeft, NULL, frames, positions, &placedCount));
+    JSG_TEST_CHECK(placedCount == 1 && CGRectIsNull(frames[0]) && positions[0] == 0 && positions[1] == JSGRectAlignmentRight);
+}
+
+int main()
+{
+    JSGTestRun("Labels random labels", TestRandomLabels);
+    JSGTestRun("Labels positions", TestPositions);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,94 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryMirroring.h"
+
+/**
+ *  Tests that mirrored rects are as far from the right edge of their container as they
+ *  were from its left edge, that arrays are mirrored like single rects, & that mirroring
+ *  twice gives back the original rects.
+ */
+
+static CGRect BruteForceMirror(CGRect rect, CGRect container)
+{
+    rect = CGRectStandardize(rect);
+    CGFloat leftDistance = CGRectGetMinX(rect) - CGRectGetMinX(container);
+    rect.origin.x = CGRectGetMaxX(container) - leftDistance - rect.size.width;
+
+    return rect;
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    bool matches = true;
+
+    for (size_t iteration = 0; iteration < 100; iteration++) {
+        // Quarter coordinates, so that mirrored edges are computed exactly
+        CGRect container = CGRectMake(random.below(400) * 0.25 - 50, random.below(400) * 0.25, random.below(800) * 0.25, 100);
+        std::vector<CGRect> rects(random.below(70));
+        std::vector<CGRect> containers(rects.size());
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            rects[i] = CGRectMake(random.below(1200) * 0.25 - 150, random.below(400) * 0.25, random.below(400) * 0.25, random.below(400) * 0.25);
+            containers[i] = CGRectMake(random.below(400) * 0.25 - 50, 0, random.below(800) * 0.25, 100);
+            matches &= CGRectEqualToRect(JSGRectMirrorInRect(rects[i], container), BruteForceMirror(rects[i], container));
+        }
+
+        JSGRectArray array, containerArray;
+        JSGRectArrayInit(&array);
+        JSGRectArrayInit(&containerArray);
+        JSGRectArraySetRects(&array, rects.data(), rects.size());
+        JSGRectArraySetRects(&containerArray, containers.data(), containers.size());
+
+        JSGRectArrayMirrorInRect(&array, container);
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            matches &= CGRectEqualToRect(JSGRectArrayGetRect(&array, i), BruteForceMirror(rects[i], container));
+        }
+
+        // Mirroring twice in the same container gives back the original rects
+        JSGRectArrayMirrorInRect(&array, container);
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            matches &= CGRectEqualToRect(JSGRectArrayGetRect(&array, i), rects[i]);
+        }
+
+        JSGRectArrayMirrorInRects(&array, &containerArray);
+
+        for (size_t i = 0; i < rects.size(); i++) {
+            matches &= CGRectEqualToRect(JSGRectArrayGetRect(&array, i), BruteForceMirror(rects[i], containers[i]));
+        }
+
+        JSGRectArrayDestroy(&array);
+        JSGRectArrayDestroy(&containerArray);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestExamples()
+{
+    // A rect 10 points from the left edge ends up 10 points from the right edge
+    CGRect rect = JSGRectMirrorInRect(CGRectMake(10, 5, 30, 20), CGRectMake(0, 0, 100, 50));
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(60, 5, 30, 20)));
+
+    // Both rects & containers are standardized first
+    rect = JSGRectMirrorInRect(CGRectMake(40, 5, -30, 20), CGRectMake(120, 50, -100, -50));
+    JSG_TEST_CHECK(CGRectEqualToRect(rect, CGRectMake(100, 5, 30, 20)));
+
+    JSGEdgeInsets insets = JSGEdgeInsetsMake(1, 2, 3, 4);
+    JSGEdgeInsets resolved = JSGEdgeInsetsForLayoutDirection(insets, JSGLayoutDirectionLeftToRight);
+    JSG_TEST_CHECK(resolved.top == 1 && resolved.left == 2 && resolved.bottom == 3 && resolved.right == 4);
+
+    resolved = JSGEdgeInsetsForLayoutDirection(insets, JSGLayoutDirectionRightToLeft);
+    JSG_TEST_CHECK(resolved.top == 1 && resolved.left == 4 && resolved.bottom == 3 && resolved.right == 2);
+}
+
+int main()
+{
+    JSGTestRun("Mirroring random rects", TestRandomRects);
+    JSGTestRun("Mirroring examples", TestExamples);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,55 @@
+#include <math.h>
+
+#include "JSGTest.h"
+
+import jsgeometry;
+
+/**
+ *  Tests that code importing the jsgeometry module sees the values of its constants &
+ *  tables, and not only that it links. Built when JSG_BUILD_MODULE is on.
+ */
+
+static void TestConstants()
+{
+    JSG_TEST_CHECK(isinf(CGRectNull.origin.x) && isinf(CGRectNull.origin.y));
+    JSG_TEST_CHECK(CGRectIsNull(CGRectNull));
+    JSG_TEST_CHECK(!CGRectIsNull(CGRectZero));
+    JSG_TEST_CHECK(CGPointEqualToPoint(CGPointZero, CGPointMake(0, 0)));
+    JSG_TEST_CHECK(CGSizeEqualToSize(CGSizeZero, CGSizeMake(0, 0)));
+
+    // CGRectNull is the identity of unions, and the result of disjoint intersections
+    JSG_TEST_CHECK(CGRectEqualToRect(CGRectUnion(CGRectNull, CGRectMake(1, 2, 3, 4)), CGRectMake(1, 2, 3, 4)));
+    JSG_TEST_CHECK(CGRectIsNull(CGRectIntersection(CGRectMake(0, 0, 1, 1), CGRectMake(5, 5, 1, 1))));
+}
+
+static void TestTables()
+{
+    // Clipping compacts each group of four rects using its compress table
+    CGRect rects[6] = {
+        CGRectMake(20, 20, 1, 1), CGRectMake(5, 5, 10, 10), CGRectMake(30, 0, 1, 1), CGRectMake(-5, -5, 6, 6),
+        CGRectMake(2, 2, 2, 2), CGRectMake(10, 0, 5, 5)
+    };
+    CGRect clipped[6];
+    size_t sourceIndices[6];
+
+    JSG_TEST_CHECK(JSGRectsClipToRect(rects, 6, CGRectMake(0, 0, 10, 10), clipped, sourceIndices) == 3);
+    JSG_TEST_CHECK(CGRectEqualToRect(clipped[0], CGRectMake(5, 5, 5, 5)) && sourceIndices[0] == 1);
+    JSG_TEST_CHECK(CGRectEqualToRect(clipped[1], CGRectMake(0, 0, 1, 1)) && sourceIndices[1] == 3);
+    JSG_TEST_CHECK(CGRectEqualToRect(clipped[2], CGRectMake(2, 2, 2, 2)) && sourceIndices[2] == 4);
+
+    JSG_TEST_CHECK(JSGLabelPositionsDefault()[0] == (JSGRectAlignmentTop | JSGRectAlignmentRight));
+    JSG_TEST_CHECK(JSGLabelPositionsDefault()[7] == JSGRectAlignmentBottom);
+
+    // Placement offsets candidates from the anchor using its coefficient table
+    JSGPlacement placement = JSGPlacementFind(CGRectMake(100, 100, 20, 20), CGSizeMake(50, 30), 8, CGRectMake(0, 0, 1000, 1000), NULL, JSGRectAlignmentBottom, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginTopLeft, NULL);
+    JSG_TEST_CHECK(CGRectEqualToRect(placement.frame, CGRectMake(85, 128, 50, 30)));
+    JSG_TEST_CHECK(placement.side == JSGRectAlignmentBottom && placement.alignment == JSGPlacementAlignmentCenter);
+}
+
+int main()
+{
+    JSGTestRun("Module constants", TestConstants);
+    JSGTestRun("Module tables", TestTables);
+
+    return JSGTestExitStatus();
+}
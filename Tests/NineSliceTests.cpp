@@ -0,0 +1,154 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryNineSlice.h"
+
+/**
+ *  Tests that nine slices keep their caps at their size when they fit, shrink them
+ *  proportionally when they don't, tile their frames from top to bottom for both
+ *  coordinate system origins, & that destination edges are snapped to pixels.
+ */
+
+/**
+ *  The 4 edges of the 3 slices of a range, before rounding
+ */
+static void BruteForceEdges(CGFloat origin, CGFloat size, CGFloat minimumCap, CGFloat maximumCap, CGFloat *edges)
+{
+    minimumCap = std::fmax(minimumCap, 0);
+    maximumCap = std::fmax(maximumCap, 0);
+
+    if (minimumCap + maximumCap > size) {
+        CGFloat total = minimumCap + maximumCap;
+        minimumCap = minimumCap / total * size;
+        maximumCap = maximumCap / total * size;
+    }
+
+    edges[0] = origin;
+    edges[1] = origin + minimumCap;
+    edges[2] = origin + size - maximumCap;
+    edges[3] = origin + size;
+}
+
+/**
+ *  Check that an edge of a slice is the expected edge, or when rounded to pixels, the
+ *  nearest pixel edge
+ */
+static bool EdgeMatches(CGFloat edge, CGFloat expected, CGFloat scale)
+{
+    const CGFloat tolerance = 1e-9;
+
+    if (scale <= 0) {
+        return std::fabs(edge - expected) <= tolerance;
+    }
+
+    return std::fabs(edge * scale - std::round(edge * scale)) <= tolerance && std::fabs(edge - expected) <= 0.5 / scale + tolerance;
+}
+
+static bool SlicesMatch(const JSGRectArray *slices, size_t frame, CGRect rect, JSGEdgeInsets insets, bool topIsMinimum, CGFloat scale)
+{
+    CGFloat xEdges[4], yEdges[4];
+    BruteForceEdges(rect.origin.x, rect.size.width, insets.left, insets.right, xEdges);
+    BruteForceEdges(rect.origin.y, rect.size.height, topIsMinimum ? insets.top : insets.bottom, topIsMinimum ? insets.bottom : insets.top, yEdges);
+
+    bool matches = true;
+
+    // Slices go from left to right, in rows from top to bottom
+    for (size_t row = 0; row < 3; row++) {
+        size_t band = topIsMinimum ? row : 2 - row;
+
+        for (size_t column = 0; column < 3; column++) {
+            CGRect slice = JSGRectArrayGetRect(slices, frame * JSG_NINE_SLICE_COUNT + row * 3 + column);
+
+            matches &= EdgeMatches(CGRectGetMinX(slice), xEdges[column], scale) && EdgeMatches(CGRectGetMaxX(slice), xEdges[column + 1], scale);
+            matches &= EdgeMatches(CGRectGetMinY(slice), yEdges[band], scale) && EdgeMatches(CGRectGetMaxY(slice), yEdges[band + 1], scale);
+        }
+    }
+
+    return matches;
+}
+
+static void TestRandomSlices()
+{
+    JSGTestRandom random;
+    CGFloat scales[] = {0, 1, 2, 3};
+    bool matches = true;
+
+    for (size_t iteration = 0; iteration < 40; iteration++) {
+        std::vector<CGRect> destinations(random.below(50));
+        std::vector<CGRect> sources(destinations.size());
+        std::vector<JSGEdgeInsets> insets(destinations.size());
+
+        // Caps that often don't fit in their frames, & some negative ones, which count as 0
+        for (size_t i = 0; i < destinations.size(); i++) {
+            destinations[i] = CGRectMake(random.next() * 500, random.next() * 500, random.next() * 80, random.next() * 80);
+            sources[i] = CGRectMake(random.below(900), random.below(900), random.below(60), random.below(60));
+            insets[i] = JSGEdgeInsetsMake(random.below(40) - 5.0, random.below(40) - 5.0, random.below(40) - 5.0, random.below(40) - 5.0);
+        }
+
+        JSGRectArray destinationArray, sourceArray, destinationSlices, sourceSlices;
+        JSGRectArrayInit(&destinationArray);
+        JSGRectArrayInit(&sourceArray);
+        JSGRectArrayInit(&destinationSlices);
+        JSGRectArrayInit(&sourceSlices);
+        JSGRectArraySetRects(&destinationArray, destinations.data(), destinations.size());
+        JSGRectArraySetRects(&sourceArray, sources.data(), sources.size());
+
+        for (size_t origin = 0; origin < 2; origin++) {
+            JSGCoordinateSystemOrigin coordinateSystemOrigin = origin ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+            CGFloat scale = scales[random.below(4)];
+
+            JSG_TEST_CHECK(JSGRectArrayGetNineSlices(&destinationArray, &sourceArray, insets.data(), coordinateSystemOrigin, scale, &sourceSlices, &destinationSlices));
+            matches &= sourceSlices.count == destinations.size() * JSG_NINE_SLICE_COUNT && destinationSlices.count == sourceSlices.count;
+
+            for (size_t i = 0; matches && i < destinations.size(); i++) {
+                matches &= SlicesMatch(&sourceSlices, i, sources[i], insets[i], !origin, 0);
+                matches &= SlicesMatch(&destinationSlices, i, destinations[i], insets[i], !origin, scale);
+            }
+        }
+
+        JSGRectArrayDestroy(&destinationArray);
+        JSGRectArrayDestroy(&sourceArray);
+        JSGRectArrayDestroy(&destinationSlices);
+        JSGRectArrayDestroy(&sourceSlices);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestExamples()
+{
+    JSGRectArray destinations, sources, destinationSlices, sourceSlices;
+    JSGRectArrayInit(&destinations);
+    JSGRectArrayInit(&sources);
+    JSGRectArrayInit(&destinationSlices);
+    JSGRectArrayInit(&sourceSlices);
+    JSGRectArrayAppend(&destinations, CGRectMake(10, 20, 100, 6));
+    JSGRectArrayAppend(&sources, CGRectMake(0, 0, 30, 30));
+    JSGEdgeInsets insets = JSGEdgeInsetsMake(9, 10, 3, 10);
+
+    // The caps keep their size horizontally, & shrink proportionally vertically, where
+    // they don't fit in the 6 point height
+    JSG_TEST_CHECK(JSGRectArrayGetNineSlices(&destinations, &sources, &insets, JSGCoordinateSystemOriginTopLeft, 0, &sourceSlices, &destinationSlices));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&destinationSlices, 0), CGRectMake(10, 20, 10, 4.5)));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&destinationSlices, 4), CGRectMake(20, 24.5, 80, 0)));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&sourceSlices, 8), CGRectMake(20, 27, 10, 3)));
+
+    // With a bottom left origin, the first row is the top one, at the maximum y
+    JSG_TEST_CHECK(JSGRectArrayGetNineSlices(&destinations, &sources, &insets, JSGCoordinateSystemOriginBottomLeft, 0, &sourceSlices, &destinationSlices));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&sourceSlices, 0), CGRectMake(0, 21, 10, 9)));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGRectArrayGetRect(&sourceSlices, 6), CGRectMake(0, 0, 10, 3)));
+
+    JSGRectArrayDestroy(&destinations);
+    JSGRectArrayDestroy(&sources);
+    JSGRectArrayDestroy(&destinationSlices);
+    JSGRectArrayDestroy(&sourceSlices);
+}
+
+int main()
+{
+    JSGTestRun("NineSlice random slices", TestRandomSlices);
+    JSGTestRun("NineSlice examples", TestExamples);
+
+    return JSGTestExitStatus();
+}
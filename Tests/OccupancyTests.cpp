@@ -0,0 +1,240 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryOccupancy.h"
+
+/**
+ *  Tests that the cells an occupancy grid marks, counts & finds free match brute force over
+ *  a grid of booleans, including rects without an interior & partial cells at the edges.
+ */
+
+static const CGRect bounds = CGRectMake(-50, 30, 205, 143);
+static const CGFloat cellSize = 10;
+
+/**
+ *  A grid of booleans, with the same cells as an occupancy grid over bounds
+ */
+struct BruteForceGrid {
+    size_t columns = (size_t)std::ceil(bounds.size.width / cellSize);
+    size_t rows = (size_t)std::ceil(bounds.size.height / cellSize);
+    std::vector<bool> cells = std::vector<bool>(columns * rows);
+
+    CGRect cellRect(size_t column, size_t row) const
+    {
+        return CGRectMake(bounds.origin.x + column * cellSize, bounds.origin.y + row * cellSize, cellSize, cellSize);
+    }
+
+    /**
+     *  Return whether the interior of a rect overlaps a cell, which it can't without one
+     */
+    bool overlaps(CGRect rect, size_t column, size_t row) const
+    {
+        rect = CGRectStandardize(rect);
+        CGRect cell = cellRect(column, row);
+
+        return rect.size.width > 0 && rect.size.height > 0 && rect.origin.x < CGRectGetMaxX(cell) && cell.origin.x < CGRectGetMaxX(rect) && rect.origin.y < CGRectGetMaxY(cell) && cell.origin.y < CGRectGetMaxY(rect);
+    }
+
+    void setRect(CGRect rect, bool occupied)
+    {
+        for (size_t row = 0; row < rows; row++) {
+            for (size_t column = 0; column < columns; column++) {
+                if (overlaps(rect, column, row)) {
+                    cells[row * columns + column] = occupied;
+                }
+            }
+        }
+    }
+
+    size_t countOccupied(CGRect rect) const
+    {
+        size_t count = 0;
+
+        for (size_t row = 0; row < rows; row++) {
+            for (size_t column = 0; column < columns; column++) {
+                count += cells[row * columns + column] && overlaps(rect, column, row);
+            }
+        }
+
+        return count;
+    }
+
+    bool findFreeRect(CGSize size, CGPoint *origin) const
+    {
+        size_t columnCount = std::fmax(1, std::ceil(std::fabs(size.width) / cellSize));
+        size_t rowCount = std::fmax(1, std::ceil(std::fabs(size.height) / cellSize));
+
+        for (size_t row = 0; row + rowCount <= rows; row++) {
+            for (size_t column = 0; column + columnCount <= columns; column++) {
+                bool free = true;
+
+                for (size_t i = row; i < row + rowCount; i++) {
+                    for (size_t j = column; j < column + columnCount; j++) {
+                        free &= !cells[i * columns + j];
+                    }
+                }
+
+                if (free) {
+                    *origin = cellRect(column, row).origin;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+};
+
+/**
+ *  A random rect around the grid, with quarter coordinates so that some edges lie exactly
+ *  on cell boundaries, & some with a zero or negative width or height
+ */
+static CGRect RandomRect(JSGTestRandom &random, CGFloat maximumSize)
+{
+    CGRect rect = CGRectMake(bounds.origin.x - 20 + random.below(1000) * 0.25, bounds.origin.y - 20 + random.below(720) * 0.25, random.below((size_t)maximumSize * 4) * 0.25, random.below((size_t)maximumSize * 4) * 0.25);
+
+    switch (random.below(8)) {
+        case 0:
+            rect.size.width = 0;
+            break;
+        case 1:
+            rect.size.height = 0;
+            break;
+        case 2:
+            rect.size.width = -rect.size.width;
+            break;
+        case 3:
+            rect.origin.x = std::floor(rect.origin.x / cellSize) * cellSize;
+            break;
+    }
+
+    return rect;
+}
+
+static void CheckQueries(JSGTestRandom &random, const JSGOccupancyGrid *grid, const BruteForceGrid &bruteForce)
+{
+    bool matches = true;
+
+    for (size_t row = 0; row < bruteForce.rows; row++) {
+        for (size_t column = 0; column < bruteForce.columns; column++) {
+            matches &= grid->cells[row * grid->columns + column] == bruteForce.cells[row * bruteForce.columns + column];
+        }
+    }
+
+    for (size_t i = 0; i < 200; i++) {
+        CGRect rect = RandomRect(random, 60);
+        matches &= JSGOccupancyGridCountOccupied(grid, rect) == bruteForce.countOccupied(rect);
+    }
+
+    for (size_t i = 0; i < 20; i++) {
+        CGSize size = CGSizeMake(random.below(400) * 0.25, random.below(300) * 0.25);
+        CGPoint origin = CGPointZero, bruteForceOrigin = CGPointZero;
+        bool found = JSGOccupancyGridFindFreeRect(grid, size, &origin);
+
+        matches &= found == bruteForce.findFreeRect(size, &bruteForceOrigin);
+        matches &= !found || CGPointEqualToPoint(origin, bruteForceOrigin);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestEmptyRects()
+{
+    JSGOccupancyGrid grid;
+    JSG_TEST_CHECK(JSGOccupancyGridInit(&grid, CGRectMake(0, 0, 100, 100), 10));
+
+    // Rects without an interior inside of a cell, & on the boundary between cells
+    CGRect rects[] = {CGRectMake(25, 25, 0, 0), CGRectMake(25, 25, 0, 3), CGRectMake(25, 25, 3, 0), CGRectMake(20, 20, 0, 0), CGRectMake(20, 25, 0, 30)};
+
+    for (size_t i = 0; i < sizeof(rects) / sizeof(rects[0]); i++) {
+        JSGOccupancyGridSetRect(&grid, rects[i], true);
+    }
+
+    JSGOccupancyGridUpdate(&grid);
+
+    for (size_t i = 0; i < grid.columns * grid.rows; i++) {
+        JSG_TEST_CHECK(grid.cells[i] == 0);
+    }
+
+    JSGOccupancyGridSetRect(&grid, CGRectMake(20, 20, 10, 10), true);
+    JSGOccupancyGridUpdate(&grid);
+
+    JSG_TEST_CHECK(JSGOccupancyGridCountOccupied(&grid, CGRectMake(20, 20, 10, 10)) == 1);
+    JSG_TEST_CHECK(JSGOccupancyGridCountOccupied(&grid, CGRectMake(25, 25, 0, 0)) == 0);
+    JSG_TEST_CHECK(JSGOccupancyGridCountOccupied(&grid, CGRectMake(25, 21, 0, 8)) == 0);
+    JSG_TEST_CHECK(JSGOccupancyGridIsFree(&grid, CGRectMake(22, 22, 5, 0)));
+    JSG_TEST_CHECK(!JSGOccupancyGridIsFree(&grid, CGRectMake(29.5, 29.5, 1, 1)));
+    JSG_TEST_CHECK(JSGOccupancyGridIsFree(&grid, CGRectMake(30, 30, 5, 5)));
+
+    JSGOccupancyGridDestroy(&grid);
+}
+
+static void TestRandomRects()
+{
+    JSGTestRandom random;
+    JSGOccupancyGrid grid;
+    BruteForceGrid bruteForce;
+    JSG_TEST_CHECK(JSGOccupancyGridInit(&grid, bounds, cellSize));
+    JSG_TEST_CHECK(grid.columns == bruteForce.columns && grid.rows == bruteForce.rows);
+
+    // Updated after every few changes, so that only some rows are stale each time
+    for (size_t i = 0; i < 60; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            CGRect rect = RandomRect(random, 40);
+            bool occupied = random.below(4) != 0;
+
+            JSGOccupancyGridSetRect(&grid, rect, occupied);
+            bruteForce.setRect(rect, occupied);
+        }
+
+        JSGOccupancyGridUpdate(&grid);
+        CheckQueries(random, &grid, bruteForce);
+    }
+
+    JSGOccupancyGridClear(&grid);
+    bruteForce = BruteForceGrid();
+    CheckQueries(random, &grid, bruteForce);
+
+    JSGOccupancyGridDestroy(&grid);
+}
+
+static void TestAddRects()
+{
+    JSGTestRandom random;
+    JSGOccupancyGrid grid;
+    BruteForceGrid bruteForce;
+    JSGRectArray rects;
+    JSGRectArrayInit(&rects);
+    JSGOccupancyGridInit(&grid, bounds, cellSize);
+
+    for (size_t i = 0; i < 25; i++) {
+        CGRect rect = RandomRect(random, 30);
+        JSGRectArrayAppend(&rects, rect);
+        bruteForce.setRect(rect, true);
+    }
+
+    JSGOccupancyGridAddRects(&grid, &rects);
+    JSGOccupancyGridUpdate(&grid);
+    CheckQueries(random, &grid, bruteForce);
+
+    // Filling the grid leaves no free area, even for an empty size
+    JSGOccupancyGridSetRect(&grid, bounds, true);
+    JSGOccupancyGridUpdate(&grid);
+
+    CGPoint origin;
+    JSG_TEST_CHECK(!JSGOccupancyGridFindFreeRect(&grid, CGSizeZero, &origin));
+    JSG_TEST_CHECK(JSGOccupancyGridCountOccupied(&grid, bounds) == grid.columns * grid.rows);
+
+    JSGOccupancyGridDestroy(&grid);
+    JSGRectArrayDestroy(&rects);
+}
+
+int main()
+{
+    JSGTestRun("Occupancy rects without an interior", TestEmptyRects);
+    JSGTestRun("Occupancy random rects", TestRandomRects);
+    JSGTestRun("Occupancy adding rect arrays", TestAddRects);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryPlacement.h"
+
+/**
+ *  Tests that popover placement picks the same candidate, frame & cost as scoring every
+ *  side & alignment one by one, for both coordinate system origins, with & without
+ *  obstacles.
+ */
+
+static CGFloat IntersectionArea(CGRect a, CGRect b)
+{
+    CGRect intersection = CGRectIntersection(a, b);
+
+    return CGRectIsNull(intersection) ? 0 : intersection.size.width * intersection.size.height;
+}
+
+/**
+ *  Score every candidate in turn, in the order of the sides top, right, bottom & left, and
+ *  of the alignments start, center & end
+ */
+static JSGPlacement BruteForcePlacement(CGRect anchor, CGSize size, CGFloat spacing, CGRect bounds, const std::vector<CGRect> &obstacles, JSGRectAlignment preferredSide, JSGPlacementAlignment preferredAlignment, JSGCoordinateSystemOrigin origin, const JSGPlacementCosts &costs)
+{
+    const JSGRectAlignment sides[] = {JSGRectAlignmentTop, JSGRectAlignmentRight, JSGRectAlignmentBottom, JSGRectAlignmentLeft};
+    bool flipped = origin == JSGCoordinateSystemOriginBottomLeft;
+    JSGPlacement best;
+    best.cost = INFINITY;
+
+    for (size_t side = 0; side < 4; side++) {
+        for (size_t alignment = 0; alignment < 3; alignment++) {
+            bool vertical = sides[side] == JSGRectAlignmentTop || sides[side] == JSGRectAlignmentBottom;
+            bool above = (sides[side] == JSGRectAlignmentTop) != flipped;
+            CGFloat x, y;
+
+            if (vertical) {
+                CGFloat alignedXs[] = {CGRectGetMinX(anchor), CGRectGetMidX(anchor) - size.width / 2, CGRectGetMaxX(anchor) - size.width};
+                x = alignedXs[alignment];
+                y = above ? CGRectGetMinY(anchor) - spacing - size.height : CGRectGetMaxY(anchor) + spacing;
+            } else {
+                // Start aligns the top edges, which are the maximum edges with a bottom left origin
+                CGFloat alignedYs[] = {CGRectGetMinY(anchor), CGRectGetMidY(anchor) - size.height / 2, CGRectGetMaxY(anchor) - size.height};
+                x = sides[side] == JSGRectAlignmentRight ? CGRectGetMaxX(anchor) + spacing : CGRectGetMinX(anchor) - spacing - size.width;
+                y = alignedYs[flipped ? 2 - alignment : alignment];
+            }
+
+            // Shifted along the side into the bounds, but still touching the anchor
+            CGFloat *position = vertical ? &x : &y;
+            CGFloat length = vertical ? size.width : size.height;
+            CGFloat shifted = std::fmin(*position, (vertical ? CGRectGetMaxX(bounds) : CGRectGetMaxY(bounds)) - length);
+            shifted = std::fmax(shifted, vertical ? CGRectGetMinX(bounds) : CGRectGetMinY(bounds));
+            shifted = std::fmax(shifted, (vertical ? CGRectGetMinX(anchor) : CGRectGetMinY(anchor)) - length);
+            shifted = std::fmin(shifted, vertical ? CGRectGetMaxX(anchor) : CGRectGetMaxY(anchor));
+            CGFloat shift = std::fabs(shifted - *position);
+            *position = shifted;
+
+            CGRect frame = CGRectMake(x, y, size.width, size.height);
+            CGFloat obstruction = 0;
+
+            for (size_t i = 0; i < obstacles.size(); i++) {
+                obstruction += IntersectionArea(frame, obstacles[i]);
+            }
+
+            bool flip = sides[side] == (preferredSide == JSGRectAlignmentTop ? JSGRectAlignmentBottom : preferredSide == JSGRectAlignmentBottom ? JSGRectAlignmentTop : preferredSide == JSGRectAlignmentLeft ? JSGRectAlignmentRight : JSGRectAlignmentLeft);
+            CGFloat cost = (size.width * size.height - IntersectionArea(frame, bounds)) * costs.overflow + obstruction * costs.obstruction + shift * costs.shift;
+            cost += sides[side] == preferredSide ? 0 : flip ? costs.flip : costs.side;
+            cost += alignment == preferredAlignment ? 0 : costs.alignment;
+
+            if (cost < best.cost) {
+                best.frame = frame;
+                best.side = sides[side];
+                best.alignment = (JSGPlacementAlignment)alignment;
+                best.cost = cost;
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ *  A random rect with quarter coordinates, so that all areas & costs are computed exactly
+ */
+static CGRect RandomRect(JSGTestRandom &random, CGFloat range, CGFloat maximumSize)
+{
+    return CGRectMake(random.below((size_t)range * 4) * 0.25, random.below((size_t)range * 4) * 0.25, 1 + random.below((size_t)maximumSize * 4) * 0.25, 1 + random.below((size_t)maximumSize * 4) * 0.25);
+}
+
+static bool Matches(JSGPlacement placement, JSGPlacement expected)
+{
+    return CGRectEqualToRect(placement.frame, expected.frame) && placement.side == expected.side && placement.alignment == expected.alignment && placement.cost == expected.cost;
+}
+
+static void TestRandomPlacements()
+{
+    JSGTestRandom random;
+    const JSGRectAlignment sides[] = {JSGRectAlignmentTop, JSGRectAlignmentRight, JSGRectAlignmentBottom, JSGRectAlignmentLeft};
+    JSGPlacementCosts costs = JSGPlacementCostsDefault();
+    JSGSpatialGrid grid;
+    std::vector<CGRect> obstacles;
+    JSGSpatialGridInit(&grid, CGRectMake(0, 0, 400, 300), 40);
+
+    for (size_t i = 0; i < 40; i++) {
+        CGRect obstacle = RandomRect(random, 400, 60);
+        obstacles.push_back(obstacle);
+        JSGSpatialGridInsert(&grid, obstacle);
+    }
+
+    bool matches = true;
+
+    for (size_t i = 0; i < 3000; i++) {
+        CGRect anchor = RandomRect(random, 400, 50);
+        CGSize size = RandomRect(random, 0, 120).size;
+        CGFloat spacing = random.below(4) * 2;
+        CGRect bounds = i % 7 ? CGRectMake(0, 0, 400, 300) : CGRectMake(100, 50, 120, 90);
+        JSGRectAlignment preferredSide = sides[random.below(4)];
+        JSGPlacementAlignment preferredAlignment = (JSGPlacementAlignment)random.below(3);
+        JSGCoordinateSystemOrigin origin = random.below(2) ? JSGCoordinateSystemOriginBottomLeft : JSGCoordinateSystemOriginTopLeft;
+        bool obstructed = i % 2;
+
+        JSGPlacement placement = JSGPlacementFind(anchor, size, spacing, bounds, obstructed ? &grid : NULL, preferredSide, preferredAlignment, origin, i % 3 ? NULL : &costs);
+        JSGPlacement expected = BruteForcePlacement(anchor, size, spacing, bounds, obstructed ? obstacles : std::vector<CGRect>(), preferredSide, preferredAlignment, origin, costs);
+
+        matches &= Matches(placement, expected);
+    }
+
+    JSG_TEST_CHECK(matches);
+
+    JSGSpatialGridDestroy(&grid);
+}
+
+static void TestFlipAndShift()
+{
+    CGRect bounds = CGRectMake(0, 0, 320, 480);
+
+    // With room, the preferred side & alignment are used
+    JSGPlacement placement = JSGPlacementFind(CGRectMake(100, 100, 20, 20), CGSizeMake(50, 30), 8, bounds, NULL, JSGRectAlignmentBottom, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginTopLeft, NULL);
+    JSG_TEST_CHECK(CGRectEqualToRect(placement.frame, CGRectMake(85, 128, 50, 30)) && placement.cost == 0);
+
+    // At the bottom of the bounds, the popover flips to the top
+    placement = JSGPlacementFind(CGRectMake(100, 440, 20, 20), CGSizeMake(50, 30), 8, bounds, NULL, JSGRectAlignmentBottom, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginTopLeft, NULL);
+    JSG_TEST_CHECK(placement.side == JSGRectAlignmentTop && CGRectEqualToRect(placement.frame, CGRectMake(85, 402, 50, 30)));
+
+    // In a bottom left coordinate system, the top side is at the maximum y
+    placement = JSGPlacementFind(CGRectMake(100, 100, 20, 20), CGSizeMake(50, 30), 8, bounds, NULL, JSGRectAlignmentTop, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginBottomLeft, NULL);
+    JSG_TEST_CHECK(placement.side == JSGRectAlignmentTop && CGRectEqualToRect(placement.frame, CGRectMake(85, 128, 50, 30)));
+
+    // Near the left edge, the popover is shifted right rather than realigned
+    placement = JSGPlacementFind(CGRectMake(5, 100, 20, 20), CGSizeMake(50, 30), 8, bounds, NULL, JSGRectAlignmentBottom, JSGPlacementAlignmentCenter, JSGCoordinateSystemOriginTopLeft, NULL);
+    JSG_TEST_CHECK(placement.alignment == JSGPlacementAlignmentCenter && CGRectEqualToRect(placement.frame, CGRectMake(0, 128, 50, 30)) && placement.cost == 10);
+}
+
+int main()
+{
+    JSGTestRun("Placement random placements", TestRandomPlacements);
+    JSGTestRun("Placement flip & shift", TestFlipAndShift);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryRTree.h"
+
+/**
+ *  Tests inserting, removing & querying items of a persistent R-tree, and that snapshots
+ *  keep seeing the version they were taken from while the tree is written & published.
+ */
+
+static const CGRect everything = CGRectMake(-1e9, -1e9, 2e9, 2e9);
+
+static bool Overlaps(CGRect a, CGRect b)
+{
+    return a.origin.x < b.origin.x + b.size.width && b.origin.x < a.origin.x + a.size.width && a.origin.y < b.origin.y + b.size.height && b.origin.y < a.origin.y + a.size.height;
+}
+
+static std::vector<size_t> Query(JSGRTreeSnapshot snapshot, CGRect rect)
+{
+    std::vector<size_t> items(JSGRTreeQuery(snapshot, rect, NULL, 0));
+    JSGRTreeQuery(snapshot, rect, items.data(), items.size());
+    std::sort(items.begin(), items.end());
+
+    return items;
+}
+
+static std::vector<size_t> BruteForce(const std::vector<CGRect> &rects, const std::vector<bool> &present, CGRect rect)
+{
+    std::vector<size_t> items;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        if (present[i] && Overlaps(rects[i], rect)) {
+            items.push_back(i);
+        }
+    }
+
+    return items;
+}
+
+static std::vector<CGRect> RandomRects(JSGTestRandom &random, size_t count)
+{
+    std::vector<CGRect> rects(count);
+
+    for (size_t i = 0; i < count; i++) {
+        rects[i] = CGRectMake(random.next() * 1000, random.next() * 1000, 1 + random.next() * 40, 1 + random.next() * 40);
+    }
+
+    return rects;
+}
+
+static void CheckQueries(JSGTestRandom &random, JSGRTreeSnapshot snapshot, const std::vector<CGRect> &rects, const std::vector<bool> &present)
+{
+    for (size_t i = 0; i < 200; i++) {
+        CGRect rect = CGRectMake(random.next() * 1000, random.next() * 1000, random.next() * 200, random.next() * 200);
+        JSG_TEST_CHECK(Query(snapshot, rect) == BruteForce(rects, present, rect));
+    }
+
+    JSG_TEST_CHECK(Query(snapshot, everything) == BruteForce(rects, present, everything));
+}
+
+static void TestInsertAndQuery()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 3000);
+    std::vector<bool> present(rects.size(), true);
+    JSGRTree tree;
+    size_t reader = 0;
+    JSGRTreeInit(&tree);
+    JSG_TEST_CHECK(JSGRTreeRegisterReader(&tree, &reader));
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        JSG_TEST_CHECK(JSGRTreeInsert(&tree, i, rects[i]));
+    }
+
+    // Writes aren't visible until the tree is published
+    JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+    JSG_TEST_CHECK(Query(snapshot, everything).empty());
+    JSGRTreeEndRead(&tree, reader);
+
+    JSGRTreePublish(&tree);
+    JSG_TEST_CHECK(tree.count == rects.size());
+
+    snapshot = JSGRTreeBeginRead(&tree, reader);
+    CheckQueries(random, snapshot, rects, present);
+
+    // Items that only touch the query rect aren't found
+    JSG_TEST_CHECK(Query(snapshot, CGRectMake(rects[0].origin.x - 10, rects[0].origin.y, 10, rects[0].size.height)) == BruteForce(rects, present, CGRectMake(rects[0].origin.x - 10, rects[0].origin.y, 10, rects[0].size.height)));
+
+    JSGRTreeEndRead(&tree, reader);
+    JSGRTreeUnregisterReader(&tree, reader);
+    JSGRTreeDestroy(&tree);
+}
+
+static void TestRemove()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 3000);
+    std::vector<bool> present(rects.size(), true);
+    JSGRTree tree;
+    size_t reader = 0;
+    JSGRTreeInit(&tree);
+    JSGRTreeRegisterReader(&tree, &reader);
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        JSGRTreeInsert(&tree, i, rects[i]);
+    }
+
+    JSGRTreePublish(&tree);
+
+    // An item is only removed when both its index & rect match
+    JSG_TEST_CHECK(!JSGRTreeRemove(&tree, 0, CGRectOffset(rects[0], 1, 0)));
+    JSG_TEST_CHECK(!JSGRTreeRemove(&tree, rects.size(), rects[0]));
+
+    // Removing in a random order, publishing in batches, underflows & merges nodes
+    std::vector<size_t> order(rects.size());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    for (size_t i = order.size() - 1; i > 0; i--) {
+        std::swap(order[i], order[random.below(i + 1)]);
+    }
+
+    for (size_t i = 0; i < order.size(); i++) {
+        JSG_TEST_CHECK(JSGRTreeRemove(&tree, order[i], rects[order[i]]));
+        present[order[i]] = false;
+
+        if (i % 500 == 499 || i == order.size() / 2) {
+            JSGRTreePublish(&tree);
+            JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+            CheckQueries(random, snapshot, rects, present);
+            JSGRTreeEndRead(&tree, reader);
+        }
+    }
+
+    JSG_TEST_CHECK(!JSGRTreeRemove(&tree, order[0], rects[order[0]]));
+    JSGRTreePublish(&tree);
+    JSG_TEST_CHECK(tree.count == 0);
+
+    JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+    JSG_TEST_CHECK(Query(snapshot, everything).empty());
+    JSGRTreeEndRead(&tree, reader);
+
+    // The emptied tree can be filled again
+    for (size_t i = 0; i < 100; i++) {
+        JSG_TEST_CHECK(JSGRTreeInsert(&tree, i, rects[i]));
+        present[i] = true;
+    }
+
+    JSGRTreePublish(&tree);
+    snapshot = JSGRTreeBeginRead(&tree, reader);
+    CheckQueries(random, snapshot, rects, present);
+    JSGRTreeEndRead(&tree, reader);
+
+    JSGRTreeUnregisterReader(&tree, reader);
+    JSGRTreeDestroy(&tree);
+}
+
+static void TestSnapshotIsolation()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects = RandomRects(random, 2000);
+    std::vector<bool> present(rects.size(), false);
+    JSGRTree tree;
+    size_t oldReader = 0, newReader = 0;
+    JSGRTreeInit(&tree);
+    JSGRTreeRegisterReader(&tree, &oldReader);
+    JSGRTreeRegisterReader(&tree, &newReader);
+    JSG_TEST_CHECK(oldReader != newReader);
+
+    for (size_t i = 0; i < 1000; i++) {
+        JSGRTreeInsert(&tree, i, rects[i]);
+        present[i] = true;
+    }
+
+    JSGRTreePublish(&tree);
+    std::vector<bool> oldPresent = present;
+    JSGRTreeSnapshot oldSnapshot = JSGRTreeBeginRead(&tree, oldReader);
+
+    // Published versions replace nodes of the old snapshot, which must stay readable
+    for (size_t version = 0; version < 10; version++) {
+        for (size_t i = version * 100; i < version * 100 + 100; i++) {
+            JSG_TEST_CHECK(JSGRTreeRemove(&tree, i, rects[i]));
+            JSG_TEST_CHECK(JSGRTreeInsert(&tree, i + 1000, rects[i + 1000]));
+            present[i] = false;
+            present[i + 1000] = true;
+        }
+
+        JSGRTreePublish(&tree);
+
+        JSGRTreeSnapshot newSnapshot = JSGRTreeBeginRead(&tree, newReader);
+        CheckQueries(random, newSnapshot, rects, present);
+        JSGRTreeEndRead(&tree, newReader);
+        CheckQueries(random, oldSnapshot, rects, oldPresent);
+    }
+
+    JSGRTreeEndRead(&tree, oldReader);
+
+    // Once the old snapshot is no longer read, its nodes are reclaimed
+    JSGRTreeReclaim(&tree);
+    JSG_TEST_CHECK(tree.retiredHead == NULL);
+
+    JSGRTreeUnregisterReader(&tree, oldReader);
+    JSGRTreeUnregisterReader(&tree, newReader);
+    JSGRTreeDestroy(&tree);
+}
+
+static void TestConcurrentReaders()
+{
+    JSGTestRandom random;
+    const size_t itemCount = 500;
+    std::vector<CGRect> rects = RandomRects(random, itemCount * 2);
+    JSGRTree tree;
+    JSGRTreeInit(&tree);
+
+    for (size_t i = 0; i < itemCount; i++) {
+        JSGRTreeInsert(&tree, i, rects[i]);
+    }
+
+    JSGRTreePublish(&tree);
+
+    // Every published version holds exactly itemCount items, so readers must always find
+    // that many, whichever version they see
+    bool done = false;
+    std::vector<size_t> wrongCounts(2, 0);
+    std::vector<std::thread> readers;
+
+    for (size_t thread = 0; thread < 2; thread++) {
+        readers.push_back(std::thread([&tree, &done, &wrongCounts, thread, itemCount]() {
+            size_t reader = 0;
+
+            if (!JSGRTreeRegisterReader(&tree, &reader)) {
+                wrongCounts[thread]++;
+                return;
+            }
+
+            while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+                JSGRTreeSnapshot snapshot = JSGRTreeBeginRead(&tree, reader);
+                wrongCounts[thread] += JSGRTreeQuery(snapshot, everything, NULL, 0) != itemCount;
+                JSGRTreeEndRead(&tree, reader);
+            }
+
+            JSGRTreeUnregisterReader(&tree, reader);
+        }));
+    }
+
+    // Each version moves 10 items between their two rects
+    std::vector<bool> moved(itemCount, false);
+
+    for (size_t version = 0; version < 200; version++) {
+        for (size_t i = 0; i < 10; i++) {
+            size_t item = (version * 10 + i) % itemCount;
+
+            JSG_TEST_CHECK(JSGRTreeRemove(&tree, item, rects[moved[item] ? item + itemCount : item]));
+            moved[item] = !moved[item];
+            JSG_TEST_CHECK(JSGRTreeInsert(&tree, item, rects[moved[item] ? item + itemCount : item]));
+        }
+
+        JSGRTreePublish(&tree);
+    }
+
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+
+    for (size_t thread = 0; thread < readers.size(); thread++) {
+        readers[thread].join();
+        JSG_TEST_CHECK(wrongCounts[thread] == 0);
+    }
+
+    JSG_TEST_CHECK(tree.count == itemCount);
+    JSGRTreeDestroy(&tree);
+}
+
+int main()
+{
+    JSGTestRun("RTree insert & query", TestInsertAndQuery);
+    JSGTestRun("RTree remove", TestRemove);
+    JSGTestRun("RTree snapshot isolation", TestSnapshotIsolation);
+    JSGTestRun("RTree concurrent readers", TestConcurrentReaders);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,112 @@
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryReduction.h"
+
+/**
+ *  Tests that reducing a rect array gives the same bounds, edge extremes & centroid as a
+ *  single loop over its rects, for counts around the lane & block sizes, & that the result
+ *  doesn't depend on the number of threads.
+ */
+
+static JSGRectArrayReduction BruteForceReduction(const std::vector<CGRect> &rects)
+{
+    JSGRectArrayReduction reduction;
+    reduction.count = rects.size();
+    reduction.bounds = CGRectNull;
+    reduction.largestMinX = reduction.largestMinY = reduction.smallestMaxX = reduction.smallestMaxY = 0;
+    reduction.centroid = CGPointZero;
+
+    if (rects.empty()) {
+        return reduction;
+    }
+
+    CGFloat sumX = 0, sumY = 0;
+    reduction.largestMinX = reduction.largestMinY = -INFINITY;
+    reduction.smallestMaxX = reduction.smallestMaxY = INFINITY;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        CGRect rect = rects[i];
+        reduction.bounds = CGRectUnion(reduction.bounds, rect);
+        reduction.largestMinX = CGRectGetMinX(rect) > reduction.largestMinX ? CGRectGetMinX(rect) : reduction.largestMinX;
+        reduction.largestMinY = CGRectGetMinY(rect) > reduction.largestMinY ? CGRectGetMinY(rect) : reduction.largestMinY;
+        reduction.smallestMaxX = CGRectGetMaxX(rect) < reduction.smallestMaxX ? CGRectGetMaxX(rect) : reduction.smallestMaxX;
+        reduction.smallestMaxY = CGRectGetMaxY(rect) < reduction.smallestMaxY ? CGRectGetMaxY(rect) : reduction.smallestMaxY;
+        sumX += CGRectGetMidX(rect);
+        sumY += CGRectGetMidY(rect);
+    }
+
+    reduction.centroid = CGPointMake(sumX / rects.size(), sumY / rects.size());
+
+    return reduction;
+}
+
+static bool Matches(JSGRectArrayReduction reduction, JSGRectArrayReduction expected)
+{
+    return reduction.count == expected.count && CGRectEqualToRect(reduction.bounds, expected.bounds) && reduction.largestMinX == expected.largestMinX && reduction.largestMinY == expected.largestMinY && reduction.smallestMaxX == expected.smallestMaxX && reduction.smallestMaxY == expected.smallestMaxY && CGPointEqualToPoint(reduction.centroid, expected.centroid);
+}
+
+static void TestRandomArrays()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, 3, 4, 5, 17, 1000, JSG_REDUCTION_BLOCK_SIZE, JSG_REDUCTION_BLOCK_SIZE + 1, 5 * JSG_REDUCTION_BLOCK_SIZE + 7};
+    bool matches = true;
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        std::vector<CGRect> rects(counts[i]);
+
+        // Quarter coordinates, so that sums are exact whatever order they're added up in
+        for (size_t j = 0; j < counts[i]; j++) {
+            rects[j] = CGRectMake(random.below(4000) * 0.25 - 500, random.below(4000) * 0.25 - 500, random.below(400) * 0.25, random.below(400) * 0.25);
+        }
+
+        JSGRectArray array;
+        JSGRectArrayInit(&array);
+        JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+        JSGRectArrayReduction expected = BruteForceReduction(rects);
+        size_t threadCounts[] = {1, 0, 3};
+
+        for (size_t j = 0; j < sizeof(threadCounts) / sizeof(threadCounts[0]); j++) {
+            JSGRectArrayReduction reduction = {};
+            matches &= JSGRectArrayReduce(&array, threadCounts[j], &reduction) && Matches(reduction, expected);
+        }
+
+        JSGRectArrayDestroy(&array);
+    }
+
+    JSG_TEST_CHECK(matches);
+}
+
+static void TestRoundingIndependentOfThreads()
+{
+    JSGTestRandom random;
+    std::vector<CGRect> rects(3 * JSG_REDUCTION_BLOCK_SIZE + 11);
+
+    // Arbitrary coordinates, whose sums round differently depending on their order
+    for (size_t i = 0; i < rects.size(); i++) {
+        rects[i] = CGRectMake(random.next() * 1e4, random.next() * 1e-3, random.next(), random.next() * 1e7);
+    }
+
+    JSGRectArray array;
+    JSGRectArrayInit(&array);
+    JSGRectArraySetRects(&array, rects.data(), rects.size());
+
+    JSGRectArrayReduction single = {}, parallel = {};
+    JSG_TEST_CHECK(JSGRectArrayReduce(&array, 1, &single));
+    JSG_TEST_CHECK(JSGRectArrayReduce(&array, 4, &parallel));
+    JSG_TEST_CHECK(Matches(single, parallel));
+
+    // The area shared by all rects is empty here
+    JSG_TEST_CHECK(single.largestMinX > single.smallestMaxX);
+
+    JSGRectArrayDestroy(&array);
+}
+
+int main()
+{
+    JSGTestRun("Reduction random arrays", TestRandomArrays);
+    JSGTestRun("Reduction rounding independent of threads", TestRoundingIndependentOfThreads);
+
+    return JSGTestExitStatus();
+}
@@ -0,0 +1,215 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometrySplitLayout.h"
+
+/**
+ *  Tests that the panes & dividers of a split tree exactly tile their container, without
+ *  gaps or overlaps, across random splits & removals, pixel scales & container sizes.
+ */
+
+static void CollectNodes(const JSGSplitTree *tree, size_t node, std::vector<size_t> *panes, std::vector<size_t> *splits)
+{
+    if (tree->nodes[node].type == JSGSplitTypePane) {
+        panes->push_back(node);
+        return;
+    }
+
+    splits->push_back(node);
+    CollectNodes(tree, tree->nodes[node].children[0], panes, splits);
+    CollectNodes(tree, tree->nodes[node].children[1], panes, splits);
+}
+
+/**
+ *  Return whether two rects overlap by more than a rounding error. Adjacent frames share
+ *  the position of their split line exactly, but the maximum edge of the first one is
+ *  computed from its origin & size, which can round the other way at fractional positions.
+ */
+static bool Overlaps(CGRect a, CGRect b)
+{
+    const CGFloat tolerance = 1e-9;
+
+    return a.origin.x < b.origin.x + b.size.width - tolerance && b.origin.x < a.origin.x + a.size.width - tolerance && a.origin.y < b.origin.y + b.size.height - tolerance && b.origin.y < a.origin.y + a.size.height - tolerance;
+}
+
+static bool IsSnapped(CGFloat value, CGFloat scale)
+{
+    return scale <= 0 || std::fabs(value * scale - std::round(value * scale)) <= 1e-9;
+}
+
+/**
+ *  Check that the panes & dividers of a laid out tree tile its root frame
+ */
+static bool CheckTiling(const JSGSplitTree *tree, CGFloat scale)
+{
+    std::vector<size_t> panes, splits;
+    CollectNodes(tree, tree->root, &panes, &splits);
+
+    std::vector<CGRect> rects;
+
+    for (size_t i = 0; i < panes.size(); i++) {
+        rects.push_back(tree->nodes[panes[i]].frame);
+    }
+
+    for (size_t i = 0; i < splits.size(); i++) {
+        rects.push_back(JSGSplitTreeGetDividerRect(tree, splits[i]));
+    }
+
+    CGRect bounds = tree->nodes[tree->root].frame;
+    CGFloat area = 0;
+    bool matches = true;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        CGRect rect = rects[i];
+        matches &= rect.size.width >= 0 && rect.size.height >= 0;
+        matches &= rect.origin.x >= bounds.origin.x && rect.origin.y >= bounds.origin.y && CGRectGetMaxX(rect) <= CGRectGetMaxX(bounds) + 1e-9 && CGRectGetMaxY(rect) <= CGRectGetMaxY(bounds) + 1e-9;
+        matches &= IsSnapped(rect.origin.x, scale) && IsSnapped(rect.origin.y, scale) && IsSnapped(CGRectGetMaxX(rect), scale) && IsSnapped(CGRectGetMaxY(rect), scale);
+        area += rect.size.width * rect.size.height;
+
+        for (size_t j = 0; j < i; j++) {
+            matches &= !Overlaps(rect, rects[j]);
+        }
+    }
+
+    return matches && std::fabs(area - bounds.size.width * bounds.size.height) <= 1e-6 * (1 + area);
+}
+
+static void TestRandomTrees()
+{
+    JSGTestRandom random;
+    CGFloat scales[] = {0, 1, 2, 3};
+
+    for (size_t iteration = 0; iteration < 40; iteration++) {
+        JSGSplitTree tree;
+        std::vector<size_t> panes(1);
+        JSGSplitTreeInit(&tree, iteration % 3);
+        JSG_TEST_CHECK(JSGSplitTreeAddRootPane(&tree, &panes[0]));
+
+        for (size_t step = 0; step < 60; step++) {
+            size_t index = random.below(panes.size());
+
+            if (random.below(4) == 0 && panes.size() > 1) {
+                JSGSplitTreeRemovePane(&tree, panes[index]);
+                panes.erase(panes.begin() + index);
+            } else {
+                size_t pane = 0;
+                JSGSplitType type = random.below(2) ? JSGSplitTypeHorizontal : JSGSplitTypeVertical;
+                JSG_TEST_CHECK(JSGSplitTreeSplitPane(&tree, panes[index], type, random.below(11) * 0.1, random.below(2) == 0, &pane));
+
+                // Some panes are given size constraints
+                if (random.below(3) == 0) {
+                    tree.nodes[pane].minSize = CGSizeMake(random.below(30), random.below(30));
+                    tree.nodes[pane].maxSize = CGSizeMake(tree.nodes[pane].minSize.width + random.below(300), CGFLOAT_MAX);
+                }
+
+                panes.push_back(pane);
+            }
+
+            CGRect container = CGRectMake(random.below(100) * 0.3, random.below(100) * 0.3, random.below(1500) * 0.7, random.below(1000) * 0.7);
+            CGFloat scale = scales[random.below(4)];
+            JSGSplitTreeLayout(&tree, container, scale);
+            JSG_TEST_CHECK(CheckTiling(&tree, scale));
+        }
+
+        // The panes that were kept are exactly the panes of the tree
+        std::vector<size_t> treePanes, splits;
+        CollectNodes(&tree, tree.root, &treePanes, &splits);
+        JSG_TEST_CHECK(treePanes.size() == panes.size() && splits.size() == panes.size() - 1);
+
+        JSGSplitTreeDestroy(&tree);
+    }
+}
+
+static void TestConstraints()
+{
+    JSGSplitTree tree;
+    size_t left = 0, right = 0, bottom = 0;
+    JSGSplitTreeInit(&tree, 1);
+    JSGSplitTreeAddRootPane(&tree, &left);
+    JSGSplitTreeSplitPane(&tree, left, JSGSplitTypeHorizontal, 0.5, false, &right);
+    JSGSplitTreeSplitPane(&tree, right, JSGSplitTypeVertical, 0.25, false, &bottom);
+    size_t split = tree.root;
+
+    // The divider splits the available length according to the ratio
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 1001, 401), 1);
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[left].frame, CGRectMake(0, 0, 500, 401)));
+    JSG_TEST_CHECK(CGRectEqualToRect(JSGSplitTreeGetDividerRect(&tree, split), CGRectMake(500, 0, 1, 401)));
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[right].frame, CGRectMake(501, 0, 500, 100)));
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[bottom].frame, CGRectMake(501, 101, 500, 300)));
+
+    // Minimum & maximum sizes take precedence over the ratio, & constrain the splits
+    // containing the panes
+    tree.nodes[left].maxSize.width = 200;
+    tree.nodes[bottom].minSize = CGSizeMake(600, 350);
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 1001, 401), 1);
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[left].frame, CGRectMake(0, 0, 200, 401)));
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[bottom].frame, CGRectMake(201, 51, 800, 350)));
+    JSG_TEST_CHECK(tree.nodes[split].minSize.width == 601 && tree.nodes[split].minSize.height == 351);
+
+    // When the minimum sizes can't all be satisfied, the first pane wins
+    tree.nodes[left].minSize.width = 150;
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 500, 401), 1);
+    JSG_TEST_CHECK(tree.nodes[left].frame.size.width == 150 && tree.nodes[bottom].frame.size.width == 349);
+    JSG_TEST_CHECK(CheckTiling(&tree, 1));
+
+    // Growing the container back restores the layout, since ratios are left untouched
+    tree.nodes[left].minSize.width = 0;
+    tree.nodes[left].maxSize.width = CGFLOAT_MAX;
+    tree.nodes[bottom].minSize = CGSizeZero;
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 20, 20), 1);
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 1001, 401), 1);
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[left].frame, CGRectMake(0, 0, 500, 401)));
+
+    // Unsnapped layouts keep fractional positions
+    JSGSplitTreeLayout(&tree, CGRectMake(0.25, 0, 100, 100), 0);
+    JSG_TEST_CHECK(tree.nodes[left].frame.origin.x == 0.25 && tree.nodes[left].frame.size.width == 49.5);
+
+    // A container too small even for the dividers gives empty frames
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 0.5, 0), 2);
+    JSG_TEST_CHECK(CheckTiling(&tree, 2));
+
+    JSGSplitTreeDestroy(&tree);
+}
+
+static void TestRemovingPanes()
+{
+    JSGSplitTree tree;
+    size_t root = 0, second = 0, third = 0, reused = 0;
+    JSGSplitTreeInit(&tree, 0);
+    JSGSplitTreeAddRootPane(&tree, &root);
+    JSGSplitTreeSplitPane(&tree, root, JSGSplitTypeHorizontal, 0.5, true, &second);
+    JSGSplitTreeSplitPane(&tree, second, JSGSplitTypeVertical, 0.5, false, &third);
+
+    // Removing a pane gives its space to its sibling
+    JSGSplitTreeRemovePane(&tree, root);
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 100, 100), 1);
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[second].frame, CGRectMake(0, 0, 100, 50)));
+    JSG_TEST_CHECK(CGRectEqualToRect(tree.nodes[third].frame, CGRectMake(0, 50, 100, 50)));
+
+    // The indices of removed nodes are reused, & the tree never grows past its peak size
+    size_t count = tree.count;
+    JSGSplitTreeSplitPane(&tree, third, JSGSplitTypeHorizontal, 0.5, false, &reused);
+    JSG_TEST_CHECK(tree.count == count && (reused == root || tree.nodes[reused].parent != JSG_SPLIT_NODE_NONE));
+
+    JSGSplitTreeRemovePane(&tree, reused);
+    JSGSplitTreeRemovePane(&tree, third);
+    JSG_TEST_CHECK(tree.root == second && tree.nodes[second].parent == JSG_SPLIT_NODE_NONE);
+
+    JSGSplitTreeRemovePane(&tree, second);
+    JSG_TEST_CHECK(tree.root == JSG_SPLIT_NODE_NONE);
+
+    // Laying out an empty tree does nothing
+    JSGSplitTreeLayout(&tree, CGRectMake(0, 0, 100, 100), 1);
+
+    JSGSplitTreeDestroy(&tree);
+}
+
+int main()
+{
+    JSGTestRun("SplitLayout random trees", TestRandomTrees);
+    JSGTestRun("SplitLayout constraints", TestConstraints);
+    JSGTestRun("SplitLayout removing panes", TestRemovingPanes);
+
+    return JSGTestExitStatus();
+}
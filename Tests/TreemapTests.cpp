@@ -0,0 +1,198 @@
+#include <cmath>
+#include <vector>
+
+#include "JSGTest.h"
+#include "../JSGeometryTreemap.h"
+
+/**
+ *  Tests that treemap tiles exactly cover their container with areas proportional to their
+ *  weights & without overlapping, for flat & nested treemaps, & both layouts.
+ */
+
+static bool Close(CGFloat a, CGFloat b, CGFloat tolerance)
+{
+    return std::fabs(a - b) <= tolerance;
+}
+
+static bool CloseRects(CGRect a, CGRect b)
+{
+    return Close(a.origin.x, b.origin.x, 1e-9) && Close(a.origin.y, b.origin.y, 1e-9) && Close(a.size.width, b.size.width, 1e-9) && Close(a.size.height, b.size.height, 1e-9);
+}
+
+/**
+ *  Check the tiles of one level of a treemap against the rect they were laid out in
+ */
+static bool CheckLevel(const CGFloat *weights, size_t count, CGRect rect, JSGTreemapLayout layout, bool vertical, const CGRect *tiles)
+{
+    CGFloat total = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        total += weights[i] > 0 ? weights[i] : 0;
+    }
+
+    CGFloat area = rect.size.width * rect.size.height;
+    CGFloat tolerance = 1e-9 * (area + 1);
+    bool matches = true;
+
+    for (size_t i = 0; i < count; i++) {
+        CGRect tile = tiles[i];
+
+        if (!(weights[i] > 0) || total <= 0) {
+            matches &= tile.size.width * tile.size.height == 0 && tile.size.width >= 0 && tile.size.height >= 0;
+            continue;
+        }
+
+        matches &= Close(tile.size.width * tile.size.height, area * weights[i] / total, tolerance);
+        matches &= tile.size.width >= 0 && tile.size.height >= 0;
+        matches &= tile.origin.x >= rect.origin.x - 1e-9 && tile.origin.y >= rect.origin.y - 1e-9;
+        matches &= CGRectGetMaxX(tile) <= CGRectGetMaxX(rect) + 1e-9 && CGRectGetMaxY(tile) <= CGRectGetMaxY(rect) + 1e-9;
+
+        for (size_t j = 0; j < i; j++) {
+            CGRect intersection = CGRectIntersection(tile, tiles[j]);
+            matches &= CGRectIsNull(intersection) || intersection.size.width * intersection.size.height <= tolerance;
+        }
+    }
+
+    // Slices are in order, each one starting where the previous one ends, & the last one
+    // ending at the far edge of the rect
+    if (layout == JSGTreemapLayoutSliceAndDice && total > 0) {
+        CGFloat end = vertical ? rect.origin.x : rect.origin.y;
+
+        for (size_t i = 0; i < count; i++) {
+            matches &= Close(vertical ? tiles[i].origin.x : tiles[i].origin.y, end, 1e-9);
+            matches &= vertical ? tiles[i].origin.y == rect.origin.y && tiles[i].size.height == rect.size.height : tiles[i].origin.x == rect.origin.x && tiles[i].size.width == rect.size.width;
+            end = vertical ? CGRectGetMaxX(tiles[i]) : CGRectGetMaxY(tiles[i]);
+        }
+
+        matches &= Close(end, vertical ? CGRectGetMaxX(rect) : CGRectGetMaxY(rect), 1e-9);
+    }
+
+    return matches;
+}
+
+static void TestSquarifiedExample()
+{
+    // The example from the squarified treemaps paper, by Bruls, Huizing & van Wijk
+    CGFloat weights[] = {6, 6, 4, 3, 2, 2, 1};
+    CGRect tiles[7];
+
+    JSG_TEST_CHECK(JSGTreemapLayoutRects(weights, 7, CGRectMake(0, 0, 6, 4), JSGTreemapLayoutSquarified, tiles));
+    JSG_TEST_CHECK(CloseRects(tiles[0], CGRectMake(0, 0, 3, 2)));
+    JSG_TEST_CHECK(CloseRects(tiles[1], CGRectMake(0, 2, 3, 2)));
+    JSG_TEST_CHECK(CloseRects(tiles[2], CGRectMake(3, 0, 12.0 / 7, 7.0 / 3)));
+    JSG_TEST_CHECK(CloseRects(tiles[3], CGRectMake(3 + 12.0 / 7, 0, 9.0 / 7, 7.0 / 3)));
+    JSG_TEST_CHECK(CloseRects(tiles[4], CGRectMake(3, 7.0 / 3, 1.2, 5.0 / 3)));
+    JSG_TEST_CHECK(CloseRects(tiles[5], CGRectMake(4.2, 7.0 / 3, 1.2, 5.0 / 3)));
+    JSG_TEST_CHECK(CloseRects(tiles[6], CGRectMake(5.4, 7.0 / 3, 0.6, 5.0 / 3)));
+}
+
+static void TestRandomWeights()
+{
+    JSGTestRandom random;
+    size_t counts[] = {0, 1, 2, 5, 64, 65, 300};
+    CGRect containers[] = {CGRectMake(10, 20, 800, 600), CGRectMake(0, 0, 50, 1000), CGRectMake(100, 100, -300, -200), CGRectMake(0, 0, 0, 100)};
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        for (size_t j = 0; j < sizeof(containers) / sizeof(containers[0]); j++) {
+            // Weights spanning orders of magnitude, with some ties, zeros & negative weights
+            std::vector<CGFloat> weights(counts[i]);
+            std::vector<CGRect> tiles(counts[i]);
+
+            for (size_t k = 0; k < counts[i]; k++) {
+                weights[k] = k % 11 == 4 ? 0 : k % 11 == 7 ? -3 : k % 5 == 0 ? 10 : std::pow(10, random.next() * 3);
+            }
+
+            for (size_t layout = 0; layout < 2; layout++) {
+                JSGTreemapLayout treemapLayout = layout ? JSGTreemapLayoutSliceAndDice : JSGTreemapLayoutSquarified;
+
+                JSG_TEST_CHECK(JSGTreemapLayoutRects(weights.data(), counts[i], containers[j], treemapLayout, tiles.data()));
+                JSG_TEST_CHECK(CheckLevel(weights.data(), counts[i], CGRectStandardize(containers[j]), treemapLayout, true, tiles.data()));
+            }
+        }
+    }
+
+    // Without any positive weight, every tile is empty
+    CGFloat weights[] = {0, -1, 0};
+    CGRect tiles[3];
+    JSG_TEST_CHECK(JSGTreemapLayoutRects(weights, 3, CGRectMake(5, 5, 10, 10), JSGTreemapLayoutSquarified, tiles));
+    JSG_TEST_CHECK(CGRectEqualToRect(tiles[1], CGRectMake(5, 5, 0, 0)));
+}
+
+static void TestHierarchy()
+{
+    JSGTestRandom random;
+
+    for (size_t iteration = 0; iteration < 20; iteration++) {
+        // A random tree in breadth-first order
+        std::vector<size_t> firstChildren(1), childCounts(1);
+        std::vector<CGFloat> weights(1);
+
+        for (size_t i = 0; i < weights.size() && weights.size() < 400; i++) {
+            size_t childCount = i == 0 ? 2 + random.below(6) : random.below(3) == 0 ? random.below(8) : 0;
+            firstChildren[i] = weights.size();
+            childCounts[i] = childCount;
+
+            for (size_t j = 0; j < childCount; j++) {
+                firstChildren.push_back(0);
+                childCounts.push_back(0);
+                weights.push_back(random.below(10) == 0 ? 0 : 1 + random.next() * 99);
+            }
+        }
+
+        size_t count = weights.size();
+        CGFloat padding = iteration % 2 ? 2 : 0;
+        CGRect container = CGRectMake(0, 0, 1000, 700);
+
+        // The weights of parents are the totals of their children
+        std::vector<CGFloat> totals = weights;
+
+        for (size_t i = count; i-- > 0;) {
+            if (childCounts[i]) {
+                totals[i] = 0;
+
+                for (size_t j = firstChildren[i]; j < firstChildren[i] + childCounts[i]; j++) {
+                    totals[i] += totals[j];
+                }
+            }
+        }
+
+        for (size_t layout = 0; layout < 2; layout++) {
+            JSGTreemapLayout treemapLayout = layout ? JSGTreemapLayoutSliceAndDice : JSGTreemapLayoutSquarified;
+            std::vector<CGRect> tiles(count);
+            std::vector<bool> vertical(count, true);
+
+            JSG_TEST_CHECK(JSGTreemapLayoutHierarchy(weights.data(), firstChildren.data(), childCounts.data(), count, container, treemapLayout, padding, tiles.data()));
+            JSG_TEST_CHECK(CGRectEqualToRect(tiles[0], container));
+
+            bool matches = true;
+
+            for (size_t i = 0; i < count; i++) {
+                if (!childCounts[i]) {
+                    continue;
+                }
+
+                CGRect rect = tiles[i];
+                CGFloat insetX = std::fmin(padding, rect.size.width / 2);
+                CGFloat insetY = std::fmin(padding, rect.size.height / 2);
+                rect = CGRectMake(rect.origin.x + insetX, rect.origin.y + insetY, rect.size.width - 2 * insetX, rect.size.height - 2 * insetY);
+
+                matches &= CheckLevel(totals.data() + firstChildren[i], childCounts[i], rect, treemapLayout, vertical[i], tiles.data() + firstChildren[i]);
+
+                for (size_t j = firstChildren[i]; j < firstChildren[i] + childCounts[i]; j++) {
+                    vertical[j] = !vertical[i];
+                }
+            }
+
+            JSG_TEST_CHECK(matches);
+        }
+    }
+}
+
+int main()
+{
+    JSGTestRun("Treemap squarified example", TestSquarifiedExample);
+    JSGTestRun("Treemap random weights", TestRandomWeights);
+    JSGTestRun("Treemap hierarchy", TestHierarchy);
+
+    return JSGTestExitStatus();
+}